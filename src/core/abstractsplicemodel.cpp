@@ -16,7 +16,10 @@
 
 #include "abstractsplicemodel.h"
 
+#include <QtCore/QList>
+#include <QtCore/QMap>
 #include <QtCore/QSet>
+#include <QtCore/QtAlgorithms>
 
 /*! \class AbstractSpliceModel
  *  \brief The class AbstractSpliceModel is a model (MVC paradigm).
@@ -37,9 +40,144 @@
  * Moreover, this architecture simplifies the calls to the commands
  * that derive from QUndoCommand.
  *
+ * Many edits can be grouped in a transaction, between beginTransaction()
+ * and endTransaction(), to be applied as a single operation: the model
+ * notifies the change once, recalculates the results once, and,
+ * if it supports undo, pushes a single undo command.
+ *
+ * The indexes of the fasteners and the design spaces shift when an element
+ * is inserted or removed before them. A view that must find the element of
+ * one of its items (e.g. a graphics item being dragged) keeps its stable ID
+ * instead, see fastenerId() and fastenerIndex().
+ *
  * \sa AbstractSpliceView.
  */
 
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \fn void AbstractSpliceModel::fastenersInserted(const int first, const int last)
+ * \brief This signal is emitted after the fasteners have been inserted
+ * in the model. The new fasteners are those between \a first and
+ * \a last inclusive. These are always valid rows: an index out of range
+ * given to insertFastener() is bounded before the insertion.
+ *
+ * Like QAbstractItemModel::rowsInserted(), the changes of the fasteners
+ * and the design spaces are notified by ranges, so that the views can
+ * handle the big changes (e.g. loading a file) in a single step.
+ */
+
+/*!
+ * \fn void AbstractSpliceModel::fastenersChanged(const int first, const int last)
+ * \brief This signal is emitted after the fasteners between \a first
+ * and \a last inclusive have been modified.
+ */
+
+/*!
+ * \fn void AbstractSpliceModel::fastenersRemoved(const int first, const int last)
+ * \brief This signal is emitted after the fasteners have been removed
+ * from the model. The removed fasteners were those between \a first
+ * and \a last inclusive.
+ */
+
+/*!
+ * \fn void AbstractSpliceModel::transactionFinished(const int firstFastener, const int lastFastener)
+ * \brief This signal is emitted at the end of the outermost transaction
+ * that modified fasteners. The fasteners between \a firstFastener and
+ * \a lastFastener (inclusive) may have been inserted, modified or removed.
+ *
+ * \remark \a lastFastener can be greater than or equal to fastenerCount()
+ * when fasteners have been inserted or modified, then removed in the
+ * same transaction.
+ */
+
+/*!
+ * \fn void AbstractSpliceModel::fastenersSelected(const QSet<int> &selected, const QSet<int> &deselected)
+ * \brief This signal is emitted before selectionFastenerChanged(), with
+ * the changes of the selection only: the fasteners at the indexes
+ * \a selected have been selected, and those at \a deselected deselected.
+ *
+ * Like QItemSelectionModel::selectionChanged(), a view updates only the
+ * items that changed, rather than all its items.
+ */
+
+/*!
+ * \fn void AbstractSpliceModel::designSpacesSelected(const QSet<int> &selected, const QSet<int> &deselected)
+ * \brief This signal is emitted before selectionDesignSpaceChanged(), with
+ * the changes of the selection only.
+ *
+ * \sa fastenersSelected()
+ */
+
+/* Stable Identifiers */
+/*! \brief Returns the ID of the fastener at the given \a index,
+ * or 0 if the index is out of range.
+ *
+ * Unlike the index, the ID doesn't change when other fasteners are
+ * inserted or removed, and it's never reused in the model.
+ * The default implementation returns \a index + 1, i.e. the ID is not stable.
+ */
+quint32 AbstractSpliceModel::fastenerId(const int index) const
+{
+    return (index >= 0 && index < fastenerCount()) ? quint32(index) + 1 : 0;
+}
+
+/*! \brief Returns the index of the fastener with the given \a id,
+ * or -1 if there's no such fastener.
+ */
+int AbstractSpliceModel::fastenerIndex(const quint32 id) const
+{
+    const int index = int(id) - 1;
+    return (index >= 0 && index < fastenerCount()) ? index : -1;
+}
+
+/*! \brief Returns the ID of the design space at the given \a index,
+ * or 0 if the index is out of range.
+ *
+ * \sa fastenerId()
+ */
+quint32 AbstractSpliceModel::designSpaceId(const int index) const
+{
+    return (index >= 0 && index < designSpaceCount()) ? quint32(index) + 1 : 0;
+}
+
+/*! \brief Returns the index of the design space with the given \a id,
+ * or -1 if there's no such design space.
+ */
+int AbstractSpliceModel::designSpaceIndex(const quint32 id) const
+{
+    const int index = int(id) - 1;
+    return (index >= 0 && index < designSpaceCount()) ? index : -1;
+}
+
+/* Transactions */
+/*! \brief Starts a transaction, i.e. a group of edits applied as a single
+ * operation. The \a text describes the operation (e.g. for the undo stack).
+ *
+ * The transactions can be nested. The default implementation does nothing.
+ */
+void AbstractSpliceModel::beginTransaction(const QString &text)
+{
+    Q_UNUSED(text);
+}
+
+/*! \brief Ends the transaction started with beginTransaction().
+ */
+void AbstractSpliceModel::endTransaction()
+{
+}
+
+/*! \brief Notifies the edits of the current transaction, and recalculates
+ * the results, without ending the transaction.
+ *
+ * An interactive edit (e.g. a drag) is a single transaction, thus a single
+ * undo command, and shows its intermediate results with this method.
+ * The default implementation does nothing.
+ */
+void AbstractSpliceModel::flushTransaction()
+{
+}
+
 /* Public Setters */
 void AbstractSpliceModel::setFastenerSelection(const QSet<int> indexes)
 {
@@ -50,3 +188,84 @@ void AbstractSpliceModel::setDesignSpaceSelection(const QSet<int> indexes)
 {
     Q_UNUSED(indexes);
 }
+
+/*! \brief Selects the fasteners at the indexes \a selected, and deselects
+ * those at \a deselected. The other fasteners keep their selection state.
+ *
+ * The default implementation calls setFastenerSelection() with the whole
+ * selection. Reimplement it to apply the changes only.
+ */
+void AbstractSpliceModel::selectFasteners(const QSet<int> &selected, const QSet<int> &deselected)
+{
+    QSet<int> indexes = selectedFastenerIndexes();
+    indexes.subtract(deselected);
+    indexes.unite(selected);
+    setFastenerSelection(indexes);
+}
+
+/*! \brief Selects the design spaces at the indexes \a selected, and
+ * deselects those at \a deselected.
+ *
+ * \sa selectFasteners()
+ */
+void AbstractSpliceModel::selectDesignSpaces(const QSet<int> &selected, const QSet<int> &deselected)
+{
+    QSet<int> indexes = selectedDesignSpaceIndexes();
+    indexes.subtract(deselected);
+    indexes.unite(selected);
+    setDesignSpaceSelection(indexes);
+}
+
+/*! \brief Inserts the given \a fasteners at the given \a index, in a single transaction.
+ */
+void AbstractSpliceModel::insertFasteners(const int index, const QList<Fastener> &fasteners)
+{
+    if (fasteners.isEmpty())
+        return;
+    beginTransaction(fasteners.count() == 1
+                     ? QStringLiteral("Insert Fastener")
+                     : QString("Insert %0 Fasteners").arg(fasteners.count()));
+    for (int i = 0; i < fasteners.count(); ++i) {
+        insertFastener(index + i, fasteners.at(i));
+    }
+    endTransaction();
+}
+
+/*! \brief Replaces the fasteners at the indexes (keys) of the given
+ * \a fasteners, in a single transaction.
+ */
+void AbstractSpliceModel::setFasteners(const QMap<int, Fastener> &fasteners)
+{
+    if (fasteners.isEmpty())
+        return;
+    beginTransaction(fasteners.count() == 1
+                     ? QStringLiteral("Edit Fastener")
+                     : QString("Edit %0 Fasteners").arg(fasteners.count()));
+    QMapIterator<int, Fastener> it(fasteners);
+    while (it.hasNext()) {
+        it.next();
+        setFastener(it.key(), it.value());
+    }
+    endTransaction();
+}
+
+/*! \brief Removes the fasteners at the given \a indexes, in a single transaction.
+ */
+void AbstractSpliceModel::removeFasteners(const QSet<int> &indexes)
+{
+    if (indexes.isEmpty())
+        return;
+    /*
+     * REMARK: The indexes change during the removal, thus
+     * we need to remove the indexes from the highest to the lowest.
+     */
+    QList<int> list = indexes.toList();
+    qSort(list);
+    beginTransaction(list.count() == 1
+                     ? QStringLiteral("Remove Fastener")
+                     : QString("Remove %0 Fasteners").arg(list.count()));
+    while (!list.isEmpty()) {
+        removeFastener(list.takeLast());
+    }
+    endTransaction();
+}
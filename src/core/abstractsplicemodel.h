@@ -23,6 +23,7 @@
 #include <Core/Solvers/Parameters>
 
 #include <QtCore/QObject>
+#include <QtCore/QString>
 #include <QtCore/QtContainerFwd> /* Forward Declarations of the Qt's Containers */
 
 class DesignSpace;
@@ -49,32 +50,52 @@ public:
     Q_INVOKABLE virtual QSet<int> selectedFastenerIndexes() const = 0;
     Q_INVOKABLE virtual QSet<int> selectedDesignSpaceIndexes() const = 0;
 
+    /* Stable Identifiers */
+    Q_INVOKABLE virtual quint32 fastenerId(const int index) const;
+    Q_INVOKABLE virtual int fastenerIndex(const quint32 id) const;
+    Q_INVOKABLE virtual quint32 designSpaceId(const int index) const;
+    Q_INVOKABLE virtual int designSpaceIndex(const quint32 id) const;
+
     Q_INVOKABLE virtual Tensor appliedLoad() const = 0;
+    Q_INVOKABLE virtual int loadCaseCount() const = 0;
+    Q_INVOKABLE virtual Tensor loadCaseAt(const int index) const = 0;
     Q_INVOKABLE virtual SolverParameters solverParameters() const = 0;
 
     Q_INVOKABLE virtual Tensor resultAt(const int index) const = 0;
+    Q_INVOKABLE virtual QList<Tensor> results() const = 0;
 
     virtual ISolver* solver() const = 0;
 
+    /* Transactions */
+    Q_INVOKABLE virtual void beginTransaction(const QString &text = QString());
+    Q_INVOKABLE virtual void endTransaction();
+    Q_INVOKABLE virtual void flushTransaction();
+
 Q_SIGNALS:
 
     /* Internal Notifications */
-    void fastenerInserted(const int index, const Fastener &fastener);
-    void fastenerChanged(const int index, const Fastener &fastener);
-    void fastenerRemoved(const int index);
+    void fastenersInserted(const int first, const int last);
+    void fastenersChanged(const int first, const int last);
+    void fastenersRemoved(const int first, const int last);
 
-    void designSpaceInserted(const int index, const DesignSpace &designSpace);
-    void designSpaceChanged(const int index, const DesignSpace &designSpace);
-    void designSpaceRemoved(const int index);
+    void designSpacesInserted(const int first, const int last);
+    void designSpacesChanged(const int first, const int last);
+    void designSpacesRemoved(const int first, const int last);
 
     void selectionFastenerChanged();
     void selectionDesignSpaceChanged();
 
+    void fastenersSelected(const QSet<int> &selected, const QSet<int> &deselected);
+    void designSpacesSelected(const QSet<int> &selected, const QSet<int> &deselected);
+
     void appliedLoadChanged();
+    void loadCasesChanged();
     void solverParamsChanged();
 
     void resultsChanged();
 
+    void transactionFinished(const int firstFastener, const int lastFastener);
+
 
 public Q_SLOTS:
 
@@ -93,6 +114,10 @@ public Q_SLOTS:
         Q_UNUSED(index);
     }
 
+    Q_INVOKABLE virtual void insertFasteners(const int index, const QList<Fastener> &fasteners);
+    Q_INVOKABLE virtual void setFasteners(const QMap<int, Fastener> &fasteners);
+    Q_INVOKABLE virtual void removeFasteners(const QSet<int> &indexes);
+
     Q_INVOKABLE virtual void insertDesignSpace(const int index, const DesignSpace &designSpace) {
         Q_UNUSED(index);
         Q_UNUSED(designSpace);
@@ -111,10 +136,27 @@ public Q_SLOTS:
 
     Q_INVOKABLE virtual void setDesignSpaceSelection(const QSet<int> indexes);
 
+    Q_INVOKABLE virtual void selectFasteners(const QSet<int> &selected, const QSet<int> &deselected);
+    Q_INVOKABLE virtual void selectDesignSpaces(const QSet<int> &selected, const QSet<int> &deselected);
+
     Q_INVOKABLE virtual void setAppliedLoad(const Tensor &loadcase) {
         Q_UNUSED(loadcase);
     }
 
+    Q_INVOKABLE virtual void insertLoadCase(const int index, const Tensor &loadCase) {
+        Q_UNUSED(index);
+        Q_UNUSED(loadCase);
+    }
+
+    Q_INVOKABLE virtual void setLoadCase(const int index, const Tensor &loadCase) {
+        Q_UNUSED(index);
+        Q_UNUSED(loadCase);
+    }
+
+    Q_INVOKABLE virtual void removeLoadCase(const int index) {
+        Q_UNUSED(index);
+    }
+
     Q_INVOKABLE virtual void setSolverParameters(SolverParameters params) {
         Q_UNUSED(params);
     }
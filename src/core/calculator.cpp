@@ -18,17 +18,31 @@
 
 #include <Core/SpliceCommand>
 
+#include <QtCore/QList>
+#include <QtCore/QVector>
 #include <QtWidgets/QUndoStack>
 
+#define C_DEFAULT_UNDO_MEMORY_LIMIT (64 * 1024 * 1024) /* 64 MB */
+#define C_UNDO_TRIM_PERCENT         75  /* of the limit, after a trim */
 
 /*! \class Calculator
  *  \brief The class Calculator is an adapter class for SpliceCalculator.
  *
  * It manages the Undo/Redo Mechanism for the SpliceCalculator.
+ *
+ * The edits of a transaction (see beginTransaction()) are grouped
+ * in a single undo command, that is undone and redone as a transaction too.
+ *
+ * The size of the undo stack in memory is bounded (see setUndoMemoryLimit()):
+ * above the limit, the oldest undo commands are discarded, down to 75%
+ * of the limit.
  */
 
 Calculator::Calculator(QObject *parent) : SpliceCalculator(parent)
   , m_undoStack(new QUndoStack(this))
+  , m_transaction(Q_NULLPTR)
+  , m_undoMemoryLimit(C_DEFAULT_UNDO_MEMORY_LIMIT)
+  , m_trimming(false)
 {
     this->clear();
 }
@@ -38,6 +52,92 @@ QUndoStack* Calculator::undoStack() const
     return m_undoStack;
 }
 
+/*! \brief Returns the maximum size of the undo stack in memory, in bytes.
+ * The default is 64 MB. A limit of 0 means no limit.
+ *
+ * The sizes of the commands are estimated.
+ */
+qint64 Calculator::undoMemoryLimit() const
+{
+    return m_undoMemoryLimit;
+}
+
+void Calculator::setUndoMemoryLimit(qint64 bytes)
+{
+    m_undoMemoryLimit = qMax(Q_INT64_C(0), bytes);
+    trimUndoStack();
+}
+
+/*! \brief Returns the approximate size of the undo stack in memory, in bytes.
+ */
+qint64 Calculator::undoMemoryCost() const
+{
+    qint64 res = 0;
+    for (int i = 0; i < m_undoStack->count(); ++i) {
+        res += static_cast<const SpliceCommand::Transaction*>(m_undoStack->command(i))->cost();
+    }
+    return res;
+}
+
+/*! \internal
+ * \brief Discards the oldest undo commands when the undo stack is larger
+ * than the limit, until it's smaller than 75% of the limit. Thus the stack
+ * is not rebuilt at each push once it's full.
+ * The commands that can be redone are kept.
+ *
+ * QUndoStack can't remove its oldest commands (except with an undo limit
+ * set on an empty stack), thus the stack is rebuilt with clones of the
+ * commands that are kept. The clones are pushed and undone without
+ * executing their commands.
+ */
+void Calculator::trimUndoStack()
+{
+    if (m_undoMemoryLimit <= 0 || m_trimming || m_transaction)
+        return;
+
+    const int count = m_undoStack->count();
+    const int index = m_undoStack->index();
+    QVector<qint64> costs(count);
+    qint64 total = 0;
+    for (int i = 0; i < count; ++i) {
+        costs[i] = static_cast<const SpliceCommand::Transaction*>(m_undoStack->command(i))->cost();
+        total += costs.at(i);
+    }
+    if (total <= m_undoMemoryLimit)
+        return;
+    const qint64 target = m_undoMemoryLimit * C_UNDO_TRIM_PERCENT / 100;
+    int first = 0;
+    while (total > target && first < index) {
+        total -= costs.at(first);
+        ++first;
+    }
+    if (first == 0)
+        return;
+
+    QList<SpliceCommand::Transaction*> transactions;
+    for (int i = first; i < count; ++i) {
+        transactions << static_cast<const SpliceCommand::Transaction*>(m_undoStack->command(i))->clone();
+    }
+    const int clean = m_undoStack->cleanIndex();
+
+    m_trimming = true;
+    m_undoStack->clear(); /* Clean at index 0 */
+    foreach (auto transaction, transactions) {
+        m_undoStack->push(transaction);
+        if (m_undoStack->index() == clean - first) {
+            m_undoStack->setClean();
+        }
+    }
+    m_undoStack->setIndex(index - first);
+#if QT_VERSION >= 0x050800
+    if (clean < first) {
+        /* The clean state has been discarded. */
+        m_undoStack->resetClean();
+    }
+#endif
+    m_trimming = false;
+}
+
 /******************************************************************************
  ******************************************************************************/
 void Calculator::clear()
@@ -46,74 +146,153 @@ void Calculator::clear()
     m_undoStack->clear();
 }
 
+/******************************************************************************
+ ******************************************************************************/
+void Calculator::beginTransaction(const QString &text)
+{
+    if (!m_transaction) {
+        m_transaction = new SpliceCommand::Transaction(this, text);
+    }
+    SpliceCalculator::beginTransaction(text);
+}
+
+void Calculator::endTransaction()
+{
+    SpliceCalculator::endTransaction();
+    if (!isInTransaction() && m_transaction) {
+        SpliceCommand::Transaction *transaction = m_transaction;
+        m_transaction = Q_NULLPTR;
+        if (transaction->commandCount() > 0) {
+            /* Already done: push() doesn't redo it. */
+            m_undoStack->push(transaction);
+            trimUndoStack();
+        } else {
+            delete transaction;
+        }
+    }
+}
+
+/*! \internal
+ * \brief Executes the \a command, and pushes it on the undo stack,
+ * or appends it to the current transaction.
+ */
+void Calculator::push(SpliceCommand::Command *command)
+{
+    if (m_transaction) {
+        command->redo();
+        m_transaction->append(command);
+    } else {
+        m_undoStack->push(new SpliceCommand::Transaction(this, command));
+        trimUndoStack();
+    }
+}
+
 /******************************************************************************
  ******************************************************************************/
 void Calculator::setTitle(const QString &title)
 {
-    m_undoStack->push(new SpliceCommand::SetTitle(this, title));
+    push(new SpliceCommand::SetTitle(this, title));
 }
 
 void Calculator::setAuthor(const QString &author)
 {
-    m_undoStack->push(new SpliceCommand::SetAuthor(this, author));
+    push(new SpliceCommand::SetAuthor(this, author));
 }
 
 void Calculator::setDate(const QString &date)
 {
-    m_undoStack->push(new SpliceCommand::SetDate(this, date));
+    push(new SpliceCommand::SetDate(this, date));
 }
 
 void Calculator::setDescription(const QString &description)
 {
-    m_undoStack->push(new SpliceCommand::SetDescription(this, description));
+    push(new SpliceCommand::SetDescription(this, description));
 }
 
 // -----------------------------------------------------------------------------
 void Calculator::insertFastener(const int index, const Fastener &fastener)
 {
-    m_undoStack->push(new SpliceCommand::InsertFastener(this, index, fastener));
+    /* Bounded, so that undo removes the inserted fastener. */
+    push(new SpliceCommand::InsertFastener(this, qBound(0, index, fastenerCount()), fastener));
 }
 
 void Calculator::setFastener(const int index, const Fastener &fastener)
 {
-    m_undoStack->push(new SpliceCommand::SetFastener(this, index, fastener));
+    push(new SpliceCommand::SetFastener(this, index, fastener));
 }
 
 void Calculator::removeFastener(const int index)
 {
-    m_undoStack->push(new SpliceCommand::RemoveFastener(this, index));
+    push(new SpliceCommand::RemoveFastener(this, index));
 }
 
 // -----------------------------------------------------------------------------
 void Calculator::insertDesignSpace(const int index, const DesignSpace &designSpace)
 {
-    m_undoStack->push(new SpliceCommand::InsertDesignSpace(this, index, designSpace));
+    push(new SpliceCommand::InsertDesignSpace(this, qBound(0, index, designSpaceCount()), designSpace));
 }
 
 void Calculator::setDesignSpace(const int index, const DesignSpace &designSpace)
 {
-    m_undoStack->push(new SpliceCommand::SetDesignSpace(this, index, designSpace));
+    push(new SpliceCommand::SetDesignSpace(this, index, designSpace));
 }
 
 void Calculator::removeDesignSpace(const int index)
 {
-    m_undoStack->push(new SpliceCommand::RemoveDesignSpace(this, index));
+    push(new SpliceCommand::RemoveDesignSpace(this, index));
 }
 
 // -----------------------------------------------------------------------------
 void Calculator::setAppliedLoad(const Tensor &appliedLoad)
 {
-    m_undoStack->push(new SpliceCommand::SetAppliedLoad(this, appliedLoad));
+    push(new SpliceCommand::SetAppliedLoad(this, appliedLoad));
+}
+
+void Calculator::insertLoadCase(const int index, const Tensor &loadCase)
+{
+    if (index < 0 || index > loadCaseCount())
+        return;
+    push(new SpliceCommand::InsertLoadCase(this, index, loadCase));
+}
+
+void Calculator::setLoadCase(const int index, const Tensor &loadCase)
+{
+    if (index < 0 || index >= loadCaseCount() || loadCaseAt(index) == loadCase)
+        return;
+    push(new SpliceCommand::SetLoadCase(this, index, loadCase));
+}
+
+void Calculator::removeLoadCase(const int index)
+{
+    if (index < 0 || index >= loadCaseCount())
+        return;
+    push(new SpliceCommand::RemoveLoadCase(this, index));
 }
 
 void Calculator::setSolverParameters(SolverParameters params)
 {
-    m_undoStack->push(new SpliceCommand::SetSolverParameters(this, params));
+    push(new SpliceCommand::SetSolverParameters(this, params));
 }
 
 /******************************************************************************
  ******************************************************************************/
 /* Callback Methods */
+void Calculator::_q_beginTransaction()
+{
+    SpliceCalculator::beginTransaction();
+}
+
+void Calculator::_q_endTransaction()
+{
+    SpliceCalculator::endTransaction();
+}
+
+bool Calculator::_q_isTrimming() const
+{
+    return m_trimming;
+}
+
+// -----------------------------------------------------------------------------
 void Calculator::_q_setTitle(const QString &title)
 {
     SpliceCalculator::setTitle(title);
@@ -172,6 +351,21 @@ void Calculator::_q_setAppliedLoad(const Tensor &appliedLoad)
     SpliceCalculator::setAppliedLoad(appliedLoad);
 }
 
+void Calculator::_q_insertLoadCase(const int index, const Tensor &loadCase)
+{
+    SpliceCalculator::insertLoadCase(index, loadCase);
+}
+
+void Calculator::_q_setLoadCase(const int index, const Tensor &loadCase)
+{
+    SpliceCalculator::setLoadCase(index, loadCase);
+}
+
+void Calculator::_q_removeLoadCase(const int index)
+{
+    SpliceCalculator::removeLoadCase(index);
+}
+
 void Calculator::_q_setSolverParameters(SolverParameters params)
 {
     SpliceCalculator::setSolverParameters(params);
@@ -23,11 +23,15 @@
 
 QT_BEGIN_NAMESPACE
 class QString;
+class QUndoCommand;
 class QUndoStack;
 QT_END_NAMESPACE
 
 
 namespace SpliceCommand {
+class Command;
+class Transaction;
+// --
 class SetTitle;
 class SetAuthor;
 class SetDate;
@@ -42,6 +46,9 @@ class SetDesignSpace;
 class RemoveDesignSpace;
 // --
 class SetAppliedLoad;
+class InsertLoadCase;
+class SetLoadCase;
+class RemoveLoadCase;
 class SetSolverParameters;
 }
 
@@ -53,6 +60,13 @@ public:
 
     QUndoStack *undoStack() const;
 
+    virtual void beginTransaction(const QString &text = QString()) Q_DECL_OVERRIDE;
+    virtual void endTransaction() Q_DECL_OVERRIDE;
+
+    qint64 undoMemoryLimit() const;
+    void setUndoMemoryLimit(qint64 bytes);
+    qint64 undoMemoryCost() const;
+
 public Q_SLOTS:
     virtual void clear() Q_DECL_OVERRIDE;
 
@@ -70,10 +84,15 @@ public Q_SLOTS:
     virtual void removeDesignSpace(const int index) Q_DECL_OVERRIDE;
     // --
     virtual void setAppliedLoad(const Tensor &appliedLoad) Q_DECL_OVERRIDE;
+    virtual void insertLoadCase(const int index, const Tensor &loadCase) Q_DECL_OVERRIDE;
+    virtual void setLoadCase(const int index, const Tensor &loadCase) Q_DECL_OVERRIDE;
+    virtual void removeLoadCase(const int index) Q_DECL_OVERRIDE;
     virtual void setSolverParameters(SolverParameters params) Q_DECL_OVERRIDE;
 
 protected:
     /* Friend Classes */
+    friend class SpliceCommand::Transaction;
+    // --
     friend class SpliceCommand::SetTitle;
     friend class SpliceCommand::SetAuthor;
     friend class SpliceCommand::SetDate;
@@ -88,9 +107,16 @@ protected:
     friend class SpliceCommand::RemoveDesignSpace;
     // --
     friend class SpliceCommand::SetAppliedLoad;
+    friend class SpliceCommand::InsertLoadCase;
+    friend class SpliceCommand::SetLoadCase;
+    friend class SpliceCommand::RemoveLoadCase;
     friend class SpliceCommand::SetSolverParameters;
 
     /* Callback Methods */
+    void _q_beginTransaction();
+    void _q_endTransaction();
+    bool _q_isTrimming() const;
+    // --
     void _q_setTitle(const QString &title);
     void _q_setAuthor(const QString &author);
     void _q_setDate(const QString &date);
@@ -105,10 +131,19 @@ protected:
     void _q_removeDesignSpace(const int index);
     // --
     void _q_setAppliedLoad(const Tensor &appliedLoad);
+    void _q_insertLoadCase(const int index, const Tensor &loadCase);
+    void _q_setLoadCase(const int index, const Tensor &loadCase);
+    void _q_removeLoadCase(const int index);
     void _q_setSolverParameters(SolverParameters params);
 
 private:
     QUndoStack* m_undoStack;
+    SpliceCommand::Transaction* m_transaction;
+    qint64 m_undoMemoryLimit;
+    bool m_trimming;
+
+    void push(SpliceCommand::Command *command);
+    void trimUndoStack();
 
 };
 
@@ -1,32 +1,53 @@
+# QLocalServer (SolverService)
+QT += network
+
 HEADERS  += \
     $$PWD/optimizer/controller.h \
     $$PWD/optimizer/maxminload.h \
     $$PWD/optimizer/optimisationsolver.h \
+    $$PWD/service/solverservice.h \
+    $$PWD/service/solversession.h \
+    $$PWD/solvers/finiteelementsolver.h \
     $$PWD/solvers/isolver.h \
     $$PWD/solvers/parameters.h \
     $$PWD/solvers/rigidbodysolver.h \
+    $$PWD/solvers/solvercache.h \
+    $$PWD/solvers/solverworker.h \
     $$PWD/units/area_moment_of_inertia.h \
+    $$PWD/units/raw_quantity.h \
     $$PWD/units/unit_system.h \
     $$PWD/abstractsplicemodel.h \
     $$PWD/calculator.h \
     $$PWD/designspace.h \
     $$PWD/fastener.h \
     $$PWD/splice.h \
+    $$PWD/splicebinary.h \
+    $$PWD/splicejson.h \
     $$PWD/splicecalculator.h \
     $$PWD/splicecommand.h \
+    $$PWD/splicefileworker.h \
     $$PWD/tensor.h
 
 SOURCES += \
     $$PWD/optimizer/controller.cpp \
     $$PWD/optimizer/maxminload.cpp \
     $$PWD/optimizer/optimisationsolver.cpp \
+    $$PWD/service/solverservice.cpp \
+    $$PWD/service/solversession.cpp \
+    $$PWD/solvers/finiteelementsolver.cpp \
+    $$PWD/solvers/isolver.cpp \
     $$PWD/solvers/parameters.cpp \
     $$PWD/solvers/rigidbodysolver.cpp \
+    $$PWD/solvers/solvercache.cpp \
+    $$PWD/solvers/solverworker.cpp \
     $$PWD/abstractsplicemodel.cpp \
     $$PWD/calculator.cpp \
     $$PWD/designspace.cpp \
     $$PWD/fastener.cpp \
     $$PWD/splice.cpp \
+    $$PWD/splicebinary.cpp \
+    $$PWD/splicejson.cpp \
     $$PWD/splicecalculator.cpp \
     $$PWD/splicecommand.cpp \
+    $$PWD/splicefileworker.cpp \
     $$PWD/tensor.cpp
@@ -19,14 +19,20 @@
 #include "maxminload.h"
 #include <Core/Optimizer/OptimisationSolver>
 #include <Core/Solvers/ISolver>
+#include <Core/Solvers/SolverCache>
 #include <Core/Splice>
 
 #include <QtCore/QDebug>
 #include <QtCore/QDateTime>
+#include <QtCore/QMutexLocker>
 #include <QtCore/QRunnable>
 #include <QtCore/QThreadPool>
+#include <QtCore/QTimer>
 #include <QtCore/QtMath> /* qFloor() */
 
+#define C_REPORT_INTERVAL_MSEC 500
+#define C_REPORT_MAX_FASTENERS 10
+
 /******************************************************************************
  ******************************************************************************/
 
@@ -76,6 +82,17 @@ private:
  * Each Task is an independant part of the whole optimisation process.
  * The Controller distributes the optimisation through all the CPUs.
  *
+ *
+ * \section reports Reports
+ *
+ * The better solutions can be found at a high rate. The Controller
+ * aggregates them: it reports the max load at most every 500 ms,
+ * with the number of improvements since the previous report.
+ * The improvements aggregated at the end of an interval are reported
+ * when it elapses, even if no better solution is found after them.
+ * The positions of the fasteners are reported once, for the best
+ * solution, when the optimisation is finished or cancelled.
+ *
  * \sa OptimisationSolver
  */
 Controller::Controller(QObject *parent) : QObject(parent)
@@ -85,7 +102,13 @@ Controller::Controller(QObject *parent) : QObject(parent)
   , m_output(QSharedPointer<Splice>(new Splice))
   , m_iteration(0)
   , m_iterationCount(10000)
+  , m_bestMaxLoad(0)
+  , m_pendingImprovements(0)
+  , m_reportFlushTimer(new QTimer(this))
 {
+    m_reportFlushTimer->setSingleShot(true);
+    connect(m_reportFlushTimer, SIGNAL(timeout()), this, SLOT(_q_flushReport()));
+
     /*
      * When a task is completed, the controller starts a new task directly,
      * without waiting for the end of the other running tasks.
@@ -144,13 +167,25 @@ void Controller::onTaskCompleted()
         m_iteration--;
         runTask();
     } else if (m_iteration == 0) {
-        waitForFinishing();
-        emit progressed(100);
-        emit messageInfo(timestamp(), tr("Finished."));
-        emit stopped();
+        /* Called in the thread of the task: the report timer
+         * belongs to the thread of the controller. */
+        m_iteration = -1;
+        QMetaObject::invokeMethod(this, "_q_finish", Qt::QueuedConnection);
     }
 }
 
+void Controller::_q_finish()
+{
+    waitForFinishing();
+    reportBestSolution();
+    emit progressed(100);
+    emit messageInfo(timestamp(), tr("Finished."));
+    const SolverCache *cache = SolverCache::globalInstance();
+    emit messageDebug(tr("Solver cache: %0 hits, %1 misses.")
+                      .arg(cache->hitCount()).arg(cache->missCount()));
+    emit stopped();
+}
+
 void Controller::onErrorDetected(OptimisationErrorType error)
 {
     emit messageFatal(timestamp(), toString(error));
@@ -158,22 +193,81 @@ void Controller::onErrorDetected(OptimisationErrorType error)
 
 void Controller::onBetterSolutionFound(const Splice &solution)
 {
-    QList<Tensor> result = m_solver->calculate( &solution );
+    QList<Tensor> result = SolverCache::globalInstance()->calculateEnvelope( m_solver, &solution );
     Force bestResultantForce = maxLoad(result);
 
+    QMutexLocker locker(&m_reportMutex);
+    if (m_bestSolution.isNull()) {
+        m_bestSolution = QSharedPointer<Splice>(new Splice);
+    }
+    *m_bestSolution = solution;
+    m_bestMaxLoad = bestResultantForce.value();
+    m_pendingImprovements++;
+
+    const qint64 elapsed = m_reportTimer.isValid() ? m_reportTimer.elapsed() : C_REPORT_INTERVAL_MSEC;
+    if (elapsed < C_REPORT_INTERVAL_MSEC) {
+        /* Aggregated in the next report */
+        if (!m_reportFlushTimer->isActive()) {
+            m_reportFlushTimer->start(int(C_REPORT_INTERVAL_MSEC - elapsed));
+        }
+        return;
+    }
+    reportImprovements();
+}
+
+void Controller::_q_flushReport()
+{
+    QMutexLocker locker(&m_reportMutex);
+    reportImprovements();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/* Reports the pending improvements in a single line.
+ * The caller must lock m_reportMutex, in the thread of the controller. */
+void Controller::reportImprovements()
+{
+    if (m_pendingImprovements == 0)
+        return;
+
+    QString message;
+    message = QString("MaxLoad = %0 N (%1 improvement(s))")
+            .arg(m_bestMaxLoad)
+            .arg(m_pendingImprovements);
+    emit messageInfo(timestamp(), message);
+
+    m_pendingImprovements = 0;
+    m_reportTimer.start();
+    m_reportFlushTimer->stop();
+}
+
+/* Reports the last improvements, and the positions of the fasteners
+ * of the best solution. */
+void Controller::reportBestSolution()
+{
+    QMutexLocker locker(&m_reportMutex);
+    reportImprovements();
+    if (m_bestSolution.isNull())
+        return;
+
     auto ts = timestamp();
     QString message;
-    message = QString("MaxLoad = %0 N, with:").arg(bestResultantForce.value());
+    message = QString("Best MaxLoad = %0 N, with:").arg(m_bestMaxLoad);
     emit messageInfo(ts, message);
 
-    for (int k = 0; k < solution.fastenerCount(); ++k) {
+    const int count = m_bestSolution->fastenerCount();
+    const int shown = qMin(count, C_REPORT_MAX_FASTENERS);
+    for (int k = 0; k < shown; ++k) {
         QString details;
         details = QString("  - fastener %0 at (%1,%2)")
                 .arg(k)
-                .arg(solution.fastenerAt(k).positionX.value())
-                .arg(solution.fastenerAt(k).positionY.value());
+                .arg(m_bestSolution->fastenerAt(k).positionX.value())
+                .arg(m_bestSolution->fastenerAt(k).positionY.value());
         emit messageInfo(ts, details);
     }
+    if (count > shown) {
+        emit messageInfo(ts, QString("  - ... and %0 more").arg(count - shown));
+    }
 }
 
 /******************************************************************************
@@ -193,6 +287,7 @@ void Controller::cancel()
 {
     emit messageInfo(timestamp(), tr("Cancelling..."));
     waitForFinishing();
+    reportBestSolution();
     emit progressed(0);
     emit messageInfo(timestamp(), tr("Cancelled."));
     emit stopped();
@@ -228,6 +323,13 @@ void Controller::start()
     Q_ASSERT(!m_input.isNull());
     Q_ASSERT(!m_output.isNull());
 
+    m_reportMutex.lock();
+    m_bestSolution.clear();
+    m_pendingImprovements = 0;
+    m_reportTimer.invalidate();
+    m_reportFlushTimer->stop();
+    m_reportMutex.unlock();
+
     emit started();
     emit progressed(0);
     emit messageInfo(timestamp(), tr("Started."));
@@ -292,7 +394,7 @@ inline QString Controller::toString(OptimisationErrorType error) const
         return tr("Error: the optimizer requires an output splice.");
         break;
     case OptimisationErrorType::ERR_NO_APPLIED_LOAD:
-        return tr("Error: the splice must have a non-zero applied load.");
+        return tr("Error: the splice must have a non-zero applied load or load case.");
         break;
     case OptimisationErrorType::ERR_NO_DESIGNSPACE:
         return tr("Error: the splice must have a design space.");
@@ -17,11 +17,14 @@
 #ifndef CORE_OPTIMISATION_CONTROLLER_H
 #define CORE_OPTIMISATION_CONTROLLER_H
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
 #include <QtCore/QSharedPointer>
 
 QT_BEGIN_NAMESPACE
 class QString;
+class QTimer;
 QT_END_NAMESPACE
 
 class ISolver;
@@ -62,6 +65,10 @@ Q_SIGNALS:
     void messageFatal(qint64 timestamp, QString message);
     void messageDebug(QString message);
 
+private Q_SLOTS:
+    void _q_flushReport();
+    void _q_finish();
+
 private:
     OptimisationSolver *m_optimizer;
     ISolver *m_solver;
@@ -70,8 +77,18 @@ private:
     int m_iteration;
     int m_iterationCount;
 
+    /* Improvements, reported at most every C_REPORT_INTERVAL_MSEC */
+    QMutex m_reportMutex;
+    QElapsedTimer m_reportTimer;
+    QSharedPointer<Splice> m_bestSolution;
+    double m_bestMaxLoad; /* in N */
+    int m_pendingImprovements;
+    QTimer *m_reportFlushTimer; /* Reports the last aggregated improvements */
+
     void runTask();
     void waitForFinishing();
+    void reportImprovements();
+    void reportBestSolution();
 
     inline QString toString(OptimisationErrorType error) const;
     inline qint64 timestamp() const;
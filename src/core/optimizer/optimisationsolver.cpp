@@ -18,6 +18,7 @@
 #include "maxminload.h"
 
 #include <Core/Solvers/ISolver>
+#include <Core/Solvers/SolverCache>
 #include <Core/Tensor>
 #include <Core/Splice>
 #include <Math/Utils>
@@ -179,6 +180,10 @@ static inline void deepCopy(const Splice *from, Splice *to)
     to->setDescription(from->description());
 
     to->setAppliedLoad(from->appliedLoad());
+    to->removeAllLoadCases();
+    for (int i = 0; i < from->loadCaseCount(); ++i) {
+        to->addLoadCase(from->loadCaseAt(i));
+    }
 
     fastenersCopy(from, to);
     designSpacesCopy(from, to);
@@ -209,7 +214,11 @@ bool OptimisationSolver::sanitarize()
         isValid = false;
     }
     if (m_input) {
-        if (m_input->appliedLoad() == Tensor()) {
+        bool hasLoad = (m_input->appliedLoad() != Tensor());
+        for (int i = 0; i < m_input->loadCaseCount(); ++i) {
+            hasLoad |= (m_input->loadCaseAt(i) != Tensor());
+        }
+        if (!hasLoad) {
             emit errorDetected(OptimisationErrorType::ERR_NO_APPLIED_LOAD);
             isValid = false;
         }
@@ -328,7 +337,8 @@ void OptimisationSolver::runAsync()
     deepCopy( m_output, &bestSolution );
     m_lock.unlock();
 
-    QList<Tensor> result = m_solver->calculate( &bestSolution );
+    /* The objective is the envelope of the load cases */
+    QList<Tensor> result = SolverCache::globalInstance()->calculateEnvelope( m_solver, &bestSolution );
     Force bestResultantForce = maxLoad(result);
     result.clear();
 
@@ -398,7 +408,7 @@ void OptimisationSolver::runAsync()
                         fk.positionY += deltaY *m;
                         localSolution.setFastenerAt(k, fk);
 
-                        QList<Tensor> result = m_solver->calculate( &localSolution );
+                        QList<Tensor> result = SolverCache::globalInstance()->calculateEnvelope( m_solver, &localSolution );
                         Force maxResultantForce = maxLoad(result);
 
                         if (bestResultantForce > maxResultantForce) {
@@ -430,7 +440,7 @@ void OptimisationSolver::runAsync()
                     fss.positionY = Math::Utils::round( fss.positionY.value(), precision ) *m;
                     intSolution.setFastenerAt(k, fss);
 
-                    QList<Tensor> result = m_solver->calculate( &intSolution );
+                    QList<Tensor> result = SolverCache::globalInstance()->calculateEnvelope( m_solver, &intSolution );
                     Force maxResultantForce = maxLoad(result);
 
                     if (bestResultantForce > maxResultantForce) {
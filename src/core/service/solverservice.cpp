@@ -0,0 +1,169 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "solverservice.h"
+#include "solversession.h"
+
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+#ifdef QT_DEBUG
+#  include <QtCore/QDebug>
+#endif
+
+/* Time to wait for an answer of the instance that uses the same name, in ms. */
+#define C_SERVICE_PROBE_TIMEOUT 500
+
+
+/*! \class SolverService
+ *  \brief The class SolverService is a long-running solver,
+ *  that listens on a local socket (named pipe on Windows,
+ *  Unix domain socket otherwise).
+ *
+ * External tools that call the solver many times with small edits
+ * of the same splice should connect to the service, instead of
+ * launching the application and parsing a complete .splice file
+ * for every solve.
+ *
+ * Each connection owns its own SolverSession, so the splice
+ * and the solver stay in memory between the requests.
+ *
+ * The protocol is line-based: each request is one compact JSON object
+ * terminated by a newline, and each reply is one compact JSON object
+ * terminated by a newline, in the same order as the requests.
+ *
+ * \sa SolverSession
+ */
+
+/*! \brief Constructor.
+ */
+SolverService::SolverService(QObject *parent) : QObject(parent)
+  , m_server(new QLocalServer(this))
+{
+    QObject::connect(m_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+}
+
+SolverService::~SolverService()
+{
+    close();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Start listening on the local socket of the given \a name.
+ * Returns true on success, otherwise false (see errorString()).
+ *
+ * If a running instance already listens on \a name, returns false
+ * and leaves its socket. A stale socket is replaced.
+ */
+bool SolverService::listen(const QString &name)
+{
+    if (m_server->listen(name)) {
+        return true;
+    }
+    if (m_server->serverError() != QAbstractSocket::AddressInUseError) {
+        return false;
+    }
+    /* The name is in use. If another instance answers, keep its socket. */
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(C_SERVICE_PROBE_TIMEOUT)) {
+        probe.abort();
+        return false;
+    }
+    /* Otherwise, remove the stale socket file left by a crashed instance (Unix only). */
+    QLocalServer::removeServer(name);
+    return m_server->listen(name);
+}
+
+void SolverService::close()
+{
+    m_server->close();
+    foreach (QLocalSocket *socket, m_sessions.keys()) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+    qDeleteAll(m_sessions);
+    m_sessions.clear();
+}
+
+QString SolverService::serverName() const
+{
+    return m_server->fullServerName();
+}
+
+QString SolverService::errorString() const
+{
+    return m_server->errorString();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void SolverService::onNewConnection()
+{
+    while (m_server->hasPendingConnections()) {
+        QLocalSocket *socket = m_server->nextPendingConnection();
+        m_sessions.insert(socket, new SolverSession());
+        QObject::connect(socket, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+        QObject::connect(socket, SIGNAL(disconnected()), this, SLOT(onDisconnected()));
+    }
+}
+
+void SolverService::onReadyRead()
+{
+    QLocalSocket *socket = static_cast<QLocalSocket *>(sender());
+    if (!socket)
+        return;
+
+    SolverSession *session = m_sessions.value(socket, Q_NULLPTR);
+    if (!session)
+        return;
+
+    while (socket->canReadLine()) {
+        const QByteArray line = socket->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        QJsonObject reply;
+        QJsonParseError ok;
+        QJsonDocument request( QJsonDocument::fromJson(line, &ok) );
+
+        if (ok.error != QJsonParseError::NoError || !request.isObject()) {
+            reply["status"] = QStringLiteral("error");
+            reply["error"] = QString("Cannot parse the request at character %0, %1.")
+                    .arg(ok.offset)
+                    .arg(ok.errorString());
+        } else {
+            reply = session->process(request.object());
+        }
+
+        socket->write( QJsonDocument(reply).toJson(QJsonDocument::Compact) );
+        socket->write( "\n" );
+    }
+}
+
+void SolverService::onDisconnected()
+{
+    QLocalSocket *socket = static_cast<QLocalSocket *>(sender());
+    if (!socket)
+        return;
+
+    delete m_sessions.take(socket);
+    socket->deleteLater();
+}
@@ -0,0 +1,56 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_SERVICE_SOLVER_SERVICE_H
+#define CORE_SERVICE_SOLVER_SERVICE_H
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+
+QT_BEGIN_NAMESPACE
+class QLocalServer;
+class QLocalSocket;
+class QString;
+QT_END_NAMESPACE
+
+class SolverSession;
+
+#define C_DEFAULT_SERVICE_NAME "fastenerpattern"
+
+class SolverService : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SolverService(QObject *parent = Q_NULLPTR);
+    ~SolverService();
+
+    bool listen(const QString &name = QLatin1String(C_DEFAULT_SERVICE_NAME));
+    void close();
+
+    QString serverName() const;
+    QString errorString() const;
+
+private Q_SLOTS:
+    void onNewConnection();
+    void onReadyRead();
+    void onDisconnected();
+
+private:
+    QLocalServer *m_server;
+    QHash<QLocalSocket*, SolverSession*> m_sessions;
+};
+
+#endif // CORE_SERVICE_SOLVER_SERVICE_H
@@ -0,0 +1,195 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "solversession.h"
+
+#include <Core/Fastener>
+#include <Core/SpliceCalculator>
+#include <Core/Tensor>
+#include <Core/Solvers/Parameters>
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+
+
+/*! \class SolverSession
+ *  \brief The class SolverSession keeps a splice and its solver warm
+ *  between incremental edit requests.
+ *
+ * A session owns one SpliceCalculator. Each request is a JSON object
+ * with a \c "command" member, and the reply is a JSON object with a
+ * \c "status" member (\c "ok" or \c "error") and the updated
+ * per-fastener \c "results".
+ *
+ * Supported commands:
+ * \li \c open                  { "splice": <.splice JSON object> }
+ * \li \c insertFastener        { "index": int, "fastener": <fastener JSON object> }
+ * \li \c setFastener           { "index": int, "fastener": <fastener JSON object> }
+ * \li \c moveFastener          { "index": int, "x": meter, "y": meter }
+ * \li \c removeFastener        { "index": int }
+ * \li \c setAppliedLoad        { "load": <tensor JSON object> }
+ * \li \c setSolverParameters   { "solver": "IsoBearing" | "IsoShear" | "None" }
+ * \li \c solve                 {} (only returns the current results)
+ *
+ * If the request contains an \c "id", it is echoed in the reply,
+ * so that the client can pipeline several requests.
+ *
+ * \sa SolverService
+ */
+
+/*! \brief Constructor.
+ */
+SolverSession::SolverSession(QObject *parent) : QObject(parent)
+  , m_calculator(new SpliceCalculator(this))
+{
+    m_calculator->clear();
+}
+
+SolverSession::~SolverSession()
+{
+}
+
+SpliceCalculator *SolverSession::calculator() const
+{
+    return m_calculator;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Apply the given \a request to the session and return the reply.
+ */
+QJsonObject SolverSession::process(const QJsonObject &request)
+{
+    QJsonObject reply;
+    if (request.contains("id")) {
+        reply["id"] = request["id"];
+    }
+
+    QString error;
+    const QString command = request["command"].toString();
+    if (dispatch(command, request, &error)) {
+        reply["status"] = QStringLiteral("ok");
+        writeResults(reply);
+    } else {
+        reply["status"] = QStringLiteral("error");
+        reply["error"] = error;
+    }
+    return reply;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+static inline bool isValidIndex(const int index, const int count)
+{
+    return index >= 0 && index < count;
+}
+
+bool SolverSession::dispatch(const QString &command, const QJsonObject &request,
+                             QString *error)
+{
+    Q_ASSERT(error);
+
+    if (command == QLatin1String("open")) {
+        m_calculator->read(request["splice"].toObject());
+        return true;
+
+    } else if (command == QLatin1String("insertFastener")) {
+        const int count = m_calculator->fastenerCount();
+        const int index = request["index"].toInt(count);
+        if (index < 0 || index > count) { /* can append */
+            *error = QString("Invalid fastener index %0.").arg(index);
+            return false;
+        }
+        Fastener fastener;
+        fastener.read(request["fastener"].toObject());
+        m_calculator->insertFastener(index, fastener);
+        return true;
+
+    } else if (command == QLatin1String("setFastener")) {
+        const int index = request["index"].toInt(-1);
+        if (!isValidIndex(index, m_calculator->fastenerCount())) {
+            *error = QString("Invalid fastener index %0.").arg(index);
+            return false;
+        }
+        Fastener fastener;
+        fastener.read(request["fastener"].toObject());
+        m_calculator->setFastener(index, fastener);
+        return true;
+
+    } else if (command == QLatin1String("moveFastener")) {
+        const int index = request["index"].toInt(-1);
+        if (!isValidIndex(index, m_calculator->fastenerCount())) {
+            *error = QString("Invalid fastener index %0.").arg(index);
+            return false;
+        }
+        Fastener fastener = m_calculator->fastenerAt(index);
+        fastener.positionX = request["x"].toDouble() *m;
+        fastener.positionY = request["y"].toDouble() *m;
+        m_calculator->setFastener(index, fastener);
+        return true;
+
+    } else if (command == QLatin1String("removeFastener")) {
+        const int index = request["index"].toInt(-1);
+        if (!isValidIndex(index, m_calculator->fastenerCount())) {
+            *error = QString("Invalid fastener index %0.").arg(index);
+            return false;
+        }
+        m_calculator->removeFastener(index);
+        return true;
+
+    } else if (command == QLatin1String("setAppliedLoad")) {
+        Tensor load;
+        load.read(request["load"].toObject());
+        m_calculator->setAppliedLoad(load);
+        return true;
+
+    } else if (command == QLatin1String("setSolverParameters")) {
+        const QString solver = request["solver"].toString();
+        if (solver == QLatin1String("IsoBearing")) {
+            m_calculator->setSolverParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+        } else if (solver == QLatin1String("IsoShear")) {
+            m_calculator->setSolverParameters(SolverParameters::RigidBodySolverWithIsoShear);
+        } else if (solver == QLatin1String("None")) {
+            m_calculator->setSolverParameters(SolverParameters::NoSolver);
+        } else {
+            *error = QString("Unknown solver '%0'.").arg(solver);
+            return false;
+        }
+        return true;
+
+    } else if (command == QLatin1String("solve")) {
+        /* The results are always up-to-date. Nothing to do. */
+        return true;
+    }
+
+    *error = QString("Unknown command '%0'.").arg(command);
+    return false;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void SolverSession::writeResults(QJsonObject &reply) const
+{
+    QJsonArray resultsArray;
+    const int count = m_calculator->fastenerCount();
+    for (int i = 0; i < count; ++i) {
+        QJsonObject resultObject;
+        m_calculator->resultAt(i).write(resultObject);
+        resultsArray.append(resultObject);
+    }
+    reply["results"] = resultsArray;
+}
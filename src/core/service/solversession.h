@@ -0,0 +1,47 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_SERVICE_SOLVER_SESSION_H
+#define CORE_SERVICE_SOLVER_SESSION_H
+
+#include <QtCore/QObject>
+
+QT_BEGIN_NAMESPACE
+class QJsonObject;
+class QString;
+QT_END_NAMESPACE
+
+class SpliceCalculator;
+
+class SolverSession : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SolverSession(QObject *parent = Q_NULLPTR);
+    ~SolverSession();
+
+    SpliceCalculator *calculator() const;
+
+    QJsonObject process(const QJsonObject &request);
+
+private:
+    SpliceCalculator *m_calculator;
+
+    bool dispatch(const QString &command, const QJsonObject &request, QString *error);
+    void writeResults(QJsonObject &reply) const;
+};
+
+#endif // CORE_SERVICE_SOLVER_SESSION_H
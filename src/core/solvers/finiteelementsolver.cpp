@@ -0,0 +1,897 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "finiteelementsolver.h"
+
+#include <Core/Splice>
+#include <Core/Tensor>
+#include <Core/Solvers/Parameters>
+#include <Math/SparseCholesky>
+#include <Math/Triangulator>
+
+#include <QtCore/QHash>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QPair>
+#include <QtCore/QPointF>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtCore/QtMath>
+
+#include <algorithm>
+
+/* Plate material (aluminium alloy) */
+#define C_FEM_YOUNG_MODULUS         70.0e9  /* Pa */
+#define C_FEM_POISSON_RATIO         0.33
+
+/* Swift's formula of the fastener flexibility (aluminium):
+ *   k = E.d / (A + B.d/t)  */
+#define C_FEM_SWIFT_A               5.0
+#define C_FEM_SWIFT_B               0.8
+
+/* Distance from the outer fasteners to the plate's edges, in diameters */
+#define C_FEM_EDGE_DISTANCE         2.0
+
+#define C_FEM_DEFAULT_NODE_COUNT    1000
+
+/* Weak spring on each node, relative to the plate stiffness E.t,
+ * that removes the rigid-body modes of an under-constrained plate. */
+#define C_FEM_SOFT_SPRING_FACTOR    1.0e-9
+
+/* Relative residual of the conjugate gradient */
+#define C_FEM_TOLERANCE             1.0e-8
+
+/* Minimum nodes per thread */
+#define C_FEM_NODES_PER_THREAD      5000
+
+/* Maximum non-zeros of the Cholesky factor (about 12 bytes each).
+ * Above, the system is solved by the conjugate gradient. */
+#define C_FEM_MAX_FACTOR_SIZE       10000000
+
+/* Nodes of the smallest parts of the nested dissection */
+#define C_FEM_DISSECTION_LEAF_SIZE  64
+
+/* Unit load cases: body forces of resultant Fx, Fy, and Mz at the plate's center */
+#define C_FEM_LOAD_CASES            3
+
+/* Sparse symmetric matrix (CSR), with 2 degrees of freedom per node. */
+struct FiniteElementSolver::StiffnessMatrix
+{
+    QVector<int> nodeStart;   /* Per node, start in nodeColumns */
+    QVector<int> nodeColumns; /* Per node, the sorted adjacent nodes (including itself) */
+    QVector<int> rowStart;    /* Per dof, start in values */
+    QVector<double> values;
+
+    /* Index of the value (2i+a, 2j+b) in values */
+    inline int index(int i, int a, int j, int b) const
+    {
+        const int *first = nodeColumns.constData() + nodeStart.at(i);
+        const int *last = nodeColumns.constData() + nodeStart.at(i + 1);
+        const int k = int(std::lower_bound(first, last, j) - first);
+        Q_ASSERT(first + k != last && first[k] == j);
+        return rowStart.at(2 * i + a) + 2 * k + b;
+    }
+};
+
+/* Loads of the fasteners for the unit load cases, for a given geometry. */
+struct FiniteElementSolver::Response
+{
+    uint hash;
+    QVector<double> geometry;   /* Node count, and data of each fastener */
+    double centerX;
+    double centerY;
+    QVector<double> loads;      /* Per fastener, per load case: fx, fy */
+};
+
+namespace {
+// ---------------------------------
+class RangeTask : public QRunnable
+{
+public:
+    RangeTask(const std::function<void(int, int, int)> &function,
+              int chunk, int begin, int end, QSemaphore *done)
+        : QRunnable()
+        , m_function(function)
+        , m_chunk(chunk), m_begin(begin), m_end(end)
+        , m_done(done)
+    {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        m_function(m_chunk, m_begin, m_end);
+        m_done->release();
+    }
+
+private:
+    const std::function<void(int, int, int)> &m_function;
+    int m_chunk;
+    int m_begin;
+    int m_end;
+    QSemaphore *m_done;
+};
+// ---------------------------------
+} // namespace
+
+static inline double fastenerStiffness(const Fastener &f)
+{
+    const double d = f.diameter.value();
+    const double t = f.thickness.value();
+    if (d <= 0 || t <= 0) {
+        return 0;
+    }
+    return C_FEM_YOUNG_MODULUS * d / (C_FEM_SWIFT_A + C_FEM_SWIFT_B * d / t);
+}
+
+/* Data that defines the stiffness matrix (but not the applied load) */
+static QVector<double> geometry(const Splice *splice, int nodeCount)
+{
+    const int count = splice->fastenerCount();
+    QVector<double> res;
+    res.reserve(1 + 6 * count);
+    res.append(nodeCount);
+    for (int i = 0; i < count; ++i) {
+        const Fastener &f = splice->fastenerAt(i);
+        res.append(f.positionX.value());
+        res.append(f.positionY.value());
+        res.append(f.diameter.value());
+        res.append(f.thickness.value());
+        res.append(f.DoF_X);
+        res.append(f.DoF_Y);
+    }
+    return res;
+}
+
+static uint geometryHash(const QVector<double> &geometry)
+{
+    uint res = 0;
+    for (int i = 0; i < geometry.count(); ++i) {
+        res = 31 * res + qHash(geometry.at(i));
+    }
+    return res;
+}
+
+/* Appends the nodes to \a order, in nested dissection order: each part is
+ * split in halves by a line of nodes (the separator), that comes last.
+ * The fill of the Cholesky factor of a 2D mesh is then O(n.log(n)). */
+static void dissect(const QPointF *xy, const int *nodeStart, const int *nodeColumns,
+                    const QVector<int> &nodes, QVector<int> &label, int &nextLabel,
+                    QVector<int> &order)
+{
+    if (nodes.count() <= C_FEM_DISSECTION_LEAF_SIZE) {
+        order += nodes;
+        return;
+    }
+    qreal minX = xy[nodes.first()].x(), maxX = minX;
+    qreal minY = xy[nodes.first()].y(), maxY = minY;
+    foreach (const int node, nodes) {
+        minX = qMin(minX, xy[node].x());
+        maxX = qMax(maxX, xy[node].x());
+        minY = qMin(minY, xy[node].y());
+        maxY = qMax(maxY, xy[node].y());
+    }
+    const bool useX = (maxX - minX >= maxY - minY);
+
+    /* Split at the median */
+    QVector<int> sorted = nodes;
+    QVector<int>::iterator middle = sorted.begin() + sorted.count() / 2;
+    std::nth_element(sorted.begin(), middle, sorted.end(), [xy, useX](int a, int b) {
+        return useX ? xy[a].x() < xy[b].x() : xy[a].y() < xy[b].y();
+    });
+    const QVector<int> second(middle, sorted.end());
+    const int secondLabel = nextLabel++;
+    foreach (const int node, second) {
+        label[node] = secondLabel;
+    }
+
+    /* The nodes of the first half connected to the second half */
+    QVector<int> first;
+    QVector<int> separator;
+    for (QVector<int>::const_iterator it = sorted.constBegin(); it != middle; ++it) {
+        const int node = *it;
+        bool connected = false;
+        for (int k = nodeStart[node]; k < nodeStart[node + 1]; ++k) {
+            if (label.at(nodeColumns[k]) == secondLabel) {
+                connected = true;
+                break;
+            }
+        }
+        if (connected) {
+            separator.append(node);
+        } else {
+            first.append(node);
+        }
+    }
+    const int firstLabel = nextLabel++;
+    foreach (const int node, first) {
+        label[node] = firstLabel;
+    }
+
+    dissect(xy, nodeStart, nodeColumns, first, label, nextLabel, order);
+    dissect(xy, nodeStart, nodeColumns, second, label, nextLabel, order);
+    order += separator;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class FiniteElementSolver
+ * \brief The class FiniteElementSolver calculates the distribution of loads
+ * with a 2D linear elastic model of the plate.
+ *
+ * The plate is a rectangle around the fasteners (with an edge distance of
+ * 2 diameters), loaded by the applied load at the origin, like in the
+ * RigidBodySolver. The fasteners are springs between the plate and the
+ * other part, which is assumed rigid. Their stiffness is given by the
+ * Swift's formula, in the fixed degrees of freedom only.
+ *
+ * Steps:
+ * \li The plate is meshed with linear triangles (plane stress): a regular
+ * grid of nodes, plus one node at each fastener, triangulated with Triangle
+ * (see Math::Triangulator).
+ * \li The stiffness matrix is assembled in a sparse (CSR) format, with the
+ * fastener springs on its diagonal.
+ * \li The applied load is a linear body force, whose resultant is the
+ * applied load (equivalent to a rigid introduction of the load).
+ * \li The system is solved with a sparse Cholesky factorization, with a
+ * nested dissection ordering of the nodes (see Math::SparseCholesky).
+ * If the factor is too big, a conjugate gradient is used instead,
+ * preconditioned by the 2x2 diagonal blocks of the nodes, whose
+ * iterations run on several threads.
+ * \li The load of each fastener is its stiffness times the displacement
+ * of its node.
+ *
+ * The model is linear, so the system is solved once for 3 unit load cases
+ * (the right-hand sides are solved together). The loads of the fasteners
+ * for these cases are cached, for the last geometry: when only the applied
+ * load changes (e.g. a sweep of load cases), calculate() just combines them.
+ *
+ * calculate() can be called from several threads at the same time
+ * (e.g. by the optimiser): the cache is protected by a mutex.
+ *
+ * \sa RigidBodySolver
+ */
+FiniteElementSolver::FiniteElementSolver(QObject *parent) : ISolver(parent)
+  , m_nodeCount(C_FEM_DEFAULT_NODE_COUNT)
+  , m_maxFactorSize(C_FEM_MAX_FACTOR_SIZE)
+{
+    m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+FiniteElementSolver::~FiniteElementSolver()
+{
+    m_pool.waitForDone();
+}
+
+/*! \brief Returns the approximative number of nodes of the mesh of the plate.
+ */
+int FiniteElementSolver::nodeCount() const
+{
+    return m_nodeCount;
+}
+
+void FiniteElementSolver::setNodeCount(int count)
+{
+    m_nodeCount = qMax(4, count);
+}
+
+/*! \brief Reimplemented. Returns the solver type and the node count.
+ * The thread count doesn't change the results.
+ */
+quint64 FiniteElementSolver::parametersKey() const
+{
+    return (quint64(m_nodeCount) << 8) | quint64(SolverParameters::FiniteElementSolver);
+}
+
+/*! \brief Returns the maximum number of threads used by a calculation.
+ */
+int FiniteElementSolver::threadCount() const
+{
+    return m_pool.maxThreadCount();
+}
+
+void FiniteElementSolver::setThreadCount(int count)
+{
+    m_pool.setMaxThreadCount(qMax(1, count));
+}
+
+/*! \brief Returns the maximum number of non-zeros of the Cholesky factor.
+ * Above, the system is solved by the conjugate gradient, on several threads.
+ * A size of 0 always uses the conjugate gradient.
+ * Both give the same results, within the tolerance.
+ */
+int FiniteElementSolver::maxFactorSize() const
+{
+    return m_maxFactorSize;
+}
+
+void FiniteElementSolver::setMaxFactorSize(int size)
+{
+    m_maxFactorSize = qMax(0, size);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int FiniteElementSolver::chunkCount(int nodes) const
+{
+    return qBound(1, nodes / C_FEM_NODES_PER_THREAD, m_pool.maxThreadCount());
+}
+
+/*! \internal
+ * \brief Calls \a function on \a chunks ranges of nodes, in parallel.
+ * The calling thread runs the first range itself.
+ */
+void FiniteElementSolver::parallelFor(int nodes, int chunks,
+                                      const std::function<void(int, int, int)> &function)
+{
+    if (chunks <= 1) {
+        function(0, 0, nodes);
+        return;
+    }
+    QSemaphore done;
+    for (int chunk = 1; chunk < chunks; ++chunk) {
+        m_pool.start( new RangeTask(function, chunk,
+                                    (nodes * chunk) / chunks,
+                                    (nodes * (chunk + 1)) / chunks, &done) );
+    }
+    function(0, 0, nodes / chunks);
+    done.acquire(chunks - 1);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QList<Tensor> FiniteElementSolver::calculate(const Splice *splice)
+{
+    Q_ASSERT(splice);
+
+    QList<Tensor> res;
+    const int count = splice->fastenerCount();
+    if (count == 0) {
+        return res;
+    }
+
+    const QSharedPointer<const Response> unit = response(splice);
+    return combine(*unit, splice->appliedLoad(), count);
+}
+
+/*! \brief Calculates the results of the \a splice for each of the \a loadCases.
+ *
+ * The system is solved (or found in the cache) once, so each load case
+ * is just a combination of the unit load cases.
+ */
+QList<QList<Tensor> > FiniteElementSolver::calculateLoadCases(const Splice *splice,
+                                                              const QVector<Tensor> &loadCases)
+{
+    Q_ASSERT(splice);
+
+    QList<QList<Tensor> > res;
+    const int count = splice->fastenerCount();
+    res.reserve(loadCases.count());
+    if (count == 0) {
+        for (int c = 0; c < loadCases.count(); ++c) {
+            res.append(QList<Tensor>());
+        }
+        return res;
+    }
+
+    const QSharedPointer<const Response> unit = response(splice);
+    foreach (const Tensor &loadCase, loadCases) {
+        res.append( combine(*unit, loadCase, count) );
+    }
+    return res;
+}
+
+/*! \internal
+ * \brief Returns the loads of the fasteners, as a linear combination of the
+ * unit load cases: the \a load is moved from the origin to the plate's center.
+ */
+QList<Tensor> FiniteElementSolver::combine(const Response &unit, const Tensor &load, int count)
+{
+    QList<Tensor> res;
+    const double fx = load.force_x.value();
+    const double fy = load.force_y.value();
+    const double mc = load.torque_z.value() + unit.centerY * fx - unit.centerX * fy;
+    res.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const double *r = unit.loads.constData() + 2 * C_FEM_LOAD_CASES * i;
+        res.append( Tensor( (fx * r[0] + fy * r[2] + mc * r[4]) * N,
+                            (fx * r[1] + fy * r[3] + mc * r[5]) * N,
+                            0. * N_m ) );
+    }
+    return res;
+}
+
+/*! \internal
+ * \brief Returns the loads of the fasteners for the unit load cases,
+ * from the cache if the geometry of the \a splice didn't change.
+ */
+QSharedPointer<const FiniteElementSolver::Response>
+FiniteElementSolver::response(const Splice *splice)
+{
+    const QVector<double> key = geometry(splice, m_nodeCount);
+    const uint hash = geometryHash(key);
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_response && m_response->hash == hash && m_response->geometry == key) {
+            return m_response;
+        }
+    }
+    QSharedPointer<Response> res = calculateResponse(splice);
+    res->hash = hash;
+    res->geometry = key;
+
+    QMutexLocker locker(&m_mutex);
+    m_response = res;
+    return res;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QSharedPointer<FiniteElementSolver::Response>
+FiniteElementSolver::calculateResponse(const Splice *splice)
+{
+    QSharedPointer<Response> res(new Response);
+    const int count = splice->fastenerCount();
+
+    /* ********************************************* */
+    /* Plate                                         */
+    /* ********************************************* */
+    QVector<QPointF> points;
+    QVector<int> fastenerNodes(count);
+    QHash<QPair<qreal, qreal>, int> nodeAt;
+    qreal minX = 0, maxX = 0, minY = 0, maxY = 0;
+    qreal maxDiameter = 0;
+    qreal thickness = 0;
+    for (int i = 0; i < count; ++i) {
+        const Fastener &f = splice->fastenerAt(i);
+        const QPointF p(f.positionX.value(), f.positionY.value());
+        const QPair<qreal, qreal> key(p.x(), p.y());
+        if (!nodeAt.contains(key)) {
+            nodeAt.insert(key, points.count());
+            points.append(p);
+        }
+        fastenerNodes[i] = nodeAt.value(key);
+        minX = (i == 0) ? p.x() : qMin(minX, p.x());
+        maxX = (i == 0) ? p.x() : qMax(maxX, p.x());
+        minY = (i == 0) ? p.y() : qMin(minY, p.y());
+        maxY = (i == 0) ? p.y() : qMax(maxY, p.y());
+        maxDiameter = qMax(maxDiameter, f.diameter.value());
+        thickness += f.thickness.value();
+    }
+    thickness /= count;
+    if (thickness <= 0) {
+        thickness = 0.001;
+    }
+    const qreal margin = (maxDiameter > 0) ? C_FEM_EDGE_DISTANCE * maxDiameter : 0.001;
+    minX -= margin;
+    maxX += margin;
+    minY -= margin;
+    maxY += margin;
+    const qreal width = maxX - minX;
+    const qreal height = maxY - minY;
+    const int fastenerPointCount = points.count();
+
+    /* ********************************************* */
+    /* Mesh                                          */
+    /* ********************************************* */
+    {
+        /* The element size only depends on the node count: a small
+         * margin (thin fasteners) doesn't refine the whole mesh. */
+        const qreal size = qSqrt(width * height / m_nodeCount);
+        const int nx = qMax(1, qCeil(width / size));
+        const int ny = qMax(1, qCeil(height / size));
+        const qreal dx = width / nx;
+        const qreal dy = height / ny;
+
+        /* Remove the nodes of the grid too close to a fastener.
+         * The radius is lower than the margin, so that the nodes on
+         * the edges are never removed (the plate is exactly the
+         * rectangle, the hull of the triangulation). */
+        const qreal radius = 0.5 * qMin(qMin(dx, dy), margin);
+        QVector<bool> removed((nx + 1) * (ny + 1), false);
+        for (int k = 0; k < fastenerPointCount; ++k) {
+            const QPointF &p = points.at(k);
+            const int i0 = qMax(0, qFloor((p.x() - radius - minX) / dx));
+            const int i1 = qMin(nx, qCeil((p.x() + radius - minX) / dx));
+            const int j0 = qMax(0, qFloor((p.y() - radius - minY) / dy));
+            const int j1 = qMin(ny, qCeil((p.y() + radius - minY) / dy));
+            for (int j = j0; j <= j1; ++j) {
+                for (int i = i0; i <= i1; ++i) {
+                    const qreal ddx = minX + i * dx - p.x();
+                    const qreal ddy = minY + j * dy - p.y();
+                    if (ddx * ddx + ddy * ddy < radius * radius) {
+                        removed[j * (nx + 1) + i] = true;
+                    }
+                }
+            }
+        }
+        points.reserve(fastenerPointCount + removed.count());
+        for (int j = 0; j <= ny; ++j) {
+            for (int i = 0; i <= nx; ++i) {
+                if (!removed.at(j * (nx + 1) + i)) {
+                    points.append(QPointF(minX + i * dx, minY + j * dy));
+                }
+            }
+        }
+    }
+
+    Math::Triangulator triangulator;
+    triangulator.triangulate(points);
+    Q_ASSERT(triangulator.pointCount() == points.count());
+
+    const int nodes = triangulator.pointCount();
+    const int dofs = 2 * nodes;
+    const QPointF *xy = triangulator.points();
+    const int *triangles = triangulator.triangles();
+    const int triangleCount = triangulator.triangleCount();
+
+    /* ********************************************* */
+    /* Sparse pattern                                */
+    /* ********************************************* */
+    StiffnessMatrix K;
+    {
+        QVector<int> degree(nodes, 1); /* itself */
+        const int *edges = triangulator.edges();
+        for (int e = 0; e < triangulator.edgeCount(); ++e) {
+            degree[edges[2 * e]]++;
+            degree[edges[2 * e + 1]]++;
+        }
+        K.nodeStart.resize(nodes + 1);
+        K.nodeStart[0] = 0;
+        for (int i = 0; i < nodes; ++i) {
+            K.nodeStart[i + 1] = K.nodeStart.at(i) + degree.at(i);
+        }
+        K.nodeColumns.resize(K.nodeStart.at(nodes));
+        QVector<int> fill = K.nodeStart;
+        for (int i = 0; i < nodes; ++i) {
+            K.nodeColumns[fill[i]++] = i;
+        }
+        for (int e = 0; e < triangulator.edgeCount(); ++e) {
+            const int a = edges[2 * e];
+            const int b = edges[2 * e + 1];
+            K.nodeColumns[fill[a]++] = b;
+            K.nodeColumns[fill[b]++] = a;
+        }
+        K.rowStart.resize(dofs + 1);
+        K.rowStart[0] = 0;
+        for (int i = 0; i < nodes; ++i) {
+            std::sort(K.nodeColumns.begin() + K.nodeStart.at(i),
+                      K.nodeColumns.begin() + K.nodeStart.at(i + 1));
+            const int rowWidth = 2 * degree.at(i);
+            K.rowStart[2 * i + 1] = K.rowStart.at(2 * i) + rowWidth;
+            K.rowStart[2 * i + 2] = K.rowStart.at(2 * i + 1) + rowWidth;
+        }
+        K.values.fill(0., K.rowStart.at(dofs));
+    }
+
+    /* ********************************************* */
+    /* Assembly                                      */
+    /* ********************************************* */
+    QVector<double> F(dofs * C_FEM_LOAD_CASES, 0.); /* Interleaved */
+    const double xc = minX + width / 2.;
+    const double yc = minY + height / 2.;
+    {
+        const double E = C_FEM_YOUNG_MODULUS;
+        const double nu = C_FEM_POISSON_RATIO;
+        const double c = E / (1. - nu * nu);
+        const double D[3][3] = { { c,      c * nu, 0. },
+                                 { c * nu, c,      0. },
+                                 { 0.,     0.,     c * (1. - nu) / 2. } };
+
+        /* Body force b(x,y) = F/A + Mc/J.(-(y-yc), x-xc), whose resultant
+         * is the load F, Mc at the center. One unit case for each of Fx, Fy, Mc. */
+        const double area = width * height;
+        const double polarInertia = area * (width * width + height * height) / 12.;
+
+        for (int e = 0; e < triangleCount; ++e) {
+            const int *n = triangles + 3 * e;
+            double b[3], cc[3];
+            for (int i = 0; i < 3; ++i) {
+                const QPointF &pj = xy[n[(i + 1) % 3]];
+                const QPointF &pk = xy[n[(i + 2) % 3]];
+                b[i] = pj.y() - pk.y();
+                cc[i] = pk.x() - pj.x();
+            }
+            const QPointF &p0 = xy[n[0]];
+            const QPointF &p1 = xy[n[1]];
+            const QPointF &p2 = xy[n[2]];
+            const double signedArea2 = (p1.x() - p0.x()) * (p2.y() - p0.y())
+                    - (p2.x() - p0.x()) * (p1.y() - p0.y());
+            const double elementArea = qAbs(signedArea2) / 2.;
+            if (elementArea <= 0) {
+                continue;
+            }
+            /* B = 1/(2A) [b1 0 b2 0 b3 0; 0 c1 0 c2 0 c3; c1 b1 c2 b2 c3 b3] */
+            double B[3][6];
+            for (int i = 0; i < 3; ++i) {
+                B[0][2 * i] = b[i] / signedArea2;  B[0][2 * i + 1] = 0.;
+                B[1][2 * i] = 0.;                  B[1][2 * i + 1] = cc[i] / signedArea2;
+                B[2][2 * i] = cc[i] / signedArea2; B[2][2 * i + 1] = b[i] / signedArea2;
+            }
+            double DB[3][6];
+            for (int r = 0; r < 3; ++r) {
+                for (int s = 0; s < 6; ++s) {
+                    DB[r][s] = D[r][0] * B[0][s] + D[r][1] * B[1][s] + D[r][2] * B[2][s];
+                }
+            }
+            const double w = thickness * elementArea;
+            for (int r = 0; r < 6; ++r) {
+                for (int s = 0; s < 6; ++s) {
+                    const double k = w * (B[0][r] * DB[0][s] + B[1][r] * DB[1][s] + B[2][r] * DB[2][s]);
+                    K.values[K.index(n[r / 2], r % 2, n[s / 2], s % 2)] += k;
+                }
+            }
+
+            /* Consistent nodal forces of the linear body force */
+            for (int c = 0; c < C_FEM_LOAD_CASES; ++c) {
+                const double fx = (c == 0) ? 1. : 0.;
+                const double fy = (c == 1) ? 1. : 0.;
+                const double mc = (c == 2) ? 1. : 0.;
+                double bx[3], by[3];
+                for (int i = 0; i < 3; ++i) {
+                    const QPointF &p = xy[n[i]];
+                    bx[i] = fx / area - mc / polarInertia * (p.y() - yc);
+                    by[i] = fy / area + mc / polarInertia * (p.x() - xc);
+                }
+                const double sumX = bx[0] + bx[1] + bx[2];
+                const double sumY = by[0] + by[1] + by[2];
+                for (int i = 0; i < 3; ++i) {
+                    F[(2 * n[i])     * C_FEM_LOAD_CASES + c] += elementArea / 12. * (bx[i] + sumX);
+                    F[(2 * n[i] + 1) * C_FEM_LOAD_CASES + c] += elementArea / 12. * (by[i] + sumY);
+                }
+            }
+        }
+
+        /* Springs */
+        const double soft = C_FEM_SOFT_SPRING_FACTOR * E * thickness;
+        for (int i = 0; i < nodes; ++i) {
+            K.values[K.index(i, 0, i, 0)] += soft;
+            K.values[K.index(i, 1, i, 1)] += soft;
+        }
+        for (int i = 0; i < count; ++i) {
+            const Fastener &f = splice->fastenerAt(i);
+            const double k = fastenerStiffness(f);
+            const int node = fastenerNodes.at(i);
+            if (f.DoF_X == Fastener::Fixed) K.values[K.index(node, 0, node, 0)] += k;
+            if (f.DoF_Y == Fastener::Fixed) K.values[K.index(node, 1, node, 1)] += k;
+        }
+    }
+
+    /* ********************************************* */
+    /* Sparse Cholesky factorization                 */
+    /* ********************************************* */
+    QVector<double> U = F;
+    bool solved = false;
+    {
+        QVector<int> order;
+        order.reserve(nodes);
+        {
+            QVector<int> all(nodes);
+            for (int i = 0; i < nodes; ++i) {
+                all[i] = i;
+            }
+            QVector<int> label(nodes, 0);
+            int nextLabel = 1;
+            dissect(xy, K.nodeStart.constData(), K.nodeColumns.constData(),
+                    all, label, nextLabel, order);
+        }
+        QVector<int> permutation(dofs);
+        for (int k = 0; k < nodes; ++k) {
+            permutation[2 * k]     = 2 * order.at(k);
+            permutation[2 * k + 1] = 2 * order.at(k) + 1;
+        }
+
+        /* Column of each value, in the CSR format of the degrees of freedom */
+        QVector<int> columns(K.values.count());
+        for (int row = 0; row < dofs; ++row) {
+            const int *nodeColumns = K.nodeColumns.constData() + K.nodeStart.at(row / 2);
+            const int columnCount = (K.rowStart.at(row + 1) - K.rowStart.at(row)) / 2;
+            int *column = columns.data() + K.rowStart.at(row);
+            for (int k = 0; k < columnCount; ++k) {
+                column[2 * k]     = 2 * nodeColumns[k];
+                column[2 * k + 1] = 2 * nodeColumns[k] + 1;
+            }
+        }
+
+        Math::SparseCholesky cholesky;
+        if (cholesky.analyze(dofs, K.rowStart.constData(), columns.constData(), permutation)
+                && cholesky.factorSize() <= m_maxFactorSize
+                && cholesky.factorize(K.values.constData())) {
+            cholesky.solve(U.data(), C_FEM_LOAD_CASES);
+            solved = true;
+        }
+    }
+    if (!solved) {
+        QVector<double> f(dofs);
+        QVector<double> u(dofs);
+        for (int c = 0; c < C_FEM_LOAD_CASES; ++c) {
+            for (int i = 0; i < dofs; ++i) {
+                f[i] = F.at(i * C_FEM_LOAD_CASES + c);
+            }
+            solveIteratively(K, f, u);
+            for (int i = 0; i < dofs; ++i) {
+                U[i * C_FEM_LOAD_CASES + c] = u.at(i);
+            }
+        }
+    }
+
+    /* ********************************************* */
+    /* Fastener loads                                */
+    /* ********************************************* */
+    res->centerX = xc;
+    res->centerY = yc;
+    res->loads.fill(0., 2 * C_FEM_LOAD_CASES * count);
+    for (int i = 0; i < count; ++i) {
+        const Fastener &f = splice->fastenerAt(i);
+        const double k = fastenerStiffness(f);
+        const int node = fastenerNodes.at(i);
+        double *loads = res->loads.data() + 2 * C_FEM_LOAD_CASES * i;
+        for (int c = 0; c < C_FEM_LOAD_CASES; ++c) {
+            if (f.DoF_X == Fastener::Fixed) {
+                loads[2 * c] = k * U.at((2 * node) * C_FEM_LOAD_CASES + c);
+            }
+            if (f.DoF_Y == Fastener::Fixed) {
+                loads[2 * c + 1] = k * U.at((2 * node + 1) * C_FEM_LOAD_CASES + c);
+            }
+        }
+    }
+    return res;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \internal
+ * \brief Solves K.U = F with a conjugate gradient, preconditioned by the
+ * inverses of the 2x2 diagonal blocks. Each iteration runs on ranges of
+ * nodes, in parallel.
+ */
+void FiniteElementSolver::solveIteratively(const StiffnessMatrix &K,
+                                           const QVector<double> &F, QVector<double> &U)
+{
+    const int nodes = K.nodeStart.count() - 1;
+    const int dofs = 2 * nodes;
+    U.fill(0., dofs);
+
+    /* Inverses of the 2x2 diagonal blocks */
+    QVector<double> M(4 * nodes);
+    for (int i = 0; i < nodes; ++i) {
+        const double a = K.values.at(K.index(i, 0, i, 0));
+        const double b = K.values.at(K.index(i, 0, i, 1));
+        const double d = K.values.at(K.index(i, 1, i, 1));
+        const double det = a * d - b * b;
+        M[4 * i]     =  d / det;
+        M[4 * i + 1] = -b / det;
+        M[4 * i + 2] = -b / det;
+        M[4 * i + 3] =  a / det;
+    }
+
+    QVector<double> R = F;
+    QVector<double> Z(dofs, 0.);
+    QVector<double> P(dofs, 0.);
+    QVector<double> Q(dofs, 0.);
+
+    const int chunks = chunkCount(nodes);
+    QVector<double> partial1(chunks, 0.);
+    QVector<double> partial2(chunks, 0.);
+
+    double *u = U.data();
+    double *r = R.data();
+    double *z = Z.data();
+    double *p = P.data();
+    double *q = Q.data();
+    const double *inverse = M.constData();
+    const int *rowStart = K.rowStart.constData();
+    const int *nodeStart = K.nodeStart.constData();
+    const int *nodeColumns = K.nodeColumns.constData();
+    const double *values = K.values.constData();
+    double *sum1 = partial1.data();
+    double *sum2 = partial2.data();
+
+    auto accumulate = [chunks](const double *partial) {
+        double s = 0.;
+        for (int c = 0; c < chunks; ++c) {
+            s += partial[c];
+        }
+        return s;
+    };
+
+    /* z = M.r, p = z, and (r.z), (r.r) */
+    const std::function<void(int, int, int)> initialize =
+            [=](int chunk, int begin, int end) {
+        double rz = 0., rr = 0.;
+        for (int i = begin; i < end; ++i) {
+            z[2 * i]     = inverse[4 * i]     * r[2 * i] + inverse[4 * i + 1] * r[2 * i + 1];
+            z[2 * i + 1] = inverse[4 * i + 2] * r[2 * i] + inverse[4 * i + 3] * r[2 * i + 1];
+            p[2 * i] = z[2 * i];
+            p[2 * i + 1] = z[2 * i + 1];
+            rz += r[2 * i] * z[2 * i] + r[2 * i + 1] * z[2 * i + 1];
+            rr += r[2 * i] * r[2 * i] + r[2 * i + 1] * r[2 * i + 1];
+        }
+        sum1[chunk] = rz;
+        sum2[chunk] = rr;
+    };
+
+    /* q = K.p, and (p.q) */
+    const std::function<void(int, int, int)> multiply =
+            [=](int chunk, int begin, int end) {
+        double pq = 0.;
+        for (int row = 2 * begin; row < 2 * end; ++row) {
+            const int *columns = nodeColumns + nodeStart[row / 2];
+            const double *value = values + rowStart[row];
+            const int columnCount = (rowStart[row + 1] - rowStart[row]) / 2;
+            double s = 0.;
+            for (int k = 0; k < columnCount; ++k) {
+                const int j = columns[k];
+                s += value[2 * k] * p[2 * j] + value[2 * k + 1] * p[2 * j + 1];
+            }
+            q[row] = s;
+            pq += p[row] * s;
+        }
+        sum1[chunk] = pq;
+    };
+
+    double alpha = 0., beta = 0.;
+
+    /* u += alpha.p, r -= alpha.q, z = M.r, and (r.z), (r.r) */
+    const std::function<void(int, int, int)> update =
+            [=, &alpha](int chunk, int begin, int end) {
+        double rz = 0., rr = 0.;
+        for (int i = begin; i < end; ++i) {
+            for (int a = 0; a < 2; ++a) {
+                u[2 * i + a] += alpha * p[2 * i + a];
+                r[2 * i + a] -= alpha * q[2 * i + a];
+            }
+            z[2 * i]     = inverse[4 * i]     * r[2 * i] + inverse[4 * i + 1] * r[2 * i + 1];
+            z[2 * i + 1] = inverse[4 * i + 2] * r[2 * i] + inverse[4 * i + 3] * r[2 * i + 1];
+            rz += r[2 * i] * z[2 * i] + r[2 * i + 1] * z[2 * i + 1];
+            rr += r[2 * i] * r[2 * i] + r[2 * i + 1] * r[2 * i + 1];
+        }
+        sum1[chunk] = rz;
+        sum2[chunk] = rr;
+    };
+
+    /* p = z + beta.p */
+    const std::function<void(int, int, int)> direction =
+            [=, &beta](int, int begin, int end) {
+        for (int i = 2 * begin; i < 2 * end; ++i) {
+            p[i] = z[i] + beta * p[i];
+        }
+    };
+
+    parallelFor(nodes, chunks, initialize);
+    double rz = accumulate(sum1);
+    const double normF = qSqrt(accumulate(sum2));
+    const double tolerance = C_FEM_TOLERANCE * normF;
+
+    if (normF > 0) {
+        const int maxIterations = 10 * dofs;
+        for (int iteration = 0; iteration < maxIterations; ++iteration) {
+            parallelFor(nodes, chunks, multiply);
+            const double pq = accumulate(sum1);
+            if (pq <= 0) {
+                break;
+            }
+            alpha = rz / pq;
+            parallelFor(nodes, chunks, update);
+            const double rzNew = accumulate(sum1);
+            if (qSqrt(accumulate(sum2)) <= tolerance) {
+                break;
+            }
+            beta = rzNew / rz;
+            rz = rzNew;
+            parallelFor(nodes, chunks, direction);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_FINITE_ELEMENT_SOLVER_H
+#define CORE_FINITE_ELEMENT_SOLVER_H
+
+#include <Core/Solvers/ISolver>
+
+#include <QtCore/QMutex>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+#include <functional>
+
+class FiniteElementSolver : public ISolver
+{
+public:
+    explicit FiniteElementSolver(QObject *parent = Q_NULLPTR);
+    ~FiniteElementSolver();
+
+    virtual QList<Tensor> calculate(const Splice *splice) Q_DECL_OVERRIDE;
+    virtual QList<QList<Tensor> > calculateLoadCases(const Splice *splice,
+                                                     const QVector<Tensor> &loadCases) Q_DECL_OVERRIDE;
+    virtual quint64 parametersKey() const Q_DECL_OVERRIDE;
+
+    int nodeCount() const;
+    void setNodeCount(int count);
+
+    int threadCount() const;
+    void setThreadCount(int count);
+
+    int maxFactorSize() const;
+    void setMaxFactorSize(int size);
+
+private:
+    struct StiffnessMatrix;
+    struct Response;
+
+    int m_nodeCount;
+    int m_maxFactorSize;
+    QThreadPool m_pool;
+    QMutex m_mutex;
+    QSharedPointer<const Response> m_response; /* Cached, for the last geometry */
+
+    QSharedPointer<const Response> response(const Splice *splice);
+    QSharedPointer<Response> calculateResponse(const Splice *splice);
+    static QList<Tensor> combine(const Response &unit, const Tensor &load, int count);
+    void solveIteratively(const StiffnessMatrix &K, const QVector<double> &F, QVector<double> &U);
+
+    int chunkCount(int nodes) const;
+    void parallelFor(int nodes, int chunks,
+                     const std::function<void(int chunk, int begin, int end)> &function);
+};
+
+#endif // CORE_FINITE_ELEMENT_SOLVER_H
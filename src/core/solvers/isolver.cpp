@@ -0,0 +1,88 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "isolver.h"
+
+#include <Core/Splice>
+#include <Core/Tensor>
+
+#include <QtCore/QList>
+#include <QtCore/QVector>
+
+/******************************************************************************
+ ******************************************************************************/
+/*!
+ * \brief Calculates the results of the \a splice for each of the given
+ * \a loadCases, instead of its applied load.
+ *
+ * Returns one list of results per load case, in the same order.
+ *
+ * The solvers can reimplement this function to share the work that
+ * doesn't depend on the load (e.g. the CoG and the inertia of the pattern).
+ * The default implementation calls calculate() for each load case.
+ */
+QList<QList<Tensor> > ISolver::calculateLoadCases(const Splice *splice,
+                                                  const QVector<Tensor> &loadCases)
+{
+    Q_ASSERT(splice);
+    QList<QList<Tensor> > res;
+    res.reserve(loadCases.count());
+    Splice copy = *splice;
+    foreach (const Tensor &loadCase, loadCases) {
+        copy.setAppliedLoad(loadCase);
+        res.append( calculate(&copy) );
+    }
+    return res;
+}
+
+/*!
+ * \brief Returns the envelope of the results of the \a splice: for each
+ * fastener, its load with the highest resultant, among the applied load
+ * and the other load cases of the \a splice.
+ *
+ * All the load cases are evaluated in one call to calculateLoadCases().
+ */
+QList<Tensor> ISolver::calculateEnvelope(const Splice *splice)
+{
+    Q_ASSERT(splice);
+    QVector<Tensor> loadCases;
+    loadCases.reserve(1 + splice->loadCaseCount());
+    loadCases.append(splice->appliedLoad());
+    for (int i = 0; i < splice->loadCaseCount(); ++i) {
+        loadCases.append(splice->loadCaseAt(i));
+    }
+
+    const QList<QList<Tensor> > results = calculateLoadCases(splice, loadCases);
+
+    QList<Tensor> res = results.first();
+    QVector<Force> maxima;
+    maxima.reserve(res.count());
+    foreach (const Tensor &load, res) {
+        maxima.append(load.resultantFxy());
+    }
+    for (int c = 1; c < results.count(); ++c) {
+        const QList<Tensor> &result = results.at(c);
+        Q_ASSERT(result.count() == res.count());
+        for (int i = 0; i < result.count(); ++i) {
+            const Force resultant = result.at(i).resultantFxy();
+            if (resultant > maxima.at(i)) {
+                maxima[i] = resultant;
+                res[i] = result.at(i);
+            }
+        }
+    }
+    return res;
+}
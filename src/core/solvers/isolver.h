@@ -44,6 +44,37 @@ public:
 
     virtual QList<Tensor> calculate(const Splice *splice) = 0;
 
+    /*!
+     * \brief Calculates the results of the \a splice, knowing that only the fastener
+     * at \a changedIndex has been changed since the previous call to this function.
+     * If \a changedIndex is negative, anything may have changed.
+     *
+     * Unlike calculate(), the solver can keep intermediate data between the calls,
+     * to update the results faster after a single edit. Hence this function
+     * must be called for one splice only, from one thread at a time.
+     *
+     * The default implementation calls calculate().
+     */
+    virtual QList<Tensor> calculateIncremental(const Splice *splice, const int changedIndex)
+    {
+        Q_UNUSED(changedIndex);
+        return calculate(splice);
+    }
+
+    /*!
+     * \brief Returns a value that identifies the method and the parameters
+     * of the solver. Two solvers that can return different results for the
+     * same splice must return different values (see SolverCache).
+     *
+     * The default implementation returns 0.
+     */
+    virtual quint64 parametersKey() const { return 0; }
+
+    virtual QList<QList<Tensor> > calculateLoadCases(const Splice *splice,
+                                                     const QVector<Tensor> &loadCases);
+
+    QList<Tensor> calculateEnvelope(const Splice *splice);
+
 };
 
 #endif // CORE_SOLVERS_ISOLVER_H
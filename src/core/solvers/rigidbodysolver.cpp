@@ -19,22 +19,235 @@
 #include <Core/Splice>
 #include <Core/Tensor>
 #include <Core/Solvers/Parameters>
-#include <Core/Units/UnitSystem>
-#include <Core/Units/AreaMomentOfInertia>
+#include <Core/Units/RawQuantity>
 
-#include <boost/units/cmath.hpp>   /* pow() */
 #include <QtCore/QDebug>
+#include <QtCore/QVector>
 
-using namespace boost;
-using namespace units;
+/* Number of incremental updates before the sums are recalculated
+ * from scratch, to avoid the accumulation of rounding errors. */
+#define C_MAX_INCREMENTAL_UPDATES 1000
 
+/*
+ * The solver is a raw kernel (see Core/Units/RawQuantity): the fasteners
+ * are packed into arrays of doubles in SI units, the calculation uses
+ * Raw::Quantity, and the results are converted back to Tensor.
+ */
+namespace {
+// ---------------------------------
+/* Packed properties of the fasteners */
+struct Packed {
+    QVector<double> x;  /* Raw::Length */
+    QVector<double> y;  /* Raw::Length */
+    QVector<double> Ax; /* Raw::Area */
+    QVector<double> Ay; /* Raw::Area */
+
+    void resize(int count)
+    {
+        x.resize(count);
+        y.resize(count);
+        Ax.resize(count);
+        Ay.resize(count);
+    }
+};
+struct Sums {
+    Raw::Area Ax;
+    Raw::Area Ay;
+    Raw::Volume Bx;     /* Sum( Ax * y ) */
+    Raw::Volume By;     /* Sum( Ay * x ) */
+};
+struct Inertia {
+    Raw::AreaMomentOfInertia x;
+    Raw::AreaMomentOfInertia y;
+};
+// ---------------------------------
+} // namespace
+
+/*! \internal
+ * \brief Intermediate data kept between the calls to calculateIncremental().
+ *
+ * In addition to the sums of calculate(), the cache contains the
+ * second moments of area about the origin, so that the inertias about
+ * the CoG are obtained with the parallel axis theorem, without
+ * iterating over the fasteners:
+ *
+ * \verbatim
+ *   Sum( Ax * (y - CoG_y)^2 ) = Sum( Ax * y^2 ) - 2 * CoG_y * Sum( Bx ) + CoG_y^2 * Sum( Ax )
+ * \endverbatim
+ */
+struct RigidBodySolver::Cache
+{
+    Cache() : updateCount(0) {}
+
+    Packed items;
+    Sums sumData;
+    Inertia sumOrigin;
+    int updateCount;
+
+    void clear()
+    {
+        items.resize(0);
+        updateCount = 0;
+    }
+};
+
+/* Boundary: packs the fastener \a f at the index \a i. */
+static void pack(const Fastener &f, SolverParameters params, Packed &p, int i)
+{
+    const double diameter = f.diameter.value();
+    double area = 0.; /* m_2 */
+
+    switch (params) {
+    case SolverParameters::RigidBodySolverWithIsoBearing:
+        area = diameter * f.thickness.value();
+        break;
+    case SolverParameters::RigidBodySolverWithIsoShear:
+        area = diameter * diameter;
+        break;
+    default:
+        Q_UNREACHABLE();
+        break;
+    }
+
+    p.x[i] = f.positionX.value();
+    p.y[i] = f.positionY.value();
+    p.Ax[i] = (f.DoF_X == Fastener::Fixed) ? area : 0.;
+    p.Ay[i] = (f.DoF_Y == Fastener::Fixed) ? area : 0.;
+}
+
+static Packed pack(const Splice *splice, SolverParameters params)
+{
+    const int count = splice->fastenerCount();
+    Packed p;
+    p.resize(count);
+    for (int i = 0 ; i < count ; ++i) {
+        pack(splice->fastenerAt(i), params, p, i);
+    }
+    return p;
+}
+
+/* Contributions of the fastener \a i to the sums, and to the inertia about the origin. */
+static Sums fastenerSums(const Packed &p, int i)
+{
+    const Raw::Area Ax(p.Ax.at(i));
+    const Raw::Area Ay(p.Ay.at(i));
+    Sums s;
+    s.Ax = Ax;
+    s.Ay = Ay;
+    s.Bx = Ax * Raw::Length(p.y.at(i));
+    s.By = Ay * Raw::Length(p.x.at(i));
+    return s;
+}
+
+static Inertia originInertia(const Packed &p, int i)
+{
+    const Raw::Length x(p.x.at(i));
+    const Raw::Length y(p.y.at(i));
+    Inertia inertia;
+    inertia.x = Raw::Area(p.Ax.at(i)) * (y * y);
+    inertia.y = Raw::Area(p.Ay.at(i)) * (x * x);
+    return inertia;
+}
+
+/*! \brief Distributes the \a appliedLoad on the fasteners.
+ */
+static QList<Tensor> distribute(const Packed &p,
+                                const Tensor &appliedLoad,
+                                const Sums &sumData,
+                                const Inertia &sumInertia,
+                                const Raw::Length CoG_x,
+                                const Raw::Length CoG_y)
+{
+    const int count = p.x.count();
+
+    // ---------------------------------
+    const Raw::Force force_x = Raw::fromSI(appliedLoad.force_x);
+    const Raw::Force force_y = Raw::fromSI(appliedLoad.force_y);
+    const Raw::Torque torque_z = Raw::fromSI(appliedLoad.torque_z)
+            + (CoG_y * force_x - CoG_x * force_y);
+
+    // ---------------------------------
+    /* Single pass over the packed arrays, that the compiler can vectorise. */
+    const Raw::Quantity<-3, 1> kx = -1.0/(sumInertia.y + sumInertia.x) * torque_z;
+    const Raw::Quantity<-3, 1> ky =  1.0/(sumInertia.y + sumInertia.x) * torque_z;
+    const double *x = p.x.constData();
+    const double *y = p.y.constData();
+    const double *Ax = p.Ax.constData();
+    const double *Ay = p.Ay.constData();
+
+    QVector<double> loadsX(count);
+    QVector<double> loadsY(count);
+    double *fx = loadsX.data();
+    double *fy = loadsY.data();
+    for (int i = 0 ; i < count ; ++i) {
+        const Raw::Force loadX = kx * (Raw::Length(y[i]) - CoG_y) * Raw::Area(Ax[i])
+                + force_x * (Raw::Area(Ax[i]) / sumData.Ax);
+        const Raw::Force loadY = ky * (Raw::Length(x[i]) - CoG_x) * Raw::Area(Ay[i])
+                + force_y * (Raw::Area(Ay[i]) / sumData.Ay);
+        fx[i] = loadX.value;
+        fy[i] = loadY.value;
+    }
+
+    // ---------------------------------
+    /* Boundary */
+    QList<Tensor> res;
+    res.reserve(count);
+    for (int i = 0 ; i < count ; ++i) {
+        res.append( Tensor( Raw::toSI(Raw::Force(fx[i])),
+                            Raw::toSI(Raw::Force(fy[i])),
+                            0. *N_m ) );
+    }
+    return res;
+}
+
+/*! \brief Calculates the CoG and the inertia of the fastener pattern,
+ * that don't depend on the applied load.
+ */
+static void pattern(const Packed &p,
+                    Sums &sumData,
+                    Inertia &sumInertia,
+                    Raw::Length &CoG_x,
+                    Raw::Length &CoG_y)
+{
+    const int count = p.x.count();
+    const double *x = p.x.constData();
+    const double *y = p.y.constData();
+    const double *Ax = p.Ax.constData();
+    const double *Ay = p.Ay.constData();
+
+    // ---------------------------------
+    sumData = Sums();
+    for (int i = 0 ; i < count ; ++i) {
+        sumData.Ax += Raw::Area(Ax[i]);
+        sumData.Ay += Raw::Area(Ay[i]);
+        sumData.Bx += Raw::Area(Ax[i]) * Raw::Length(y[i]);
+        sumData.By += Raw::Area(Ay[i]) * Raw::Length(x[i]);
+    }
+
+    CoG_x = sumData.By / sumData.Ay ;
+    CoG_y = sumData.Bx / sumData.Ax ;
+
+    // ---------------------------------
+    sumInertia = Inertia();
+    for (int i = 0 ; i < count ; ++i) {
+        const Raw::Length dx = Raw::Length(x[i]) - CoG_x;
+        const Raw::Length dy = Raw::Length(y[i]) - CoG_y;
+        sumInertia.x += Raw::Area(Ax[i]) * (dy * dy);
+        sumInertia.y += Raw::Area(Ay[i]) * (dx * dx);
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
 RigidBodySolver::RigidBodySolver(QObject *parent) : ISolver(parent)
   , m_params(SolverParameters::RigidBodySolverWithIsoBearing)
+  , m_cache(new Cache)
 {
 }
 
 RigidBodySolver::~RigidBodySolver()
 {
+    delete m_cache;
 }
 
 SolverParameters RigidBodySolver::parameters() const
@@ -42,6 +255,13 @@ SolverParameters RigidBodySolver::parameters() const
     return m_params;
 }
 
+/*! \brief Reimplemented. Returns the mode (isobearing or isoshear).
+ */
+quint64 RigidBodySolver::parametersKey() const
+{
+    return quint64(m_params);
+}
+
 void RigidBodySolver::setParameters(SolverParameters mode)
 {
     if ( mode == SolverParameters::RigidBodySolverWithIsoBearing  ||
@@ -50,123 +270,176 @@ void RigidBodySolver::setParameters(SolverParameters mode)
     } else {
         m_params = SolverParameters::NoSolver;
     }
+    m_cache->clear();
 }
 
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Calculates the results of the \a splice.
+ *
+ * This function doesn't use the cache of calculateIncremental(),
+ * so it can be called from several threads at the same time
+ * (e.g. by the optimiser).
+ */
 QList<Tensor> RigidBodySolver::calculate(const Splice *splice)
 {
     Q_ASSERT(splice);
     Q_ASSERT(m_params == SolverParameters::RigidBodySolverWithIsoBearing ||
              m_params == SolverParameters::RigidBodySolverWithIsoShear);
 
-    QList<Tensor> res;
-
-    const int count = splice->fastenerCount();
+    const Packed p = pack(splice, m_params);
+    Sums sumData;
+    Inertia sumInertia;
+    Raw::Length CoG_x;
+    Raw::Length CoG_y;
+    pattern(p, sumData, sumInertia, CoG_x, CoG_y);
 
-    // ---------------------------------
-    struct Data {
-        quantity<si::area> Ax;
-        quantity<si::area> Ay;
-        quantity<si::volume> Bx;
-        quantity<si::volume> By;
-    };
-    struct Inertia {
-        quantity<si::area_moment_of_inertia> x;
-        quantity<si::area_moment_of_inertia> y;
-    };
-    // ---------------------------------
+    return distribute(p, splice->appliedLoad(), sumData, sumInertia, CoG_x, CoG_y);
+}
 
-    QList<Data> _list;
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Calculates the results of the \a splice for each of the \a loadCases.
+ *
+ * The CoG and the inertia of the pattern are calculated once. Then, the
+ * loads of the fasteners are linear in the load at the CoG, so the work
+ * per load case is a product by a (fastenerCount x 3) matrix:
+ *
+ * \verbatim
+ *   fx(i) = ax(i) * Fx + mx(i) * Mz_cog
+ *   fy(i) = ay(i) * Fy + my(i) * Mz_cog
+ * \endverbatim
+ *
+ * Like calculate(), this function can be called from several threads.
+ */
+QList<QList<Tensor> > RigidBodySolver::calculateLoadCases(const Splice *splice,
+                                                          const QVector<Tensor> &loadCases)
+{
+    Q_ASSERT(splice);
+    Q_ASSERT(m_params == SolverParameters::RigidBodySolverWithIsoBearing ||
+             m_params == SolverParameters::RigidBodySolverWithIsoShear);
 
+    const Packed p = pack(splice, m_params);
+    Sums sumData;
+    Inertia sumInertia;
+    Raw::Length CoG_x;
+    Raw::Length CoG_y;
+    pattern(p, sumData, sumInertia, CoG_x, CoG_y);
+
+    /* Coefficients of the matrix, packed as values: ax and ay are
+     * dimensionless, mx and my are in m^-1. */
+    const int count = p.x.count();
+    const Raw::AreaMomentOfInertia polar = sumInertia.y + sumInertia.x;
+    QVector<double> coefficients(4 * count);
     for (int i = 0 ; i < count ; ++i) {
-        const Fastener f = splice->fastenerAt(i);
-        //foreach(const Fastener &f, splice->fasteners()) {
-
-        Data d { 0.*m_2, 0.*m_2, 0.*m_3, 0.*m_3 };
-
-        switch (m_params) {
-        case SolverParameters::RigidBodySolverWithIsoBearing:
-
-            if (f.DoF_X == Fastener::Fixed) d.Ax = f.diameter * f.thickness;
-            if (f.DoF_Y == Fastener::Fixed) d.Ay = f.diameter * f.thickness;
-
-            break;
-        case SolverParameters::RigidBodySolverWithIsoShear:
-
-            if (f.DoF_X == Fastener::Fixed) d.Ax = f.diameter * f.diameter;
-            if (f.DoF_Y == Fastener::Fixed) d.Ay = f.diameter * f.diameter;
-
-            break;
-        default:
-            Q_UNREACHABLE();
-            break;
-        }
-
-        d.Bx = d.Ax * f.positionY;
-        d.By = d.Ay * f.positionX;
-
-        _list.append( d );
+        const Raw::Area Ax(p.Ax.at(i));
+        const Raw::Area Ay(p.Ay.at(i));
+        const Raw::Dimensionless ax = Ax / sumData.Ax;
+        const Raw::Dimensionless ay = Ay / sumData.Ay;
+        const Raw::Quantity<-1, 0> mx = -1.0 * (Raw::Length(p.y.at(i)) - CoG_y) * Ax / polar;
+        const Raw::Quantity<-1, 0> my =        (Raw::Length(p.x.at(i)) - CoG_x) * Ay / polar;
+        coefficients[4 * i]     = ax.value;
+        coefficients[4 * i + 1] = ay.value;
+        coefficients[4 * i + 2] = mx.value;
+        coefficients[4 * i + 3] = my.value;
     }
 
-    // ---------------------------------
-    Data sumData { 0, 0, 0, 0 };
-    foreach(const Data &p, _list) {
-        sumData.Ax += p.Ax;
-        sumData.Ay += p.Ay;
-        sumData.Bx += p.Bx;
-        sumData.By += p.By;
+    QList<QList<Tensor> > res;
+    res.reserve(loadCases.count());
+    foreach (const Tensor &loadCase, loadCases) {
+        const Raw::Force fx = Raw::fromSI(loadCase.force_x);
+        const Raw::Force fy = Raw::fromSI(loadCase.force_y);
+        const Raw::Torque mz = Raw::fromSI(loadCase.torque_z) + (CoG_y * fx - CoG_x * fy);
+
+        QList<Tensor> result;
+        result.reserve(count);
+        const double *c = coefficients.constData();
+        for (int i = 0 ; i < count ; ++i, c += 4) {
+            const Raw::Force loadX = Raw::Dimensionless(c[0]) * fx + Raw::Quantity<-1, 0>(c[2]) * mz;
+            const Raw::Force loadY = Raw::Dimensionless(c[1]) * fy + Raw::Quantity<-1, 0>(c[3]) * mz;
+            /* Boundary */
+            result.append( Tensor( Raw::toSI(loadX),
+                                   Raw::toSI(loadY),
+                                   0. *N_m ) );
+        }
+        res.append(result);
     }
+    return res;
+}
 
-    quantity<si::length> CoG_x = sumData.By / sumData.Ay ;
-    quantity<si::length> CoG_y = sumData.Bx / sumData.Ax ;
-
-    // ---------------------------------
-    QList<Inertia> inertias;
-
-    for (int i = 0 ; i < count ; ++i) {
-        const Fastener f = splice->fastenerAt(i);
-        Inertia inertia;
-        inertia.x = _list[i].Ax * boost::units::pow<2>(f.positionY - CoG_y);
-        inertia.y = _list[i].Ay * boost::units::pow<2>(f.positionX - CoG_x);
-        inertias.append(inertia);
-    }
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Calculates the results of the \a splice, after a change of
+ * the fastener at \a changedIndex only.
+ *
+ * The contribution of the changed fastener is replaced in the cached sums,
+ * and the inertias are obtained from the sums in constant time.
+ * The results of all the fasteners change when a single fastener moves,
+ * so the distribution of the load is still linear with the fastener count,
+ * but with a single pass instead of three.
+ *
+ * If \a changedIndex is negative, or if the fastener count changed,
+ * the cache is rebuilt.
+ */
+QList<Tensor> RigidBodySolver::calculateIncremental(const Splice *splice, const int changedIndex)
+{
+    Q_ASSERT(splice);
+    Q_ASSERT(m_params == SolverParameters::RigidBodySolverWithIsoBearing ||
+             m_params == SolverParameters::RigidBodySolverWithIsoShear);
 
+    const int count = splice->fastenerCount();
+    Cache &cache = *m_cache;
+
+    const bool valid = changedIndex >= 0
+            && changedIndex < count
+            && cache.items.x.count() == count
+            && cache.updateCount < C_MAX_INCREMENTAL_UPDATES;
+
+    if (valid) {
+        /* Replace the contribution of the changed fastener. */
+        const Sums before = fastenerSums(cache.items, changedIndex);
+        const Inertia beforeOrigin = originInertia(cache.items, changedIndex);
+        pack(splice->fastenerAt(changedIndex), m_params, cache.items, changedIndex);
+        const Sums after = fastenerSums(cache.items, changedIndex);
+        const Inertia afterOrigin = originInertia(cache.items, changedIndex);
+
+        cache.sumData.Ax += after.Ax - before.Ax;
+        cache.sumData.Ay += after.Ay - before.Ay;
+        cache.sumData.Bx += after.Bx - before.Bx;
+        cache.sumData.By += after.By - before.By;
+        cache.sumOrigin.x += afterOrigin.x - beforeOrigin.x;
+        cache.sumOrigin.y += afterOrigin.y - beforeOrigin.y;
+        cache.updateCount++;
 
-    Inertia sumInertia { 0, 0 };
-    foreach(const Inertia &p, inertias) {
-        sumInertia.x += p.x;
-        sumInertia.y += p.y;
+    } else {
+        /* Rebuild the cache. */
+        cache.clear();
+        cache.items = pack(splice, m_params);
+        cache.sumData = Sums();
+        cache.sumOrigin = Inertia();
+
+        for (int i = 0 ; i < count ; ++i) {
+            const Sums d = fastenerSums(cache.items, i);
+            const Inertia origin = originInertia(cache.items, i);
+            cache.sumData.Ax += d.Ax;
+            cache.sumData.Ay += d.Ay;
+            cache.sumData.Bx += d.Bx;
+            cache.sumData.By += d.By;
+            cache.sumOrigin.x += origin.x;
+            cache.sumOrigin.y += origin.y;
+        }
     }
 
-    inertias.clear(); // no need anymore
-
-    // ---------------------------------
-    Tensor appliedLoad = splice->appliedLoad();
-    Tensor cogLoad;
-    cogLoad.force_x = appliedLoad.force_x;
-    cogLoad.force_y = appliedLoad.force_y;
-    cogLoad.torque_z = appliedLoad.torque_z
-            + (CoG_y * appliedLoad.force_x - CoG_x * appliedLoad.force_y) / (si::radian);
-
-    // ---------------------------------
-
-    for (int i = 0 ; i < count ; ++i) {
-        const Fastener f = splice->fastenerAt(i);
-
-        Tensor fastenerload;
-        fastenerload.force_x =
-                -1.0/(sumInertia.y + sumInertia.x) * cogLoad.torque_z
-                * (f.positionY - CoG_y) * _list[i].Ax * si::radians
-                + cogLoad.force_x * (_list[i].Ax / sumData.Ax);
-
-        fastenerload.force_y =
-                1.0/(sumInertia.y + sumInertia.x)  * cogLoad.torque_z
-                * (f.positionX - CoG_x) * _list[i].Ay * si::radians
-                + cogLoad.force_y * (_list[i].Ay / sumData.Ay);
+    const Sums &sumData = cache.sumData;
+    const Raw::Length CoG_x = sumData.By / sumData.Ay ;
+    const Raw::Length CoG_y = sumData.Bx / sumData.Ax ;
 
-        fastenerload.torque_z = 0.0 *si::newton_meters;
+    /* Parallel axis theorem */
+    Inertia sumInertia;
+    sumInertia.x = cache.sumOrigin.x - 2.0 * CoG_y * sumData.Bx
+            + (CoG_y * CoG_y) * sumData.Ax;
+    sumInertia.y = cache.sumOrigin.y - 2.0 * CoG_x * sumData.By
+            + (CoG_x * CoG_x) * sumData.Ay;
 
-        res.append(fastenerload);
-    }
-    return res;
+    return distribute(cache.items, splice->appliedLoad(), sumData, sumInertia, CoG_x, CoG_y);
 }
-
@@ -30,12 +30,20 @@ public:
     ~RigidBodySolver();
 
     virtual QList<Tensor> calculate(const Splice *splice) Q_DECL_OVERRIDE;
+    virtual QList<Tensor> calculateIncremental(const Splice *splice,
+                                               const int changedIndex) Q_DECL_OVERRIDE;
+    virtual QList<QList<Tensor> > calculateLoadCases(const Splice *splice,
+                                                     const QVector<Tensor> &loadCases) Q_DECL_OVERRIDE;
+    virtual quint64 parametersKey() const Q_DECL_OVERRIDE;
 
     SolverParameters parameters() const;
     void setParameters(SolverParameters parameters);
 
 private:
+    struct Cache;
+
     SolverParameters m_params;
+    Cache *m_cache;
 };
 
 
@@ -0,0 +1,245 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "solvercache.h"
+
+#include <Core/Solvers/ISolver>
+#include <Core/Splice>
+
+#include <QtCore/QHash>
+#include <QtCore/QMutexLocker>
+
+#include <limits>
+
+Q_GLOBAL_STATIC(SolverCache, _q_globalSolverCache)
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class SolverCache
+ * \brief The class SolverCache keeps the most recently calculated results,
+ * to not solve again a pattern that was already solved.
+ *
+ * The results are keyed by the solver's parameters (ISolver::parametersKey()),
+ * the fastener geometry and DoFs, and the applied load (and the load cases,
+ * for an envelope). The other properties of the splice (title, design
+ * spaces...) are ignored. The keys are compared exactly, so a hash
+ * collision can't return the results of another pattern.
+ *
+ * The cache holds at most capacity() bytes of keys and results, and
+ * discards the least recently used entries first. An entry of n fasteners
+ * costs about 6n doubles of key plus n Tensors, so a large pattern
+ * takes the room of many small ones.
+ *
+ * The global instance is shared by the SpliceCalculator (undo/redo
+ * returns to states already solved), the optimiser and its Controller
+ * (that reports the solutions the optimiser has just evaluated).
+ * hitCount() and missCount() help to tune the capacity.
+ *
+ * The class is thread-safe. The solver itself runs outside the lock.
+ */
+SolverCache::SolverCache(int capacity)
+    : m_cache(qMax(0, capacity))
+    , m_hitCount(0)
+    , m_missCount(0)
+{
+}
+
+SolverCache::~SolverCache()
+{
+}
+
+/*! \brief Returns the cache shared by the application.
+ */
+SolverCache *SolverCache::globalInstance()
+{
+    return _q_globalSolverCache();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Returns the maximum size of the cache in memory, in bytes.
+ * The default is 32 MB.
+ */
+int SolverCache::capacity() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.maxCost();
+}
+
+void SolverCache::setCapacity(int capacity)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(qMax(0, capacity));
+}
+
+int SolverCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.count();
+}
+
+/*! \brief Returns the approximate size of the cached entries, in bytes.
+ */
+int SolverCache::cost() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.totalCost();
+}
+
+void SolverCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Returns true and sets the \a results if the \a solver has
+ * already calculated the \a splice. Otherwise returns false.
+ *
+ * Counts a hit or a miss.
+ */
+bool SolverCache::find(const ISolver *solver, const Splice *splice, ResultType type,
+                       QList<Tensor> *results)
+{
+    Q_ASSERT(solver);
+    Q_ASSERT(splice);
+    Q_ASSERT(results);
+    const Key k = key(solver, splice, type);
+
+    QMutexLocker locker(&m_mutex);
+    const QList<Tensor> *cached = m_cache.object(k); /* Most recently used now */
+    if (!cached) {
+        ++m_missCount;
+        return false;
+    }
+    ++m_hitCount;
+    *results = *cached;
+    return true;
+}
+
+void SolverCache::insert(const ISolver *solver, const Splice *splice, ResultType type,
+                         const QList<Tensor> &results)
+{
+    Q_ASSERT(solver);
+    Q_ASSERT(splice);
+    const Key k = key(solver, splice, type);
+
+    QMutexLocker locker(&m_mutex);
+    /* An entry larger than the capacity is not cached. */
+    m_cache.insert(k, new QList<Tensor>(results), costOf(k, results));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Returns the cached results of the \a splice, or calculates
+ * them with ISolver::calculate() and caches them.
+ */
+QList<Tensor> SolverCache::calculate(ISolver *solver, const Splice *splice)
+{
+    QList<Tensor> res;
+    if (!find(solver, splice, Results, &res)) {
+        res = solver->calculate(splice);
+        insert(solver, splice, Results, res);
+    }
+    return res;
+}
+
+/*! \brief Returns the cached envelope of the \a splice, or calculates
+ * it with ISolver::calculateEnvelope() and caches it.
+ */
+QList<Tensor> SolverCache::calculateEnvelope(ISolver *solver, const Splice *splice)
+{
+    QList<Tensor> res;
+    if (!find(solver, splice, Envelope, &res)) {
+        res = solver->calculateEnvelope(splice);
+        insert(solver, splice, Envelope, res);
+    }
+    return res;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+quint64 SolverCache::hitCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hitCount;
+}
+
+quint64 SolverCache::missCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_missCount;
+}
+
+void SolverCache::resetCounters()
+{
+    QMutexLocker locker(&m_mutex);
+    m_hitCount = 0;
+    m_missCount = 0;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+bool SolverCache::Key::operator==(const Key &other) const
+{
+    return hash == other.hash && values == other.values;
+}
+
+/* Approximate size of an entry in memory, in bytes. */
+int SolverCache::costOf(const Key &key, const QList<Tensor> &results)
+{
+    /* QList stores each Tensor (larger than a pointer) in its own node. */
+    const qint64 cost = qint64(sizeof(Key)) + qint64(sizeof(QList<Tensor>))
+            + qint64(key.values.capacity()) * qint64(sizeof(double))
+            + qint64(results.count()) * qint64(sizeof(void*) + sizeof(Tensor));
+    return int(qMin(cost, qint64(std::numeric_limits<int>::max())));
+}
+
+/* Flattens what the results depend on, in SI units. */
+SolverCache::Key SolverCache::key(const ISolver *solver, const Splice *splice,
+                                  ResultType type)
+{
+    const int fastenerCount = splice->fastenerCount();
+    const int loadCaseCount = (type == Envelope) ? splice->loadCaseCount() : 0;
+
+    Key k;
+    k.values.reserve(6 + 6 * fastenerCount + 3 * loadCaseCount);
+    k.values.append(type);
+    k.values.append(solver->parametersKey());
+    k.values.append(fastenerCount);
+    for (int i = 0; i < fastenerCount; ++i) {
+        const Fastener &fastener = splice->fastenerAt(i);
+        k.values.append(fastener.positionX.value());
+        k.values.append(fastener.positionY.value());
+        k.values.append(fastener.diameter.value());
+        k.values.append(fastener.thickness.value());
+        k.values.append(fastener.DoF_X);
+        k.values.append(fastener.DoF_Y);
+    }
+    const Tensor &load = splice->appliedLoad();
+    k.values.append(load.force_x.value());
+    k.values.append(load.force_y.value());
+    k.values.append(load.torque_z.value());
+    for (int i = 0; i < loadCaseCount; ++i) {
+        const Tensor &loadCase = splice->loadCaseAt(i);
+        k.values.append(loadCase.force_x.value());
+        k.values.append(loadCase.force_y.value());
+        k.values.append(loadCase.torque_z.value());
+    }
+    k.hash = qHashBits(k.values.constData(), size_t(k.values.count()) * sizeof(double));
+    return k;
+}
@@ -0,0 +1,84 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_SOLVERS_SOLVER_CACHE_H
+#define CORE_SOLVERS_SOLVER_CACHE_H
+
+#include <Core/Tensor>
+
+#include <QtCore/QCache>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+
+class ISolver;
+class Splice;
+
+#define C_SOLVER_CACHE_DEFAULT_CAPACITY (32 * 1024 * 1024) /* 32 MB */
+
+class SolverCache
+{
+public:
+    enum ResultType { Results, Envelope };
+
+    explicit SolverCache(int capacity = C_SOLVER_CACHE_DEFAULT_CAPACITY);
+    ~SolverCache();
+
+    static SolverCache *globalInstance();
+
+    int capacity() const;
+    void setCapacity(int capacity);
+    int count() const;
+    int cost() const;
+    void clear();
+
+    bool find(const ISolver *solver, const Splice *splice, ResultType type,
+              QList<Tensor> *results);
+    void insert(const ISolver *solver, const Splice *splice, ResultType type,
+                const QList<Tensor> &results);
+
+    QList<Tensor> calculate(ISolver *solver, const Splice *splice);
+    QList<Tensor> calculateEnvelope(ISolver *solver, const Splice *splice);
+
+    quint64 hitCount() const;
+    quint64 missCount() const;
+    void resetCounters();
+
+    struct Key
+    {
+        uint hash;
+        QVector<double> values;
+        bool operator==(const Key &other) const;
+    };
+
+private:
+    Q_DISABLE_COPY(SolverCache)
+
+    mutable QMutex m_mutex;
+    QCache<Key, QList<Tensor> > m_cache;
+    quint64 m_hitCount;
+    quint64 m_missCount;
+
+    static Key key(const ISolver *solver, const Splice *splice, ResultType type);
+    static int costOf(const Key &key, const QList<Tensor> &results);
+};
+
+inline uint qHash(const SolverCache::Key &key, uint seed = 0)
+{
+    return key.hash ^ seed;
+}
+
+#endif // CORE_SOLVERS_SOLVER_CACHE_H
@@ -0,0 +1,165 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "solverworker.h"
+
+#include <Core/Solvers/ISolver>
+#include <Core/Solvers/SolverCache>
+
+#include <QtCore/QMetaType>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRunnable>
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class SolverTask
+ * \remark QRunnable cannot emit Signals. It's not a QObject.
+ *         The workaround is to emit Signals from the SolverWorker.
+ */
+class SolverTask : public QRunnable
+{
+public:
+    SolverTask(SolverWorker *w) : QRunnable(), m_worker(w) {}
+
+public:
+    void run() Q_DECL_OVERRIDE
+    {
+        m_worker->runAsync();
+    }
+
+private:
+    SolverWorker* m_worker;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class SolverWorker
+ * \brief The class SolverWorker runs the solver in a worker thread,
+ * with latest-wins coalescing.
+ *
+ * The worker keeps at most one pending job: a job submitted while
+ * another one is pending replaces it, so a burst of edits
+ * (e.g. a fastener dragged with the mouse) is solved only once
+ * after the running job.
+ *
+ * Each job is identified by a generation number. The results are
+ * emitted with the generation of their job, with resultsReady(),
+ * in the thread of the receiver (i.e. queued). The receiver
+ * discards the results of an outdated generation.
+ *
+ * The results are inserted into SolverCache::globalInstance() by the
+ * worker, under the splice of their job: the receiver's splice may
+ * have changed since (e.g. edits postponed by beginUpdate()).
+ *
+ * The jobs call ISolver::calculateIncremental() in the order of
+ * execution. When two jobs are coalesced, the changed index of the
+ * resulting job is the union of both (i.e. all the fasteners if
+ * they differ), so that the solver's incremental data stay consistent.
+ *
+ * \remark The job contains a copy of the Splice. Since the containers
+ * of Splice are implicitly shared, the copy is cheap, and the
+ * caller can modify its splice while the job runs.
+ */
+SolverWorker::SolverWorker(QObject *parent) : QObject(parent)
+  , m_running(false)
+  , m_hasPendingJob(false)
+{
+    qRegisterMetaType<QList<Tensor> >("QList<Tensor>");
+
+    /* Use a dedicated pool, so that the jobs don't wait
+     * for the optimisation tasks in QThreadPool::globalInstance(). */
+    m_pool.setMaxThreadCount(1);
+}
+
+SolverWorker::~SolverWorker()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_hasPendingJob = false;
+        m_pendingJob = Job();
+    }
+    m_pool.waitForDone();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Submits a job that calculates the results of the given \a splice
+ * with the given \a solver. The previous pending job, if any, is discarded.
+ */
+void SolverWorker::submit(const quint64 generation, ISolver *solver,
+                          const Splice &splice, const int changedIndex)
+{
+    Q_ASSERT(solver);
+    QMutexLocker locker(&m_mutex);
+
+    int index = changedIndex;
+    if (m_hasPendingJob) {
+        /* Coalesce with the pending job */
+        if (m_pendingJob.solver != solver || m_pendingJob.changedIndex != changedIndex) {
+            index = -1;
+        }
+    }
+    m_pendingJob.generation = generation;
+    m_pendingJob.solver = solver;
+    m_pendingJob.splice = splice;
+    m_pendingJob.changedIndex = index;
+    m_hasPendingJob = true;
+
+    if (!m_running) {
+        m_running = true;
+        m_pool.start( new SolverTask(this) );
+    }
+}
+
+/*! \brief Blocks until all the submitted jobs are done.
+ */
+void SolverWorker::waitForDone()
+{
+    m_pool.waitForDone();
+}
+
+bool SolverWorker::isIdle() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_running;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \internal
+ * \brief Runs in the worker thread, until there's no pending job.
+ */
+void SolverWorker::runAsync()
+{
+    forever {
+        Job job;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_hasPendingJob) {
+                m_running = false;
+                return;
+            }
+            job = m_pendingJob;
+            m_pendingJob = Job();
+            m_hasPendingJob = false;
+        }
+
+        QList<Tensor> results = job.solver->calculateIncremental( &job.splice, job.changedIndex );
+        SolverCache::globalInstance()->insert( job.solver, &job.splice,
+                                               SolverCache::Results, results );
+        emit resultsReady(job.generation, results);
+    }
+}
@@ -0,0 +1,64 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_SOLVERS_SOLVER_WORKER_H
+#define CORE_SOLVERS_SOLVER_WORKER_H
+
+#include <Core/Splice>
+#include <Core/Tensor>
+
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QThreadPool>
+
+class ISolver;
+
+class SolverWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SolverWorker(QObject *parent = Q_NULLPTR);
+    ~SolverWorker();
+
+    void submit(const quint64 generation, ISolver *solver,
+                const Splice &splice, const int changedIndex);
+    void waitForDone();
+    bool isIdle() const;
+
+Q_SIGNALS:
+    void resultsReady(quint64 generation, QList<Tensor> results);
+
+private:
+    friend class SolverTask;
+
+    struct Job {
+        quint64 generation;
+        ISolver *solver;
+        Splice splice;
+        int changedIndex;
+    };
+
+    mutable QMutex m_mutex;
+    QThreadPool m_pool;
+    bool m_running;
+    bool m_hasPendingJob;
+    Job m_pendingJob;
+
+    void runAsync();
+};
+
+#endif // CORE_SOLVERS_SOLVER_WORKER_H
@@ -31,6 +31,10 @@
 /*! \class Splice
  *  \brief The class Splice is a container for splice document.
  *
+ * The applied load is the current load case, the one that is displayed
+ * and calculated. The splice can contain other load cases, that the
+ * design must also withstand (see ISolver::calculateEnvelope()).
+ *
  * Use read() and write() to serialize to JSON format.
  */
 
@@ -58,6 +62,15 @@ void Splice::read(const QJsonObject &json)
     QJsonObject load = json["load"].toObject();
     m_appliedLoad.read(load);
 
+    m_loadCases.clear();
+    QJsonArray loadCasesArray = json["loadcases"].toArray();
+    for (int i = 0; i < loadCasesArray.size(); ++i) {
+        QJsonObject loadCaseObject = loadCasesArray[i].toObject();
+        Tensor loadCase;
+        loadCase.read(loadCaseObject);
+        m_loadCases.append(loadCase);
+    }
+
     m_fasteners.clear();
     QJsonArray fixationsArray = json["fasteners"].toArray();
     for (int i = 0; i < fixationsArray.size(); ++i) {
@@ -90,6 +103,14 @@ void Splice::write(QJsonObject &json) const
     m_appliedLoad.write(load);
     json["load"] = load;
 
+    QJsonArray loadCasesArray;
+    foreach (const Tensor loadCase, m_loadCases) {
+        QJsonObject loadCaseObject;
+        loadCase.write(loadCaseObject);
+        loadCasesArray.append(loadCaseObject);
+    }
+    json["loadcases"] = loadCasesArray;
+
     QJsonArray fixationsArray;
     foreach (const Fastener fixation, m_fasteners) {
         QJsonObject fixationObject;
@@ -167,6 +188,54 @@ void Splice::setAppliedLoad(const Tensor &loadcase)
     m_appliedLoad = loadcase;
 }
 
+/******************************************************************************
+ ******************************************************************************/
+int Splice::loadCaseCount() const
+{
+    return m_loadCases.count();
+}
+
+const Tensor &Splice::loadCaseAt(const int index) const
+{
+    return m_loadCases.at(index);
+}
+
+void Splice::addLoadCase(const Tensor &loadCase)
+{
+    m_loadCases.append(loadCase);
+}
+
+void Splice::addLoadCase(const QVector<Tensor> &loadCases)
+{
+#if QT_VERSION >= 0x050500
+    m_loadCases.append(loadCases);
+#else
+    foreach (auto lc, loadCases) {
+        m_loadCases.append(lc);
+    }
+#endif
+}
+
+void Splice::insertLoadCase(const int index, const Tensor &loadCase)
+{
+    m_loadCases.insert(qBound(0, index, m_loadCases.size()), loadCase);
+}
+
+void Splice::setLoadCaseAt(const int index, const Tensor &loadCase)
+{
+    m_loadCases[index] = loadCase;
+}
+
+void Splice::removeLoadCaseAt(const int index)
+{
+    m_loadCases.removeAt(index);
+}
+
+void Splice::removeAllLoadCases()
+{
+    m_loadCases.clear();
+}
+
 /******************************************************************************
  ******************************************************************************/
 int Splice::fastenerCount() const
@@ -285,6 +354,7 @@ bool Splice::operator==(const Splice &other) const
             && (*this).m_date == other.m_date
             && (*this).m_description == other.m_description
             && (*this).m_appliedLoad == other.m_appliedLoad
+            && (*this).m_loadCases == other.m_loadCases
             && (*this).m_fasteners == other.m_fasteners
             && (*this).m_designSpaces == other.m_designSpaces;
 
@@ -337,7 +407,8 @@ bool Splice::isEquivalentTo(const Splice &other) const
             && (*this).m_author == other.m_author
             && (*this).m_date == other.m_date
             && (*this).m_description == other.m_description
-            && (*this).m_appliedLoad == other.m_appliedLoad;
+            && (*this).m_appliedLoad == other.m_appliedLoad
+            && (*this).m_loadCases == other.m_loadCases;
 }
 
 /******************************************************************************
@@ -350,11 +421,12 @@ char *toString(const Splice &splice)
     using QTest::toString;
 
     // delegate char* handling to QTest::toString(QByteArray):
-    return toString( QString("<Splice '%0' applied=(%1N, %2N, %3Nm) fCount=%4 dCount=%5 ... >")
+    return toString( QString("<Splice '%0' applied=(%1N, %2N, %3Nm) lcCount=%4 fCount=%5 dCount=%6 ... >")
                      .arg(splice.title())
                      .arg(splice.appliedLoad().force_x.value() , 0, 'f', 1)
                      .arg(splice.appliedLoad().force_y.value() , 0, 'f', 1)
                      .arg(splice.appliedLoad().torque_z.value() , 0, 'f', 1)
+                     .arg(splice.loadCaseCount())
                      .arg(splice.fastenerCount())
                      .arg(splice.designSpaceCount()) );
 }
@@ -364,11 +436,12 @@ char *toString(const Splice &splice)
 /// Custom Types to a Stream
 QDebug operator<<(QDebug dbg, const Splice &splice)
 {
-    dbg.nospace() << QString("<Splice '%0' applied=(%1N, %2N, %3Nm) fCount=%4 dCount=%5 ... >")
+    dbg.nospace() << QString("<Splice '%0' applied=(%1N, %2N, %3Nm) lcCount=%4 fCount=%5 dCount=%6 ... >")
                      .arg(splice.title())
                      .arg(splice.appliedLoad().force_x.value() , 0, 'f', 1)
                      .arg(splice.appliedLoad().force_y.value() , 0, 'f', 1)
                      .arg(splice.appliedLoad().torque_z.value() , 0, 'f', 1)
+                     .arg(splice.loadCaseCount())
                      .arg(splice.fastenerCount())
                      .arg(splice.designSpaceCount());
     return dbg.maybeSpace();
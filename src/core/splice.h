@@ -62,6 +62,15 @@ public:
     Tensor appliedLoad() const;
     void setAppliedLoad(const Tensor &appliedLoad);
 
+    int loadCaseCount() const;
+    const Tensor& loadCaseAt(const int index) const;
+    void addLoadCase(const Tensor &loadCase);
+    void addLoadCase(const QVector<Tensor> &loadCases);
+    void insertLoadCase(const int index, const Tensor &loadCase);
+    void setLoadCaseAt(const int index, const Tensor &loadCase);
+    void removeLoadCaseAt(const int index);
+    void removeAllLoadCases();
+
     int fastenerCount() const;
     const Fastener& fastenerAt(const int index) const;
     void insertFastener(const int index, const Fastener &fastener);
@@ -90,6 +99,7 @@ private:
     QString m_date;
     QString m_description;
     Tensor m_appliedLoad;
+    QVector<Tensor> m_loadCases;
     QVector<Fastener> m_fasteners;
     QVector<DesignSpace> m_designSpaces;
 
@@ -0,0 +1,556 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "splicebinary.h"
+
+#include <Core/DesignSpace>
+#include <Core/Fastener>
+#include <Core/Splice>
+#include <Core/Tensor>
+
+#include <QtCore/QBuffer>
+#include <QtCore/QByteArray>
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtCore/QtEndian>
+
+#include <cstring> /* memcpy() */
+
+/*! \namespace SpliceBinary
+ *  \brief The namespace SpliceBinary contains the compact binary
+ *  serialization of a Splice.
+ *
+ * The binary format is an alternative to the JSON format (see Splice::read()
+ * and Splice::write()) for the very large splices. Both formats contain
+ * exactly the same data, so a splice can be converted losslessly
+ * from one format to the other, through the Splice class.
+ *
+ * The file is little-endian, and all the sections are 8-byte aligned:
+ *
+ * \verbatim
+ *   +------------------------+  0
+ *   | Header (136 bytes)     |
+ *   +------------------------+  fastenerOffset
+ *   | Fastener records       |  40 bytes per fastener
+ *   +------------------------+  designSpaceOffset
+ *   | Design Space records   |  16 bytes per design space
+ *   +------------------------+  loadCaseOffset
+ *   | Load case records      |  24 bytes per load case (fx, fy, mz)
+ *   +------------------------+  pointOffset
+ *   | Polygon points         |  16 bytes per point (x, y)
+ *   +------------------------+  stringIndexOffset
+ *   | String index           |  8 bytes per string (offset, size)
+ *   +------------------------+  stringDataOffset
+ *   | String data (UTF-8)    |
+ *   +------------------------+
+ * \endverbatim
+ *
+ * The strings are deduplicated, and referenced by their index in the
+ * string table. When reading, each distinct string is decoded once from
+ * the mapped memory, and then shared (implicitly) by all the objects
+ * that reference it.
+ *
+ * The version 1.0 had a header of 128 bytes, and no load case. Its padding
+ * was zeroed, so the load case count of these files is read as zero.
+ *
+ * \remark The reader memory-maps the file with QFile::map(), so the file
+ * content is not copied before parsing. If the file cannot be mapped,
+ * it is read in memory.
+ */
+
+namespace SpliceBinary {
+
+static const char C_MAGIC[8] = { 'F', 'P', 'S', 'P', 'L', 'I', 'C', 'E' };
+
+enum {
+    HeaderSize = 136,
+    HeaderSizeV10 = 128,
+    FastenerRecordSize = 40,
+    DesignSpaceRecordSize = 16,
+    LoadCaseRecordSize = 24,
+    PointRecordSize = 16,
+    StringRecordSize = 8
+};
+
+/* Offsets of the header's fields */
+enum {
+    H_Magic = 0,
+    H_VersionMajor = 8,
+    H_VersionMinor = 10,
+    H_HeaderSize = 12,
+    H_FastenerCount = 16,
+    H_DesignSpaceCount = 20,
+    H_PointCount = 24,
+    H_StringCount = 28,
+    H_Title = 32,
+    H_Author = 36,
+    H_Date = 40,
+    H_Description = 44,
+    H_LoadFx = 48,
+    H_LoadFy = 56,
+    H_LoadMz = 64,
+    H_FastenerOffset = 72,
+    H_DesignSpaceOffset = 80,
+    H_PointOffset = 88,
+    H_StringIndexOffset = 96,
+    H_StringDataOffset = 104,
+    H_StringDataSize = 112,
+    H_LoadCaseCount = 120,
+    H_LoadCaseOffset = 128
+};
+
+/******************************************************************************
+ ******************************************************************************/
+static inline quint8 readUInt8(const uchar *p)
+{
+    return *p;
+}
+
+static inline quint16 readUInt16(const uchar *p)
+{
+    return qFromLittleEndian<quint16>(p);
+}
+
+static inline quint32 readUInt32(const uchar *p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+static inline quint64 readUInt64(const uchar *p)
+{
+    return qFromLittleEndian<quint64>(p);
+}
+
+static inline double readDouble(const uchar *p)
+{
+    const quint64 bits = qFromLittleEndian<quint64>(p);
+    double value;
+    std::memcpy(&value, &bits, sizeof(double));
+    return value;
+}
+
+/* Returns true if the \a count records of \a recordSize bytes at \a offset
+ * are inside the \a total bytes. The offsets come from the file, so the
+ * test must not overflow. */
+static inline bool isInside(quint64 offset, quint64 count, quint64 recordSize, quint64 total)
+{
+    return offset <= total && count <= (total - offset) / recordSize;
+}
+
+static inline bool setError(QString *error, const QString &message)
+{
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \internal
+ * \class StringTable
+ * \brief Decodes each string of the mapped file once.
+ */
+class StringTable
+{
+public:
+    StringTable(const uchar *index, const uchar *data, quint32 count, quint64 dataSize)
+        : m_index(index), m_data(data), m_count(count), m_dataSize(dataSize)
+        , m_strings(count), m_decoded(count, false)
+    {}
+
+    bool isValid(quint32 id) const
+    {
+        if (id >= m_count)
+            return false;
+        const uchar *record = m_index + id * StringRecordSize;
+        const quint64 offset = readUInt32(record);
+        const quint64 size = readUInt32(record + 4);
+        return offset + size <= m_dataSize;
+    }
+
+    QString at(quint32 id)
+    {
+        Q_ASSERT(isValid(id));
+        if (!m_decoded.at(id)) {
+            const uchar *record = m_index + id * StringRecordSize;
+            const quint32 offset = readUInt32(record);
+            const quint32 size = readUInt32(record + 4);
+            m_strings[id] = QString::fromUtf8(
+                        reinterpret_cast<const char*>(m_data + offset), int(size));
+            m_decoded[id] = true;
+        }
+        return m_strings.at(id);
+    }
+
+private:
+    const uchar *m_index;
+    const uchar *m_data;
+    quint32 m_count;
+    quint64 m_dataSize;
+    QVector<QString> m_strings;
+    QVector<bool> m_decoded;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Returns true if the given \a data starts with the binary header.
+ */
+bool isBinary(const uchar *data, qint64 size)
+{
+    return data
+            && size >= HeaderSizeV10
+            && std::memcmp(data, C_MAGIC, sizeof(C_MAGIC)) == 0;
+}
+
+/*! \brief Returns true if the file at \a path is a binary splice file.
+ */
+bool isBinaryFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray header = file.read(HeaderSizeV10);
+    return isBinary(reinterpret_cast<const uchar*>(header.constData()), header.size());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Assign the \a splice's members values from the given binary \a data.
+ *
+ * Returns false if the data is not a valid binary splice,
+ * and then \a error contains a description of the problem.
+ */
+bool read(const uchar *data, qint64 size, Splice *splice, QString *error)
+{
+    Q_ASSERT(splice);
+
+    if (!isBinary(data, size)) {
+        return setError(error, QStringLiteral("Not a binary splice file."));
+    }
+
+    const quint16 major = readUInt16(data + H_VersionMajor);
+    if (major != C_SPLICE_BINARY_VERSION_MAJOR) {
+        return setError(error, QString("Unsupported binary splice version %0.%1.")
+                        .arg(major).arg(readUInt16(data + H_VersionMinor)));
+    }
+    const quint32 headerSize = readUInt32(data + H_HeaderSize);
+    if (headerSize < HeaderSizeV10 || headerSize > quint64(size)) {
+        return setError(error, QStringLiteral("Corrupted header."));
+    }
+
+    const quint32 fastenerCount    = readUInt32(data + H_FastenerCount);
+    const quint32 designSpaceCount = readUInt32(data + H_DesignSpaceCount);
+    const quint32 pointCount       = readUInt32(data + H_PointCount);
+    const quint32 stringCount      = readUInt32(data + H_StringCount);
+    const quint32 loadCaseCount    = readUInt32(data + H_LoadCaseCount);
+    if (loadCaseCount > 0 && headerSize < HeaderSize) {
+        return setError(error, QStringLiteral("Corrupted header."));
+    }
+
+    const quint64 fastenerOffset    = readUInt64(data + H_FastenerOffset);
+    const quint64 designSpaceOffset = readUInt64(data + H_DesignSpaceOffset);
+    const quint64 pointOffset       = readUInt64(data + H_PointOffset);
+    const quint64 stringIndexOffset = readUInt64(data + H_StringIndexOffset);
+    const quint64 stringDataOffset  = readUInt64(data + H_StringDataOffset);
+    const quint64 stringDataSize    = readUInt64(data + H_StringDataSize);
+    const quint64 loadCaseOffset    = (loadCaseCount > 0) ? readUInt64(data + H_LoadCaseOffset) : 0;
+
+    /* Sanity checks: all the sections must be inside the data. */
+    const quint64 total = quint64(size);
+    if (!isInside(fastenerOffset,    fastenerCount,    FastenerRecordSize,    total) ||
+        !isInside(designSpaceOffset, designSpaceCount, DesignSpaceRecordSize, total) ||
+        !isInside(loadCaseOffset,    loadCaseCount,    LoadCaseRecordSize,    total) ||
+        !isInside(pointOffset,       pointCount,       PointRecordSize,       total) ||
+        !isInside(stringIndexOffset, stringCount,      StringRecordSize,      total) ||
+        !isInside(stringDataOffset,  stringDataSize,   1,                     total)) {
+        return setError(error, QStringLiteral("Truncated binary splice file."));
+    }
+
+    StringTable strings(data + stringIndexOffset, data + stringDataOffset,
+                        stringCount, stringDataSize);
+
+    const quint32 titleId       = readUInt32(data + H_Title);
+    const quint32 authorId      = readUInt32(data + H_Author);
+    const quint32 dateId        = readUInt32(data + H_Date);
+    const quint32 descriptionId = readUInt32(data + H_Description);
+    if (!strings.isValid(titleId) || !strings.isValid(authorId) ||
+        !strings.isValid(dateId) || !strings.isValid(descriptionId)) {
+        return setError(error, QStringLiteral("Corrupted string table."));
+    }
+
+    /* Fasteners */
+    QVector<Fastener> fasteners;
+    fasteners.reserve(int(fastenerCount));
+    for (quint32 i = 0; i < fastenerCount; ++i) {
+        const uchar *record = data + fastenerOffset + quint64(i) * FastenerRecordSize;
+        const quint32 nameId = readUInt32(record + 32);
+        if (!strings.isValid(nameId)) {
+            return setError(error, QStringLiteral("Corrupted string table."));
+        }
+        Fastener fastener(readDouble(record     ) *m,
+                          readDouble(record +  8) *m,
+                          readDouble(record + 16) *m,
+                          readDouble(record + 24) *m,
+                          Fastener::boolToDOF( readUInt8(record + 36) != 0 ),
+                          Fastener::boolToDOF( readUInt8(record + 37) != 0 ));
+        fastener.name = strings.at(nameId);
+        fasteners.append(fastener);
+    }
+
+    /* Design Spaces */
+    QVector<DesignSpace> designSpaces;
+    designSpaces.reserve(int(designSpaceCount));
+    for (quint32 i = 0; i < designSpaceCount; ++i) {
+        const uchar *record = data + designSpaceOffset + quint64(i) * DesignSpaceRecordSize;
+        const quint32 nameId = readUInt32(record);
+        const quint64 first = readUInt32(record + 4);
+        const quint64 count = readUInt32(record + 8);
+        if (!strings.isValid(nameId) || first + count > pointCount) {
+            return setError(error, QStringLiteral("Corrupted design space."));
+        }
+        DesignSpace designSpace;
+        designSpace.name = strings.at(nameId);
+        designSpace.polygon.reserve(int(count));
+        const uchar *point = data + pointOffset + first * PointRecordSize;
+        for (quint64 j = 0; j < count; ++j, point += PointRecordSize) {
+            designSpace.polygon << QPointF(readDouble(point), readDouble(point + 8));
+        }
+        designSpaces.append(designSpace);
+    }
+
+    /* Load cases */
+    QVector<Tensor> loadCases;
+    loadCases.reserve(int(loadCaseCount));
+    for (quint32 i = 0; i < loadCaseCount; ++i) {
+        const uchar *record = data + loadCaseOffset + quint64(i) * LoadCaseRecordSize;
+        loadCases.append( Tensor(readDouble(record     ) *N,
+                                 readDouble(record +  8) *N,
+                                 readDouble(record + 16) *N_m) );
+    }
+
+    splice->setTitle( strings.at(titleId) );
+    splice->setAuthor( strings.at(authorId) );
+    splice->setDate( strings.at(dateId) );
+    splice->setDescription( strings.at(descriptionId) );
+    splice->setAppliedLoad( Tensor(readDouble(data + H_LoadFx) *N,
+                                   readDouble(data + H_LoadFy) *N,
+                                   readDouble(data + H_LoadMz) *N_m) );
+    splice->removeAllLoadCases();
+    splice->addLoadCase(loadCases);
+    splice->removeAllFasteners();
+    splice->addFastener(fasteners);
+    splice->removeAllDesignSpaces();
+    splice->addDesignSpace(designSpaces);
+    return true;
+}
+
+/*! \brief Assign the \a splice's members values from the binary file at \a path.
+ *
+ * The file is memory-mapped, if possible.
+ */
+bool readFile(const QString &path, Splice *splice, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return setError(error, file.errorString());
+    }
+    const qint64 size = file.size();
+    uchar *mapped = file.map(0, size);
+    if (mapped) {
+        const bool ok = read(mapped, size, splice, error);
+        file.unmap(mapped);
+        return ok;
+    }
+    /* Fallback: the file system doesn't support the mapping. */
+    const QByteArray bytes = file.readAll();
+    return read(reinterpret_cast<const uchar*>(bytes.constData()), bytes.size(),
+                splice, error);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \internal
+ * \class StringTableBuilder
+ * \brief Deduplicates the strings before writing them.
+ */
+class StringTableBuilder
+{
+public:
+    quint32 insert(const QString &str)
+    {
+        QHash<QString, quint32>::const_iterator it = m_ids.constFind(str);
+        if (it != m_ids.constEnd()) {
+            return it.value();
+        }
+        const quint32 id = quint32(m_offsets.count());
+        const QByteArray utf8 = str.toUtf8();
+        m_ids.insert(str, id);
+        m_offsets.append(quint32(m_data.size()));
+        m_sizes.append(quint32(utf8.size()));
+        m_data.append(utf8);
+        return id;
+    }
+
+    quint32 count() const { return quint32(m_offsets.count()); }
+    const QByteArray &data() const { return m_data; }
+    quint32 offsetAt(int i) const { return m_offsets.at(i); }
+    quint32 sizeAt(int i) const { return m_sizes.at(i); }
+
+private:
+    QHash<QString, quint32> m_ids;
+    QVector<quint32> m_offsets;
+    QVector<quint32> m_sizes;
+    QByteArray m_data;
+};
+
+static inline void writePadding(QDataStream &out, qint64 count)
+{
+    for (qint64 i = 0; i < count; ++i) {
+        out << quint8(0);
+    }
+}
+
+/*! \brief Write the given \a splice to the \a device, in binary format.
+ */
+bool write(const Splice &splice, QIODevice *device)
+{
+    Q_ASSERT(device);
+
+    /* Collect the strings and the points */
+    StringTableBuilder strings;
+    const quint32 titleId       = strings.insert(splice.title());
+    const quint32 authorId      = strings.insert(splice.author());
+    const quint32 dateId        = strings.insert(splice.date());
+    const quint32 descriptionId = strings.insert(splice.description());
+
+    const quint32 fastenerCount = quint32(splice.fastenerCount());
+    QVector<quint32> fastenerNameIds;
+    fastenerNameIds.reserve(int(fastenerCount));
+    for (int i = 0; i < splice.fastenerCount(); ++i) {
+        fastenerNameIds.append(strings.insert(splice.fastenerAt(i).name));
+    }
+
+    const quint32 designSpaceCount = quint32(splice.designSpaceCount());
+    QVector<quint32> designSpaceNameIds;
+    designSpaceNameIds.reserve(int(designSpaceCount));
+    quint32 pointCount = 0;
+    for (int i = 0; i < splice.designSpaceCount(); ++i) {
+        designSpaceNameIds.append(strings.insert(splice.designSpaceAt(i).name));
+        pointCount += quint32(splice.designSpaceAt(i).polygon.count());
+    }
+
+    const quint32 loadCaseCount = quint32(splice.loadCaseCount());
+
+    /* Layout */
+    const quint64 fastenerOffset    = HeaderSize;
+    const quint64 designSpaceOffset = fastenerOffset + quint64(fastenerCount) * FastenerRecordSize;
+    const quint64 loadCaseOffset    = designSpaceOffset + quint64(designSpaceCount) * DesignSpaceRecordSize;
+    const quint64 pointOffset       = loadCaseOffset + quint64(loadCaseCount) * LoadCaseRecordSize;
+    const quint64 stringIndexOffset = pointOffset + quint64(pointCount) * PointRecordSize;
+    const quint64 stringDataOffset  = stringIndexOffset + quint64(strings.count()) * StringRecordSize;
+    const quint64 stringDataSize    = quint64(strings.data().size());
+
+    QDataStream out(device);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    /* Header */
+    const Tensor load = splice.appliedLoad();
+    out.writeRawData(C_MAGIC, sizeof(C_MAGIC));
+    out << quint16(C_SPLICE_BINARY_VERSION_MAJOR)
+        << quint16(C_SPLICE_BINARY_VERSION_MINOR)
+        << quint32(HeaderSize)
+        << fastenerCount
+        << designSpaceCount
+        << pointCount
+        << strings.count()
+        << titleId << authorId << dateId << descriptionId
+        << double(load.force_x.value())
+        << double(load.force_y.value())
+        << double(load.torque_z.value())
+        << fastenerOffset
+        << designSpaceOffset
+        << pointOffset
+        << stringIndexOffset
+        << stringDataOffset
+        << stringDataSize
+        << loadCaseCount;
+    writePadding(out, H_LoadCaseOffset - (H_LoadCaseCount + 4));
+    out << loadCaseOffset;
+
+    /* Fasteners */
+    for (int i = 0; i < splice.fastenerCount(); ++i) {
+        const Fastener &f = splice.fastenerAt(i);
+        out << double(f.positionX.value())
+            << double(f.positionY.value())
+            << double(f.diameter.value())
+            << double(f.thickness.value())
+            << fastenerNameIds.at(i)
+            << quint8(Fastener::DOFtoBool(f.DoF_X) ? 1 : 0)
+            << quint8(Fastener::DOFtoBool(f.DoF_Y) ? 1 : 0);
+        writePadding(out, 2);
+    }
+
+    /* Design Spaces */
+    quint32 first = 0;
+    for (int i = 0; i < splice.designSpaceCount(); ++i) {
+        const quint32 count = quint32(splice.designSpaceAt(i).polygon.count());
+        out << designSpaceNameIds.at(i) << first << count;
+        writePadding(out, 4);
+        first += count;
+    }
+
+    /* Load cases */
+    for (int i = 0; i < splice.loadCaseCount(); ++i) {
+        const Tensor &loadCase = splice.loadCaseAt(i);
+        out << double(loadCase.force_x.value())
+            << double(loadCase.force_y.value())
+            << double(loadCase.torque_z.value());
+    }
+
+    /* Points */
+    for (int i = 0; i < splice.designSpaceCount(); ++i) {
+        foreach (const QPointF &point, splice.designSpaceAt(i).polygon) {
+            out << double(point.x()) << double(point.y());
+        }
+    }
+
+    /* Strings */
+    for (quint32 i = 0; i < strings.count(); ++i) {
+        out << strings.offsetAt(int(i)) << strings.sizeAt(int(i));
+    }
+    out.writeRawData(strings.data().constData(), strings.data().size());
+
+    return out.status() == QDataStream::Ok;
+}
+
+/*! \brief Returns the given \a splice in binary format.
+ */
+QByteArray toByteArray(const Splice &splice)
+{
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::WriteOnly);
+    write(splice, &buffer);
+    return bytes;
+}
+
+} // namespace SpliceBinary
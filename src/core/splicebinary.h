@@ -0,0 +1,47 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_SPLICE_BINARY_H
+#define CORE_SPLICE_BINARY_H
+
+#include <QtCore/QtGlobal>
+
+QT_BEGIN_NAMESPACE
+class QByteArray;
+class QIODevice;
+class QString;
+QT_END_NAMESPACE
+
+class Splice;
+
+#define C_SPLICE_BINARY_VERSION_MAJOR 1
+#define C_SPLICE_BINARY_VERSION_MINOR 1
+
+namespace SpliceBinary {
+
+bool isBinary(const uchar *data, qint64 size);
+bool isBinaryFile(const QString &path);
+
+/* Binary Serialization */
+bool read(const uchar *data, qint64 size, Splice *splice, QString *error = Q_NULLPTR);
+bool readFile(const QString &path, Splice *splice, QString *error = Q_NULLPTR);
+
+bool write(const Splice &splice, QIODevice *device);
+QByteArray toByteArray(const Splice &splice);
+
+}
+
+#endif // CORE_SPLICE_BINARY_H
@@ -20,20 +20,59 @@
 #include <Core/Fastener>
 #include <Core/Splice>
 #include <Core/Tensor>
+#include <Core/Solvers/FiniteElementSolver>
 #include <Core/Solvers/ISolver>
 #include <Core/Solvers/Parameters>
 #include <Core/Solvers/RigidBodySolver>
+#include <Core/Solvers/SolverCache>
+#include <Core/Solvers/SolverWorker>
 
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonObject>
 #ifdef QT_DEBUG
 #  include <QtCore/QDebug>
 #endif
 
+#include <climits>
+
+/* Index passed to recalculate() when more than one fastener may have changed. */
+#define C_ALL_FASTENERS -1
 
 /*! \class SpliceCalculator
  *  \brief The class SpliceCalculator is the main manager for a splice document.
  *
+ * Each edit of the fasteners, the applied load or the solver parameters
+ * recalculates the results. To apply many edits with a single
+ * recalculation, enclose them between beginUpdate() and endUpdate().
+ *
+ * When a single fastener is changed, the results are updated with
+ * ISolver::calculateIncremental(), which can reuse the intermediate
+ * data of the previous calculation.
+ *
+ * The results are also kept in SolverCache::globalInstance(), so that
+ * returning to a pattern already solved (e.g. undo/redo) doesn't
+ * run the solver again.
+ *
+ * When asynchronous (see setAsynchronous()), the solver runs in a worker
+ * thread, and resultsChanged() is emitted later, in the thread of the
+ * SpliceCalculator (i.e. the GUI thread), when the results are ready.
+ * An edit made while a solve is pending supersedes it (latest wins).
+ * Each recalculation gets a new generation number, so the results of
+ * an outdated solve are discarded. This keeps the GUI responsive
+ * while dragging a fastener, regardless of the number of fasteners.
+ *
+ * Until the results are ready, resultAt() returns the previous results.
+ *
+ * A transaction (see beginTransaction()) is a batch of edits that
+ * also emits changed() only once, and transactionFinished()
+ * with the range of the modified fasteners.
+ *
+ * Each fastener and design space gets a stable ID (see fastenerId()).
+ * The lookup of an index by its ID is O(1): the map is updated in place
+ * when an element is appended or removed at the end, and rebuilt at the
+ * next lookup when the indexes have shifted.
  */
 
 /*! \brief Constructor.
@@ -42,7 +81,37 @@ SpliceCalculator::SpliceCalculator(QObject *parent) : AbstractSpliceModel(parent
   , m_params(SolverParameters::NoSolver)
   , m_solver(Q_NULLPTR)
   , m_splice(QSharedPointer<Splice>(new Splice))
+  , m_updateLevel(0)
+  , m_recalculationPending(false)
+  , m_changedFastenerIndex(C_ALL_FASTENERS)
+  , m_solverSynchronized(false)
+  , m_worker(new SolverWorker(this))
+  , m_asynchronous(false)
+  , m_generation(0)
+  , m_transactionLevel(0)
+  , m_changePending(false)
+  , m_firstChangedFastener(INT_MAX)
+  , m_lastChangedFastener(-1)
+  , m_lastId(0)
+{
+    m_pendingFasteners.isFastener = true;
+    m_pendingFasteners.type = NoRange;
+    m_pendingDesignSpaces.isFastener = false;
+    m_pendingDesignSpaces.type = NoRange;
+    m_fastenerIds.dirty = false;
+    m_designSpaceIds.dirty = false;
+
+    QObject::connect(m_worker, SIGNAL(resultsReady(quint64,QList<Tensor>)),
+                     this, SLOT(_q_resultsReady(quint64,QList<Tensor>)),
+                     Qt::QueuedConnection);
+}
+
+/*! \brief Destructor.
+ */
+SpliceCalculator::~SpliceCalculator()
 {
+    /* The worker uses the solver, that is deleted with the children. */
+    m_worker->waitForDone();
 }
 
 /******************************************************************************
@@ -60,6 +129,9 @@ SpliceCalculator::SpliceCalculator(QObject *parent) : AbstractSpliceModel(parent
  */
 void SpliceCalculator::clear()
 {
+    /* Not virtual: Calculator must not record the clearing as undoable. */
+    SpliceCalculator::beginTransaction();
+
     m_splice->setTitle(QStringLiteral("untitled"));
     m_splice->setAuthor(QStringLiteral("-"));
     m_splice->setDate(QStringLiteral("-"));
@@ -78,12 +150,16 @@ void SpliceCalculator::clear()
     for (int i = designSpaceCount()-1; i >=0; --i) {
         removeDesignSpace(i);
     }
+    m_splice->removeAllLoadCases();
 
     emit selectionFastenerChanged();
     emit selectionDesignSpaceChanged();
     emit appliedLoadChanged();
+    emit loadCasesChanged();
     emit solverParamsChanged();
     recalculate();
+
+    SpliceCalculator::endTransaction();
 }
 
 /******************************************************************************
@@ -93,24 +169,49 @@ void SpliceCalculator::clear()
  */
 void SpliceCalculator::read(const QJsonObject &json)
 {
+    Splice splice;
+    splice.read(json);
+    read(splice);
+}
+
+/*! \brief Assigns the values from the SpliceCalculator to the given \a json object.
+ */
+void SpliceCalculator::write(QJsonObject &json) const
+{
+    m_splice->write(json);
+}
+
+/*! \brief Assign the SpliceCalculator's members values from the given \a splice.
+ *
+ * This is used to load the formats other than JSON (e.g. SpliceBinary).
+ */
+void SpliceCalculator::read(const Splice &splice)
+{
+    SpliceCalculator::beginTransaction();
     clear();
-    m_splice->read(json);
+    flushPendingRanges();
+    *m_splice = splice;
+    resetIds(m_fastenerIds, fastenerCount());
+    resetIds(m_designSpaceIds, designSpaceCount());
     emit appliedLoadChanged();
-    for (int i = 0 ; i < fastenerCount(); ++i) {
-        emit fastenerInserted(i, fastenerAt(i));
+    emit loadCasesChanged();
+    if (fastenerCount() > 0) {
+        emit fastenersInserted(0, fastenerCount() - 1);
+        notifyFastenersChanged(0, fastenerCount() - 1);
     }
-    for (int i = 0 ; i < designSpaceCount(); ++i) {
-        emit designSpaceInserted(i, designSpaceAt(i));
+    if (designSpaceCount() > 0) {
+        emit designSpacesInserted(0, designSpaceCount() - 1);
     }
-    emit changed();
+    notifyChanged();
     recalculate();
+    SpliceCalculator::endTransaction();
 }
 
-/*! \brief Assigns the values from the SpliceCalculator to the given \a json object.
+/*! \brief Assigns the values from the SpliceCalculator to the given \a splice.
  */
-void SpliceCalculator::write(QJsonObject &json) const
+void SpliceCalculator::write(Splice &splice) const
 {
-    m_splice->write(json);
+    splice = *m_splice;
 }
 
 /******************************************************************************
@@ -124,7 +225,7 @@ void SpliceCalculator::setTitle(const QString &title)
 {
     if (m_splice->title() != title) {
         m_splice->setTitle(title);
-        emit changed();
+        notifyChanged();
     }
 }
 
@@ -139,7 +240,7 @@ void SpliceCalculator::setAuthor(const QString &author)
 {
     if (m_splice->author() != author) {
         m_splice->setAuthor(author);
-        emit changed();
+        notifyChanged();
     }
 }
 
@@ -154,7 +255,7 @@ void SpliceCalculator::setDate(const QString &date)
 {
     if (m_splice->date() != date) {
         m_splice->setDate(date);
-        emit changed();
+        notifyChanged();
     }
 }
 
@@ -169,7 +270,7 @@ void SpliceCalculator::setDescription(const QString &description)
 {
     if (m_splice->description() != description) {
         m_splice->setDescription(description);
-        emit changed();
+        notifyChanged();
     }
 }
 
@@ -211,6 +312,21 @@ Tensor SpliceCalculator::appliedLoad() const
     return m_splice->appliedLoad();
 }
 
+/*! \brief Returns the number of load cases, in addition to the applied load.
+ */
+int SpliceCalculator::loadCaseCount() const
+{
+    return m_splice->loadCaseCount();
+}
+
+Tensor SpliceCalculator::loadCaseAt(const int index) const
+{
+    if (index >= 0 && index < m_splice->loadCaseCount()) {
+        return m_splice->loadCaseAt(index);
+    }
+    return Tensor();
+}
+
 Tensor SpliceCalculator::resultAt(const int index) const
 {
     if (index >= 0 && index < m_results.count()) {
@@ -219,6 +335,14 @@ Tensor SpliceCalculator::resultAt(const int index) const
     return Tensor();
 }
 
+/*! \brief Returns the results of the solver, one per fastener.
+ * The list is implicitly shared: the copy is cheap.
+ */
+QList<Tensor> SpliceCalculator::results() const
+{
+    return m_results;
+}
+
 SolverParameters SpliceCalculator::solverParameters() const
 {
     return m_params;
@@ -236,13 +360,109 @@ QSet<int> SpliceCalculator::selectedDesignSpaceIndexes() const
     return m_selectedDesignSpaceIndexes;
 }
 
+/******************************************************************************
+ ******************************************************************************/
+quint32 SpliceCalculator::fastenerId(const int index) const
+{
+    return m_fastenerIds.ids.value(index, 0);
+}
+
+int SpliceCalculator::fastenerIndex(const quint32 id) const
+{
+    return indexOfId(m_fastenerIds, id);
+}
+
+quint32 SpliceCalculator::designSpaceId(const int index) const
+{
+    return m_designSpaceIds.ids.value(index, 0);
+}
+
+int SpliceCalculator::designSpaceIndex(const quint32 id) const
+{
+    return indexOfId(m_designSpaceIds, id);
+}
+
+/* Gives a new ID to the element inserted at the given \a index.
+ * Like Splice::insertFastener(), the index is bounded. */
+void SpliceCalculator::insertId(IdMap &map, const int index)
+{
+    const quint32 id = ++m_lastId;
+    if (index >= map.ids.count()) {
+        if (!map.dirty) {
+            map.indexes.insert(id, map.ids.count());
+        }
+        map.ids.append(id);
+    } else {
+        map.ids.insert(qMax(0, index), id);
+        map.dirty = true;
+    }
+}
+
+/* Gives new IDs to all the \a count elements. */
+void SpliceCalculator::resetIds(IdMap &map, const int count)
+{
+    map.ids.resize(count);
+    for (int i = 0; i < count; ++i) {
+        map.ids[i] = ++m_lastId;
+    }
+    map.dirty = true;
+}
+
+void SpliceCalculator::removeId(IdMap &map, const int index)
+{
+    if (index < 0 || index >= map.ids.count())
+        return;
+    if (index == map.ids.count() - 1) {
+        if (!map.dirty) {
+            map.indexes.remove(map.ids.last());
+        }
+        map.ids.removeLast();
+    } else {
+        map.ids.remove(index);
+        map.dirty = true;
+    }
+}
+
+int SpliceCalculator::indexOfId(const IdMap &map, const quint32 id)
+{
+    if (map.dirty) {
+        map.indexes.clear();
+        map.indexes.reserve(map.ids.count());
+        for (int i = 0; i < map.ids.count(); ++i) {
+            map.indexes.insert(map.ids.at(i), i);
+        }
+        map.dirty = false;
+    }
+    return map.indexes.value(id, -1);
+}
+
+/* The selection follows the elements when an element is inserted or
+ * removed before them: the indexes from \a index are shifted by \a delta.
+ * This is not notified, as the selection state of each element is unchanged. */
+void SpliceCalculator::shiftSelection(QSet<int> &selection, const int index, const int delta)
+{
+    QSet<int> shifted;
+    shifted.reserve(selection.count());
+    foreach (const int selected, selection) {
+        shifted << (selected >= index ? selected + delta : selected);
+    }
+    selection.swap(shifted);
+}
+
 /******************************************************************************
  ******************************************************************************/
 void SpliceCalculator::insertFastener(const int index, const Fastener &fastener)
 {
-    m_splice->insertFastener(index, fastener);
-    emit fastenerInserted(index, fastener);
-    emit changed();
+    /* Like Splice::insertFastener(), the index is bounded:
+     * the range signals give the actual row. */
+    const int position = qBound(0, index, m_splice->fastenerCount());
+    prepareRange(m_pendingFasteners, Inserted, position);
+    m_splice->insertFastener(position, fastener);
+    insertId(m_fastenerIds, position);
+    shiftSelection(m_selectedFastenerIndexes, position, +1);
+    notifyRange(m_pendingFasteners, Inserted, position);
+    notifyFastenersChanged(position, m_splice->fastenerCount() - 1);
+    notifyChanged();
     recalculate();
 }
 
@@ -256,22 +476,31 @@ void SpliceCalculator::setFastener(const int index, const Fastener &fastener)
     if (old == fastener)
         return;
 
+    prepareRange(m_pendingFasteners, Changed, index);
     m_splice->setFastenerAt(index, fastener);
 
-    emit fastenerChanged(index, fastener);
-    emit changed();
-    recalculate();
+    notifyRange(m_pendingFasteners, Changed, index);
+    notifyFastenersChanged(index, index);
+    notifyChanged();
+    recalculate(index);
 }
 
 void SpliceCalculator::removeFastener(const int index)
 {
     if (m_selectedFastenerIndexes.remove( index )) {
+        flushPendingRanges();
+        emit fastenersSelected(QSet<int>(), QSet<int>() << index);
         emit selectionFastenerChanged();
     }
     if (index >= 0 && index < m_splice->fastenerCount()) {
+        prepareRange(m_pendingFasteners, Removed, index);
         m_splice->removeFastenerAt(index);
-        emit fastenerRemoved(index);
-        emit changed();
+        removeId(m_fastenerIds, index);
+        shiftSelection(m_selectedFastenerIndexes, index + 1, -1);
+        notifyRange(m_pendingFasteners, Removed, index);
+        /* The fasteners after the removed one have moved. */
+        notifyFastenersChanged(index, qMax(index, m_splice->fastenerCount() - 1));
+        notifyChanged();
         recalculate();
     }
 }
@@ -280,9 +509,13 @@ void SpliceCalculator::removeFastener(const int index)
  ******************************************************************************/
 void SpliceCalculator::insertDesignSpace(const int index, const DesignSpace &designSpace)
 {
-    m_splice->insertDesignSpace(index, designSpace);
-    emit designSpaceInserted(index, designSpace);
-    emit changed();
+    const int position = qBound(0, index, m_splice->designSpaceCount());
+    prepareRange(m_pendingDesignSpaces, Inserted, position);
+    m_splice->insertDesignSpace(position, designSpace);
+    insertId(m_designSpaceIds, position);
+    shiftSelection(m_selectedDesignSpaceIndexes, position, +1);
+    notifyRange(m_pendingDesignSpaces, Inserted, position);
+    notifyChanged();
     // ** Remark **
     // Changing the design space does change the immediat results.
     // This is why the following methods are not called:
@@ -299,10 +532,11 @@ void SpliceCalculator::setDesignSpace(const int index, const DesignSpace &design
     if (old == designSpace)
         return;
 
+    prepareRange(m_pendingDesignSpaces, Changed, index);
     m_splice->setDesignSpaceAt(index, designSpace);
 
-    emit designSpaceChanged(index, designSpace);
-    emit changed();
+    notifyRange(m_pendingDesignSpaces, Changed, index);
+    notifyChanged();
     // ** Remark **
     // Changing the design space does change the immediat results.
     // This is why the following methods are not called:
@@ -313,12 +547,17 @@ void SpliceCalculator::setDesignSpace(const int index, const DesignSpace &design
 void SpliceCalculator::removeDesignSpace(const int index)
 {
     if (m_selectedDesignSpaceIndexes.remove( index )) {
+        flushPendingRanges();
+        emit designSpacesSelected(QSet<int>(), QSet<int>() << index);
         emit selectionDesignSpaceChanged();
     }
     if (index >= 0 && index < m_splice->designSpaceCount()) {
+        prepareRange(m_pendingDesignSpaces, Removed, index);
         m_splice->removeDesignSpaceAt(index);
-        emit designSpaceRemoved(index);
-        emit changed();
+        removeId(m_designSpaceIds, index);
+        shiftSelection(m_selectedDesignSpaceIndexes, index + 1, -1);
+        notifyRange(m_pendingDesignSpaces, Removed, index);
+        notifyChanged();
         // ** Remark **
         // Changing the design space does change the immediat results.
         // This is why the following methods are not called:
@@ -334,17 +573,54 @@ void SpliceCalculator::setAppliedLoad(const Tensor &appliedLoad)
     if (m_splice->appliedLoad() != appliedLoad) {
         m_splice->setAppliedLoad(appliedLoad);
         emit appliedLoadChanged();
-        emit changed();
+        notifyChanged();
         recalculate();
     }
 }
 
+/*! \brief Inserts the \a loadCase at the given \a index.
+ * The load cases don't change the results of the applied load.
+ */
+void SpliceCalculator::insertLoadCase(const int index, const Tensor &loadCase)
+{
+    if (index < 0 || index > m_splice->loadCaseCount())
+        return;
+
+    m_splice->insertLoadCase(index, loadCase);
+    emit loadCasesChanged();
+    notifyChanged();
+}
+
+void SpliceCalculator::setLoadCase(const int index, const Tensor &loadCase)
+{
+    if (index < 0 || index >= m_splice->loadCaseCount())
+        return;
+    if (m_splice->loadCaseAt(index) == loadCase)
+        return;
+
+    m_splice->setLoadCaseAt(index, loadCase);
+    emit loadCasesChanged();
+    notifyChanged();
+}
+
+void SpliceCalculator::removeLoadCase(const int index)
+{
+    if (index < 0 || index >= m_splice->loadCaseCount())
+        return;
+
+    m_splice->removeLoadCaseAt(index);
+    emit loadCasesChanged();
+    notifyChanged();
+}
+
 void SpliceCalculator::setSolverParameters(SolverParameters params)
 {
     if (m_params == params)
         return;
 
     if (m_solver) {
+        /* The running job (if any) still uses the old solver. */
+        m_worker->waitForDone();
         delete m_solver;
         m_solver = Q_NULLPTR;
     }
@@ -367,17 +643,20 @@ void SpliceCalculator::setSolverParameters(SolverParameters params)
     }
 
     case SolverParameters::FiniteElementSolver:
-
-        /// \todo implement SolverParameters::FiniteElementSolver
-
+    {
+        FiniteElementSolver* s = new FiniteElementSolver(this);
+        m_solver = (ISolver*)(s);
         break;
+    }
+
     case SolverParameters::NoSolver:
     default:
         break;
     }
     m_params = params;
+    m_solverSynchronized = false;
     emit solverParamsChanged();
-    emit changed();
+    notifyChanged();
     recalculate();
 }
 
@@ -387,7 +666,11 @@ void SpliceCalculator::setFastenerSelection(const QSet<int> indexes)
 {
     if (m_selectedFastenerIndexes == indexes)
         return;
+    const QSet<int> selected = QSet<int>(indexes).subtract(m_selectedFastenerIndexes);
+    const QSet<int> deselected = QSet<int>(m_selectedFastenerIndexes).subtract(indexes);
     m_selectedFastenerIndexes = indexes;
+    flushPendingRanges();
+    emit fastenersSelected(selected, deselected);
     emit selectionFastenerChanged();
 }
 
@@ -395,21 +678,385 @@ void SpliceCalculator::setDesignSpaceSelection(const QSet<int> indexes)
 {
     if (m_selectedDesignSpaceIndexes == indexes)
         return;
+    const QSet<int> selected = QSet<int>(indexes).subtract(m_selectedDesignSpaceIndexes);
+    const QSet<int> deselected = QSet<int>(m_selectedDesignSpaceIndexes).subtract(indexes);
     m_selectedDesignSpaceIndexes = indexes;
+    flushPendingRanges();
+    emit designSpacesSelected(selected, deselected);
+    emit selectionDesignSpaceChanged();
+}
+
+/*! \brief Applies the changes of the selection, in O(changes), and emits
+ * only the indexes whose selection state actually changed.
+ */
+void SpliceCalculator::selectFasteners(const QSet<int> &selected, const QSet<int> &deselected)
+{
+    QSet<int> newlySelected;
+    QSet<int> newlyDeselected;
+    foreach (const int index, deselected) {
+        if (!selected.contains(index) && m_selectedFastenerIndexes.remove(index)) {
+            newlyDeselected << index;
+        }
+    }
+    foreach (const int index, selected) {
+        if (!m_selectedFastenerIndexes.contains(index)) {
+            m_selectedFastenerIndexes << index;
+            newlySelected << index;
+        }
+    }
+    if (newlySelected.isEmpty() && newlyDeselected.isEmpty())
+        return;
+    flushPendingRanges();
+    emit fastenersSelected(newlySelected, newlyDeselected);
+    emit selectionFastenerChanged();
+}
+
+void SpliceCalculator::selectDesignSpaces(const QSet<int> &selected, const QSet<int> &deselected)
+{
+    QSet<int> newlySelected;
+    QSet<int> newlyDeselected;
+    foreach (const int index, deselected) {
+        if (!selected.contains(index) && m_selectedDesignSpaceIndexes.remove(index)) {
+            newlyDeselected << index;
+        }
+    }
+    foreach (const int index, selected) {
+        if (!m_selectedDesignSpaceIndexes.contains(index)) {
+            m_selectedDesignSpaceIndexes << index;
+            newlySelected << index;
+        }
+    }
+    if (newlySelected.isEmpty() && newlyDeselected.isEmpty())
+        return;
+    flushPendingRanges();
+    emit designSpacesSelected(newlySelected, newlyDeselected);
     emit selectionDesignSpaceChanged();
 }
 
 /******************************************************************************
  ******************************************************************************/
-void SpliceCalculator::recalculate()
+/*! \brief Starts a batch of edits.
+ *
+ * The results are not recalculated until the matching call to endUpdate().
+ * The calls can be nested: the results are recalculated (once, if needed)
+ * at the end of the outermost batch.
+ */
+void SpliceCalculator::beginUpdate()
+{
+    m_updateLevel++;
+}
+
+/*! \brief Ends a batch of edits started with beginUpdate().
+ */
+void SpliceCalculator::endUpdate()
+{
+    Q_ASSERT(m_updateLevel > 0);
+    if (m_updateLevel <= 0)
+        return;
+    m_updateLevel--;
+    if (m_updateLevel == 0 && m_recalculationPending) {
+        m_recalculationPending = false;
+        recalculate(m_changedFastenerIndex);
+    }
+}
+
+bool SpliceCalculator::isUpdating() const
+{
+    return m_updateLevel > 0;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Starts a transaction.
+ *
+ * Until the matching call to endTransaction(), the results are not
+ * recalculated (see beginUpdate()) and changed() is not emitted.
+ *
+ * The adjacent edits of the fasteners and the design spaces are merged
+ * in ranges: for instance, inserting 1000 fasteners emits fastenersInserted()
+ * once. A range is emitted before any edit that cannot be merged with it,
+ * so that the views always read consistent data.
+ */
+void SpliceCalculator::beginTransaction(const QString &text)
+{
+    Q_UNUSED(text);
+    if (m_transactionLevel == 0) {
+        m_changePending = false;
+        m_firstChangedFastener = INT_MAX;
+        m_lastChangedFastener = -1;
+    }
+    m_transactionLevel++;
+    beginUpdate();
+}
+
+/*! \brief Ends the transaction. At the end of the outermost transaction,
+ * emits changed() and transactionFinished() once, and recalculates the results.
+ */
+void SpliceCalculator::endTransaction()
+{
+    Q_ASSERT(m_transactionLevel > 0);
+    if (m_transactionLevel <= 0)
+        return;
+    m_transactionLevel--;
+    if (m_transactionLevel == 0) {
+        flushPendingRanges();
+        if (m_changePending) {
+            m_changePending = false;
+            emit changed();
+        }
+        if (m_firstChangedFastener <= m_lastChangedFastener) {
+            emit transactionFinished(m_firstChangedFastener, m_lastChangedFastener);
+        }
+    }
+    endUpdate();
+}
+
+/*! \brief Emits the pending ranges of the transaction, and recalculates
+ * the results if needed, without ending the transaction.
+ *
+ * changed() and transactionFinished() are still emitted once, by the
+ * matching call to endTransaction().
+ */
+void SpliceCalculator::flushTransaction()
 {
-    /// \todo Use worker thread here.
-    /// \todo see  Mandelbrot Example  or  Blocking Fortune Client Example
-    if (m_solver && m_splice) {
-        m_results = m_solver->calculate( m_splice.data() );
+    if (m_transactionLevel <= 0)
+        return;
+    flushPendingRanges();
+    if (m_recalculationPending) {
+        m_recalculationPending = false;
+        solve(m_changedFastenerIndex);
+    }
+}
+
+bool SpliceCalculator::isInTransaction() const
+{
+    return m_transactionLevel > 0;
+}
+
+void SpliceCalculator::notifyChanged()
+{
+    if (m_transactionLevel > 0) {
+        m_changePending = true;
     } else {
+        emit changed();
+    }
+}
+
+/*! \internal
+ * \brief Extends the range of the fasteners modified by the transaction.
+ */
+void SpliceCalculator::notifyFastenersChanged(const int first, const int last)
+{
+    if (m_transactionLevel > 0) {
+        m_firstChangedFastener = qMin(m_firstChangedFastener, first);
+        m_lastChangedFastener = qMax(m_lastChangedFastener, last);
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \internal
+ * \brief Called before an edit of the item at \a index. Emits the pending
+ * range of the transaction, if the edit cannot be merged with it.
+ */
+void SpliceCalculator::prepareRange(PendingRange &range, const RangeType type, const int index)
+{
+    if (range.type == NoRange)
+        return;
+    bool mergeable = false;
+    if (range.type == type) {
+        switch (type) {
+        case Inserted: mergeable = (index >= range.first && index <= range.last + 1); break;
+        case Changed:  mergeable = (index >= range.first - 1 && index <= range.last + 1); break;
+        case Removed:  mergeable = (index == range.first || index == range.first - 1); break;
+        case NoRange:
+        default:
+            break;
+        }
+    }
+    if (!mergeable) {
+        flushRange(range);
+    }
+}
+
+/*! \internal
+ * \brief Called after an edit of the item at \a index. Emits the signal
+ * immediately, or merges the edit in the pending range of the transaction.
+ */
+void SpliceCalculator::notifyRange(PendingRange &range, const RangeType type, const int index)
+{
+    if (m_transactionLevel == 0) {
+        range.type = type;
+        range.first = index;
+        range.last = index;
+        flushRange(range);
+        return;
+    }
+    if (range.type == NoRange) {
+        range.type = type;
+        range.first = index;
+        range.last = index;
+        return;
+    }
+    Q_ASSERT(range.type == type);
+    switch (type) {
+    case Inserted:
+        range.last++;
+        break;
+    case Changed:
+        range.first = qMin(range.first, index);
+        range.last = qMax(range.last, index);
+        break;
+    case Removed:
+        /* The indexes are those before the removal. */
+        if (index == range.first) {
+            range.last++;
+        } else {
+            range.first--;
+        }
+        break;
+    case NoRange:
+    default:
+        break;
+    }
+}
+
+void SpliceCalculator::flushRange(PendingRange &range)
+{
+    const RangeType type = range.type;
+    range.type = NoRange;
+    if (range.isFastener) {
+        switch (type) {
+        case Inserted: emit fastenersInserted(range.first, range.last); break;
+        case Changed:  emit fastenersChanged(range.first, range.last); break;
+        case Removed:  emit fastenersRemoved(range.first, range.last); break;
+        case NoRange:
+        default:
+            break;
+        }
+    } else {
+        switch (type) {
+        case Inserted: emit designSpacesInserted(range.first, range.last); break;
+        case Changed:  emit designSpacesChanged(range.first, range.last); break;
+        case Removed:  emit designSpacesRemoved(range.first, range.last); break;
+        case NoRange:
+        default:
+            break;
+        }
+    }
+}
+
+void SpliceCalculator::flushPendingRanges()
+{
+    flushRange(m_pendingFasteners);
+    flushRange(m_pendingDesignSpaces);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void SpliceCalculator::recalculate()
+{
+    recalculate(C_ALL_FASTENERS);
+}
+
+/*! \brief Recalculates the results, after a change of the fastener
+ * at \a changedFastenerIndex only, or of anything if C_ALL_FASTENERS.
+ */
+void SpliceCalculator::recalculate(const int changedFastenerIndex)
+{
+    if (m_updateLevel > 0) {
+        /* Postpone to endUpdate() */
+        if (!m_recalculationPending) {
+            m_changedFastenerIndex = changedFastenerIndex;
+        } else if (m_changedFastenerIndex != changedFastenerIndex) {
+            m_changedFastenerIndex = C_ALL_FASTENERS;
+        }
+        m_recalculationPending = true;
+        return;
+    }
+    solve(changedFastenerIndex);
+}
+
+/*! \internal
+ * \brief Calculates the results now, even if the updates are suspended.
+ */
+void SpliceCalculator::solve(const int changedFastenerIndex)
+{
+    ++m_generation;
+    if (!m_solver || !m_splice) {
         m_results.clear();
+        emit resultsChanged();
+        return;
+    }
+    SolverCache *cache = SolverCache::globalInstance();
+    if (cache->find( m_solver, m_splice.data(), SolverCache::Results, &m_results )) {
+        /* e.g. undo/redo. The solver has skipped this state, so its
+         * intermediate data doesn't match the splice anymore. */
+        m_solverSynchronized = false;
+        emit resultsChanged();
+        return;
+    }
+    const int changedIndex = m_solverSynchronized ? changedFastenerIndex : C_ALL_FASTENERS;
+    m_solverSynchronized = true;
+    if (m_asynchronous) {
+        /* The worker uses a copy of the splice (cheap, implicitly shared). */
+        m_worker->submit( m_generation, m_solver, *m_splice, changedIndex );
+        return;
     }
+    /* The solver is not reentrant: don't run concurrently with the worker. */
+    m_worker->waitForDone();
+    m_results = m_solver->calculateIncremental( m_splice.data(), changedIndex );
+    cache->insert( m_solver, m_splice.data(), SolverCache::Results, m_results );
     emit resultsChanged();
 }
 
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Returns true if the results are calculated in a worker thread.
+ *
+ * The default is false: the results are available as soon as the edit returns.
+ */
+bool SpliceCalculator::isAsynchronous() const
+{
+    return m_asynchronous;
+}
+
+void SpliceCalculator::setAsynchronous(bool enabled)
+{
+    if (m_asynchronous == enabled)
+        return;
+    if (!enabled) {
+        waitForResults();
+    }
+    m_asynchronous = enabled;
+}
+
+/*! \brief Returns true if the worker is calculating results
+ * that are not yet available.
+ */
+bool SpliceCalculator::isCalculating() const
+{
+    return !m_worker->isIdle();
+}
+
+/*! \brief Blocks until the worker is done, and updates the results.
+ */
+void SpliceCalculator::waitForResults()
+{
+    m_worker->waitForDone();
+    /* Deliver the queued results now. */
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+/*! \internal
+ */
+void SpliceCalculator::_q_resultsReady(quint64 generation, const QList<Tensor> &results)
+{
+    if (generation != m_generation) {
+        /* Outdated: a more recent solve is pending, or was already done. */
+        return;
+    }
+    /* Already cached by the worker, under the submitted splice. */
+    m_results = results;
+    emit resultsChanged();
+}
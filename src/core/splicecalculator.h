@@ -19,8 +19,10 @@
 
 #include <Core/AbstractSpliceModel>
 
+#include <QtCore/QHash>
 #include <QtCore/QSet>
 #include <QtCore/QSharedPointer>
+#include <QtCore/QVector>
 
 QT_BEGIN_NAMESPACE
 class QDebug;
@@ -31,6 +33,7 @@ QT_END_NAMESPACE
 
 class ISolver;
 class Splice;
+class SolverWorker;
 enum class SolverParameters;
 
 class SpliceCalculator : public AbstractSpliceModel
@@ -44,11 +47,15 @@ class SpliceCalculator : public AbstractSpliceModel
 
 public:
     explicit SpliceCalculator(QObject *parent = Q_NULLPTR);
+    ~SpliceCalculator();
 
     /* JSON Serialization */
     void read(const QJsonObject &json);
     void write(QJsonObject &json) const;
 
+    void read(const Splice &splice);
+    void write(Splice &splice) const;
+
     QString title() const;
     QString author() const;
     QString date() const;
@@ -61,14 +68,39 @@ public:
     virtual DesignSpace designSpaceAt(const int index) const Q_DECL_OVERRIDE;
 
     virtual Tensor appliedLoad() const Q_DECL_OVERRIDE;
+    virtual int loadCaseCount() const Q_DECL_OVERRIDE;
+    virtual Tensor loadCaseAt(const int index) const Q_DECL_OVERRIDE;
     virtual Tensor resultAt(const int index) const Q_DECL_OVERRIDE;
+    virtual QList<Tensor> results() const Q_DECL_OVERRIDE;
     virtual SolverParameters solverParameters() const Q_DECL_OVERRIDE;
 
     virtual QSet<int> selectedFastenerIndexes() const Q_DECL_OVERRIDE;
     virtual QSet<int> selectedDesignSpaceIndexes() const Q_DECL_OVERRIDE;
 
+    virtual quint32 fastenerId(const int index) const Q_DECL_OVERRIDE;
+    virtual int fastenerIndex(const quint32 id) const Q_DECL_OVERRIDE;
+    virtual quint32 designSpaceId(const int index) const Q_DECL_OVERRIDE;
+    virtual int designSpaceIndex(const quint32 id) const Q_DECL_OVERRIDE;
+
     virtual ISolver* solver() const Q_DECL_OVERRIDE { return m_solver; }
 
+    /* Transactions */
+    virtual void beginTransaction(const QString &text = QString()) Q_DECL_OVERRIDE;
+    virtual void endTransaction() Q_DECL_OVERRIDE;
+    virtual void flushTransaction() Q_DECL_OVERRIDE;
+    bool isInTransaction() const;
+
+    /* Batched Edits */
+    void beginUpdate();
+    void endUpdate();
+    bool isUpdating() const;
+
+    /* Background Solving */
+    bool isAsynchronous() const;
+    void setAsynchronous(bool enabled);
+    bool isCalculating() const;
+    void waitForResults();
+
 Q_SIGNALS:
     void changed();
 
@@ -89,11 +121,20 @@ public Q_SLOTS:
     virtual void removeDesignSpace(const int index) Q_DECL_OVERRIDE;
 
     virtual void setAppliedLoad(const Tensor &appliedLoad) Q_DECL_OVERRIDE;
+    virtual void insertLoadCase(const int index, const Tensor &loadCase) Q_DECL_OVERRIDE;
+    virtual void setLoadCase(const int index, const Tensor &loadCase) Q_DECL_OVERRIDE;
+    virtual void removeLoadCase(const int index) Q_DECL_OVERRIDE;
     virtual void setSolverParameters(SolverParameters params) Q_DECL_OVERRIDE;
 
     virtual void setFastenerSelection(const QSet<int> indexes) Q_DECL_OVERRIDE;
     virtual void setDesignSpaceSelection(const QSet<int> indexes) Q_DECL_OVERRIDE;
 
+    virtual void selectFasteners(const QSet<int> &selected, const QSet<int> &deselected) Q_DECL_OVERRIDE;
+    virtual void selectDesignSpaces(const QSet<int> &selected, const QSet<int> &deselected) Q_DECL_OVERRIDE;
+
+private Q_SLOTS:
+    void _q_resultsReady(quint64 generation, const QList<Tensor> &results);
+
 private:
     SolverParameters m_params;
     ISolver *m_solver;
@@ -101,8 +142,55 @@ private:
     QSet<int> m_selectedFastenerIndexes;
     QSet<int> m_selectedDesignSpaceIndexes;
     QList<Tensor> m_results;
+    int m_updateLevel;
+    bool m_recalculationPending;
+    int m_changedFastenerIndex;
+    bool m_solverSynchronized;
+    SolverWorker *m_worker;
+    bool m_asynchronous;
+    quint64 m_generation;
+    int m_transactionLevel;
+    bool m_changePending;
+    int m_firstChangedFastener;
+    int m_lastChangedFastener;
+
+    enum RangeType { NoRange = 0, Inserted, Changed, Removed };
+    struct PendingRange {
+        bool isFastener;
+        RangeType type;
+        int first;
+        int last;
+    };
+    PendingRange m_pendingFasteners;
+    PendingRange m_pendingDesignSpaces;
+
+    struct IdMap {
+        QVector<quint32> ids;                /* ID of each index */
+        mutable QHash<quint32, int> indexes; /* Index of each ID */
+        mutable bool dirty;                  /* The indexes must be rebuilt */
+    };
+    IdMap m_fastenerIds;
+    IdMap m_designSpaceIds;
+    quint32 m_lastId;
+
+    void notifyChanged();
+    void notifyFastenersChanged(const int first, const int last);
+
+    void prepareRange(PendingRange &range, const RangeType type, const int index);
+    void notifyRange(PendingRange &range, const RangeType type, const int index);
+    void flushRange(PendingRange &range);
+    void flushPendingRanges();
+
+    void insertId(IdMap &map, const int index);
+    void resetIds(IdMap &map, const int count);
+    static void removeId(IdMap &map, const int index);
+    static int indexOfId(const IdMap &map, const quint32 id);
+
+    static void shiftSelection(QSet<int> &selection, const int index, const int delta);
 
     void recalculate();
+    void recalculate(const int changedFastenerIndex);
+    void solve(const int changedFastenerIndex);
 };
 
 #endif // CORE_SPLICE_CALCULATOR_H
@@ -26,3 +26,288 @@
  *
  */
 
+namespace SpliceCommand {
+
+/* Unlike QPointF::operator==(), compares exactly, to undo exactly. */
+static inline bool _q_isEqual(const QPointF &p1, const QPointF &p2)
+{
+    return p1.x() == p2.x() && p1.y() == p2.y();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class SpliceCommand::Transaction
+ * \brief The class Transaction is the undo command of a transaction,
+ * or of a single command pushed outside a transaction.
+ *
+ * The consecutive commands of the same kind (e.g. the moves of a drag)
+ * are merged when they are appended, so that a long transaction
+ * doesn't keep a command per edit.
+ *
+ * The clones share the commands. Calculator uses them to remove
+ * the oldest entries from its undo stack.
+ */
+Transaction::Transaction(Calculator *calc, const QString &text)
+    : QUndoCommand()
+    , m_calc(calc)
+    , d(new Data)
+    , m_done(true)
+    , m_single(false)
+{
+    this->setText(text.isEmpty() ? QStringLiteral("Modify Splice") : text);
+}
+
+/*! \brief Wraps the given \a command, that is not done yet.
+ * Like the \a command, the transaction can be merged.
+ */
+Transaction::Transaction(Calculator *calc, Command *command)
+    : QUndoCommand()
+    , m_calc(calc)
+    , d(new Data)
+    , m_done(false)
+    , m_single(true)
+{
+    this->setText(command->text());
+    d->commands.append(command);
+    d->cost = command->cost();
+}
+
+/*! \brief Appends the \a command, that has already been done.
+ * The transaction takes ownership of the \a command.
+ */
+void Transaction::append(Command *command)
+{
+    if (!d->commands.isEmpty()) {
+        Command *last = d->commands.last();
+        const qint64 cost = last->cost();
+        if (command->id() != -1 && command->id() == last->id() && last->mergeWith(command)) {
+            d->cost += last->cost() - cost;
+            delete command;
+            return;
+        }
+    }
+    d->commands.append(command);
+    d->cost += command->cost();
+}
+
+int Transaction::commandCount() const
+{
+    return d->commands.count();
+}
+
+/*! \brief Returns the approximate size of the transaction, in bytes.
+ */
+qint64 Transaction::cost() const
+{
+    return sizeof(*this) + costOf(text()) + d->cost;
+}
+
+/*! \brief Returns a new transaction, in the same state, that shares the commands.
+ */
+Transaction *Transaction::clone() const
+{
+    Transaction *transaction = new Transaction(m_calc, text());
+    transaction->d = d;
+    transaction->m_done = m_done;
+    transaction->m_single = m_single;
+    return transaction;
+}
+
+void Transaction::undo()
+{
+    if (!m_calc->_q_isTrimming()) {
+        if (!m_single) {
+            m_calc->_q_beginTransaction();
+        }
+        for (int i = d->commands.count() - 1; i >= 0; --i) {
+            d->commands.at(i)->undo();
+        }
+        if (!m_single) {
+            m_calc->_q_endTransaction();
+        }
+    }
+    m_done = false;
+}
+
+void Transaction::redo()
+{
+    if (m_done) {
+        /* The commands have been executed during the transaction. */
+        return;
+    }
+    if (!m_calc->_q_isTrimming()) {
+        if (!m_single) {
+            m_calc->_q_beginTransaction();
+        }
+        foreach (auto command, d->commands) {
+            command->redo();
+        }
+        if (!m_single) {
+            m_calc->_q_endTransaction();
+        }
+    }
+    m_done = true;
+}
+
+/* Only a single command merges, like the command itself. */
+int Transaction::id() const
+{
+    if (!m_single || m_calc->_q_isTrimming() || d->commands.count() != 1) {
+        return -1;
+    }
+    return d->commands.first()->id();
+}
+
+bool Transaction::mergeWith(const QUndoCommand *other)
+{
+    if (other->id() != id() || id() == -1)
+        return false;
+    const Transaction *transaction = static_cast<const Transaction*>(other);
+    Command *command = d->commands.first();
+    const qint64 cost = command->cost();
+    if (!command->mergeWith(transaction->d->commands.first()))
+        return false;
+    d->cost += command->cost() - cost;
+    return true;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+DesignSpaceDelta::DesignSpaceDelta()
+    : m_nameChanged(false)
+    , m_change(Unchanged)
+{
+}
+
+/*! \brief Stores the changes from \a before to \a after.
+ *
+ * When all the vertices are moved by the same offset (the user drags the
+ * design space), only the offset is stored. When a few vertices are moved,
+ * only those vertices are stored. Otherwise, the polygons are stored.
+ */
+DesignSpaceDelta::DesignSpaceDelta(const DesignSpace &before, const DesignSpace &after)
+    : m_nameChanged(before.name != after.name)
+    , m_change(Unchanged)
+{
+    if (m_nameChanged) {
+        m_nameBefore = before.name;
+        m_nameAfter = after.name;
+    }
+    const QPolygonF &p0 = before.polygon;
+    const QPolygonF &p1 = after.polygon;
+    const int count = p0.count();
+    if (count == 0 || count != p1.count()) {
+        if (count == 0 && p1.isEmpty()) {
+            return;
+        }
+        m_change = Replaced;
+        m_polygonBefore = p0;
+        m_polygonAfter = p1;
+        return;
+    }
+
+    /* The offset must give back the exact vertices, in both directions. */
+    const QPointF offset = p1.first() - p0.first();
+    bool translated = true;
+    for (int i = 0; i < count && translated; ++i) {
+        translated = (_q_isEqual(p0.at(i) + offset, p1.at(i))
+                      && _q_isEqual(p1.at(i) - offset, p0.at(i)));
+    }
+    if (translated && _q_isEqual(offset, QPointF())) {
+        return; /* Unchanged */
+    }
+    if (translated) {
+        m_change = Translated;
+        m_offset = offset;
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (!_q_isEqual(p0.at(i), p1.at(i))) {
+            m_vertices.append(i);
+        }
+    }
+    if (2 * m_vertices.count() < count) {
+        m_change = Moved;
+        m_polygonBefore.reserve(m_vertices.count());
+        m_polygonAfter.reserve(m_vertices.count());
+        foreach (auto i, m_vertices) {
+            m_polygonBefore.append(p0.at(i));
+            m_polygonAfter.append(p1.at(i));
+        }
+    } else {
+        m_change = Replaced;
+        m_vertices.clear();
+        m_polygonBefore = p0;
+        m_polygonAfter = p1;
+    }
+}
+
+/*! \brief Returns the design space before the changes, from the design
+ * space \a after the changes.
+ */
+DesignSpace DesignSpaceDelta::before(const DesignSpace &after) const
+{
+    DesignSpace res = after;
+    if (m_nameChanged) {
+        res.name = m_nameBefore;
+    }
+    switch (m_change) {
+    case Translated:
+        for (int i = 0; i < res.polygon.count(); ++i) {
+            res.polygon[i] -= m_offset;
+        }
+        break;
+    case Moved:
+        for (int k = 0; k < m_vertices.count(); ++k) {
+            res.polygon[m_vertices.at(k)] = m_polygonBefore.at(k);
+        }
+        break;
+    case Replaced:
+        res.polygon = m_polygonBefore;
+        break;
+    case Unchanged:
+    default:
+        break;
+    }
+    return res;
+}
+
+/*! \brief Returns the design space after the changes, from the design
+ * space \a before the changes.
+ */
+DesignSpace DesignSpaceDelta::after(const DesignSpace &before) const
+{
+    DesignSpace res = before;
+    if (m_nameChanged) {
+        res.name = m_nameAfter;
+    }
+    switch (m_change) {
+    case Translated:
+        for (int i = 0; i < res.polygon.count(); ++i) {
+            res.polygon[i] += m_offset;
+        }
+        break;
+    case Moved:
+        for (int k = 0; k < m_vertices.count(); ++k) {
+            res.polygon[m_vertices.at(k)] = m_polygonAfter.at(k);
+        }
+        break;
+    case Replaced:
+        res.polygon = m_polygonAfter;
+        break;
+    case Unchanged:
+    default:
+        break;
+    }
+    return res;
+}
+
+qint64 DesignSpaceDelta::cost() const
+{
+    return sizeof(*this) + costOf(m_nameBefore) + costOf(m_nameAfter)
+            + qint64(m_vertices.capacity()) * qint64(sizeof(int))
+            + qint64(m_polygonBefore.capacity() + m_polygonAfter.capacity()) * qint64(sizeof(QPointF));
+}
+
+} // namespace SpliceCommand
@@ -14,11 +14,15 @@
  * License along with this program; If not, see <http://www.gnu.org/licenses/>.
  */
 
+
 #ifndef CORE_SPLICE_COMMAND_H
 #define CORE_SPLICE_COMMAND_H
 
 #include <QtCore/QMap>
 #include <QtCore/QMapIterator>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QVector>
+#include <QtGui/QPolygonF>
 #include <QtWidgets/QUndoCommand>
 
 #include <Core/Calculator>
@@ -30,15 +34,81 @@
 #define C_COMMAND_ID_SET_FASTENER          20
 #define C_COMMAND_ID_SET_DESIGN_SPACE      30
 #define C_COMMAND_ID_SET_APPLIED_LOAD      40
+#define C_COMMAND_ID_SET_LOAD_CASE         41
 
 
 namespace SpliceCommand {
 
-class SetTitle : public QUndoCommand
+/* Approximate sizes in memory, in bytes. */
+inline qint64 costOf(const QString &text)
+{ return qint64(text.capacity()) * qint64(sizeof(QChar)); }
+
+inline qint64 costOf(const Fastener &fastener)
+{ return qint64(sizeof(Fastener)) + costOf(fastener.name); }
+
+inline qint64 costOf(const DesignSpace &designSpace)
+{
+    return qint64(sizeof(DesignSpace)) + costOf(designSpace.name)
+            + qint64(designSpace.polygon.capacity()) * qint64(sizeof(QPointF));
+}
+
+/*! \brief Base class of the commands, that estimates their size in memory.
+ * \sa Calculator::setUndoMemoryLimit()
+ */
+class Command : public QUndoCommand
+{
+public:
+    Command(Calculator *calc, QUndoCommand *parent = Q_NULLPTR)
+        : QUndoCommand(parent), m_calc(calc)
+    {}
+    /*! \brief Returns the approximate size of the command, in bytes. */
+    virtual qint64 cost() const = 0;
+protected:
+    Calculator *m_calc;
+};
+
+/*! \brief Groups the commands of a transaction.
+ * The commands are undone and redone in a single transaction,
+ * so that the results are recalculated only once.
+ * \sa Calculator::beginTransaction()
+ */
+class Transaction : public QUndoCommand
+{
+public:
+    Transaction(Calculator *calc, const QString &text);
+    Transaction(Calculator *calc, Command *command);
+
+    void append(Command *command);
+    int commandCount() const;
+    qint64 cost() const;
+    Transaction *clone() const;
+
+    virtual void undo() Q_DECL_OVERRIDE;
+    virtual void redo() Q_DECL_OVERRIDE;
+    virtual int id() const Q_DECL_OVERRIDE;
+    virtual bool mergeWith(const QUndoCommand *other) Q_DECL_OVERRIDE;
+
+private:
+    struct Data
+    {
+        Data() : cost(0) {}
+        ~Data() { qDeleteAll(commands); }
+        QList<Command*> commands;
+        qint64 cost;
+    };
+    Calculator *m_calc;
+    QSharedPointer<Data> d; /* Shared with the clones */
+    bool m_done;
+    bool m_single;          /* Wraps a single command, outside a transaction */
+};
+
+/******************************************************************************
+ ******************************************************************************/
+class SetTitle : public Command
 {
 public:
     SetTitle(Calculator *calc, const QString &title, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc), m_title(title), m_previous(m_calc->title())
+        : Command(calc, parent), m_title(title), m_previous(m_calc->title())
     { this->setText("Change Title"); }
     virtual void undo() { m_calc->_q_setTitle(m_previous); }
     virtual void redo() { m_calc->_q_setTitle(m_title);    }
@@ -50,18 +120,18 @@ public:
         m_title = static_cast<const SetTitle*>(other)->m_title;
         return true;
     }
+    virtual qint64 cost() const { return sizeof(*this) + costOf(m_title) + costOf(m_previous); }
 private:
-    Calculator *m_calc;
     QString m_title;
     QString m_previous;
 };
 
 
-class SetAuthor : public QUndoCommand
+class SetAuthor : public Command
 {
 public:
     SetAuthor(Calculator *calc, const QString &author, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc), m_author(author), m_previous(m_calc->author())
+        : Command(calc, parent), m_author(author), m_previous(m_calc->author())
     { this->setText("Change Author"); }
     virtual void undo() { m_calc->_q_setAuthor(m_previous); }
     virtual void redo() { m_calc->_q_setAuthor(m_author); }
@@ -73,17 +143,17 @@ public:
         m_author = static_cast<const SetAuthor*>(other)->m_author;
         return true;
     }
+    virtual qint64 cost() const { return sizeof(*this) + costOf(m_author) + costOf(m_previous); }
 private:
-    Calculator *m_calc;
     QString m_author;
     QString m_previous;
 };
 
-class SetDate : public QUndoCommand
+class SetDate : public Command
 {
 public:
     SetDate(Calculator *calc, const QString &date, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc), m_date(date), m_previous(m_calc->date())
+        : Command(calc, parent), m_date(date), m_previous(m_calc->date())
     { this->setText("Change Date"); }
     virtual void undo() { m_calc->_q_setDate(m_previous); }
     virtual void redo() { m_calc->_q_setDate(m_date); }
@@ -95,18 +165,18 @@ public:
         m_date = static_cast<const SetDate*>(other)->m_date;
         return true;
     }
+    virtual qint64 cost() const { return sizeof(*this) + costOf(m_date) + costOf(m_previous); }
 private:
-    Calculator *m_calc;
     QString m_date;
     QString m_previous;
 };
 
 
-class SetDescription : public QUndoCommand
+class SetDescription : public Command
 {
 public:
     SetDescription(Calculator *calc, const QString &description, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc), m_description(description), m_previous(m_calc->description())
+        : Command(calc, parent), m_description(description), m_previous(m_calc->description())
     { this->setText("Change Description"); }
     virtual void undo() { m_calc->_q_setDescription(m_previous); }
     virtual void redo() { m_calc->_q_setDescription(m_description); }
@@ -118,39 +188,37 @@ public:
         m_description = static_cast<const SetDescription*>(other)->m_description;
         return true;
     }
+    virtual qint64 cost() const { return sizeof(*this) + costOf(m_description) + costOf(m_previous); }
 private:
-    Calculator *m_calc;
     QString m_description;
     QString m_previous;
 };
 
 /******************************************************************************
  ******************************************************************************/
-
-///  \todo add class ModifyGroup: public QUndoCommand
-
-
-/******************************************************************************
- ******************************************************************************/
-class InsertFastener : public QUndoCommand
+class InsertFastener : public Command
 {
 public:
     InsertFastener(Calculator *calc, int index, Fastener fastener, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc), m_index(index), m_fastener(fastener)
+        : Command(calc, parent), m_index(index), m_fastener(fastener)
     { this->setText("Insert Fastener"); }
     virtual void undo() { m_calc->_q_removeFastener(m_index); }
     virtual void redo() { m_calc->_q_insertFastener(m_index, m_fastener); }
+    virtual qint64 cost() const { return sizeof(*this) + costOf(m_fastener.name); }
 private:
-    Calculator *m_calc;
     int m_index;
     Fastener m_fastener;
 };
 
-class SetFastener : public QUndoCommand
+/*! \brief Modifies one or many fasteners.
+ * The consecutive modifications are merged: the command keeps, for each
+ * modified index, the first previous value and the last value only.
+ */
+class SetFastener : public Command
 {
 public:
     SetFastener(Calculator *calc, int index, Fastener fastener, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc)
+        : Command(calc, parent)
     {
         this->setText("Modify Fastener");
         m_fasteners.insert(index, fastener);
@@ -193,22 +261,26 @@ public:
         }
         return true;
     }
+    virtual qint64 cost() const
+    {
+        /* The names are usually shared with the model. */
+        return sizeof(*this) + qint64(m_fasteners.count()) * 2 * qint64(sizeof(QMapNode<int, Fastener>));
+    }
 private:
-    Calculator *m_calc;
     QMap<int, Fastener> m_previous;
     QMap<int, Fastener> m_fasteners;
 };
 
-class RemoveFastener : public QUndoCommand
+class RemoveFastener : public Command
 {
 public:
     RemoveFastener(Calculator *calc, int index, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc), m_index(index), m_previous(m_calc->fastenerAt(index))
+        : Command(calc, parent), m_index(index), m_previous(m_calc->fastenerAt(index))
     { this->setText("Remove Fastener"); }
     virtual void undo() { m_calc->_q_insertFastener(m_index, m_previous); }
     virtual void redo() { m_calc->_q_removeFastener(m_index); }
+    virtual qint64 cost() const { return sizeof(*this) + costOf(m_previous.name); }
 private:
-    Calculator *m_calc;
     int m_index;
     Fastener m_previous;
 };
@@ -217,83 +289,115 @@ private:
 
 /******************************************************************************
  ******************************************************************************/
-class InsertDesignSpace : public QUndoCommand
+/*! \brief The changes of a design space, i.e. the changed fields only.
+ */
+class DesignSpaceDelta
+{
+public:
+    DesignSpaceDelta();
+    DesignSpaceDelta(const DesignSpace &before, const DesignSpace &after);
+
+    DesignSpace before(const DesignSpace &after) const;
+    DesignSpace after(const DesignSpace &before) const;
+    qint64 cost() const;
+
+private:
+    enum PolygonChange { Unchanged, Translated, Moved, Replaced };
+    bool m_nameChanged;
+    QString m_nameBefore;
+    QString m_nameAfter;
+    PolygonChange m_change;
+    QPointF m_offset;           /* Translated: the offset of all the vertices */
+    QVector<int> m_vertices;    /* Moved: the indexes of the moved vertices */
+    QPolygonF m_polygonBefore;  /* Moved: the moved vertices, Replaced: the polygon */
+    QPolygonF m_polygonAfter;
+};
+
+class InsertDesignSpace : public Command
 {
 public:
     InsertDesignSpace(Calculator *calc, int index, DesignSpace designSpace, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc), m_index(index), m_designSpace(designSpace)
+        : Command(calc, parent), m_index(index), m_designSpace(designSpace)
     { this->setText("Insert Design Space"); }
     virtual void undo() { m_calc->_q_removeDesignSpace(m_index); }
     virtual void redo() { m_calc->_q_insertDesignSpace(m_index, m_designSpace); }
+    virtual qint64 cost() const { return sizeof(*this) + costOf(m_designSpace); }
 private:
-    Calculator *m_calc;
     int m_index;
     DesignSpace m_designSpace;
 };
 
-class SetDesignSpace : public QUndoCommand
+/*! \brief Modifies one or many design spaces.
+ * The command stores a DesignSpaceDelta for each modified index,
+ * rather than copies of the design spaces.
+ */
+class SetDesignSpace : public Command
 {
 public:
     SetDesignSpace(Calculator *calc, int index, DesignSpace designSpace, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc)
+        : Command(calc, parent)
     {
         this->setText("Modify Design Space");
-        m_designSpaces.insert(index, designSpace);
-        m_previous.insert(index, m_calc->designSpaceAt(index));
+        m_deltas.insert(index, DesignSpaceDelta(m_calc->designSpaceAt(index), designSpace));
     }
     virtual void undo()
     {
-        QMapIterator<int, DesignSpace> i(m_previous);
+        QMapIterator<int, DesignSpaceDelta> i(m_deltas);
         while (i.hasNext()) {
             i.next();
-            m_calc->_q_setDesignSpace(i.key(), i.value());
+            m_calc->_q_setDesignSpace(i.key(), i.value().before(m_calc->designSpaceAt(i.key())));
         }
     }
     virtual void redo()
     {
-        QMapIterator<int, DesignSpace> i(m_designSpaces);
+        QMapIterator<int, DesignSpaceDelta> i(m_deltas);
         while (i.hasNext()) {
             i.next();
-            m_calc->_q_setDesignSpace(i.key(), i.value());
+            m_calc->_q_setDesignSpace(i.key(), i.value().after(m_calc->designSpaceAt(i.key())));
         }
     }
     virtual int id() const { return C_COMMAND_ID_SET_DESIGN_SPACE; }
+    /* The other command has been done: the design spaces are in their last state. */
     bool mergeWith(const QUndoCommand *other)
     {
         if (other->id() != id())
             return false;
-        QMap<int, DesignSpace> previous = static_cast<const SetDesignSpace*>(other)->m_previous;
-        QMapIterator<int, DesignSpace> prev(previous);
-        while (prev.hasNext()) {
-            prev.next();
-            if (!m_previous.contains(prev.key())) {
-                m_previous.insert(prev.key(), prev.value());
-            }
-        }
-        QMap<int, DesignSpace> designSpaces = static_cast<const SetDesignSpace*>(other)->m_designSpaces;
-        QMapIterator<int, DesignSpace> i(designSpaces);
+        QMap<int, DesignSpaceDelta> deltas = static_cast<const SetDesignSpace*>(other)->m_deltas;
+        QMapIterator<int, DesignSpaceDelta> i(deltas);
         while (i.hasNext()) {
             i.next();
-            m_designSpaces.insert(i.key(), i.value());
+            if (m_deltas.contains(i.key())) {
+                const DesignSpace last = m_calc->designSpaceAt(i.key());
+                const DesignSpace first = m_deltas.value(i.key()).before(i.value().before(last));
+                m_deltas.insert(i.key(), DesignSpaceDelta(first, last));
+            } else {
+                m_deltas.insert(i.key(), i.value());
+            }
         }
         return true;
     }
+    virtual qint64 cost() const
+    {
+        qint64 res = sizeof(*this);
+        foreach (auto &delta, m_deltas) {
+            res += sizeof(int) + delta.cost();
+        }
+        return res;
+    }
 private:
-    Calculator *m_calc;
-    QMap<int, DesignSpace> m_previous;
-    QMap<int, DesignSpace> m_designSpaces;
+    QMap<int, DesignSpaceDelta> m_deltas;
 };
 
-class RemoveDesignSpace : public QUndoCommand
+class RemoveDesignSpace : public Command
 {
 public:
     RemoveDesignSpace(Calculator *calc, int index, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc), m_index(index), m_previous(m_calc->designSpaceAt(index))
+        : Command(calc, parent), m_index(index), m_previous(m_calc->designSpaceAt(index))
     { this->setText("Remove Design Space"); }
     virtual void undo() { m_calc->_q_insertDesignSpace(m_index, m_previous); }
     virtual void redo() { m_calc->_q_removeDesignSpace(m_index); }
+    virtual qint64 cost() const { return sizeof(*this) + costOf(m_previous); }
 private:
-    Calculator *m_calc;
     int m_index;
     DesignSpace m_previous;
 };
@@ -301,11 +405,11 @@ private:
 
 /******************************************************************************
  ******************************************************************************/
-class SetAppliedLoad : public QUndoCommand
+class SetAppliedLoad : public Command
 {
 public:
     SetAppliedLoad(Calculator *calc, const Tensor &appliedLoad, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc), m_load(appliedLoad), m_previous(m_calc->appliedLoad())
+        : Command(calc, parent), m_load(appliedLoad), m_previous(m_calc->appliedLoad())
     { this->setText("Change Applied Load"); }
     virtual void undo() { m_calc->_q_setAppliedLoad(m_previous); }
     virtual void redo() { m_calc->_q_setAppliedLoad(m_load); }
@@ -317,22 +421,79 @@ public:
         m_load = static_cast<const SetAppliedLoad*>(other)->m_load;
         return true;
     }
+    virtual qint64 cost() const { return sizeof(*this); }
 private:
-    Calculator *m_calc;
     Tensor m_load;
     Tensor m_previous;
 };
 
-class SetSolverParameters : public QUndoCommand
+class InsertLoadCase : public Command
+{
+public:
+    InsertLoadCase(Calculator *calc, int index, const Tensor &loadCase, QUndoCommand *parent = Q_NULLPTR)
+        : Command(calc, parent), m_index(index), m_loadCase(loadCase)
+    { this->setText("Insert Load Case"); }
+    virtual void undo() { m_calc->_q_removeLoadCase(m_index); }
+    virtual void redo() { m_calc->_q_insertLoadCase(m_index, m_loadCase); }
+    virtual qint64 cost() const { return sizeof(*this); }
+private:
+    int m_index;
+    Tensor m_loadCase;
+};
+
+/*! \brief Modifies a load case.
+ * The consecutive modifications of the same load case are merged.
+ */
+class SetLoadCase : public Command
+{
+public:
+    SetLoadCase(Calculator *calc, int index, const Tensor &loadCase, QUndoCommand *parent = Q_NULLPTR)
+        : Command(calc, parent), m_index(index), m_loadCase(loadCase), m_previous(m_calc->loadCaseAt(index))
+    { this->setText("Modify Load Case"); }
+    virtual void undo() { m_calc->_q_setLoadCase(m_index, m_previous); }
+    virtual void redo() { m_calc->_q_setLoadCase(m_index, m_loadCase); }
+    virtual int id() const { return C_COMMAND_ID_SET_LOAD_CASE; }
+    bool mergeWith(const QUndoCommand *other)
+    {
+        if (other->id() != id())
+            return false;
+        const SetLoadCase *command = static_cast<const SetLoadCase*>(other);
+        if (command->m_index != m_index)
+            return false;
+        m_loadCase = command->m_loadCase;
+        return true;
+    }
+    virtual qint64 cost() const { return sizeof(*this); }
+private:
+    int m_index;
+    Tensor m_loadCase;
+    Tensor m_previous;
+};
+
+class RemoveLoadCase : public Command
+{
+public:
+    RemoveLoadCase(Calculator *calc, int index, QUndoCommand *parent = Q_NULLPTR)
+        : Command(calc, parent), m_index(index), m_previous(m_calc->loadCaseAt(index))
+    { this->setText("Remove Load Case"); }
+    virtual void undo() { m_calc->_q_insertLoadCase(m_index, m_previous); }
+    virtual void redo() { m_calc->_q_removeLoadCase(m_index); }
+    virtual qint64 cost() const { return sizeof(*this); }
+private:
+    int m_index;
+    Tensor m_previous;
+};
+
+class SetSolverParameters : public Command
 {
 public:
     SetSolverParameters(Calculator *calc, SolverParameters params, QUndoCommand *parent = Q_NULLPTR)
-        : QUndoCommand(parent), m_calc(calc), m_params(params), m_previous(m_calc->solverParameters())
+        : Command(calc, parent), m_params(params), m_previous(m_calc->solverParameters())
     { this->setText("Change Solver Parameters"); }
     virtual void undo() { m_calc->_q_setSolverParameters(m_previous); }
     virtual void redo() { m_calc->_q_setSolverParameters(m_params); }
+    virtual qint64 cost() const { return sizeof(*this); }
 private:
-    Calculator *m_calc;
     SolverParameters m_params;
     SolverParameters m_previous;
 };
@@ -0,0 +1,388 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "splicefileworker.h"
+
+#include <Core/SpliceBinary>
+#include <Core/SpliceJson>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+#include <QtCore/QFile>
+#include <QtCore/QIODevice>
+#include <QtCore/QMetaObject>
+#include <QtCore/QRunnable>
+#include <QtCore/QSaveFile>
+
+/* Rough size of a record in the JSON file, used to estimate the progress of the saving. */
+#define C_JSON_HEADER_SIZE          256
+#define C_JSON_FASTENER_SIZE        232
+#define C_JSON_DESIGNSPACE_SIZE      64
+#define C_JSON_POINT_SIZE            64
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class SpliceFileTask
+ * \remark QRunnable cannot emit Signals. It's not a QObject.
+ *         The workaround is to emit Signals from the SpliceFileWorker.
+ */
+class SpliceFileTask : public QRunnable
+{
+public:
+    SpliceFileTask(SpliceFileWorker *w) : QRunnable(), m_worker(w) {}
+
+public:
+    void run() Q_DECL_OVERRIDE
+    {
+        m_worker->runAsync();
+    }
+
+private:
+    SpliceFileWorker* m_worker;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class ProgressDevice
+ * \brief The class ProgressDevice forwards the reads and the writes
+ * to another device, reports the progress to the SpliceFileWorker,
+ * and fails as soon as the cancellation is requested.
+ *
+ * This lets the streaming readers and writers (SpliceJson, SpliceBinary)
+ * report the progress and be cancelled, without changing their API.
+ */
+class ProgressDevice : public QIODevice
+{
+public:
+    ProgressDevice(QIODevice *device, SpliceFileWorker *worker, qint64 total)
+        : QIODevice()
+        , m_device(device)
+        , m_worker(worker)
+        , m_done(0)
+        , m_total(total)
+    {}
+
+    bool isSequential() const Q_DECL_OVERRIDE { return m_device->isSequential(); }
+    qint64 size() const Q_DECL_OVERRIDE { return m_device->size(); }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) Q_DECL_OVERRIDE
+    {
+        if (m_worker->isCancelRequested()) {
+            return -1;
+        }
+        const qint64 count = m_device->read(data, maxSize);
+        report(count);
+        return count;
+    }
+
+    qint64 writeData(const char *data, qint64 maxSize) Q_DECL_OVERRIDE
+    {
+        if (m_worker->isCancelRequested()) {
+            return -1;
+        }
+        const qint64 count = m_device->write(data, maxSize);
+        report(count);
+        return count;
+    }
+
+private:
+    QIODevice *m_device;
+    SpliceFileWorker *m_worker;
+    qint64 m_done;
+    qint64 m_total;
+
+    inline void report(qint64 count)
+    {
+        if (count > 0) {
+            m_done += count;
+            m_worker->reportProgress(m_done, m_total);
+        }
+    }
+};
+
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class SpliceFileWorker
+ * \brief The class SpliceFileWorker loads and saves the splice files
+ * in a worker thread, so that the GUI doesn't freeze on big files.
+ *
+ * When loading, the file is read, parsed and converted into a Splice
+ * in the worker thread. The signal loaded() is emitted in the thread
+ * of the SpliceFileWorker (the GUI thread) with the complete Splice,
+ * so that the receiver can assign it to the SpliceCalculator
+ * in a single step (see SpliceCalculator::read()).
+ *
+ * When saving, the worker serializes a snapshot of the Splice.
+ * Since the Splice's containers are implicitly shared (copy-on-write),
+ * taking the snapshot is cheap, and the GUI can continue to edit
+ * the splice during the saving. The file is written with QSaveFile,
+ * so the existing file is replaced only when the saving succeeds.
+ *
+ * Both operations emit progressed(), and can be cancelled with cancel().
+ * Only one operation runs at a time.
+ *
+ * \sa SpliceJson, SpliceBinary
+ */
+SpliceFileWorker::SpliceFileWorker(QObject *parent) : QObject(parent)
+  , m_cancelRequested(0)
+  , m_running(false)
+  , m_success(false)
+  , m_operation(NoOperation)
+  , m_format(Json)
+  , m_percent(-1)
+{
+    /* Use a dedicated pool, so that the file operations don't wait
+     * for the optimisation tasks in QThreadPool::globalInstance(). */
+    m_pool.setMaxThreadCount(1);
+}
+
+SpliceFileWorker::~SpliceFileWorker()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+bool SpliceFileWorker::isRunning() const
+{
+    return m_running;
+}
+
+/*! \brief Returns the current operation, or the last one if no operation is running.
+ */
+SpliceFileWorker::Operation SpliceFileWorker::operation() const
+{
+    return m_operation;
+}
+
+QString SpliceFileWorker::path() const
+{
+    return m_path;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Starts to load the file of the given \a path in JSON or binary format.
+ * Returns false if another operation is still running.
+ */
+bool SpliceFileWorker::load(const QString &path)
+{
+    if (m_running) {
+        return false;
+    }
+    m_splice = Splice();
+    start(Load, path);
+    return true;
+}
+
+/*! \brief Starts to save the given \a snapshot to the file of the given \a path.
+ * Returns false if another operation is still running.
+ */
+bool SpliceFileWorker::save(const Splice &snapshot, const QString &path, Format format)
+{
+    if (m_running) {
+        return false;
+    }
+    m_splice = snapshot;
+    m_format = format;
+    start(Save, path);
+    return true;
+}
+
+/*! \brief Blocks until the current operation is done, and emits its signals.
+ * Returns true if the operation succeeded.
+ *
+ * Only the completion of this worker is delivered: unlike a nested
+ * event loop, no other event is processed during the call.
+ * The GUI should rather react to finished().
+ */
+bool SpliceFileWorker::waitForFinished()
+{
+    if (m_running) {
+        m_pool.waitForDone();
+        /* Deliver the queued call to _q_finished() now. */
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    }
+    return m_success;
+}
+
+void SpliceFileWorker::cancel()
+{
+    m_cancelRequested.storeRelease(1);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void SpliceFileWorker::start(Operation operation, const QString &path)
+{
+    m_running = true;
+    m_success = false;
+    m_operation = operation;
+    m_path = path;
+    m_percent = -1;
+    m_cancelRequested.storeRelease(0);
+
+    emit started(path);
+    emit progressed(0);
+    m_pool.start( new SpliceFileTask(this) );
+}
+
+inline bool SpliceFileWorker::isCancelRequested() const
+{
+    return m_cancelRequested.loadAcquire() != 0;
+}
+
+/*! \brief Emits progressed() when the percentage changes (from the worker thread).
+ */
+void SpliceFileWorker::reportProgress(qint64 done, qint64 total)
+{
+    if (total <= 0) {
+        return;
+    }
+    /* Keep 100% for the end of the operation. */
+    const int percent = int(qMin(qint64(99), (100 * done) / total));
+    if (percent != m_percent) {
+        m_percent = percent;
+        emit progressed(percent);
+    }
+}
+
+/*! \brief Returns the estimated size of the file of m_splice, for the progress.
+ */
+qint64 SpliceFileWorker::estimatedSize() const
+{
+    qint64 pointCount = 0;
+    for (int i = 0; i < m_splice.designSpaceCount(); ++i) {
+        pointCount += m_splice.designSpaceAt(i).polygon.count();
+    }
+    if (m_format == Binary) {
+        return SpliceBinary::toByteArray(Splice()).size()
+                + 40 * qint64(m_splice.fastenerCount())
+                + 16 * qint64(m_splice.designSpaceCount())
+                + 16 * pointCount;
+    }
+    return C_JSON_HEADER_SIZE
+            + C_JSON_FASTENER_SIZE * qint64(m_splice.fastenerCount())
+            + C_JSON_DESIGNSPACE_SIZE * qint64(m_splice.designSpaceCount())
+            + C_JSON_POINT_SIZE * pointCount;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \internal
+ * \brief Runs in the worker thread.
+ */
+void SpliceFileWorker::runAsync()
+{
+    QString error;
+    const bool ok = (m_operation == Load) ? runLoad(&error) : runSave(&error);
+    Status status = Succeeded;
+    if (!ok) {
+        status = isCancelRequested() ? Cancelled : Failed;
+    }
+    QMetaObject::invokeMethod(this, "_q_finished", Qt::QueuedConnection,
+                              Q_ARG(int, int(status)), Q_ARG(QString, error));
+}
+
+bool SpliceFileWorker::runLoad(QString *error)
+{
+    Splice splice;
+    if (SpliceBinary::isBinaryFile(m_path)) {
+        /* Memory-mapped: there's nothing to stream. */
+        if (!SpliceBinary::readFile(m_path, &splice, error)) {
+            return false;
+        }
+    } else {
+        QFile file(m_path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            *error = file.errorString();
+            return false;
+        }
+        ProgressDevice device(&file, this, file.size());
+        device.open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+        if (!SpliceJson::read(&device, &splice, error)) {
+            return false;
+        }
+    }
+    if (isCancelRequested()) {
+        return false;
+    }
+    m_splice = splice;
+    return true;
+}
+
+bool SpliceFileWorker::runSave(QString *error)
+{
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        *error = file.errorString();
+        return false;
+    }
+
+    ProgressDevice device(&file, this, estimatedSize());
+    device.open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+    const bool ok = (m_format == Binary)
+            ? SpliceBinary::write(m_splice, &device)
+            : SpliceJson::write(m_splice, &device);
+
+    if (!ok || isCancelRequested()) {
+        /* Keep the existing file unchanged. */
+        *error = file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit()) {
+        *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void SpliceFileWorker::_q_finished(int status, const QString &error)
+{
+    m_running = false;
+    m_success = (status == Succeeded);
+
+    const QString path = m_path;
+    const Splice splice = m_splice;
+    m_splice = Splice(); /* Release the snapshot */
+
+    switch (status) {
+    case Succeeded:
+        emit progressed(100);
+        if (m_operation == Load) {
+            emit loaded(path, splice);
+        } else {
+            emit saved(path);
+        }
+        break;
+    case Cancelled:
+        emit progressed(0);
+        emit cancelled(path);
+        break;
+    case Failed:
+    default:
+        emit progressed(0);
+        emit failed(path, error);
+        break;
+    }
+    emit finished(m_success);
+}
@@ -0,0 +1,86 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_SPLICE_FILE_WORKER_H
+#define CORE_SPLICE_FILE_WORKER_H
+
+#include <Core/Splice>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QThreadPool>
+
+class SpliceFileWorker : public QObject
+{
+    Q_OBJECT
+public:
+    enum Operation { NoOperation, Load, Save };
+    enum Format { Json, Binary };
+
+    explicit SpliceFileWorker(QObject *parent = Q_NULLPTR);
+    ~SpliceFileWorker();
+
+    bool isRunning() const;
+    Operation operation() const;
+    QString path() const;
+
+    bool load(const QString &path);
+    bool save(const Splice &snapshot, const QString &path, Format format = Json);
+    bool waitForFinished();
+
+public Q_SLOTS:
+    void cancel();
+
+Q_SIGNALS:
+    void started(QString path);
+    void progressed(int percent); /* between 0 and 100 */
+    void loaded(QString path, Splice splice);
+    void saved(QString path);
+    void failed(QString path, QString error);
+    void cancelled(QString path);
+    void finished(bool success);
+
+private Q_SLOTS:
+    void _q_finished(int status, const QString &error);
+
+private:
+    friend class SpliceFileTask;
+    friend class ProgressDevice;
+
+    enum Status { Succeeded = 0, Failed, Cancelled };
+
+    QThreadPool m_pool;
+    QAtomicInt m_cancelRequested;
+    bool m_running;
+    bool m_success;
+    Operation m_operation;
+    Format m_format;
+    QString m_path;
+    Splice m_splice;
+    int m_percent;
+
+    void start(Operation operation, const QString &path);
+    void runAsync();
+    bool runLoad(QString *error);
+    bool runSave(QString *error);
+
+    inline bool isCancelRequested() const;
+    void reportProgress(qint64 done, qint64 total);
+    qint64 estimatedSize() const;
+};
+
+#endif // CORE_SPLICE_FILE_WORKER_H
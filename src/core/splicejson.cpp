@@ -0,0 +1,1095 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "splicejson.h"
+
+#include <Core/DesignSpace>
+#include <Core/Fastener>
+#include <Core/Splice>
+#include <Core/Tensor>
+#include <Core/Units/UnitSystem>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QIODevice>
+#include <QtCore/QLocale>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <QtCore/qnumeric.h>
+
+/*! \namespace SpliceJson
+ *  \brief The namespace SpliceJson contains the streaming
+ *  reader and writer of the JSON (*.splice) format.
+ *
+ * Splice::read() and Splice::write() work on a QJsonObject, so the whole
+ * document must be parsed into a DOM before it can be converted into a
+ * Splice (and the reverse when writing). For the very large splices,
+ * the DOM roughly doubles the peak memory.
+ *
+ * The functions of this namespace read and write the same schema
+ * directly from/to a QIODevice, in chunks of C_CHUNK_SIZE bytes,
+ * without building a DOM. The reader is a pull parser (SAX-style):
+ * the fasteners and the design spaces are appended to their vectors
+ * as soon as they are parsed, and the vector of fasteners is reserved
+ * from the size of the remaining input.
+ *
+ * The unknown members are skipped, and the missing members take the same
+ * default values as with Splice::read(), so both readers are equivalent.
+ *
+ * The writer outputs the members in the same order and with the same
+ * indentation as QJsonDocument::toJson().
+ */
+
+/* Size of the chunks read from / written to the device. */
+#define C_CHUNK_SIZE (64 * 1024)
+
+/* Minimum size of a fastener in a compact JSON file, used to
+ * estimate the capacity to reserve before parsing the fasteners. */
+#define C_FASTENER_MIN_JSON_SIZE 112
+
+/* Upper bound of the reserved capacity (doesn't limit the count). */
+#define C_FASTENER_MAX_RESERVE (1 << 24)
+
+namespace SpliceJson {
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \internal
+ * \class JsonReader
+ * \brief Pull parser for JSON documents (RFC 7159), that reads
+ * its input from a QIODevice, chunk by chunk.
+ *
+ * Call readNext() to get the next token. After a Name token,
+ * the next token is the start of the member's value.
+ * Use skipCurrentValue() to ignore the current value
+ * (a scalar, or a whole object or array).
+ */
+class JsonReader
+{
+public:
+    enum TokenType {
+        NoToken = 0,
+        Invalid,
+        EndDocument,
+        StartObject,
+        EndObject,
+        StartArray,
+        EndArray,
+        Name,
+        String,
+        Number,
+        Bool,
+        Null
+    };
+
+    explicit JsonReader(QIODevice *device)
+        : m_device(device)
+        , m_size(0)
+        , m_pos(0)
+        , m_consumed(0)
+        , m_state(ExpectValue)
+        , m_token(NoToken)
+        , m_number(0.)
+        , m_boolean(false)
+    {
+        m_buffer.resize(C_CHUNK_SIZE);
+    }
+
+    TokenType readNext();
+    void skipCurrentValue();
+
+    TokenType tokenType() const { return m_token; }
+    bool hasError() const { return m_token == Invalid; }
+    QString errorString() const { return m_errorString; }
+
+    /* Token's value */
+    bool isName(const char *name) const { return m_text == name; }
+    QString text() const { return QString::fromUtf8(m_text); }
+    double number() const { return m_number; }
+    bool boolean() const { return m_boolean; }
+
+    qint64 offset() const { return m_consumed + m_pos; }
+    qint64 bytesRemaining() const;
+
+private:
+    enum State {
+        ExpectValue,
+        ExpectValueOrEnd,
+        ExpectName,
+        ExpectNameOrEnd,
+        ExpectCommaOrEnd,
+        Done
+    };
+
+    inline int peek();
+    bool fill();
+    void skipWhitespace();
+    TokenType readValue(int c);
+    TokenType endContainer(TokenType token);
+    bool readString();
+    bool readHex4(uint *code);
+    void appendUtf8(uint code);
+    bool readNumber();
+    bool readLiteral(const char *literal);
+    bool raiseError(const QString &message);
+    void endValue();
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    int m_size;
+    int m_pos;
+    qint64 m_consumed;
+    QByteArray m_stack;
+    State m_state;
+    TokenType m_token;
+    QByteArray m_text;
+    double m_number;
+    bool m_boolean;
+    QString m_errorString;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Returns the number of bytes not yet parsed, or 0 if unknown.
+ */
+qint64 JsonReader::bytesRemaining() const
+{
+    if (!m_device || m_device->isSequential()) {
+        return 0;
+    }
+    return qMax(qint64(0), m_device->size() - offset());
+}
+
+/*! \brief Returns the next character without consuming it, or -1 at the end.
+ */
+inline int JsonReader::peek()
+{
+    if (m_pos >= m_size && !fill()) {
+        return -1;
+    }
+    return uchar(m_buffer.at(m_pos));
+}
+
+bool JsonReader::fill()
+{
+    m_consumed += m_size;
+    m_pos = 0;
+    m_size = 0;
+    if (!m_device) {
+        return false;
+    }
+    const qint64 count = m_device->read(m_buffer.data(), m_buffer.size());
+    if (count > 0) {
+        m_size = int(count);
+    }
+    return m_size > 0;
+}
+
+void JsonReader::skipWhitespace()
+{
+    for (;;) {
+        const int c = peek();
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            ++m_pos;
+        } else {
+            return;
+        }
+    }
+}
+
+bool JsonReader::raiseError(const QString &message)
+{
+    m_errorString = QString("At character %0, %1.").arg(offset()).arg(message);
+    m_token = Invalid;
+    return false;
+}
+
+void JsonReader::endValue()
+{
+    m_state = m_stack.isEmpty() ? Done : ExpectCommaOrEnd;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+JsonReader::TokenType JsonReader::readNext()
+{
+    if (m_token == Invalid || m_token == EndDocument) {
+        return m_token;
+    }
+    for (;;) {
+        skipWhitespace();
+        const int c = peek();
+
+        switch (m_state) {
+        case Done:
+            if (c != -1) {
+                raiseError(QStringLiteral("unexpected data after the document"));
+                return m_token;
+            }
+            return m_token = EndDocument;
+
+        case ExpectNameOrEnd:
+            if (c == '}') {
+                return endContainer(EndObject);
+            }
+            // fall through
+        case ExpectName:
+            if (c != '"') {
+                raiseError(QStringLiteral("member name expected"));
+                return m_token;
+            }
+            ++m_pos;
+            if (!readString()) {
+                return m_token;
+            }
+            skipWhitespace();
+            if (peek() != ':') {
+                raiseError(QStringLiteral("':' expected after the member name"));
+                return m_token;
+            }
+            ++m_pos;
+            m_state = ExpectValue;
+            return m_token = Name;
+
+        case ExpectValueOrEnd:
+            if (c == ']') {
+                return endContainer(EndArray);
+            }
+            return readValue(c);
+
+        case ExpectValue:
+            return readValue(c);
+
+        case ExpectCommaOrEnd:
+        {
+            const bool inObject = (m_stack.at(m_stack.size() - 1) == '{');
+            if (c == ',') {
+                ++m_pos;
+                m_state = inObject ? ExpectName : ExpectValue;
+                continue;
+            }
+            if (inObject && c == '}') {
+                return endContainer(EndObject);
+            }
+            if (!inObject && c == ']') {
+                return endContainer(EndArray);
+            }
+            raiseError(inObject
+                       ? QStringLiteral("',' or '}' expected")
+                       : QStringLiteral("',' or ']' expected"));
+            return m_token;
+        }
+        }
+    }
+}
+
+JsonReader::TokenType JsonReader::endContainer(TokenType token)
+{
+    ++m_pos;
+    m_stack.chop(1);
+    endValue();
+    return m_token = token;
+}
+
+JsonReader::TokenType JsonReader::readValue(int c)
+{
+    switch (c) {
+    case '{':
+        ++m_pos;
+        m_stack.append('{');
+        m_state = ExpectNameOrEnd;
+        return m_token = StartObject;
+    case '[':
+        ++m_pos;
+        m_stack.append('[');
+        m_state = ExpectValueOrEnd;
+        return m_token = StartArray;
+    case '"':
+        ++m_pos;
+        if (!readString()) {
+            return m_token;
+        }
+        endValue();
+        return m_token = String;
+    case 't':
+    case 'f':
+        m_boolean = (c == 't');
+        if (!readLiteral(m_boolean ? "true" : "false")) {
+            return m_token;
+        }
+        endValue();
+        return m_token = Bool;
+    case 'n':
+        if (!readLiteral("null")) {
+            return m_token;
+        }
+        endValue();
+        return m_token = Null;
+    case -1:
+        raiseError(QStringLiteral("unexpected end of the document"));
+        return m_token;
+    default:
+        break;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        if (!readNumber()) {
+            return m_token;
+        }
+        endValue();
+        return m_token = Number;
+    }
+    raiseError(QString("unexpected character '%0'").arg(QChar(c)));
+    return m_token;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Reads the string after the opening quote, into m_text (UTF-8).
+ */
+bool JsonReader::readString()
+{
+    m_text.resize(0);
+    for (;;) {
+        const int c = peek();
+        if (c == -1) {
+            return raiseError(QStringLiteral("unterminated string"));
+        }
+        ++m_pos;
+        if (c == '"') {
+            return true;
+        }
+        if (c < 0x20) {
+            return raiseError(QStringLiteral("control character in string"));
+        }
+        if (c != '\\') {
+            m_text.append(char(c));
+            continue;
+        }
+        const int e = peek();
+        ++m_pos;
+        switch (e) {
+        case '"':  m_text.append('"');  break;
+        case '\\': m_text.append('\\'); break;
+        case '/':  m_text.append('/');  break;
+        case 'b':  m_text.append('\b'); break;
+        case 'f':  m_text.append('\f'); break;
+        case 'n':  m_text.append('\n'); break;
+        case 'r':  m_text.append('\r'); break;
+        case 't':  m_text.append('\t'); break;
+        case 'u':
+        {
+            uint code = 0;
+            if (!readHex4(&code)) {
+                return false;
+            }
+            if (QChar::isHighSurrogate(code)) {
+                uint low = 0;
+                if (peek() != '\\') {
+                    return raiseError(QStringLiteral("invalid surrogate pair"));
+                }
+                ++m_pos;
+                if (peek() != 'u') {
+                    return raiseError(QStringLiteral("invalid surrogate pair"));
+                }
+                ++m_pos;
+                if (!readHex4(&low) || !QChar::isLowSurrogate(low)) {
+                    return raiseError(QStringLiteral("invalid surrogate pair"));
+                }
+                code = QChar::surrogateToUcs4(ushort(code), ushort(low));
+            }
+            appendUtf8(code);
+            break;
+        }
+        default:
+            return raiseError(QStringLiteral("invalid escape sequence"));
+        }
+    }
+}
+
+bool JsonReader::readHex4(uint *code)
+{
+    *code = 0;
+    for (int i = 0; i < 4; ++i) {
+        const int c = peek();
+        uint digit;
+        if (c >= '0' && c <= '9') {
+            digit = uint(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = uint(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            digit = uint(c - 'A' + 10);
+        } else {
+            return raiseError(QStringLiteral("invalid unicode escape sequence"));
+        }
+        ++m_pos;
+        *code = (*code << 4) | digit;
+    }
+    return true;
+}
+
+void JsonReader::appendUtf8(uint code)
+{
+    if (code < 0x80) {
+        m_text.append(char(code));
+    } else if (code < 0x800) {
+        m_text.append(char(0xC0 | (code >> 6)));
+        m_text.append(char(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        m_text.append(char(0xE0 | (code >> 12)));
+        m_text.append(char(0x80 | ((code >> 6) & 0x3F)));
+        m_text.append(char(0x80 | (code & 0x3F)));
+    } else {
+        m_text.append(char(0xF0 | (code >> 18)));
+        m_text.append(char(0x80 | ((code >> 12) & 0x3F)));
+        m_text.append(char(0x80 | ((code >> 6) & 0x3F)));
+        m_text.append(char(0x80 | (code & 0x3F)));
+    }
+}
+
+bool JsonReader::readNumber()
+{
+    m_text.resize(0);
+    for (;;) {
+        const int c = peek();
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+'
+                || c == '.' || c == 'e' || c == 'E') {
+            m_text.append(char(c));
+            ++m_pos;
+        } else {
+            break;
+        }
+    }
+    bool ok = false;
+    m_number = m_text.toDouble(&ok);
+    if (!ok) {
+        return raiseError(QString("invalid number '%0'").arg(QString::fromLatin1(m_text)));
+    }
+    return true;
+}
+
+bool JsonReader::readLiteral(const char *literal)
+{
+    for (const char *p = literal; *p; ++p) {
+        if (peek() != *p) {
+            return raiseError(QStringLiteral("invalid literal"));
+        }
+        ++m_pos;
+    }
+    return true;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Skips the current value. If the current token starts an object
+ * or an array, skips until the end of this object or array.
+ */
+void JsonReader::skipCurrentValue()
+{
+    if (m_token != StartObject && m_token != StartArray) {
+        return;
+    }
+    int depth = 1;
+    while (depth > 0) {
+        switch (readNext()) {
+        case StartObject:
+        case StartArray:
+            ++depth;
+            break;
+        case EndObject:
+        case EndArray:
+            --depth;
+            break;
+        case Invalid:
+        case EndDocument:
+            return;
+        default:
+            break;
+        }
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/* Values of the members. As with QJsonValue::toString(), toDouble() and
+ * toBool(), a value of another type is converted to the default value.
+ */
+static QString readStringValue(JsonReader &reader)
+{
+    if (reader.readNext() == JsonReader::String) {
+        return reader.text();
+    }
+    reader.skipCurrentValue();
+    return QString();
+}
+
+static double readDoubleValue(JsonReader &reader)
+{
+    if (reader.readNext() == JsonReader::Number) {
+        return reader.number();
+    }
+    reader.skipCurrentValue();
+    return 0.;
+}
+
+static bool readBoolValue(JsonReader &reader)
+{
+    if (reader.readNext() == JsonReader::Bool) {
+        return reader.boolean();
+    }
+    reader.skipCurrentValue();
+    return false;
+}
+
+static inline void skipValue(JsonReader &reader)
+{
+    reader.readNext();
+    reader.skipCurrentValue();
+}
+
+/*! \brief Returns true if the current token starts an array,
+ * otherwise skips the current value and returns false.
+ */
+static inline bool isStartArray(JsonReader &reader)
+{
+    if (reader.tokenType() == JsonReader::StartArray) {
+        return true;
+    }
+    reader.skipCurrentValue();
+    return false;
+}
+
+/*! \brief Returns true when the next token is an element of the array.
+ */
+static inline bool readNextElement(JsonReader &reader)
+{
+    const JsonReader::TokenType token = reader.readNext();
+    return token != JsonReader::EndArray
+            && token != JsonReader::Invalid
+            && token != JsonReader::EndDocument;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+static Tensor readTensor(JsonReader &reader)
+{
+    double fx = 0.;
+    double fy = 0.;
+    double mz = 0.;
+    if (reader.readNext() == JsonReader::StartObject) {
+        while (reader.readNext() == JsonReader::Name) {
+            if (reader.isName("fx")) {
+                fx = readDoubleValue(reader);
+            } else if (reader.isName("fy")) {
+                fy = readDoubleValue(reader);
+            } else if (reader.isName("mz")) {
+                mz = readDoubleValue(reader);
+            } else {
+                skipValue(reader);
+            }
+        }
+    } else {
+        reader.skipCurrentValue();
+    }
+    return Tensor( fx *N, fy *N, mz *N_m );
+}
+
+/*! \brief Reads the fastener that starts at the current token.
+ */
+static Fastener readFastener(JsonReader &reader)
+{
+    Fastener fastener;
+    QString name;
+    double positionX = 0.;
+    double positionY = 0.;
+    double diameter = 0.;
+    double thickness = 0.;
+    bool dofX = false;
+    bool dofY = false;
+
+    if (reader.tokenType() == JsonReader::StartObject) {
+        while (reader.readNext() == JsonReader::Name) {
+            if (reader.isName("name")) {
+                name = readStringValue(reader);
+            } else if (reader.isName("position_x")) {
+                positionX = readDoubleValue(reader);
+            } else if (reader.isName("position_y")) {
+                positionY = readDoubleValue(reader);
+            } else if (reader.isName("diameter")) {
+                diameter = readDoubleValue(reader);
+            } else if (reader.isName("thickness")) {
+                thickness = readDoubleValue(reader);
+            } else if (reader.isName("DoF_X")) {
+                dofX = readBoolValue(reader);
+            } else if (reader.isName("DoF_Y")) {
+                dofY = readBoolValue(reader);
+            } else {
+                skipValue(reader);
+            }
+        }
+    } else {
+        reader.skipCurrentValue();
+    }
+
+    fastener.name = name;
+    fastener.positionX = positionX *m;
+    fastener.positionY = positionY *m;
+    fastener.diameter  = diameter  *m;
+    fastener.thickness = thickness *m;
+    fastener.DoF_X = Fastener::boolToDOF(dofX);
+    fastener.DoF_Y = Fastener::boolToDOF(dofY);
+    return fastener;
+}
+
+/*! \brief Reads the point (array [x, y]) that starts at the current token.
+ */
+static QPointF readPoint(JsonReader &reader)
+{
+    double coords[2] = { 0., 0. };
+    if (isStartArray(reader)) {
+        int i = 0;
+        while (readNextElement(reader)) {
+            if (i < 2 && reader.tokenType() == JsonReader::Number) {
+                coords[i] = reader.number();
+            }
+            reader.skipCurrentValue();
+            ++i;
+        }
+    }
+    return QPointF(coords[0], coords[1]);
+}
+
+/*! \brief Reads the design space that starts at the current token.
+ */
+static DesignSpace readDesignSpace(JsonReader &reader)
+{
+    DesignSpace designSpace;
+    designSpace.name.clear();
+    designSpace.polygon.clear();
+    if (reader.tokenType() == JsonReader::StartObject) {
+        while (reader.readNext() == JsonReader::Name) {
+            if (reader.isName("name")) {
+                designSpace.name = readStringValue(reader);
+            } else if (reader.isName("points")) {
+                designSpace.polygon.clear();
+                reader.readNext();
+                if (isStartArray(reader)) {
+                    while (readNextElement(reader)) {
+                        designSpace.polygon << readPoint(reader);
+                    }
+                }
+            } else {
+                skipValue(reader);
+            }
+        }
+    } else {
+        reader.skipCurrentValue();
+    }
+    return designSpace;
+}
+
+static void readFasteners(JsonReader &reader, QVector<Fastener> &fasteners)
+{
+    fasteners.clear();
+    reader.readNext();
+    if (!isStartArray(reader)) {
+        return;
+    }
+    /* Reserve the vector from the remaining input, so that large
+     * files don't reallocate (and copy) the vector while growing. */
+    const qint64 estimate = reader.bytesRemaining() / C_FASTENER_MIN_JSON_SIZE;
+    if (estimate > 0) {
+        fasteners.reserve(int(qMin(estimate, qint64(C_FASTENER_MAX_RESERVE))));
+    }
+    while (readNextElement(reader)) {
+        fasteners.append( readFastener(reader) );
+    }
+}
+
+static void readLoadCases(JsonReader &reader, QVector<Tensor> &loadCases)
+{
+    loadCases.clear();
+    reader.readNext();
+    if (!isStartArray(reader)) {
+        return;
+    }
+    while (readNextElement(reader)) {
+        loadCases.append( readTensor(reader) );
+    }
+}
+
+static void readDesignSpaces(JsonReader &reader, QVector<DesignSpace> &designSpaces)
+{
+    designSpaces.clear();
+    reader.readNext();
+    if (!isStartArray(reader)) {
+        return;
+    }
+    while (readNextElement(reader)) {
+        designSpaces.append( readDesignSpace(reader) );
+    }
+}
+
+static inline bool setError(QString *error, const QString &message)
+{
+    if (error) {
+        *error = message;
+    }
+    return false;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Reads the JSON document from the given \a device and assigns
+ * it to the given \a splice.
+ *
+ * Returns true on success. Otherwise, returns false, sets the \a error
+ * message if not null and leaves the \a splice unchanged.
+ */
+bool read(QIODevice *device, Splice *splice, QString *error)
+{
+    if (!device || !splice) {
+        return setError(error, QStringLiteral("Invalid device or splice."));
+    }
+
+    JsonReader reader(device);
+    if (reader.readNext() != JsonReader::StartObject) {
+        if (reader.hasError()) {
+            return setError(error, reader.errorString());
+        }
+        return setError(error, QStringLiteral("The document is not a JSON object."));
+    }
+
+    Splice result;
+    QVector<Tensor> loadCases;
+    QVector<Fastener> fasteners;
+    QVector<DesignSpace> designSpaces;
+
+    while (reader.readNext() == JsonReader::Name) {
+        if (reader.isName("title")) {
+            result.setTitle( readStringValue(reader) );
+        } else if (reader.isName("author")) {
+            result.setAuthor( readStringValue(reader) );
+        } else if (reader.isName("date")) {
+            result.setDate( readStringValue(reader) );
+        } else if (reader.isName("description")) {
+            result.setDescription( readStringValue(reader) );
+        } else if (reader.isName("load")) {
+            result.setAppliedLoad( readTensor(reader) );
+        } else if (reader.isName("loadcases")) {
+            readLoadCases(reader, loadCases);
+        } else if (reader.isName("fasteners")) {
+            readFasteners(reader, fasteners);
+        } else if (reader.isName("designspaces")) {
+            readDesignSpaces(reader, designSpaces);
+        } else {
+            skipValue(reader);
+        }
+    }
+
+    /* Check that the document is well-formed until its end. */
+    if (!reader.hasError()) {
+        reader.readNext();
+    }
+    if (reader.hasError()) {
+        return setError(error, reader.errorString());
+    }
+
+    /* The vectors are implicitly shared, not copied. */
+    result.addLoadCase(loadCases);
+    result.addFastener(fasteners);
+    result.addDesignSpace(designSpaces);
+    *splice = result;
+    return true;
+}
+
+/*! \brief Reads the JSON file of the given \a path and assigns it to the given \a splice.
+ */
+bool readFile(const QString &path, Splice *splice, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return setError(error, file.errorString());
+    }
+    return read(&file, splice, error);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \internal
+ * \class JsonWriter
+ * \brief Writes an indented JSON document to a QIODevice, chunk by chunk.
+ */
+class JsonWriter
+{
+public:
+    explicit JsonWriter(QIODevice *device)
+        : m_device(device)
+        , m_depth(0)
+        , m_first(true)
+        , m_afterName(false)
+        , m_ok(true)
+    {
+        m_buffer.reserve(C_CHUNK_SIZE + 1024);
+    }
+
+    void writeStartObject() { beginValue(); m_buffer.append('{'); ++m_depth; m_first = true; }
+    void writeEndObject() { writeEnd('}'); }
+    void writeStartArray() { beginValue(); m_buffer.append('['); ++m_depth; m_first = true; }
+    void writeEndArray() { writeEnd(']'); }
+
+    void writeName(const char *name);
+    void writeString(const QString &value);
+    void writeDouble(double value);
+    void writeBool(bool value);
+
+    bool finish();
+
+private:
+    void beginValue();
+    void writeEnd(char c);
+    void writeIndent();
+    bool flush();
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    int m_depth;
+    bool m_first;
+    bool m_afterName;
+    bool m_ok;
+};
+
+void JsonWriter::writeIndent()
+{
+    m_buffer.append('\n');
+    for (int i = 0; i < m_depth; ++i) {
+        m_buffer.append("    ", 4);
+    }
+}
+
+void JsonWriter::beginValue()
+{
+    if (m_afterName) {
+        m_afterName = false;
+        return;
+    }
+    if (m_depth > 0) {
+        if (!m_first) {
+            m_buffer.append(',');
+        }
+        writeIndent();
+    }
+    m_first = false;
+}
+
+void JsonWriter::writeEnd(char c)
+{
+    --m_depth;
+    if (!m_first) {
+        writeIndent();
+    }
+    m_buffer.append(c);
+    m_first = false;
+    if (m_buffer.size() >= C_CHUNK_SIZE) {
+        flush();
+    }
+}
+
+void JsonWriter::writeName(const char *name)
+{
+    beginValue();
+    m_buffer.append('"');
+    m_buffer.append(name);
+    m_buffer.append("\": ", 3);
+    m_afterName = true;
+}
+
+void JsonWriter::writeString(const QString &value)
+{
+    beginValue();
+    m_buffer.append('"');
+    const QByteArray utf8 = value.toUtf8();
+    for (int i = 0; i < utf8.size(); ++i) {
+        const char c = utf8.at(i);
+        switch (c) {
+        case '"':  m_buffer.append("\\\"", 2); break;
+        case '\\': m_buffer.append("\\\\", 2); break;
+        case '\b': m_buffer.append("\\b", 2);  break;
+        case '\f': m_buffer.append("\\f", 2);  break;
+        case '\n': m_buffer.append("\\n", 2);  break;
+        case '\r': m_buffer.append("\\r", 2);  break;
+        case '\t': m_buffer.append("\\t", 2);  break;
+        default:
+            if (uchar(c) < 0x20) {
+                static const char hex[] = "0123456789abcdef";
+                m_buffer.append("\\u00", 4);
+                m_buffer.append(hex[(uchar(c) >> 4) & 0xF]);
+                m_buffer.append(hex[uchar(c) & 0xF]);
+            } else {
+                m_buffer.append(c);
+            }
+            break;
+        }
+    }
+    m_buffer.append('"');
+}
+
+void JsonWriter::writeDouble(double value)
+{
+    beginValue();
+    if (!qIsFinite(value)) {
+        /* Same as QJsonDocument: NaN and infinity aren't valid JSON numbers. */
+        m_buffer.append("null", 4);
+        return;
+    }
+#if QT_VERSION >= 0x050700
+    m_buffer.append(QByteArray::number(value, 'g', QLocale::FloatingPointShortest));
+#else
+    m_buffer.append(QByteArray::number(value, 'g', 17));
+#endif
+}
+
+void JsonWriter::writeBool(bool value)
+{
+    beginValue();
+    if (value) {
+        m_buffer.append("true", 4);
+    } else {
+        m_buffer.append("false", 5);
+    }
+}
+
+bool JsonWriter::flush()
+{
+    if (m_ok && !m_buffer.isEmpty()) {
+        m_ok = (m_device->write(m_buffer) == m_buffer.size());
+    }
+    m_buffer.resize(0); // keeps the reserved capacity
+    return m_ok;
+}
+
+bool JsonWriter::finish()
+{
+    Q_ASSERT(m_depth == 0);
+    m_buffer.append('\n');
+    return flush();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+static void writeTensor(JsonWriter &writer, const Tensor &tensor)
+{
+    writer.writeStartObject();
+    writer.writeName("fx");
+    writer.writeDouble( tensor.force_x.value() );
+    writer.writeName("fy");
+    writer.writeDouble( tensor.force_y.value() );
+    writer.writeName("mz");
+    writer.writeDouble( tensor.torque_z.value() );
+    writer.writeEndObject();
+}
+
+static void writeFastener(JsonWriter &writer, const Fastener &fastener)
+{
+    writer.writeStartObject();
+    writer.writeName("DoF_X");
+    writer.writeBool( Fastener::DOFtoBool(fastener.DoF_X) );
+    writer.writeName("DoF_Y");
+    writer.writeBool( Fastener::DOFtoBool(fastener.DoF_Y) );
+    writer.writeName("diameter");
+    writer.writeDouble( fastener.diameter.value() );
+    writer.writeName("name");
+    writer.writeString( fastener.name );
+    writer.writeName("position_x");
+    writer.writeDouble( fastener.positionX.value() );
+    writer.writeName("position_y");
+    writer.writeDouble( fastener.positionY.value() );
+    writer.writeName("thickness");
+    writer.writeDouble( fastener.thickness.value() );
+    writer.writeEndObject();
+}
+
+static void writeDesignSpace(JsonWriter &writer, const DesignSpace &designSpace)
+{
+    writer.writeStartObject();
+    writer.writeName("name");
+    writer.writeString( designSpace.name );
+    writer.writeName("points");
+    writer.writeStartArray();
+    foreach (const QPointF &point, designSpace.polygon) {
+        writer.writeStartArray();
+        writer.writeDouble( point.x() );
+        writer.writeDouble( point.y() );
+        writer.writeEndArray();
+    }
+    writer.writeEndArray();
+    writer.writeEndObject();
+}
+
+/*! \brief Writes the given \a splice to the given \a device, in JSON format.
+ *
+ * The members are written in alphabetical order, like QJsonDocument does.
+ * As a side effect, the design spaces are written before the fasteners,
+ * which lets read() estimate the number of fasteners from the remaining size.
+ *
+ * Returns true on success, otherwise false.
+ */
+bool write(const Splice &splice, QIODevice *device)
+{
+    if (!device) {
+        return false;
+    }
+    JsonWriter writer(device);
+    writer.writeStartObject();
+
+    writer.writeName("author");
+    writer.writeString( splice.author() );
+    writer.writeName("date");
+    writer.writeString( splice.date() );
+    writer.writeName("description");
+    writer.writeString( splice.description() );
+
+    writer.writeName("designspaces");
+    writer.writeStartArray();
+    for (int i = 0; i < splice.designSpaceCount(); ++i) {
+        writeDesignSpace(writer, splice.designSpaceAt(i));
+    }
+    writer.writeEndArray();
+
+    writer.writeName("fasteners");
+    writer.writeStartArray();
+    for (int i = 0; i < splice.fastenerCount(); ++i) {
+        writeFastener(writer, splice.fastenerAt(i));
+    }
+    writer.writeEndArray();
+
+    writer.writeName("load");
+    writeTensor(writer, splice.appliedLoad());
+
+    writer.writeName("loadcases");
+    writer.writeStartArray();
+    for (int i = 0; i < splice.loadCaseCount(); ++i) {
+        writeTensor(writer, splice.loadCaseAt(i));
+    }
+    writer.writeEndArray();
+
+    writer.writeName("title");
+    writer.writeString( splice.title() );
+
+    writer.writeEndObject();
+    return writer.finish();
+}
+
+} // namespace SpliceJson
@@ -0,0 +1,39 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_SPLICE_JSON_H
+#define CORE_SPLICE_JSON_H
+
+#include <QtCore/QtGlobal>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+class QString;
+QT_END_NAMESPACE
+
+class Splice;
+
+namespace SpliceJson {
+
+/* Streaming JSON Serialization */
+bool read(QIODevice *device, Splice *splice, QString *error = Q_NULLPTR);
+bool readFile(const QString &path, Splice *splice, QString *error = Q_NULLPTR);
+
+bool write(const Splice &splice, QIODevice *device);
+
+}
+
+#endif // CORE_SPLICE_JSON_H
@@ -0,0 +1,127 @@
+/* - FastenerPattern - Copyright (C) 2016 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CORE_RAW_QUANTITY_H
+#define CORE_RAW_QUANTITY_H
+
+#include <Core/Units/UnitSystem>
+#include <Core/Units/AreaMomentOfInertia>
+
+#include <QtCore/QtGlobal>
+
+/*
+ * RAW KERNEL BOUNDARY
+ *
+ * The public API (Fastener, Tensor, the solvers...) uses the quantities
+ * of Boost.Units, that check the units at compile time. But the
+ * quantities are deep templates: in debug builds, each operation is
+ * a chain of function calls, and the loops over quantities are not
+ * vectorised by the compiler in release builds.
+ *
+ * The hot numerical kernels (e.g. the RigidBodySolver) work on plain
+ * doubles instead, in SI units:
+ *
+ *  - The arrays are packed (one array of doubles per property), so that
+ *    the inner loops operate on 'const double *' and can be vectorised.
+ *
+ *  - The scalars (sums, centre of gravity, inertia...) are Raw::Quantity,
+ *    a double with a compile-time unit tag. The dimensional analysis is
+ *    still checked at compile time, but each operation is a single
+ *    inline (and constexpr) arithmetic operation on a double.
+ *
+ *  - The quantities of Boost.Units are converted to and from raw values
+ *    at the boundary of the kernel only, with Raw::fromSI() and toSI().
+ */
+namespace Raw {
+
+/*! \brief A value in SI units, with the exponents of the length (m)
+ * and of the force (N) of its unit as a compile-time tag.
+ */
+template <int L, int F>
+struct Quantity
+{
+    Q_DECL_CONSTEXPR Quantity() : value(0.) {}
+    Q_DECL_CONSTEXPR explicit Quantity(double v) : value(v) {}
+
+    Quantity &operator+=(Quantity other) { value += other.value; return *this; }
+    Quantity &operator-=(Quantity other) { value -= other.value; return *this; }
+
+    double value;
+};
+
+typedef Quantity<0, 0> Dimensionless;
+typedef Quantity<1, 0> Length;
+typedef Quantity<2, 0> Area;
+typedef Quantity<3, 0> Volume;
+typedef Quantity<4, 0> AreaMomentOfInertia;
+typedef Quantity<0, 1> Force;
+typedef Quantity<1, 1> Torque;
+
+/* Zero overhead: a quantity is stored as a double. */
+Q_STATIC_ASSERT(sizeof(Length) == sizeof(double));
+
+/* Operators */
+template <int L, int F>
+Q_DECL_CONSTEXPR inline Quantity<L, F> operator+(Quantity<L, F> a, Quantity<L, F> b)
+{ return Quantity<L, F>(a.value + b.value); }
+
+template <int L, int F>
+Q_DECL_CONSTEXPR inline Quantity<L, F> operator-(Quantity<L, F> a, Quantity<L, F> b)
+{ return Quantity<L, F>(a.value - b.value); }
+
+template <int L, int F>
+Q_DECL_CONSTEXPR inline Quantity<L, F> operator-(Quantity<L, F> a)
+{ return Quantity<L, F>(-a.value); }
+
+template <int L1, int F1, int L2, int F2>
+Q_DECL_CONSTEXPR inline Quantity<L1 + L2, F1 + F2> operator*(Quantity<L1, F1> a, Quantity<L2, F2> b)
+{ return Quantity<L1 + L2, F1 + F2>(a.value * b.value); }
+
+template <int L1, int F1, int L2, int F2>
+Q_DECL_CONSTEXPR inline Quantity<L1 - L2, F1 - F2> operator/(Quantity<L1, F1> a, Quantity<L2, F2> b)
+{ return Quantity<L1 - L2, F1 - F2>(a.value / b.value); }
+
+template <int L, int F>
+Q_DECL_CONSTEXPR inline Quantity<L, F> operator*(double k, Quantity<L, F> a)
+{ return Quantity<L, F>(k * a.value); }
+
+template <int L, int F>
+Q_DECL_CONSTEXPR inline Quantity<L, F> operator*(Quantity<L, F> a, double k)
+{ return Quantity<L, F>(a.value * k); }
+
+template <int L, int F>
+Q_DECL_CONSTEXPR inline Quantity<-L, -F> operator/(double k, Quantity<L, F> a)
+{ return Quantity<-L, -F>(k / a.value); }
+
+/* The unit algebra is checked at compile time. */
+#ifdef Q_COMPILER_CONSTEXPR
+Q_STATIC_ASSERT((Length(2.) * Length(3.)).value == 6.);
+Q_STATIC_ASSERT((Volume(6.) / Area(2.)).value == 3.);
+Q_STATIC_ASSERT((Force(2.) * Length(3.) - Torque(1.)).value == 5.);
+#endif
+
+/* Boundary: conversions from and to the quantities of Boost.Units */
+inline Length fromSI(const ::Length &q) { return Length(q.value()); }
+inline Force fromSI(const ::Force &q) { return Force(q.value()); }
+inline Torque fromSI(const ::Torque &q) { return Torque(q.value()); }
+
+inline ::Length toSI(Length q) { return q.value * m; }
+inline ::Force toSI(Force q) { return q.value * N; }
+inline ::Torque toSI(Torque q) { return q.value * N_m; }
+
+} // namespace Raw
+
+#endif // CORE_RAW_QUANTITY_H
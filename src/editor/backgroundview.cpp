@@ -22,8 +22,10 @@
 
 #include <QtCore/QDebug>
 #include <QtCore/QMimeData>
+#include <QtCore/qnumeric.h>         /* qIsFinite() */
 #include <QtCore/QtMath>             /* qPow() */
 #include <QtGui/QDragMoveEvent>
+#include <QtGui/QPainter>
 #include <QtWidgets/QApplication>
 
 /*!
@@ -46,8 +48,11 @@ BackgroundView::BackgroundView(QGraphicsScene *scene, QWidget *parent) : QGraphi
   , m_gridVisible(true)
   , m_pxPerUnit(10)
   , m_imageItem(Q_NULLPTR)
+  , m_gridScale(0)
+  , m_gridUnitSize(0)
 {
     this->setDragMode(QGraphicsView::RubberBandDrag);
+    this->setCacheMode(QGraphicsView::CacheBackground); /* Panning only blits the grid */
     this->viewport()->setMouseTracking(true);
     this->setOptimizationFlags(QGraphicsView::DontAdjustForAntialiasing);
 
@@ -100,6 +105,7 @@ bool BackgroundView::isGridVisible() const
 void BackgroundView::setGridVisible(bool visible)
 {
     m_gridVisible = visible;
+    resetCachedContent();
     viewport()->update();
 }
 
@@ -115,6 +121,7 @@ void BackgroundView::setPixelsPerUnit(qreal pxPerUnit)
     else
         m_pxPerUnit = pxPerUnit;
 
+    resetCachedContent();
     scene()->update();
 }
 
@@ -148,46 +155,66 @@ void BackgroundView::setImageUrl(const QUrl &url)
 
 /******************************************************************************
  ******************************************************************************/
+/*! \brief Draws the grid.
+ *
+ * The spacing of the grid adapts to the zoom: the minor lines are between
+ * C_BACKGROUND_MIN_UNIT_SIZE and 10 times C_BACKGROUND_MIN_UNIT_SIZE pixels
+ * apart, and the spacing is a power of ten of the unit.
+ *
+ * The grid is periodic, so one tile (between two major lines) is rendered
+ * in a pixmap, and the background is filled with it. The tile is rendered
+ * again only when the zoom changes. Moreover the view caches its
+ * background, thus panning only blits the already drawn grid.
+ */
 void BackgroundView::drawBackground(QPainter *painter, const QRectF &rect)
 {
     if (!m_gridVisible)
         return;
 
-    qreal unitSize = m_pxPerUnit;
-    /// \todo Find a suitable unitSize:
-    /// \todo qreal unitSize = m_pxPerUnit/100;
-    /// \todo while (unitSize < MIN_UNIT_SIZE)
-    /// \todo     unitSize *= 10;
-
-    painter->setPen(QPen(QColor(0, 0, 0, 50), C_BACKGROUND_PEN_WIDTH, Qt::SolidLine));
-    drawLinesWithInterval(unitSize, painter, rect);
+    const qreal scale = transform().m11();
+    const qreal pxPerUnit = qAbs(m_pxPerUnit);
+    if (!(scale > 0) || !qIsFinite(scale) || !(pxPerUnit > 0) || !qIsFinite(pxPerUnit))
+        return;
 
-    painter->setPen(QPen(QColor(0, 0, 0, 100), C_BACKGROUND_PEN_WIDTH, Qt::SolidLine));
-    drawLinesWithInterval(unitSize * C_BACKGROUND_MINOR_LINES, painter, rect);
+    /* Between 1 and 10 times the minimum, whatever the zoom:
+     * the tile is never too large to render. */
+    qreal unitSize = pxPerUnit / 100;
+    while (unitSize * scale < C_BACKGROUND_MIN_UNIT_SIZE)
+        unitSize *= 10;
+    while (unitSize * scale >= 10 * C_BACKGROUND_MIN_UNIT_SIZE)
+        unitSize /= 10;
+
+    const qreal tileSize = unitSize * C_BACKGROUND_MINOR_LINES;
+    if (scale != m_gridScale || unitSize != m_gridUnitSize) {
+        const QPixmap tile = createGridTile(qRound(tileSize * scale));
+        m_gridBrush = QBrush(tile);
+        m_gridBrush.setTransform(QTransform::fromScale(tileSize / tile.width(),
+                                                       tileSize / tile.height()));
+        m_gridScale = scale;
+        m_gridUnitSize = unitSize;
+    }
+    painter->fillRect(rect, m_gridBrush); /* The tile origin is the scene origin */
 }
 
-void BackgroundView::drawLinesWithInterval(qreal px, QPainter *painter, const QRectF &rect)
+/* Renders the square between two major lines, with the minor lines,
+ * in device pixels. */
+QPixmap BackgroundView::createGridTile(int size)
 {
-    QVector<QPointF> pointPairs;
-    QPointF bottomLeft = rect.bottomLeft();
-    QPointF topRight = rect.topRight();
-    for (qreal h = 0; h > topRight.y(); h -= px) {
-        pointPairs.append(QPointF(bottomLeft.x(), h));
-        pointPairs.append(QPointF(topRight.x(), h));
-    }
-    for (qreal h = px; h < bottomLeft.y(); h += px) {
-        pointPairs.append(QPointF(bottomLeft.x(), h));
-        pointPairs.append(QPointF(topRight.x(), h));
-    }
-    for (qreal w = 0; w < topRight.x(); w += px) {
-        pointPairs.append(QPointF(w, bottomLeft.y()));
-        pointPairs.append(QPointF(w, topRight.y()));
-    }
-    for (qreal w = -px; w > bottomLeft.x(); w -= px) {
-        pointPairs.append(QPointF(w, bottomLeft.y()));
-        pointPairs.append(QPointF(w, topRight.y()));
+    size = qMax(size, C_BACKGROUND_MINOR_LINES);
+    QPixmap tile(size, size);
+    tile.fill(Qt::transparent);
+
+    QPainter painter(&tile);
+    painter.setPen(QPen(QColor(0, 0, 0, 50), C_BACKGROUND_PEN_WIDTH, Qt::SolidLine));
+    for (int i = 0; i < C_BACKGROUND_MINOR_LINES; ++i) {
+        const int pos = qRound(qreal(i * size) / C_BACKGROUND_MINOR_LINES);
+        painter.drawLine(pos, 0, pos, size - 1);
+        painter.drawLine(0, pos, size - 1, pos);
     }
-    painter->drawLines(pointPairs);
+    painter.setPen(QPen(QColor(0, 0, 0, 100), C_BACKGROUND_PEN_WIDTH, Qt::SolidLine));
+    painter.drawLine(0, 0, 0, size - 1);
+    painter.drawLine(0, 0, size - 1, 0);
+    return tile;
 }
 
 
@@ -22,6 +22,8 @@
  */
 
 #include <QtCore/QUrl>
+#include <QtGui/QBrush>
+#include <QtGui/QPixmap>
 #include <QtWidgets/QGraphicsView>
 
 class ScalableImageItem;
@@ -75,7 +77,12 @@ private:
     QPoint  m_lastMousePos;
     QPointF m_lastMouseScenePos;
 
-    void drawLinesWithInterval(qreal px, QPainter *painter, const QRectF &rect);
+    /* Grid tile, cached for the current zoom */
+    QBrush m_gridBrush;
+    qreal m_gridScale;
+    qreal m_gridUnitSize;
+
+    static QPixmap createGridTile(int size);
 };
 
 #endif // EDITOR_BACKGROUND_VIEW_H
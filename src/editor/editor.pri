@@ -6,6 +6,7 @@ HEADERS  += \
     $$PWD/items/fasteneritem.h \
     $$PWD/items/handleitem.h \
     $$PWD/items/measureitem.h \
+    $$PWD/items/patternlayeritem.h \
     $$PWD/items/scalableimageitem.h \
     $$PWD/items/symbolitem.h \
     $$PWD/items/tensoritem.h \
@@ -13,6 +14,7 @@ HEADERS  += \
     $$PWD/backgroundview.h \
     $$PWD/backgroundwidget.h \
     $$PWD/flexiblescrollbar.h \
+    $$PWD/imagepyramid.h \
     $$PWD/splicegraphicswidget.h
 
 SOURCES += \
@@ -23,10 +25,12 @@ SOURCES += \
     $$PWD/items/fasteneritem.cpp \
     $$PWD/items/handleitem.cpp \
     $$PWD/items/measureitem.cpp \
+    $$PWD/items/patternlayeritem.cpp \
     $$PWD/items/scalableimageitem.cpp \
     $$PWD/items/symbolitem.cpp \
     $$PWD/items/tensoritem.cpp \
     $$PWD/backgroundview.cpp \
     $$PWD/backgroundwidget.cpp \
     $$PWD/flexiblescrollbar.cpp \
+    $$PWD/imagepyramid.cpp \
     $$PWD/splicegraphicswidget.cpp
@@ -0,0 +1,531 @@
+/* - FastenerPattern - Copyright (C) 2016 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "imagepyramid.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMetaObject>
+#include <QtCore/QRunnable>
+#include <QtCore/QSaveFile>
+#include <QtCore/QTextStream>
+#include <QtGui/QImageReader>
+
+#include <algorithm>
+
+#define C_IMAGE_TILE_SIZE           256         /* pixels */
+#define C_IMAGE_PIXMAP_CACHE_SIZE   (64 * 1024) /* KB */
+#define C_IMAGE_MANIFEST_FILE       "pyramid.txt"
+#define C_IMAGE_DISK_CACHE_LIMIT    (Q_INT64_C(512) * 1024 * 1024) /* bytes */
+
+/* Fast formats to convert into pixmaps. */
+static inline QImage toPixmapFormat(const QImage &image)
+{
+    return image.convertToFormat(image.hasAlphaChannel()
+                                 ? QImage::Format_ARGB32_Premultiplied
+                                 : QImage::Format_RGB32);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class ImagePyramidTask
+ * \remark QRunnable cannot emit Signals. It's not a QObject.
+ *         The workaround is to emit Signals from the ImagePyramid.
+ */
+class ImagePyramidTask : public QRunnable
+{
+public:
+    ImagePyramidTask(ImagePyramid *p, QSharedPointer<ImagePyramid::Job> job)
+        : QRunnable(), m_pyramid(p), m_job(job) {}
+
+public:
+    void run() Q_DECL_OVERRIDE
+    {
+        m_pyramid->runAsync(m_job);
+    }
+
+private:
+    ImagePyramid* m_pyramid;
+    QSharedPointer<ImagePyramid::Job> m_job;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class ImagePyramid
+ * \brief The class ImagePyramid splits a (very) large image into tiles,
+ * at several levels of resolution, to paint only the visible tiles,
+ * at the resolution of the screen.
+ *
+ * The level 0 is the image at full resolution, and each next level is
+ * half the size of the previous one, until the image fits in a single tile.
+ *
+ * The image is decoded, scaled and split in a worker thread, once.
+ * The signal loaded() is emitted in the thread of the ImagePyramid
+ * (the GUI thread) when the tiles are ready. The tiles are kept in memory
+ * until the next image, so painting never decodes an image.
+ *
+ * The disk cache is optional (see setCacheDirectory()). The tiles are then
+ * saved to the disk after loaded(), in a sub-directory specific to the file
+ * (path, size and date), so reopening the same file reads the tiles back
+ * in the worker thread instead of decoding and scaling the full resolution
+ * image again. The cache directory is bounded (see setCacheSizeLimit()):
+ * the tiles of the least recently opened files are removed first.
+ *
+ * tile() converts the tiles into pixmaps, and keeps the most recently
+ * painted ones.
+ *
+ * \remark Only one image is built at a time. load() discards the image
+ * that is still being built.
+ */
+ImagePyramid::ImagePyramid(QObject *parent) : QObject(parent)
+  , m_cacheSizeLimit(C_IMAGE_DISK_CACHE_LIMIT)
+  , m_generation(0)
+  , m_running(false)
+  , m_ready(false)
+  , m_pixmaps(C_IMAGE_PIXMAP_CACHE_SIZE)
+{
+    /* A single thread: decoding a large image takes a lot of memory. */
+    m_pool.setMaxThreadCount(1);
+}
+
+ImagePyramid::~ImagePyramid()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+bool ImagePyramid::isRunning() const
+{
+    return m_running;
+}
+
+/*! \brief Returns true if the tiles of the image are ready to be painted.
+ */
+bool ImagePyramid::isReady() const
+{
+    return m_ready;
+}
+
+QString ImagePyramid::fileName() const
+{
+    return m_job ? m_job->fileName : QString();
+}
+
+/*! \brief Returns the directory where the tiles are saved.
+ * If empty (default), the tiles aren't saved to the disk.
+ */
+QString ImagePyramid::cacheDirectory() const
+{
+    return m_cacheDirectory;
+}
+
+void ImagePyramid::setCacheDirectory(const QString &path)
+{
+    m_cacheDirectory = path;
+}
+
+/*! \brief Returns the maximum size of the cache directory on the disk, in bytes.
+ * The default is 512 MB. A limit of 0 means no limit.
+ *
+ * The limit is applied after building the tiles of an image. The tiles of
+ * the current image are always kept, even if they're larger than the limit.
+ */
+qint64 ImagePyramid::cacheSizeLimit() const
+{
+    return m_cacheSizeLimit;
+}
+
+void ImagePyramid::setCacheSizeLimit(qint64 bytes)
+{
+    m_cacheSizeLimit = qMax(Q_INT64_C(0), bytes);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Starts to build the tiles of the image \a fileName.
+ * If the tiles are already in the cache directory, they're read back instead.
+ * Returns false if the file doesn't exist.
+ */
+bool ImagePyramid::load(const QString &fileName)
+{
+    clear();
+    if (!QFileInfo(fileName).isFile()) {
+        return false;
+    }
+
+    QSharedPointer<Job> job(new Job());
+    job->generation = ++m_generation;
+    job->fileName = fileName;
+    job->cancelRequested.storeRelease(0);
+    job->success = false;
+    if (!m_cacheDirectory.isEmpty()) {
+        job->tileDirectory = tileDirectory(m_cacheDirectory, fileName);
+    }
+    job->cacheDirectory = m_cacheDirectory;
+    job->cacheSizeLimit = m_cacheSizeLimit;
+    m_job = job;
+    m_running = true;
+    m_pool.start( new ImagePyramidTask(this, job) );
+    return true;
+}
+
+/*! \brief Discards the image, and cancels its building if needed.
+ */
+void ImagePyramid::clear()
+{
+    cancel();
+    m_running = false;
+    m_ready = false;
+    m_levelSizes.clear();
+    m_tiles.clear();
+    m_pixmaps.clear();
+}
+
+void ImagePyramid::cancel()
+{
+    if (m_job) {
+        m_job->cancelRequested.storeRelease(1);
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Returns the size of the image, at full resolution.
+ */
+QSize ImagePyramid::size() const
+{
+    return levelSize(0);
+}
+
+int ImagePyramid::levelCount() const
+{
+    return m_levelSizes.count();
+}
+
+QSize ImagePyramid::levelSize(int level) const
+{
+    return (level >= 0 && level < m_levelSizes.count()) ? m_levelSizes.at(level) : QSize();
+}
+
+/*! \brief Returns the level to paint the image with the given \a scale,
+ * i.e. the number of screen pixels per pixel of the full resolution image.
+ *
+ * The level has at least the resolution of the screen.
+ */
+int ImagePyramid::levelForScale(qreal scale) const
+{
+    int level = 0;
+    while (level + 1 < m_levelSizes.count() && scale > 0 && scale <= 0.5) {
+        scale *= 2;
+        ++level;
+    }
+    return level;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int ImagePyramid::tileSize()
+{
+    return C_IMAGE_TILE_SIZE;
+}
+
+int ImagePyramid::columnCount(int level) const
+{
+    return (levelSize(level).width() + C_IMAGE_TILE_SIZE - 1) / C_IMAGE_TILE_SIZE;
+}
+
+int ImagePyramid::rowCount(int level) const
+{
+    return (levelSize(level).height() + C_IMAGE_TILE_SIZE - 1) / C_IMAGE_TILE_SIZE;
+}
+
+/*! \brief Returns the tile at the given \a column and \a row of the \a level.
+ * The tiles of the last column and of the last row can be smaller.
+ *
+ * \remark Must be called from the GUI thread.
+ */
+QPixmap ImagePyramid::tile(int level, int column, int row)
+{
+    if (!m_ready
+            || level < 0 || level >= levelCount()
+            || column < 0 || column >= columnCount(level)
+            || row < 0 || row >= rowCount(level)) {
+        return QPixmap();
+    }
+    const quint64 key = (quint64(level) << 48) | (quint64(row) << 24) | quint64(column);
+    const QPixmap *cached = m_pixmaps.object(key);
+    if (cached) {
+        return *cached;
+    }
+    const QImage image = m_tiles.at(level).at(row * columnCount(level) + column);
+    if (image.isNull()) {
+        return QPixmap();
+    }
+    const QPixmap pixmap = QPixmap::fromImage(image);
+    const int cost = qMax(1, pixmap.width() * pixmap.height() * pixmap.depth() / 8 / 1024);
+    m_pixmaps.insert(key, new QPixmap(pixmap), cost);
+    return pixmap;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void ImagePyramid::_q_finished(int generation)
+{
+    if (!m_job || m_job->generation != generation) {
+        return; /* Discarded */
+    }
+    m_running = false;
+    if (m_job->cancelRequested.loadAcquire() != 0) {
+        return;
+    }
+    if (!m_job->success) {
+        emit failed(m_job->fileName, m_job->error);
+        return;
+    }
+    m_levelSizes = m_job->levelSizes;
+    m_tiles = m_job->tiles;
+    m_job->tiles.clear();
+    m_ready = true;
+    emit loaded(m_job->fileName);
+}
+
+/*! \internal
+ * \brief Runs in the worker thread.
+ * The cache directory is written after loaded(), with the worker's own
+ * copy of the tiles: the ImagePyramid takes those of the job.
+ */
+void ImagePyramid::runAsync(QSharedPointer<Job> job)
+{
+    const bool cached = readCache(job.data());
+    job->success = cached || build(job.data());
+    const QVector<QVector<QImage> > tiles = job->tiles;
+    QMetaObject::invokeMethod(this, "_q_finished", Qt::QueuedConnection,
+                              Q_ARG(int, job->generation));
+
+    if (!job->success || job->tileDirectory.isEmpty()) {
+        return;
+    }
+    if (cached) {
+        /* Most recently used, for trimCache() */
+        writeManifest(job.data());
+    } else if (writeCache(job.data(), tiles) && job->cacheSizeLimit > 0) {
+        trimCache(job->cacheDirectory, job->cacheSizeLimit, job->tileDirectory);
+    }
+}
+
+/* Decodes the image, and splits each level into tiles,
+ * from the full resolution to the smallest level. */
+bool ImagePyramid::build(Job *job)
+{
+    QImageReader reader(job->fileName);
+    QImage image = reader.read();
+    if (image.isNull()) {
+        job->error = reader.errorString();
+        return false;
+    }
+    image = toPixmapFormat(image);
+
+    job->levelSizes.clear();
+    job->tiles.clear();
+    for (;;) {
+        const int width = image.width();
+        const int height = image.height();
+        const int columns = (width + C_IMAGE_TILE_SIZE - 1) / C_IMAGE_TILE_SIZE;
+        const int rows = (height + C_IMAGE_TILE_SIZE - 1) / C_IMAGE_TILE_SIZE;
+
+        QVector<QImage> tiles;
+        tiles.reserve(columns * rows);
+        for (int row = 0; row < rows; ++row) {
+            for (int column = 0; column < columns; ++column) {
+                if (job->cancelRequested.loadAcquire() != 0) {
+                    return false;
+                }
+                const int x = column * C_IMAGE_TILE_SIZE;
+                const int y = row * C_IMAGE_TILE_SIZE;
+                tiles.append(image.copy(x, y,
+                                        qMin(C_IMAGE_TILE_SIZE, width - x),
+                                        qMin(C_IMAGE_TILE_SIZE, height - y)));
+            }
+        }
+        job->levelSizes.append(image.size());
+        job->tiles.append(tiles);
+
+        if (qMax(width, height) <= C_IMAGE_TILE_SIZE) {
+            break;
+        }
+        image = image.scaled(qMax(1, (width + 1) / 2), qMax(1, (height + 1) / 2),
+                             Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+    return true;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/* The manifest is written last: a cache without manifest is incomplete.
+ * If a tile is missing or unreadable, the image is built again. */
+bool ImagePyramid::readCache(Job *job)
+{
+    if (job->tileDirectory.isEmpty()) {
+        return false;
+    }
+    QFile file(job->tileDirectory + QLatin1Char('/') + QLatin1String(C_IMAGE_MANIFEST_FILE));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+    QVector<QSize> sizes;
+    QTextStream in(&file);
+    int count = 0;
+    in >> count;
+    for (int level = 0; level < count; ++level) {
+        int width = 0;
+        int height = 0;
+        in >> width >> height;
+        if (width <= 0 || height <= 0) {
+            return false;
+        }
+        sizes.append(QSize(width, height));
+    }
+    if (sizes.isEmpty() || in.status() != QTextStream::Ok) {
+        return false;
+    }
+    QVector<QVector<QImage> > levels;
+    levels.reserve(sizes.count());
+    for (int level = 0; level < sizes.count(); ++level) {
+        const int columns = (sizes.at(level).width() + C_IMAGE_TILE_SIZE - 1) / C_IMAGE_TILE_SIZE;
+        const int rows = (sizes.at(level).height() + C_IMAGE_TILE_SIZE - 1) / C_IMAGE_TILE_SIZE;
+        QVector<QImage> tiles;
+        tiles.reserve(columns * rows);
+        for (int row = 0; row < rows; ++row) {
+            for (int column = 0; column < columns; ++column) {
+                if (job->cancelRequested.loadAcquire() != 0) {
+                    return false;
+                }
+                QImage tile;
+                if (!tile.load(tilePath(job->tileDirectory, level, column, row))) {
+                    return false;
+                }
+                tiles.append(toPixmapFormat(tile));
+            }
+        }
+        levels.append(tiles);
+    }
+    job->levelSizes = sizes;
+    job->tiles = levels;
+    return true;
+}
+
+/* Saves the \a tiles, then the manifest. If cancelled, the incomplete
+ * sub-directory is removed. */
+bool ImagePyramid::writeCache(const Job *job, const QVector<QVector<QImage> > &tiles)
+{
+    if (!QDir().mkpath(job->tileDirectory)) {
+        return false;
+    }
+    for (int level = 0; level < tiles.count(); ++level) {
+        const int columns = (job->levelSizes.at(level).width() + C_IMAGE_TILE_SIZE - 1) / C_IMAGE_TILE_SIZE;
+        for (int i = 0; i < tiles.at(level).count(); ++i) {
+            if (job->cancelRequested.loadAcquire() != 0
+                    || !tiles.at(level).at(i).save(
+                        tilePath(job->tileDirectory, level, i % columns, i / columns), "PNG")) {
+                QDir(job->tileDirectory).removeRecursively();
+                return false;
+            }
+        }
+    }
+    return writeManifest(job);
+}
+
+bool ImagePyramid::writeManifest(const Job *job)
+{
+    QSaveFile file(job->tileDirectory + QLatin1Char('/') + QLatin1String(C_IMAGE_MANIFEST_FILE));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    QTextStream out(&file);
+    out << job->levelSizes.count() << '\n';
+    foreach (auto &size, job->levelSizes) {
+        out << size.width() << ' ' << size.height() << '\n';
+    }
+    out.flush();
+    return file.commit();
+}
+
+/* Removes the tiles of the least recently used files (the oldest
+ * manifests first), until the cache directory is smaller than the
+ * \a limit. The \a kept directory is not removed. */
+void ImagePyramid::trimCache(const QString &cacheDirectory, qint64 limit, const QString &kept)
+{
+    struct Entry
+    {
+        QString path;
+        QDateTime lastUsed;
+        qint64 size;
+    };
+    QList<Entry> entries;
+    qint64 total = 0;
+    const QDir root(cacheDirectory);
+    foreach (auto &info, root.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        Entry entry;
+        entry.path = info.absoluteFilePath();
+        entry.size = 0;
+        foreach (auto &file, QDir(entry.path).entryInfoList(QDir::Files)) {
+            entry.size += file.size();
+        }
+        /* Without manifest (incomplete), the date of the directory */
+        const QFileInfo manifest(entry.path + QLatin1Char('/') + QLatin1String(C_IMAGE_MANIFEST_FILE));
+        entry.lastUsed = manifest.exists() ? manifest.lastModified() : info.lastModified();
+        total += entry.size;
+        if (entry.path != QFileInfo(kept).absoluteFilePath()) {
+            entries.append(entry);
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.lastUsed < b.lastUsed;
+    });
+    foreach (auto &entry, entries) {
+        if (total <= limit) {
+            break;
+        }
+        if (QDir(entry.path).removeRecursively()) {
+            total -= entry.size;
+        }
+    }
+}
+
+/* The sub-directory changes when the file is modified. */
+QString ImagePyramid::tileDirectory(const QString &cacheDirectory, const QString &fileName)
+{
+    const QFileInfo info(fileName);
+    const QString id = QString("%0|%1|%2").arg(
+                info.absoluteFilePath(),
+                QString::number(info.size()),
+                QString::number(info.lastModified().toMSecsSinceEpoch()));
+    const QByteArray hash = QCryptographicHash::hash(id.toUtf8(), QCryptographicHash::Md5);
+    return cacheDirectory + QLatin1Char('/') + QString::fromLatin1(hash.toHex());
+}
+
+QString ImagePyramid::tilePath(const QString &tileDirectory, int level, int column, int row)
+{
+    return QString("%0/%1_%2_%3.png").arg(
+                tileDirectory, QString::number(level),
+                QString::number(column), QString::number(row));
+}
@@ -0,0 +1,110 @@
+/* - FastenerPattern - Copyright (C) 2016 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EDITOR_IMAGE_PYRAMID_H
+#define EDITOR_IMAGE_PYRAMID_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCache>
+#include <QtCore/QObject>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QSize>
+#include <QtCore/QString>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+#include <QtGui/QPixmap>
+
+class ImagePyramid : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ImagePyramid(QObject *parent = Q_NULLPTR);
+    ~ImagePyramid();
+
+    bool isRunning() const;
+    bool isReady() const;
+    QString fileName() const;
+
+    QString cacheDirectory() const;
+    void setCacheDirectory(const QString &path);
+    qint64 cacheSizeLimit() const;
+    void setCacheSizeLimit(qint64 bytes);
+
+    bool load(const QString &fileName);
+    void clear();
+
+    QSize size() const;
+    int levelCount() const;
+    QSize levelSize(int level) const;
+    int levelForScale(qreal scale) const;
+
+    static int tileSize();
+    int columnCount(int level) const;
+    int rowCount(int level) const;
+    QPixmap tile(int level, int column, int row);
+
+public Q_SLOTS:
+    void cancel();
+
+Q_SIGNALS:
+    void loaded(QString fileName);
+    void failed(QString fileName, QString error);
+
+private Q_SLOTS:
+    void _q_finished(int generation);
+
+private:
+    friend class ImagePyramidTask;
+
+    struct Job
+    {
+        int generation;
+        QString fileName;
+        QString tileDirectory;      /* Empty without cache directory */
+        QString cacheDirectory;
+        qint64 cacheSizeLimit;
+        QAtomicInt cancelRequested;
+        bool success;
+        QString error;
+        QVector<QSize> levelSizes;
+        QVector<QVector<QImage> > tiles;
+    };
+
+    QThreadPool m_pool;
+    QString m_cacheDirectory;
+    qint64 m_cacheSizeLimit;
+    QSharedPointer<Job> m_job;
+    int m_generation;
+    bool m_running;
+    bool m_ready;
+
+    QVector<QSize> m_levelSizes;
+    QVector<QVector<QImage> > m_tiles;
+    QCache<quint64, QPixmap> m_pixmaps;
+
+    void runAsync(QSharedPointer<Job> job);
+    static bool build(Job *job);
+    static bool readCache(Job *job);
+    static bool writeCache(const Job *job, const QVector<QVector<QImage> > &tiles);
+    static bool writeManifest(const Job *job);
+    static void trimCache(const QString &cacheDirectory, qint64 limit, const QString &kept);
+    static QString tileDirectory(const QString &cacheDirectory, const QString &fileName);
+    static QString tilePath(const QString &tileDirectory, int level, int column, int row);
+};
+
+#endif // EDITOR_IMAGE_PYRAMID_H
@@ -23,9 +23,20 @@
 #include <QtGui/QCursor>
 #include <QtGui/QPainter>
 
+/*! \class FastenerItem
+ *  \brief Draw a fastener, with its symbol and the arrows of its result.
+ *
+ * When the item is not detailed (see setDetailed()), the symbol is hidden
+ * and the arrows are deleted. The item can still be selected and moved,
+ * but the PatternLayerItem draws it.
+ */
 FastenerItem::FastenerItem(QGraphicsItem *parent) : QGraphicsObject(parent)
   , m_tensorItem(new TensorItem(this))
   , m_symbolItem(new SymbolItem(this))
+  , m_componentVisible(m_tensorItem->isComponentVisible())
+  , m_resultantVisible(m_tensorItem->isResultantVisible())
+  , m_torqueVisible(m_tensorItem->isTorqueVisible())
+  , m_labelVisible(m_tensorItem->isLabelVisible())
 {
     this->setFlag(QGraphicsItem::ItemIsMovable);
     this->setFlag(QGraphicsItem::ItemIsSelectable);
@@ -83,61 +94,105 @@ void FastenerItem::setDiameterInMeter(qreal diameter_in_meter)
 
 Tensor FastenerItem::result() const
 {
-    Q_ASSERT(m_tensorItem);
-    return m_tensorItem->tensor();
+    return m_result;
 }
 
 void FastenerItem::setResult(const Tensor &tensor)
-{    
-    Q_ASSERT(m_tensorItem);
-    m_tensorItem->setTensor(tensor);
+{
+    m_result = tensor;
+    if (m_tensorItem) {
+        m_tensorItem->setTensor(tensor);
+    }
     QGraphicsItem::update();
 }
 
 bool FastenerItem::isComponentVisible() const
 {
-    Q_ASSERT(m_tensorItem);
-    return m_tensorItem->isComponentVisible();
+    return m_componentVisible;
 }
 
 void FastenerItem::setComponentVisible(bool visible)
 {
-    Q_ASSERT(m_tensorItem);
-    m_tensorItem->setComponentVisible(visible);
+    m_componentVisible = visible;
+    if (m_tensorItem) {
+        m_tensorItem->setComponentVisible(visible);
+    }
 }
 
 bool FastenerItem::isResultantVisible() const
 {
-    Q_ASSERT(m_tensorItem);
-    return m_tensorItem->isResultantVisible();
+    return m_resultantVisible;
 }
 
 void FastenerItem::setResultantVisible(bool visible)
 {
-    Q_ASSERT(m_tensorItem);
-    m_tensorItem->setResultantVisible(visible);
+    m_resultantVisible = visible;
+    if (m_tensorItem) {
+        m_tensorItem->setResultantVisible(visible);
+    }
 }
 
 bool FastenerItem::isTorqueVisible() const
 {
-    Q_ASSERT(m_tensorItem);
-    return m_tensorItem->isTorqueVisible();
+    return m_torqueVisible;
 }
 
 void FastenerItem::setTorqueVisible(bool visible)
 {
-    Q_ASSERT(m_tensorItem);
-    m_tensorItem->setTorqueVisible(visible);
+    m_torqueVisible = visible;
+    if (m_tensorItem) {
+        m_tensorItem->setTorqueVisible(visible);
+    }
 }
 
 bool FastenerItem::isLabelVisible() const
 {
-    Q_ASSERT(m_tensorItem);
-    return m_tensorItem->isLabelVisible();
+    return m_labelVisible;
 }
 
 void FastenerItem::setLabelVisible(bool visible)
+{
+    m_labelVisible = visible;
+    if (m_tensorItem) {
+        m_tensorItem->setLabelVisible(visible);
+    }
+}
+
+/*! \brief Returns true if the item draws its symbol and its arrows.
+ * Default is true.
+ */
+bool FastenerItem::isDetailed() const
+{
+    return m_tensorItem != Q_NULLPTR;
+}
+
+/*! \brief Creates the arrows if \a detailed is true,
+ * otherwise deletes them, to keep the scene small.
+ */
+void FastenerItem::setDetailed(bool detailed)
+{
+    Q_ASSERT(m_symbolItem);
+    if (detailed == isDetailed()) {
+        return;
+    }
+    if (detailed) {
+        m_tensorItem = new TensorItem(this);
+        updateTensorItem();
+        this->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    } else {
+        delete m_tensorItem;
+        m_tensorItem = Q_NULLPTR;
+        this->setCacheMode(QGraphicsItem::NoCache);
+    }
+    m_symbolItem->setVisible(detailed);
+}
+
+void FastenerItem::updateTensorItem()
 {
     Q_ASSERT(m_tensorItem);
-    m_tensorItem->setLabelVisible(visible);
+    m_tensorItem->setComponentVisible(m_componentVisible);
+    m_tensorItem->setResultantVisible(m_resultantVisible);
+    m_tensorItem->setTorqueVisible(m_torqueVisible);
+    m_tensorItem->setLabelVisible(m_labelVisible);
+    m_tensorItem->setTensor(m_result);
 }
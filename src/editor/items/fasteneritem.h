@@ -33,6 +33,7 @@ class FastenerItem : public QGraphicsObject
     Q_PROPERTY(bool resultantVisible READ isResultantVisible WRITE setResultantVisible)
     Q_PROPERTY(bool torqueVisible READ isTorqueVisible WRITE setTorqueVisible)
     Q_PROPERTY(bool labelVisible READ isLabelVisible WRITE setLabelVisible)
+    Q_PROPERTY(bool detailed READ isDetailed WRITE setDetailed)
 
 public:
     explicit FastenerItem(QGraphicsItem *parent = Q_NULLPTR);
@@ -63,9 +64,19 @@ public:
     bool isLabelVisible() const;
     void setLabelVisible(bool visible);
 
+    bool isDetailed() const;
+    void setDetailed(bool detailed);
+
 private:
-    TensorItem *m_tensorItem;
+    TensorItem *m_tensorItem; /* Null when not detailed */
     SymbolItem *m_symbolItem;
+    Tensor m_result;
+    bool m_componentVisible;
+    bool m_resultantVisible;
+    bool m_torqueVisible;
+    bool m_labelVisible;
+
+    void updateTensorItem();
 
 };
 
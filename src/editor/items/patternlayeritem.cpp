@@ -0,0 +1,321 @@
+/* - FastenerPattern - Copyright (C) 2016 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "patternlayeritem.h"
+#include "utils_scale.h"
+
+#include <QtCore/qnumeric.h>  /* qIsFinite() */
+#include <QtCore/QtMath>      /* M_PI */
+#include <QtGui/QPainter>
+#include <QtWidgets/QStyleOptionGraphicsItem>
+
+/*! \class PatternLayerItem
+ *  \brief Draw all the fasteners of the pattern, and their loads, in a single paint.
+ *
+ * With thousands of fasteners, the FastenerItem and its children (symbol,
+ * arrows and labels) make tens of thousands of items in the scene.
+ * When zoomed out, the details are too small to be seen anyway.
+ *
+ * The PatternLayerItem keeps the positions, diameters and loads of the
+ * fasteners in packed arrays, and draws them as simple circles and arrows,
+ * batched by color, in one pass.
+ *
+ * The layer draws only when it's not detailed. When the zoom
+ * (i.e. the level of detail) crosses detailThreshold(), the layer emits
+ * detailRequested(). The receiver shows or hides the per-item graphics,
+ * then calls setDetailed(). The signal is emitted during the paint, thus
+ * it must be connected with a Qt::QueuedConnection.
+ *
+ * The small patterns (less than C_PATTERN_LAYER_MIN_COUNT fasteners)
+ * are always detailed.
+ *
+ * \remark The torques and the labels are not drawn by the layer.
+ */
+PatternLayerItem::PatternLayerItem(QGraphicsItem *parent) : QGraphicsObject(parent)
+  , m_detailed(true)
+  , m_detailThreshold(C_PATTERN_LAYER_DETAIL_THRESHOLD)
+  , m_componentVisible(false)
+  , m_resultantVisible(true)
+{
+    this->setFlag(QGraphicsItem::ItemUsesExtendedStyleOption); /* exposedRect */
+    this->setAcceptedMouseButtons(Qt::NoButton);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+QRectF PatternLayerItem::boundingRect() const
+{
+    return m_boundingRect;
+}
+
+void PatternLayerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
+{
+    const int count = m_positions.count();
+    const qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+    const bool detailed = (count < C_PATTERN_LAYER_MIN_COUNT) || (lod >= m_detailThreshold);
+    if (detailed != m_detailed) {
+        emit detailRequested(detailed);
+    }
+    if (m_detailed || lod <= 0) {
+        return; /* The fastener items draw themselves */
+    }
+
+    const QRectF exposed = option->exposedRect;
+    const QColor green(133,189,60);
+
+    /* Fasteners: a circle, or a point when too small. The selected ones last. */
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool selected = (pass == 1);
+        QPolygonF points;
+        painter->setPen(QPen(selected ? green : Qt::black, 0)); /* cosmetic */
+        painter->setBrush(Qt::NoBrush);
+        for (int i = 0; i < count; ++i) {
+            if (m_selected.at(i) != selected || !exposed.intersects(extent(i))) {
+                continue;
+            }
+            const qreal diameter = m_diameters.at(i);
+            if (diameter * lod < C_PATTERN_LAYER_MIN_SYMBOL_SIZE) {
+                points << m_positions.at(i);
+            } else {
+                painter->drawEllipse(m_positions.at(i), diameter / 2, diameter / 2);
+            }
+        }
+        QPen pointPen(selected ? green : Qt::black, C_PATTERN_LAYER_MIN_SYMBOL_SIZE,
+                      Qt::SolidLine, Qt::RoundCap);
+        pointPen.setCosmetic(true);
+        painter->setPen(pointPen);
+        painter->drawPoints(points);
+    }
+
+    /* Arrows: one batch of lines per color. */
+    struct Batch { bool visible; QColor color; qreal fx; qreal fy; };
+    const Batch batches[3] = {
+        { m_resultantVisible, QColor(255,127, 39), 1, 1 },   // orange
+        { m_componentVisible, QColor(237, 28, 36), 1, 0 },   // red
+        { m_componentVisible, QColor( 34,177, 76), 0, 1 }    // green
+    };
+    for (const Batch &batch : batches) {
+        if (!batch.visible) {
+            continue;
+        }
+        m_lines.resize(0);
+        for (int i = 0; i < count; ++i) {
+            if (!exposed.intersects(extent(i))) {
+                continue;
+            }
+            const QPointF &load = m_loads.at(i);
+            appendArrow(m_positions.at(i), QPointF(load.x() * batch.fx, load.y() * batch.fy), lod);
+        }
+        QPen pen(batch.color, 1.5, Qt::SolidLine, Qt::FlatCap, Qt::MiterJoin);
+        pen.setCosmetic(true);
+        painter->setPen(pen);
+        painter->drawLines(m_lines);
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int PatternLayerItem::count() const
+{
+    return m_positions.count();
+}
+
+/*! \brief Inserts the fasteners at the given \a positions, with the
+ * given \a diameters, before the index \a first.
+ * The values are in scene coordinates. The loads are null.
+ */
+void PatternLayerItem::insertFasteners(int first, const QVector<QPointF> &positions,
+                                       const QVector<qreal> &diameters)
+{
+    Q_ASSERT(positions.count() == diameters.count());
+    const int count = positions.count();
+    if (first >= m_positions.count()) {
+        first = m_positions.count();
+        m_positions += positions;
+        m_diameters += diameters;
+    } else {
+        first = qMax(0, first);
+        m_positions = m_positions.mid(0, first) + positions + m_positions.mid(first);
+        m_diameters = m_diameters.mid(0, first) + diameters + m_diameters.mid(first);
+    }
+    m_loads.insert(first, count, QPointF());
+    m_selected.insert(first, count, false);
+    for (int i = first; i < first + count; ++i) {
+        growBoundingRect(extent(i));
+    }
+    QGraphicsItem::update();
+}
+
+void PatternLayerItem::setFastener(int index, const QPointF &position, qreal diameter)
+{
+    if (index >= 0 && index < m_positions.count()) {
+        m_positions[index] = position;
+        m_diameters[index] = diameter;
+        growBoundingRect(extent(index));
+        QGraphicsItem::update();
+    }
+}
+
+void PatternLayerItem::removeFasteners(int first, int last)
+{
+    const int from = qMax(0, first);
+    const int to = qMin(last, m_positions.count() - 1);
+    if (from <= to) {
+        const int count = to - from + 1;
+        m_positions.remove(from, count);
+        m_diameters.remove(from, count);
+        m_loads.remove(from, count);
+        m_selected.remove(from, count);
+        updateBoundingRect();
+        QGraphicsItem::update();
+    }
+}
+
+/*! \brief Sets the load of each fastener, as a vector in scene coordinates
+ * (i.e. the Y axis is inverted).
+ */
+void PatternLayerItem::setLoads(const QVector<QPointF> &loads)
+{
+    Q_ASSERT(loads.count() == m_positions.count());
+    m_loads = loads;
+    m_loads.resize(m_positions.count());
+    updateBoundingRect();
+    QGraphicsItem::update();
+}
+
+/* Changes the selection state of the given indexes only. */
+void PatternLayerItem::select(const QSet<int> &selected, const QSet<int> &deselected)
+{
+    foreach (auto index, deselected) {
+        if (index >= 0 && index < m_selected.count()) {
+            m_selected[index] = false;
+        }
+    }
+    foreach (auto index, selected) {
+        if (index >= 0 && index < m_selected.count()) {
+            m_selected[index] = true;
+        }
+    }
+    QGraphicsItem::update();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Returns true if the fastener items draw themselves.
+ * Otherwise, the layer draws the fasteners.
+ */
+bool PatternLayerItem::isDetailed() const
+{
+    return m_detailed;
+}
+
+void PatternLayerItem::setDetailed(bool detailed)
+{
+    m_detailed = detailed;
+    QGraphicsItem::update();
+}
+
+/*! \brief Returns the level of detail (the zoom of the view)
+ * from which the fastener items draw themselves.
+ */
+qreal PatternLayerItem::detailThreshold() const
+{
+    return m_detailThreshold;
+}
+
+void PatternLayerItem::setDetailThreshold(qreal levelOfDetail)
+{
+    m_detailThreshold = levelOfDetail;
+    QGraphicsItem::update();
+}
+
+bool PatternLayerItem::isComponentVisible() const
+{
+    return m_componentVisible;
+}
+
+void PatternLayerItem::setComponentVisible(bool visible)
+{
+    m_componentVisible = visible;
+    QGraphicsItem::update();
+}
+
+bool PatternLayerItem::isResultantVisible() const
+{
+    return m_resultantVisible;
+}
+
+void PatternLayerItem::setResultantVisible(bool visible)
+{
+    m_resultantVisible = visible;
+    QGraphicsItem::update();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/* Returns the area covered by the fastener and its load arrow. */
+QRectF PatternLayerItem::extent(int index) const
+{
+    const QPointF &position = m_positions.at(index);
+    const qreal axes = m_diameters.at(index) * C_SYMBOL_PERCENT_AXES_LENGTH / 2.0;
+    QRectF rect(position.x() - axes, position.y() - axes, 2 * axes, 2 * axes);
+
+    const QPointF &load = m_loads.at(index);
+    if (qIsFinite(load.x()) && qIsFinite(load.y()) && !load.isNull()) {
+        /* The arrow head is at most a third of the arrow. */
+        const qreal head = qSqrt(load.x() * load.x() + load.y() * load.y()) / 3.0;
+        rect |= QRectF(position, position + load).normalized().adjusted(-head, -head, head, head);
+    }
+    return rect;
+}
+
+/* The rect only grows, to not iterate over all the fasteners at each change. */
+void PatternLayerItem::growBoundingRect(const QRectF &rect)
+{
+    if (!m_boundingRect.contains(rect)) {
+        QGraphicsItem::prepareGeometryChange();
+        m_boundingRect |= rect;
+    }
+}
+
+void PatternLayerItem::updateBoundingRect()
+{
+    QRectF rect;
+    for (int i = 0; i < m_positions.count(); ++i) {
+        rect |= extent(i);
+    }
+    QGraphicsItem::prepareGeometryChange();
+    m_boundingRect = rect;
+}
+
+/* Appends the arrow as 3 lines: the shaft and the two sides of the head.
+ * The head has a constant size on the screen, at the given level of detail. */
+void PatternLayerItem::appendArrow(const QPointF &origin, const QPointF &vector, qreal lod)
+{
+    const qreal length = qSqrt(vector.x() * vector.x() + vector.y() * vector.y());
+    if (!qIsFinite(length) || length <= 0.0) {
+        return;
+    }
+    const qreal head = qMin(qreal(C_ARROW_SIZE) / lod, length / 3.0);
+    const qreal angle = qAtan2(vector.y(), vector.x());
+    const QPointF p0 = origin + vector;
+    const QPointF p1 = p0 - QPointF(qCos(angle + M_PI * 0.1) * head,
+                                    qSin(angle + M_PI * 0.1) * head);
+    const QPointF p2 = p0 - QPointF(qCos(angle - M_PI * 0.1) * head,
+                                    qSin(angle - M_PI * 0.1) * head);
+    m_lines << QLineF(origin, p0) << QLineF(p0, p1) << QLineF(p0, p2);
+}
@@ -0,0 +1,84 @@
+/* - FastenerPattern - Copyright (C) 2016 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EDITOR_ITEMS_PATTERN_LAYER_ITEM_H
+#define EDITOR_ITEMS_PATTERN_LAYER_ITEM_H
+
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+#include <QtWidgets/QGraphicsObject>
+
+class PatternLayerItem : public QGraphicsObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool detailed READ isDetailed WRITE setDetailed)
+    Q_PROPERTY(qreal detailThreshold READ detailThreshold WRITE setDetailThreshold)
+    Q_PROPERTY(bool componentVisible READ isComponentVisible WRITE setComponentVisible)
+    Q_PROPERTY(bool resultantVisible READ isResultantVisible WRITE setResultantVisible)
+
+public:
+    explicit PatternLayerItem(QGraphicsItem *parent = Q_NULLPTR);
+
+    QRectF boundingRect() const Q_DECL_OVERRIDE;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *) Q_DECL_OVERRIDE;
+
+    int count() const;
+    void insertFasteners(int first, const QVector<QPointF> &positions, const QVector<qreal> &diameters);
+    void setFastener(int index, const QPointF &position, qreal diameter);
+    void removeFasteners(int first, int last);
+
+    void setLoads(const QVector<QPointF> &loads);
+    void select(const QSet<int> &selected, const QSet<int> &deselected);
+
+    bool isDetailed() const;
+    void setDetailed(bool detailed);
+
+    qreal detailThreshold() const;
+    void setDetailThreshold(qreal levelOfDetail);
+
+    bool isComponentVisible() const;
+    void setComponentVisible(bool visible);
+
+    bool isResultantVisible() const;
+    void setResultantVisible(bool visible);
+
+Q_SIGNALS:
+    void detailRequested(bool detailed);
+
+private:
+    /* Packed arrays, one entry per fastener, in scene coordinates. */
+    QVector<QPointF> m_positions;
+    QVector<qreal> m_diameters;
+    QVector<QPointF> m_loads;
+    QVector<bool> m_selected;
+
+    QRectF m_boundingRect;
+    bool m_detailed;
+    qreal m_detailThreshold;
+    bool m_componentVisible;
+    bool m_resultantVisible;
+
+    /* Painting buffers, kept from one paint to the next. */
+    QVector<QLineF> m_lines;
+
+    QRectF extent(int index) const;
+    void growBoundingRect(const QRectF &rect);
+    void updateBoundingRect();
+    void appendArrow(const QPointF &origin, const QPointF &vector, qreal lod);
+};
+
+#endif // EDITOR_ITEMS_PATTERN_LAYER_ITEM_H
@@ -16,12 +16,15 @@
 
 #include "scalableimageitem.h"
 #include "handleitem.h"
+#include "../imagepyramid.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QFileInfo>
 #include <QtGui/QCursor>
 #include <QtGui/QPainter>
 #include <QtGui/QPen>
 #include <QtWidgets/QGraphicsScene>
+#include <QtWidgets/QStyleOptionGraphicsItem>
 
 /******************************************************************************
  ******************************************************************************/
@@ -40,15 +43,35 @@ void ScalableImageObject::onCornerPositionChanged()
     m_parent->setCorner(item);
 }
 
+void ScalableImageObject::onImageLoaded()
+{
+    m_parent->updateImage();
+}
+
+void ScalableImageObject::onImageFailed(const QString &fileName, const QString &error)
+{
+    qWarning("ScalableImage: cannot load the image %s: %s",
+             qPrintable(fileName), qPrintable(error));
+}
+
 
 /******************************************************************************
  ******************************************************************************/
+/*! \class ScalableImageItem
+ *  \brief Draw the background image, that the user can move and resize.
+ *
+ * The image is loaded into an ImagePyramid in a worker thread, and only
+ * the exposed tiles are painted, at the level of resolution of the screen.
+ * Thus the huge scanned drawings don't freeze the editor.
+ */
 ScalableImageItem::ScalableImageItem(QGraphicsItem *parent) : QGraphicsObject(parent)
   , m_object(new ScalableImageObject(this))
+  , m_pyramid(new ImagePyramid(this))
   , m_rect(QRectF())
 {
     this->setFlag(QGraphicsItem::ItemIsMovable);
     this->setFlag(QGraphicsItem::ItemIsSelectable);
+    this->setFlag(QGraphicsItem::ItemUsesExtendedStyleOption); /* exposedRect */
     this->setCursor(Qt::SizeAllCursor);
     this->setZValue(-100); /* Below the axes (Z=0), above the grid (background) */
 
@@ -66,6 +89,10 @@ ScalableImageItem::ScalableImageItem(QGraphicsItem *parent) : QGraphicsObject(pa
         QObject::connect(item, SIGNAL(xChanged()), m_object, SLOT(onCornerPositionChanged()));
         QObject::connect(item, SIGNAL(yChanged()), m_object, SLOT(onCornerPositionChanged()));
     }
+
+    QObject::connect(m_pyramid, SIGNAL(loaded(QString)), m_object, SLOT(onImageLoaded()));
+    QObject::connect(m_pyramid, SIGNAL(failed(QString,QString)),
+                     m_object, SLOT(onImageFailed(QString,QString)));
 }
 
 ScalableImageItem::~ScalableImageItem()
@@ -91,19 +118,41 @@ void ScalableImageItem::setUrl(const QUrl &url)
     m_url = url;
 
     QString imagePath = url.path();
-    QPixmap image(url.path());
-    if (image.isNull()) {
-        image.load(imagePath.right(imagePath.size() - 1));
+    if (!QFileInfo(imagePath).isFile()) {
+        imagePath = imagePath.right(imagePath.size() - 1);
     }
-    m_pixmap = image;
-    if (!m_pixmap.isNull()) {
-        m_rect = m_pixmap.rect();
+    m_pyramid->load(imagePath); /* updateImage() when loaded */
+    this->scene()->update();
+}
+
+/*! \brief Returns the directory where the tiles of the images are cached.
+ * If empty (default), the tiles aren't saved to the disk.
+ */
+QString ScalableImageItem::cacheDirectory() const
+{
+    return m_pyramid->cacheDirectory();
+}
+
+void ScalableImageItem::setCacheDirectory(const QString &path)
+{
+    m_pyramid->setCacheDirectory(path);
+}
+
+/*! \brief Fits the rect to the image, once loaded.
+ */
+void ScalableImageItem::updateImage()
+{
+    if (m_pyramid->isReady()) {
+        QGraphicsItem::prepareGeometryChange();
+        m_rect = QRectF(QPointF(0, 0), m_pyramid->size());
         m_handles[0]->setPos(m_rect.topLeft());
         m_handles[1]->setPos(m_rect.topRight());
         m_handles[2]->setPos(m_rect.bottomLeft());
         m_handles[3]->setPos(m_rect.bottomRight());
     }
-    this->scene()->update();
+    if (this->scene()) {
+        this->scene()->update();
+    }
 }
 
 QRectF ScalableImageItem::rect() const
@@ -112,7 +161,8 @@ QRectF ScalableImageItem::rect() const
 }
 void ScalableImageItem::setRect(const QRectF &rect)
 {
-    if (m_pixmap.height() == 0 || m_pixmap.width() == 0){
+    const QSize imageSize = m_pyramid->size();
+    if (imageSize.height() <= 0 || imageSize.width() <= 0){
         qWarning("ScalableImage::setRect() warning: current pixmap has 0-dimension!");
         return;
     }
@@ -120,7 +170,7 @@ void ScalableImageItem::setRect(const QRectF &rect)
         qWarning("ScalableImage::setRect() warning: given rect has 0-dimension!");
         return;
     }
-    qreal imageAR = (qreal)m_pixmap.height() / (qreal)m_pixmap.width();
+    qreal imageAR = (qreal)imageSize.height() / (qreal)imageSize.width();
     qreal rectAR = rect.height() / rect.width();
     m_rect = rect;
     if (imageAR > rectAR) {
@@ -169,11 +219,12 @@ QRectF ScalableImageItem::boundingRect() const
             | m_handles[2]->boundingRect() | m_handles[3]->boundingRect();
 }
 
-void ScalableImageItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+void ScalableImageItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
 {
-    const bool _isSelected = !m_pixmap.isNull() && isSelected();
-    if (!m_pixmap.isNull()) {
-        painter->drawPixmap(m_rect.toRect(), m_pixmap);
+    const bool ready = m_pyramid->isReady();
+    const bool _isSelected = ready && isSelected();
+    if (ready) {
+        paintTiles(painter, option);
         if (_isSelected) {
             painter->setPen(QPen(Qt::blue, 1));
             painter->setBrush(Qt::NoBrush);
@@ -185,3 +236,48 @@ void ScalableImageItem::paint(QPainter *painter, const QStyleOptionGraphicsItem
         painter->drawRect(m_rect);
     }
 }
+
+/* Paints the exposed tiles, at the level that fits the zoom. */
+void ScalableImageItem::paintTiles(QPainter *painter, const QStyleOptionGraphicsItem *option)
+{
+    const QRectF rect = m_rect.normalized();
+    const QSize size = m_pyramid->size();
+    if (rect.isEmpty() || size.isEmpty()) {
+        return;
+    }
+    const qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+    const qreal scale = lod * qMax(rect.width() / size.width(),
+                                   rect.height() / size.height());
+    const int level = m_pyramid->levelForScale(scale);
+    const QSize levelSize = m_pyramid->levelSize(level);
+
+    /* From the level's pixels to the item's coordinates. */
+    const qreal sx = rect.width() / levelSize.width();
+    const qreal sy = rect.height() / levelSize.height();
+    const QRectF exposed = option->exposedRect & rect;
+    if (exposed.isEmpty()) {
+        return;
+    }
+    const int tile = ImagePyramid::tileSize();
+    const int c0 = qMax(0, int((exposed.left() - rect.left()) / sx) / tile);
+    const int c1 = qMin(m_pyramid->columnCount(level) - 1,
+                        int((exposed.right() - rect.left()) / sx) / tile);
+    const int r0 = qMax(0, int((exposed.top() - rect.top()) / sy) / tile);
+    const int r1 = qMin(m_pyramid->rowCount(level) - 1,
+                        int((exposed.bottom() - rect.top()) / sy) / tile);
+
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    for (int row = r0; row <= r1; ++row) {
+        for (int column = c0; column <= c1; ++column) {
+            const QPixmap pixmap = m_pyramid->tile(level, column, row);
+            if (pixmap.isNull()) {
+                continue;
+            }
+            const QRectF target(rect.left() + column * tile * sx,
+                                rect.top() + row * tile * sy,
+                                pixmap.width() * sx,
+                                pixmap.height() * sy);
+            painter->drawPixmap(target, pixmap, QRectF(pixmap.rect()));
+        }
+    }
+}
@@ -23,6 +23,7 @@
 #include <QtWidgets/QGraphicsObject>
 
 class HandleItem;
+class ImagePyramid;
 class ScalableImageItem;
 
 /******************************************************************************
@@ -35,6 +36,8 @@ public:
 
 public Q_SLOTS:
     void onCornerPositionChanged();
+    void onImageLoaded();
+    void onImageFailed(const QString &fileName, const QString &error);
 
 private:
     ScalableImageItem *m_parent;
@@ -49,7 +52,7 @@ public:
     ~ScalableImageItem();
 
     QRectF boundingRect() const Q_DECL_OVERRIDE;
-    void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *) Q_DECL_OVERRIDE;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *) Q_DECL_OVERRIDE;
 
     void setObjectVisible(bool visible);
 
@@ -60,14 +63,20 @@ public:
 
     void setCorner(const HandleItem *item);
 
+    QString cacheDirectory() const;
+    void setCacheDirectory(const QString &path);
+
+    void updateImage();
 
 private:
     ScalableImageObject *m_object;
     HandleItem *m_handles[4];
-    QPixmap m_pixmap;
+    ImagePyramid *m_pyramid;
     QRectF m_rect;
     QUrl m_url;
 
+    void paintTiles(QPainter *painter, const QStyleOptionGraphicsItem *option);
+
 
 };
 
@@ -43,4 +43,11 @@
 #define C_ARROW_SIZE 10      /* pixels */
 
 
+/* Level of Detail */
+/* NB: below the threshold zoom, the fasteners are drawn by the pattern layer. */
+#define C_PATTERN_LAYER_DETAIL_THRESHOLD   0.25  /* view scale */
+#define C_PATTERN_LAYER_MIN_COUNT          100   /* fasteners */
+#define C_PATTERN_LAYER_MIN_SYMBOL_SIZE    3     /* pixels */
+
+
 #endif // EDITOR_ITEMS_SCALE_H
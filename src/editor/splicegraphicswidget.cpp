@@ -21,21 +21,37 @@
 #include "items/designspaceitem.h"
 #include "items/fasteneritem.h"
 #include "items/measureitem.h"
+#include "items/patternlayeritem.h"
 #include "items/utils_scale.h"
 
 #include <Core/AbstractSpliceModel>
 #include <Core/Fastener>
 #include <Core/Tensor>
 #include <Core/DesignSpace>
-#include <Math/Delaunay>
 
+#include <QtCore/QEvent>
+#include <QtCore/QMap>
 #include <QtCore/QSet>
+#include <QtCore/QTimer>
+#include <QtWidgets/QApplication>
 #include <QtWidgets/QVBoxLayout>
 #include <QtWidgets/QGroupBox>
 #include <QtWidgets/QGraphicsScene>
 
+#define C_FRAME_INTERVAL_MSEC 16   /* About 60 frames per second */
+
 /*! \class SpliceGraphicsWidget
  *  \brief The class SpliceGraphicsWidget is the main GUI Graphics View.
+ *
+ * When the user drags the fasteners, their moves are accumulated and
+ * applied to the model at most once per frame, as a single multi-fastener
+ * edit. The whole drag, until the mouse release, is a single transaction
+ * of the model, i.e. a single undo command.
+ *
+ * Each item keeps the stable ID of its element in the model, rather
+ * than its index, which shifts when elements are inserted or removed.
+ * The selection is exchanged with the model as changes only, so that
+ * selecting or moving a few items doesn't scan all the items.
  */
 
 SpliceGraphicsWidget::SpliceGraphicsWidget(QWidget *parent) : AbstractSpliceView(parent)
@@ -48,6 +64,8 @@ SpliceGraphicsWidget::SpliceGraphicsWidget(QWidget *parent) : AbstractSpliceView
   , m_snapEnable(false)
   , m_distanceVisible(false)
   , m_designSpaceVisible(true)
+  , m_moveTimer(new QTimer(this))
+  , m_moving(false)
 {
     m_backgroundWidget->setFlags(
                 QFlags<BackgroundWidget::Feature>(
@@ -67,10 +85,24 @@ SpliceGraphicsWidget::SpliceGraphicsWidget(QWidget *parent) : AbstractSpliceView
     QObject::connect(m_backgroundWidget->scene(), SIGNAL(selectionChanged()),
                      this, SLOT(onSelectionChanged()));
 
+    /* Detects the end of the drags. */
+    m_backgroundWidget->scene()->installEventFilter(this);
+
+    m_moveTimer->setSingleShot(true);
+    m_moveTimer->setInterval(C_FRAME_INTERVAL_MSEC);
+    QObject::connect(m_moveTimer, SIGNAL(timeout()), this, SLOT(flushMovedFasteners()));
+
     /* Create immuable items. */
     m_appliedLoadItem = new AppliedLoadItem();
     m_backgroundWidget->scene()->addItem(m_appliedLoadItem);
 
+    /* The layer requests the level of detail while painting: the items
+     * are created or deleted after the paint. */
+    m_patternLayerItem = new PatternLayerItem();
+    m_backgroundWidget->scene()->addItem(m_patternLayerItem);
+    QObject::connect(m_patternLayerItem, SIGNAL(detailRequested(bool)),
+                     this, SLOT(onDetailRequested(bool)), Qt::QueuedConnection);
+
     /// \todo Auto resize instead ?
     m_backgroundWidget->scene()->setSceneRect(-1000, -1000, 2000, 2000);
 }
@@ -87,29 +119,47 @@ void SpliceGraphicsWidget::update()
 
 /******************************************************************************
  ******************************************************************************/
+/* Compares the items selected now with those selected before,
+ * and sends the changes only. */
 void SpliceGraphicsWidget::onSelectionChanged()
 {
-    {
-        /* fastener items */
-        QSet<int> set;
-        for (int i = 0; i < m_fastenerItems.count(); ++i) {
-            FastenerItem* item = m_fastenerItems.at(i);
-            if (item->isSelected()) {
-                set << i;
-            }
-        }
-        model()->setFastenerSelection(set);
+    QSet<QGraphicsItem*> items;
+    foreach (auto item, m_backgroundWidget->scene()->selectedItems()) {
+        items.insert(item);
     }
-    {
-        /* design space items */
-        QSet<int> set;
-        for (int i = 0; i < m_designSpaceItems.count(); ++i) {
-            DesignSpaceItem* item = m_designSpaceItems.at(i);
-            if (item->isSelected()) {
-                set << i;
+    const QSet<QGraphicsItem*> selectedItems = QSet<QGraphicsItem*>(items).subtract(m_selectedItems);
+    const QSet<QGraphicsItem*> deselectedItems = m_selectedItems.subtract(items);
+    m_selectedItems = items;
+
+    QSet<int> selectedFasteners;
+    QSet<int> selectedDesignSpaces;
+    indexesOf(selectedItems, &selectedFasteners, &selectedDesignSpaces);
+
+    QSet<int> deselectedFasteners;
+    QSet<int> deselectedDesignSpaces;
+    indexesOf(deselectedItems, &deselectedFasteners, &deselectedDesignSpaces);
+
+    m_patternLayerItem->select(selectedFasteners, deselectedFasteners);
+    model()->selectFasteners(selectedFasteners, deselectedFasteners);
+    model()->selectDesignSpaces(selectedDesignSpaces, deselectedDesignSpaces);
+}
+
+/* Finds the model indexes of the given fastener and design space \a items. */
+void SpliceGraphicsWidget::indexesOf(const QSet<QGraphicsItem*> &items,
+                                     QSet<int> *fasteners, QSet<int> *designSpaces) const
+{
+    foreach (auto item, items) {
+        if (m_fastenerIds.contains(item)) {
+            const int index = model()->fastenerIndex(m_fastenerIds.value(item));
+            if (index >= 0) {
+                fasteners->insert(index);
+            }
+        } else if (m_designSpaceIds.contains(item)) {
+            const int index = model()->designSpaceIndex(m_designSpaceIds.value(item));
+            if (index >= 0) {
+                designSpaces->insert(index);
             }
         }
-        model()->setDesignSpaceSelection(set);
     }
 }
 
@@ -119,11 +169,57 @@ void SpliceGraphicsWidget::onFastenerItemPositionChanged()
     if (!item)
         return;
 
-    int index = m_fastenerItems.indexOf(item);
-    Fastener fastener = model()->fastenerAt(index);
-    fastener.positionX = item->positionXInMeter() *m;
-    fastener.positionY = item->positionYInMeter() *m;
-    model()->setFastener(index, fastener);
+    if (!m_moving && (QApplication::mouseButtons() & Qt::LeftButton)) {
+        m_moving = true;
+        model()->beginTransaction(tr("Move Fasteners"));
+    }
+    m_movedFastenerItems.insert(item);
+    if (!m_moveTimer->isActive()) {
+        m_moveTimer->start();
+    }
+}
+
+/* Applies the moves of the last frame, and shows the intermediate
+ * results of the drag. */
+void SpliceGraphicsWidget::flushMovedFasteners()
+{
+    if (!m_movedFastenerItems.isEmpty()) {
+        QMap<int, Fastener> fasteners;
+        foreach (auto item, m_movedFastenerItems) {
+            const int index = model()->fastenerIndex(m_fastenerIds.value(item));
+            if (index >= 0) {
+                Fastener fastener = model()->fastenerAt(index);
+                fastener.positionX = item->positionXInMeter() *m;
+                fastener.positionY = item->positionYInMeter() *m;
+                fasteners.insert(index, fastener);
+            }
+        }
+        m_movedFastenerItems.clear();
+        model()->setFasteners(fasteners);
+    }
+    if (m_moving) {
+        model()->flushTransaction();
+    }
+}
+
+/* Applies the last moves, and ends the transaction of the drag. */
+void SpliceGraphicsWidget::finishMove()
+{
+    m_moveTimer->stop();
+    flushMovedFasteners();
+    if (m_moving) {
+        m_moving = false;
+        model()->endTransaction();
+    }
+}
+
+bool SpliceGraphicsWidget::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_backgroundWidget->scene()
+            && event->type() == QEvent::GraphicsSceneMouseRelease) {
+        finishMove();
+    }
+    return AbstractSpliceView::eventFilter(watched, event);
 }
 
 void SpliceGraphicsWidget::onDesignSpaceItemChanged()
@@ -132,53 +228,138 @@ void SpliceGraphicsWidget::onDesignSpaceItemChanged()
     if (!item)
         return;
 
-    int index = m_designSpaceItems.indexOf(item);
+    const int index = model()->designSpaceIndex(m_designSpaceIds.value(item));
+    if (index < 0)
+        return;
     DesignSpace designSpace = model()->designSpaceAt(index);
     designSpace.name = item->name();
     designSpace.polygon = item->polygonInMeter();
     model()->setDesignSpace(index, designSpace);
 }
 
+/* Shows the per-item graphics only when zoomed in. */
+void SpliceGraphicsWidget::onDetailRequested(bool detailed)
+{
+    if (detailed == m_patternLayerItem->isDetailed()) {
+        return;
+    }
+    foreach (auto &item, m_fastenerItems) {
+        item->setDetailed(detailed);
+    }
+    m_patternLayerItem->setDetailed(detailed);
+}
+
 /******************************************************************************
  ******************************************************************************/
-void SpliceGraphicsWidget::onFastenerInserted(const int index, const Fastener &fastener)
+void SpliceGraphicsWidget::onFastenersInserted(const int first, const int last)
+{
+    QList<FastenerItem*> items;
+    items.reserve(last - first + 1);
+    for (int index = first; index <= last; ++index) {
+        FastenerItem *item = createFastenerItem(model()->fastenerAt(index));
+        m_fastenerIds.insert(item, model()->fastenerId(index));
+        items << item;
+    }
+    if (first >= m_fastenerItems.count()) {
+        m_fastenerItems.append(items);
+    } else {
+        m_fastenerItems = m_fastenerItems.mid(0, first) + items + m_fastenerItems.mid(first);
+    }
+    {
+        QVector<QPointF> positions;
+        QVector<qreal> diameters;
+        positions.reserve(items.count());
+        diameters.reserve(items.count());
+        foreach (auto &item, items) {
+            positions << item->pos();
+            diameters << item->diameterInMeter() * (C_DEFAULT_SCREEN_DPI * 1000.);
+        }
+        m_patternLayerItem->insertFasteners(first, positions, diameters);
+    }
+    if (m_distanceVisible) {
+        QList<int> ids;
+        ids.reserve(items.count());
+        foreach (auto &item, items) {
+            ids << m_triangulation.insert(item->pos());
+        }
+        if (first >= m_vertexIds.count()) {
+            m_vertexIds.append(ids);
+        } else {
+            m_vertexIds = m_vertexIds.mid(0, first) + ids + m_vertexIds.mid(first);
+        }
+        this->updateDistanceItems();
+    }
+}
+
+void SpliceGraphicsWidget::onFastenersChanged(const int first, const int last)
+{
+    for (int index = first; index <= last; ++index) {
+        if (index >= 0 && index < m_fastenerItems.count()) {
+            const Fastener fastener = model()->fastenerAt(index);
+            FastenerItem *item = m_fastenerItems[index];
+            bool blocked = item->blockSignals(true);
+            item->setPositionInMeter(fastener.positionX.value(), fastener.positionY.value());
+            item->setDiameterInMeter(fastener.diameter.value());
+            item->blockSignals(blocked);
+            m_patternLayerItem->setFastener(index, item->pos(),
+                                            fastener.diameter.value() * (C_DEFAULT_SCREEN_DPI * 1000.));
+            if (m_distanceVisible) {
+                m_triangulation.move(m_vertexIds.at(index), item->pos());
+            }
+        }
+    }
+    if (m_distanceVisible) {
+        this->updateDistanceItems();
+    }
+}
+
+void SpliceGraphicsWidget::onFastenersRemoved(const int first, const int last)
+{
+    const int from = qMax(0, first);
+    const int to = qMin(last, m_fastenerItems.count() - 1);
+    if (from <= to) {
+        for (int index = from; index <= to; ++index) {
+            deleteFastenerItem(m_fastenerItems.at(index));
+        }
+        m_fastenerItems.erase(m_fastenerItems.begin() + from,
+                              m_fastenerItems.begin() + to + 1);
+        m_patternLayerItem->removeFasteners(from, to);
+        if (m_distanceVisible) {
+            for (int index = from; index <= to; ++index) {
+                m_triangulation.remove(m_vertexIds.at(index));
+            }
+            m_vertexIds.erase(m_vertexIds.begin() + from,
+                              m_vertexIds.begin() + to + 1);
+            this->updateDistanceItems();
+        }
+    }
+}
+
+FastenerItem *SpliceGraphicsWidget::createFastenerItem(const Fastener &fastener)
 {
     FastenerItem *item = new FastenerItem();
     m_backgroundWidget->scene()->addItem(item);
-    m_fastenerItems.insert(index, item);
     item->setPositionInMeter(fastener.positionX.value(), fastener.positionY.value());
     item->setDiameterInMeter(fastener.diameter.value());
     item->setResultantVisible(m_resultantVisible);
     item->setComponentVisible(m_componentVisible);
     item->setTorqueVisible(m_torqueVisible);
     item->setLabelVisible(m_labelVisible);
+    item->setDetailed(m_patternLayerItem->isDetailed());
     QObject::connect(item, SIGNAL(xChanged()), this, SLOT(onFastenerItemPositionChanged()));
     QObject::connect(item, SIGNAL(yChanged()), this, SLOT(onFastenerItemPositionChanged()));
-    this->updateDistanceItemPositions();
+    return item;
 }
 
-void SpliceGraphicsWidget::onFastenerChanged(const int index, const Fastener &fastener)
+void SpliceGraphicsWidget::deleteFastenerItem(FastenerItem *item)
 {
-    if (index >= 0 && index < m_fastenerItems.count()) {
-        FastenerItem *item = m_fastenerItems[index];
-        bool blocked = item->blockSignals(true);
-        item->setPositionInMeter(fastener.positionX.value(), fastener.positionY.value());
-        item->setDiameterInMeter(fastener.diameter.value());
-        item->blockSignals(blocked);
-    }
-    this->updateDistanceItemPositions();
-}
-
-void SpliceGraphicsWidget::onFastenerRemoved(const int index)
-{
-    if (index >= 0 && index < m_fastenerItems.count()) {
-        FastenerItem* item = m_fastenerItems.takeAt(index);
-        QObject::disconnect(item, SIGNAL(xChanged()), this, SLOT(onFastenerItemPositionChanged()));
-        QObject::disconnect(item, SIGNAL(yChanged()), this, SLOT(onFastenerItemPositionChanged()));
-        m_backgroundWidget->scene()->removeItem(item);
-        delete item;
-    }
-    this->updateDistanceItemPositions();
+    m_movedFastenerItems.remove(item);
+    m_fastenerIds.remove(item);
+    m_selectedItems.remove(item);
+    QObject::disconnect(item, SIGNAL(xChanged()), this, SLOT(onFastenerItemPositionChanged()));
+    QObject::disconnect(item, SIGNAL(yChanged()), this, SLOT(onFastenerItemPositionChanged()));
+    m_backgroundWidget->scene()->removeItem(item);
+    delete item;
 }
 
 /******************************************************************************
@@ -190,6 +371,7 @@ void SpliceGraphicsWidget::onDesignSpaceInserted(const int index, const DesignSp
 
     m_backgroundWidget->scene()->addItem(item);
     m_designSpaceItems.insert(index, item);
+    m_designSpaceIds.insert(item, model()->designSpaceId(index));
 
     bool blocked = item->blockSignals(true);
     item->setName(designSpace.name);
@@ -212,6 +394,8 @@ void SpliceGraphicsWidget::onDesignSpaceRemoved(const int index)
 {
     if (index >= 0 && index < m_designSpaceItems.count()) {
         DesignSpaceItem* item = m_designSpaceItems.takeAt(index);
+        m_designSpaceIds.remove(item);
+        m_selectedItems.remove(item);
         QObject::disconnect(item, SIGNAL(changed()), this, SLOT(onDesignSpaceItemChanged()));
         m_backgroundWidget->scene()->removeItem(item);
         delete item;
@@ -231,30 +415,59 @@ void SpliceGraphicsWidget::onResultsChanged()
     if (count != m_fastenerItems.count()) {
         return;
     }
+    QVector<QPointF> loads(count);
     for (int index = 0; index < count; ++index) {
+        const Tensor result = model()->resultAt(index);
         FastenerItem *item = m_fastenerItems[index];
-        item->setResult(model()->resultAt(index));
+        item->setResult(result);
+        loads[index] = QPointF(result.force_x.value(), -1 * result.force_y.value());
     }
+    m_patternLayerItem->setLoads(loads);
 }
 
 /******************************************************************************
  ******************************************************************************/
-void SpliceGraphicsWidget::onSelectionFastenerChanged()
+void SpliceGraphicsWidget::onFastenersSelected(const QSet<int> &selected, const QSet<int> &deselected)
 {
     bool blocked = m_backgroundWidget->scene()->blockSignals(true);
-    QSet<int> set = model()->selectedFastenerIndexes();
-    for( int i = 0; i < m_fastenerItems.count(); ++i) {
-        m_fastenerItems.at(i)->setSelected(set.contains(i));
+    foreach (auto index, deselected) {
+        if (index >= 0 && index < m_fastenerItems.count()) {
+            FastenerItem *item = m_fastenerItems.at(index);
+            item->setSelected(false);
+            m_selectedItems.remove(item);
+        }
+    }
+    foreach (auto index, selected) {
+        if (index >= 0 && index < m_fastenerItems.count()) {
+            FastenerItem *item = m_fastenerItems.at(index);
+            item->setSelected(true);
+            if (item->isSelected()) {
+                m_selectedItems.insert(item);
+            }
+        }
     }
+    m_patternLayerItem->select(selected, deselected);
     m_backgroundWidget->scene()->blockSignals(blocked);
 }
 
-void SpliceGraphicsWidget::onSelectionDesignSpaceChanged()
+void SpliceGraphicsWidget::onDesignSpacesSelected(const QSet<int> &selected, const QSet<int> &deselected)
 {
     bool blocked = m_backgroundWidget->scene()->blockSignals(true);
-    QSet<int> set = model()->selectedDesignSpaceIndexes();
-    for( int i = 0; i < m_designSpaceItems.count(); ++i) {
-        m_designSpaceItems.at(i)->setSelected(set.contains(i));
+    foreach (auto index, deselected) {
+        if (index >= 0 && index < m_designSpaceItems.count()) {
+            DesignSpaceItem *item = m_designSpaceItems.at(index);
+            item->setSelected(false);
+            m_selectedItems.remove(item);
+        }
+    }
+    foreach (auto index, selected) {
+        if (index >= 0 && index < m_designSpaceItems.count()) {
+            DesignSpaceItem *item = m_designSpaceItems.at(index);
+            item->setSelected(true);
+            if (item->isSelected()) {
+                m_selectedItems.insert(item);
+            }
+        }
     }
     m_backgroundWidget->scene()->blockSignals(blocked);
 }
@@ -310,6 +523,7 @@ void SpliceGraphicsWidget::setComponentVisible(bool visible)
 {
     m_componentVisible = visible;
     m_appliedLoadItem->setComponentVisible(visible);
+    m_patternLayerItem->setComponentVisible(visible);
     foreach (auto &f, m_fastenerItems) {
         f->setComponentVisible(visible);
     }
@@ -326,6 +540,7 @@ void SpliceGraphicsWidget::setResultantVisible(bool visible)
 {
     m_resultantVisible = visible;
     m_appliedLoadItem->setResultantVisible(visible);
+    m_patternLayerItem->setResultantVisible(visible);
     foreach (auto &f, m_fastenerItems) {
         f->setResultantVisible(visible);
     }
@@ -385,33 +600,74 @@ bool SpliceGraphicsWidget::isDistanceVisible() const
 
 void SpliceGraphicsWidget::setDistanceVisible(bool visible)
 {
+    if (m_distanceVisible == visible)
+        return;
     m_distanceVisible = visible;
-    this->updateDistanceItemPositions();
+    if (m_distanceVisible) {
+        this->createDistanceItems();
+    } else {
+        this->deleteDistanceItems();
+    }
+}
+
+/*! \brief Triangulates the fasteners, and shows the distances along the edges.
+ *
+ * Then, the triangulation is updated incrementally when the fasteners
+ * are inserted, moved or removed, and only the measures of the
+ * affected edges are updated (see updateDistanceItems()).
+ */
+void SpliceGraphicsWidget::createDistanceItems()
+{
+    this->deleteDistanceItems();
+    m_vertexIds.reserve(m_fastenerItems.count());
+    foreach (auto &f, m_fastenerItems) {
+        m_vertexIds << m_triangulation.insert(f->pos());
+    }
+    this->updateDistanceItems();
 }
 
-void SpliceGraphicsWidget::updateDistanceItemPositions()
+void SpliceGraphicsWidget::deleteDistanceItems()
 {
-    while (!m_measureItems.isEmpty()) {
-        MeasureItem *item = m_measureItems.takeLast();
+    foreach (auto &item, m_measureItems) {
         m_backgroundWidget->scene()->removeItem(item);
         delete item;
     }
-    if (m_distanceVisible) {
-        QList<QPointF> points;
-        foreach (auto &f, m_fastenerItems) {
-            points << f->pos();
+    m_measureItems.clear();
+    m_triangulation.clear();
+    m_triangulation.takeChangedEdges();
+    m_vertexIds.clear();
+}
+
+void SpliceGraphicsWidget::updateDistanceItems()
+{
+    QSet<quint64> done;
+    foreach (auto &edge, m_triangulation.takeChangedEdges()) {
+        const quint64 key = (quint64(edge.first) << 32) | quint64(edge.second);
+        if (done.contains(key))
+            continue;
+        done.insert(key);
+
+        MeasureItem *item = m_measureItems.value(key, Q_NULLPTR);
+        if (!m_triangulation.hasEdge(edge.first, edge.second)) {
+            if (item) {
+                m_measureItems.remove(key);
+                m_backgroundWidget->scene()->removeItem(item);
+                delete item;
+            }
+            continue;
         }
-        const QList<QLineF> lines = Math::delaunayTriangulation( points );
-        foreach (auto &line, lines) {
-            MeasureItem *item = new MeasureItem();
-            qreal lengthInMeter = line.length() / (C_DEFAULT_SCREEN_DPI * 1000.);
-            item->setLine(line);
+        if (!item) {
+            item = new MeasureItem();
             item->setEndSpace( 0.0025 ); // around diameter/2 = 5/2 = 2.5mm
             item->setColor( QColor(136, 0, 21) ); /* Brown */
-            item->setText(QString("%0mm").arg(lengthInMeter * 1000., 0, 'f', 1));
             m_backgroundWidget->scene()->addItem(item);
-            m_measureItems << item;
+            m_measureItems.insert(key, item);
         }
+        const QLineF line(m_triangulation.point(edge.first),
+                          m_triangulation.point(edge.second));
+        qreal lengthInMeter = line.length() / (C_DEFAULT_SCREEN_DPI * 1000.);
+        item->setLine(line);
+        item->setText(QString("%0mm").arg(lengthInMeter * 1000., 0, 'f', 1));
     }
 }
 
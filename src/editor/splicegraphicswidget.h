@@ -18,10 +18,15 @@
 #define EDITOR_SPLICE_GRAPHICS_WIDGET_H
 
 #include <Widgets/AbstractSpliceView>
+#include <Math/IncrementalDelaunay>
 
+#include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QtCore/QUrl>
 
 QT_BEGIN_NAMESPACE
+class QGraphicsItem;
+class QTimer;
 class QVBoxLayout;
 class QWidget;
 QT_END_NAMESPACE
@@ -32,6 +37,7 @@ class BackgroundWidget;
 class DesignSpaceItem;
 class FastenerItem;
 class MeasureItem;
+class PatternLayerItem;
 class TensorItem;
 
 class SpliceGraphicsWidget : public AbstractSpliceView
@@ -81,9 +87,9 @@ public Q_SLOTS:
 
 
 public Q_SLOTS:
-    virtual void onFastenerInserted(const int index, const Fastener &fastener) Q_DECL_OVERRIDE;
-    virtual void onFastenerChanged(const int index, const Fastener &fastener) Q_DECL_OVERRIDE;
-    virtual void onFastenerRemoved(const int index) Q_DECL_OVERRIDE;
+    virtual void onFastenersInserted(const int first, const int last) Q_DECL_OVERRIDE;
+    virtual void onFastenersChanged(const int first, const int last) Q_DECL_OVERRIDE;
+    virtual void onFastenersRemoved(const int first, const int last) Q_DECL_OVERRIDE;
 
     virtual void onDesignSpaceInserted(const int index, const DesignSpace &designSpace) Q_DECL_OVERRIDE;
     virtual void onDesignSpaceChanged(const int index, const DesignSpace &designSpace) Q_DECL_OVERRIDE;
@@ -92,23 +98,37 @@ public Q_SLOTS:
     virtual void onAppliedLoadChanged() Q_DECL_OVERRIDE;
     virtual void onResultsChanged() Q_DECL_OVERRIDE;
 
-    virtual void onSelectionFastenerChanged() Q_DECL_OVERRIDE;
-    virtual void onSelectionDesignSpaceChanged() Q_DECL_OVERRIDE;
+    virtual void onFastenersSelected(const QSet<int> &selected, const QSet<int> &deselected) Q_DECL_OVERRIDE;
+    virtual void onDesignSpacesSelected(const QSet<int> &selected, const QSet<int> &deselected) Q_DECL_OVERRIDE;
 
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) Q_DECL_OVERRIDE;
+
 private Q_SLOTS:
     void update();
     void onSelectionChanged();
     void onFastenerItemPositionChanged();
+    void flushMovedFasteners();
     void onDesignSpaceItemChanged();
+    void onDetailRequested(bool detailed);
 
 private:
     QVBoxLayout *m_mainLayout;
     BackgroundWidget *m_backgroundWidget;
     TensorItem *m_appliedLoadItem;
+    PatternLayerItem *m_patternLayerItem;   /* Draws the fasteners when zoomed out */
     QList<FastenerItem*> m_fastenerItems;
     QList<DesignSpaceItem*> m_designSpaceItems;
-    QList<MeasureItem*> m_measureItems;
+    QHash<QGraphicsItem*, quint32> m_fastenerIds;    /* Model ID of each fastener item */
+    QHash<QGraphicsItem*, quint32> m_designSpaceIds; /* Model ID of each design space item */
+    QSet<QGraphicsItem*> m_selectedItems;            /* Selected at the last selection change */
+    QHash<quint64, MeasureItem*> m_measureItems; /* Key is the edge */
+    Math::IncrementalDelaunay m_triangulation;
+    QList<int> m_vertexIds;     /* Vertex of each fastener item, when the distances are visible */
+    QTimer *m_moveTimer;
+    QSet<FastenerItem*> m_movedFastenerItems; /* Moved since the last frame */
+    bool m_moving;              /* Dragging, in a transaction */
 
     bool m_componentVisible;
     bool m_resultantVisible;
@@ -126,7 +146,14 @@ private:
     /// \todo  Design Domain for Optimisation
     /// \todo  ...
 
-    void updateDistanceItemPositions();
+    FastenerItem *createFastenerItem(const Fastener &fastener);
+    void deleteFastenerItem(FastenerItem *item);
+    void finishMove();
+    void indexesOf(const QSet<QGraphicsItem*> &items,
+                   QSet<int> *fasteners, QSet<int> *designSpaces) const;
+    void createDistanceItems();
+    void deleteDistanceItems();
+    void updateDistanceItems();
 
 };
 
@@ -15,10 +15,41 @@
  */
 
 #include "mainwindow.h"
+#include <Core/Service/SolverService>
+
+#include <QtCore/QCoreApplication>
 #include <QtWidgets/QApplication>
 
+#include <iostream>
+
+/*! \brief Run the headless solver service, without GUI.
+ *
+ * Usage: fastenerpattern --service [name]
+ */
+static int runService(int argc, char *argv[], const QString &name)
+{
+    QCoreApplication a(argc, argv);
+    SolverService service;
+    if (!service.listen(name)) {
+        std::cerr << "Cannot start the service: "
+                  << service.errorString().toStdString() << std::endl;
+        return 1;
+    }
+    std::cout << "Listening on " << service.serverName().toStdString() << std::endl;
+    return a.exec();
+}
+
 int main(int argc, char *argv[])
 {
+    for (int i = 1; i < argc; ++i) {
+        if (QString::fromLocal8Bit(argv[i]) == QLatin1String("--service")) {
+            const QString name = (i + 1 < argc)
+                    ? QString::fromLocal8Bit(argv[i + 1])
+                    : QStringLiteral(C_DEFAULT_SERVICE_NAME);
+            return runService(argc, argv, name);
+        }
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
@@ -20,6 +20,8 @@
 #include "about.h"
 #include "version.h"
 #include <Core/Calculator>
+#include <Core/Splice>
+#include <Core/SpliceFileWorker>
 #include <Dialogs/PropertiesDialog>
 #include <Widgets/AppliedLoadWidget>
 #include <Widgets/DesignObjectiveWidget>
@@ -43,8 +45,13 @@
 #include <QtGui/QCloseEvent>
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QMessageBox>
+#include <QtWidgets/QProgressBar>
+#include <QtWidgets/QStatusBar>
+#include <QtWidgets/QToolButton>
 #include <QtWidgets/QUndoStack>
 #include <QtWidgets/QUndoView>
+
+#include <utility> /* std::swap() */
 #ifdef QT_DEBUG
 #  include <QtCore/QDebug>
 #endif
@@ -54,8 +61,15 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
   , ui(new Ui::MainWindow)
   , m_calculator(new Calculator(this))
   , m_undoRedoPanel(Q_NULLPTR)
+  , m_fileWorker(new SpliceFileWorker(this))
+  , m_fileProgressBar(new QProgressBar(this))
+  , m_fileCancelButton(new QToolButton(this))
   , m_dirty(false)
+  , m_revision(0)
+  , m_savedRevision(0)
   , m_physicalFile(false)
+  , m_pendingActionNeedsSave(false)
+  , m_closeAccepted(false)
 {
     ui->setupUi(this);
     ui->splitter->setStretchFactor(0,0);
@@ -88,7 +102,10 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
     /* Internally, the Calculator updates the Splice, and
      * recalculates the results thanks to the Solvers.
      * It emits the signal changed() to inform the GUI.
+     * The solver runs in a worker thread, so that the GUI stays
+     * responsive (e.g. when dragging a fastener in a big pattern).
      */
+    m_calculator->setAsynchronous(true);
 
 
     /* [4] */
@@ -120,6 +137,27 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
                      ui->spliceGraphicsWidget, SLOT(setDistanceVisible(bool)));
 
 
+    /* [6] */
+    /* The files are loaded and saved in a worker thread. */
+    m_fileProgressBar->setRange(0, 100);
+    m_fileProgressBar->setMaximumWidth(150);
+    m_fileProgressBar->setVisible(false);
+    m_fileCancelButton->setText(tr("Cancel"));
+    m_fileCancelButton->setAutoRaise(true);
+    m_fileCancelButton->setVisible(false);
+    this->statusBar()->addPermanentWidget(m_fileProgressBar);
+    this->statusBar()->addPermanentWidget(m_fileCancelButton);
+
+    QObject::connect(m_fileCancelButton, SIGNAL(clicked()), m_fileWorker, SLOT(cancel()));
+    QObject::connect(m_fileWorker, SIGNAL(progressed(int)), m_fileProgressBar, SLOT(setValue(int)));
+    QObject::connect(m_fileWorker, SIGNAL(started(QString)), this, SLOT(onFileStarted(QString)));
+    QObject::connect(m_fileWorker, SIGNAL(loaded(QString,Splice)), this, SLOT(onFileLoaded(QString,Splice)));
+    QObject::connect(m_fileWorker, SIGNAL(saved(QString)), this, SLOT(onFileSaved(QString)));
+    QObject::connect(m_fileWorker, SIGNAL(failed(QString,QString)), this, SLOT(onFileFailed(QString,QString)));
+    QObject::connect(m_fileWorker, SIGNAL(cancelled(QString)), this, SLOT(onFileCancelled(QString)));
+    QObject::connect(m_fileWorker, SIGNAL(finished(bool)), this, SLOT(onFileFinished(bool)));
+
+
     createActions();
     createMenus();
 
@@ -135,19 +173,24 @@ MainWindow::~MainWindow()
  ******************************************************************************/
 void MainWindow::closeEvent(QCloseEvent *event)
 {
-    if (maybeSave()) {
+    if (m_closeAccepted || (!m_dirty && !m_fileWorker->isRunning())) {
         /// \todo XXX store settings ?
         event->accept();
-    } else {
-        event->ignore();
+        return;
     }
+    /* Close later, when the file operations are done. */
+    event->ignore();
+    maybeSave([this]() {
+        m_closeAccepted = true;
+        QMetaObject::invokeMethod(this, "close", Qt::QueuedConnection);
+    });
 }
 
 /******************************************************************************
  ******************************************************************************/
 void MainWindow::newFile()
 {
-    if (maybeSave()) {
+    maybeSave([this]() {
         m_physicalFile = false;
         m_currentFile = QFileInfo();
         m_currentFile.setFile(QStringLiteral("untitled.splice"));
@@ -158,7 +201,7 @@ void MainWindow::newFile()
         ui->spliceGraphicsWidget->setImageUrl(QUrl());
 
         this->setClean();
-    }
+    });
 }
 
 bool MainWindow::isExampleFile() const
@@ -185,7 +228,8 @@ bool MainWindow::save()
 
 bool MainWindow::saveAs()
 {
-    QString filePath = askSaveFileName(QStringLiteral("Splice Data File (*.splice)"),
+    QString filePath = askSaveFileName(tr("Splice Data File (*.splice);;"
+                                          "Binary Splice Data File (*.bsplice)"),
                                        tr("Splice Data File"));
     if (filePath.isEmpty()) {
         return false;
@@ -195,14 +239,12 @@ bool MainWindow::saveAs()
 
 void MainWindow::open()
 {
-    if (maybeSave()) {
-        QString filePath = askOpenFileName(tr("Splice Data File (*.splice);;All files (*.*)"));
+    maybeSave([this]() {
+        QString filePath = askOpenFileName(tr("Splice Data File (*.splice *.bsplice);;All files (*.*)"));
         if (!filePath.isEmpty()) {
-            if (loadFile(filePath)) {
-                this->setClean();
-            }
+            loadFile(filePath);
         }
-    }
+    });
 }
 
 /******************************************************************************
@@ -238,8 +280,22 @@ void MainWindow::about()
 
 /******************************************************************************
  ******************************************************************************/
-bool MainWindow::maybeSave()
+/*! \brief Runs the \a action once the splice is saved or discarded.
+ *
+ * The file operations run in background, so the \a action may run later,
+ * from onFileFinished(): after the current file operation, or after the
+ * saving, if the user chooses to save the changes. It doesn't run if the
+ * user cancels, or if the saving fails. A new request replaces the
+ * pending action.
+ */
+void MainWindow::maybeSave(const std::function<void()> &action)
 {
+    /* Don't start another file operation before the end of the current one. */
+    if (m_fileWorker->isRunning()) {
+        m_pendingAction = [this, action]() { maybeSave(action); };
+        m_pendingActionNeedsSave = false;
+        return;
+    }
     if (m_dirty) {
         int ret = QMessageBox::warning(
                     this, tr("Unsaved changes"),
@@ -248,12 +304,17 @@ bool MainWindow::maybeSave()
                     QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
 
         if (ret == QMessageBox::Save) {
-            return save();
+            /* The saving runs in background: continue at its end. */
+            if (save()) {
+                m_pendingAction = action;
+                m_pendingActionNeedsSave = true;
+            }
+            return;
         } else if (ret == QMessageBox::Cancel) {
-            return false;
+            return;
         }
     }
-    return true;
+    action();
 }
 
 QString MainWindow::niceFileName() const
@@ -267,6 +328,7 @@ QString MainWindow::niceFileName() const
 
 void MainWindow::setDirty()
 {
+    m_revision++;
     if (!m_dirty) {
         m_dirty = true;
         this->setWindowTitle( niceFileName() + QStringLiteral("* - FastenerPattern"));
@@ -403,28 +465,22 @@ void MainWindow::createMenus()
 
 bool MainWindow::saveFile(const QString &path)
 {
-    QDir::setCurrent(path);
-    QFile file(path);
-
-    if (!file.open(QIODevice::WriteOnly)) {
-        qWarning("Couldn't open save file.");
-        QMessageBox::warning(this, tr("Cannot save file"),
-                             tr("Cannot write to file %1:\n%2.")
-                             .arg(path)
-                             .arg(file.errorString()));
+    if (m_fileWorker->isRunning()) {
+        this->statusBar()->showMessage(tr("Another file operation is in progress"), 2000);
         return false;
     }
+    QDir::setCurrent(path);
 
-    QJsonObject json;
-    m_calculator->write(json);
-    QJsonDocument saveDoc(json);
-    file.write( saveDoc.toJson() );
+    /* The snapshot is a shallow copy (copy-on-write): the splice
+     * can be edited during the saving, without changing the file. */
+    Splice snapshot;
+    m_calculator->write(snapshot);
+    m_savedRevision = m_revision;
 
-    m_physicalFile = true;
-    m_currentFile.setFile(path);
-    this->statusBar()->showMessage(tr("File saved"), 2000);
-    this->setClean();
-    return true;
+    const SpliceFileWorker::Format format = isBinaryFileName(path)
+            ? SpliceFileWorker::Binary
+            : SpliceFileWorker::Json;
+    return m_fileWorker->save(snapshot, path, format);
 }
 
 
@@ -432,38 +488,93 @@ bool MainWindow::saveFile(const QString &path)
  ******************************************************************************/
 bool MainWindow::loadFile(const QString &path)
 {
-    QFile file(path);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning("Couldn't open file.");
-        QMessageBox::warning(this, tr("Error"),
-                             tr("Cannot read file %1:\n%2.")
-                             .arg(path)
-                             .arg(file.errorString()));
+    if (m_fileWorker->isRunning()) {
+        this->statusBar()->showMessage(tr("Another file operation is in progress"), 2000);
         return false;
     }
-    QByteArray saveData = file.readAll();
-    QJsonParseError ok;
-    QJsonDocument loadDoc( QJsonDocument::fromJson(saveData, &ok) );
+    return m_fileWorker->load(path);
+}
+
+bool MainWindow::isBinaryFileName(const QString &path) const
+{
+    return QFileInfo(path).suffix().compare(
+                QLatin1String("bsplice"), Qt::CaseInsensitive) == 0;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void MainWindow::onFileStarted(const QString &path)
+{
+    const QString message = (m_fileWorker->operation() == SpliceFileWorker::Load)
+            ? tr("Loading %0...") : tr("Saving %0...");
+    this->statusBar()->showMessage(message.arg(QFileInfo(path).fileName()));
+    m_fileProgressBar->setValue(0);
+    m_fileProgressBar->setVisible(true);
+    m_fileCancelButton->setVisible(true);
+}
+
+void MainWindow::onFileLoaded(const QString &path, const Splice &splice)
+{
+    /* The whole splice is assigned at once, in the GUI thread. */
+    m_calculator->read(splice);
+    m_physicalFile = true;
+    m_currentFile = path;
+    this->statusBar()->showMessage(tr("File loaded"), 5000);
+    this->setClean();
+}
+
+void MainWindow::onFileSaved(const QString &path)
+{
+    m_physicalFile = true;
+    m_currentFile.setFile(path);
+    this->statusBar()->showMessage(tr("File saved"), 2000);
+    if (m_revision == m_savedRevision) {
+        this->setClean();
+    } else {
+        /* The splice has been modified during the saving. */
+        this->setWindowTitle( niceFileName() + QStringLiteral("* - FastenerPattern"));
+    }
+}
 
-    if (ok.error != QJsonParseError::NoError) {
-        qCritical("Couldn't parse JSON file.");
+void MainWindow::onFileFailed(const QString &path, const QString &error)
+{
+    if (m_fileWorker->operation() == SpliceFileWorker::Load) {
+        qCritical("Couldn't read file.");
         QMessageBox::warning(this, tr("Error"),
-                             tr("Cannot parse the JSON file:\n"
+                             tr("Cannot read the file:\n"
                                 "%1\n\n"
-                                "At character %2, %3.\n\n"
+                                "%2\n\n"
                                 "Operation cancelled.")
                              .arg(path)
-                             .arg(ok.offset)
-                             .arg(ok.errorString()));
-        return false;
+                             .arg(error));
+    } else {
+        qWarning("Couldn't save file.");
+        QMessageBox::warning(this, tr("Cannot save file"),
+                             tr("Cannot write to file %1:\n%2.")
+                             .arg(path)
+                             .arg(error));
     }
+}
 
-    m_calculator->read(loadDoc.object());
-    m_physicalFile = true;
-    m_currentFile = path;
-    this->statusBar()->showMessage(tr("File loaded"), 5000);
-    this->setClean();
-    return true;
+void MainWindow::onFileCancelled(const QString &path)
+{
+    Q_UNUSED(path);
+    const QString message = (m_fileWorker->operation() == SpliceFileWorker::Load)
+            ? tr("Loading cancelled") : tr("Saving cancelled");
+    this->statusBar()->showMessage(message, 2000);
+}
+
+void MainWindow::onFileFinished(bool success)
+{
+    m_fileProgressBar->setVisible(false);
+    m_fileCancelButton->setVisible(false);
+
+    /* Continue the action that was waiting for the file operation. */
+    std::function<void()> action;
+    std::swap(action, m_pendingAction);
+    if (action && (success || !m_pendingActionNeedsSave)) {
+        action();
+    }
 }
 
 
@@ -471,29 +582,29 @@ bool MainWindow::loadFile(const QString &path)
  ******************************************************************************/
 void MainWindow::on_action_4BoltJoint_triggered()
 {
-    if (maybeSave()) {
+    maybeSave([this]() {
         loadFile(":/examples/4BoltJoint.splice");
-    }
+    });
 }
 
 void MainWindow::on_action_PatternJoint_triggered()
 {
-    if (maybeSave()) {
+    maybeSave([this]() {
         loadFile(":/examples/PatternJoint.splice");
-    }
+    });
 }
 
 void MainWindow::on_action_RandomPattern_triggered()
 {
-    if (maybeSave()) {
+    maybeSave([this]() {
         loadFile(":/examples/RandomJoint.splice");
-    }
+    });
 }
 
 void MainWindow::on_action_Optimize4Bolt_triggered()
 {
-    if (maybeSave()) {
+    maybeSave([this]() {
         loadFile(":/examples/Optimize_4BoltJoint.splice");
         ui->mainWidget->setCurrentIndex(3);
-    }
+    });
 }
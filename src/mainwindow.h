@@ -20,8 +20,14 @@
 #include <QtCore/QFileInfo>
 #include <QtWidgets/QMainWindow>
 
+#include <functional>
+
 class Calculator;
+class Splice;
+class SpliceFileWorker;
 
+class QProgressBar;
+class QToolButton;
 class QUndoView;
 
 namespace Ui {
@@ -52,8 +58,6 @@ private Q_SLOTS:
 
     void about();
 
-    bool maybeSave();
-
     void setDirty();
     void setClean();
 
@@ -65,19 +69,37 @@ private Q_SLOTS:
     void on_action_RandomPattern_triggered();
     void on_action_Optimize4Bolt_triggered();
 
+    void onFileStarted(const QString &path);
+    void onFileLoaded(const QString &path, const Splice &splice);
+    void onFileSaved(const QString &path);
+    void onFileFailed(const QString &path, const QString &error);
+    void onFileCancelled(const QString &path);
+    void onFileFinished(bool success);
 
 private:
     Ui::MainWindow *ui;
     Calculator *m_calculator;
     QUndoView *m_undoRedoPanel;
+    SpliceFileWorker *m_fileWorker;
+    QProgressBar *m_fileProgressBar;
+    QToolButton *m_fileCancelButton;
 
     bool m_dirty;
+    int m_revision;
+    int m_savedRevision;
     bool m_physicalFile;
     QFileInfo m_currentFile;
 
+    std::function<void()> m_pendingAction;
+    bool m_pendingActionNeedsSave;
+    bool m_closeAccepted;
+
+    void maybeSave(const std::function<void()> &action);
+
     inline QString niceFileName() const;
     inline bool isExampleFile() const;
     inline bool isPhysicalFile() const;
+    inline bool isBinaryFileName(const QString &path) const;
 
     void createActions();
     void createMenus();
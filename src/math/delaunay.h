@@ -26,7 +26,7 @@ QT_END_NAMESPACE
 
 namespace Math {
 
-QList<QLineF> delaunayTriangulation(const QList<QPointF> &points);
+QVector<QLineF> delaunayTriangulation(const QVector<QPointF> &points);
 
 }
 
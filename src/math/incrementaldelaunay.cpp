@@ -0,0 +1,843 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "incrementaldelaunay.h"
+
+#include <QtCore/QHash>
+
+#include <algorithm>
+
+namespace Math
+{
+
+/******************************************************************************
+ ******************************************************************************/
+/* Geometric predicates */
+
+/* Returns a positive value if a, b and c are counter-clockwise,
+ * negative if clockwise, and zero if collinear. */
+static inline qreal _q_orient(const QPointF &a, const QPointF &b, const QPointF &c)
+{
+    return (b.x() - a.x()) * (c.y() - a.y()) - (b.y() - a.y()) * (c.x() - a.x());
+}
+
+/* Returns a positive value if d is inside the circumcircle
+ * of the counter-clockwise triangle a, b, c. */
+static inline qreal _q_inCircle(const QPointF &a, const QPointF &b,
+                                const QPointF &c, const QPointF &d)
+{
+    const qreal adx = a.x() - d.x();
+    const qreal ady = a.y() - d.y();
+    const qreal bdx = b.x() - d.x();
+    const qreal bdy = b.y() - d.y();
+    const qreal cdx = c.x() - d.x();
+    const qreal cdy = c.y() - d.y();
+    const qreal alift = adx * adx + ady * ady;
+    const qreal blift = bdx * bdx + bdy * bdy;
+    const qreal clift = cdx * cdx + cdy * cdy;
+    return alift * (bdx * cdy - cdx * bdy)
+            + blift * (cdx * ady - adx * cdy)
+            + clift * (adx * bdy - bdx * ady);
+}
+
+/* Returns true if p is strictly between a and b (p collinear with a and b). */
+static inline bool _q_isBetween(const QPointF &a, const QPointF &b, const QPointF &p)
+{
+    const QPointF ab = b - a;
+    return QPointF::dotProduct(p - a, ab) > 0 && QPointF::dotProduct(p - b, ab) < 0;
+}
+
+static inline bool _q_lessThan(const QPointF &a, const QPointF &b)
+{
+    return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class Math::IncrementalDelaunay
+ * \brief The class IncrementalDelaunay is a Delaunay triangulation that
+ * supports the insertion, the move and the removal of a point,
+ * with a local re-triangulation.
+ *
+ * Unlike Math::delaunayTriangulation(), that triangulates all the points
+ * at each call, the cost of an operation depends only on the number of
+ * triangles around the point (6 in average), plus the point location.
+ *
+ * The points are identified by stable ids (returned by insert()).
+ * The edges created or removed by the operations are recorded;
+ * takeChangedEdges() returns them, so that a view only updates
+ * the affected edges (an edge can also be returned because its
+ * geometry changed, when one of its points moved).
+ *
+ * Implementation:
+ *  - The triangulation is closed by "ghost" triangles, that link each edge
+ *    of the convex hull to an infinite vertex. Thus, the insertion of a point
+ *    outside the convex hull is the same as the insertion inside.
+ *  - The insertion removes the triangles whose circumcircle contains
+ *    the point (the cavity), and connects the point to the boundary
+ *    of the cavity (Bowyer-Watson).
+ *  - The removal removes the triangles around the point, and fills the hole
+ *    with Delaunay ears, i.e. the ears whose circumcircle is empty.
+ *  - The duplicate points are hidden, and are shown again when their twin
+ *    is removed or moved.
+ *  - While all the points are collinear, the edges are the segments
+ *    between the consecutive points along the line.
+ *  - In case of a numerical failure, the triangulation is rebuilt.
+ *
+ * \sa Math::delaunayTriangulation()
+ */
+IncrementalDelaunay::IncrementalDelaunay()
+    : m_stamp(0)
+    , m_planar(false)
+    , m_aliveCount(0)
+    , m_finiteCount(0)
+    , m_lastTriangle(-1)
+{
+}
+
+void IncrementalDelaunay::clear()
+{
+    foreach (const Edge &edge, edges()) {
+        touchEdge(edge.first, edge.second);
+    }
+    m_vertices.clear();
+    m_freeVertices.clear();
+    m_triangles.clear();
+    m_freeTriangles.clear();
+    m_hidden.clear();
+    m_chain.clear();
+    m_marks.clear();
+    m_planar = false;
+    m_aliveCount = 0;
+    m_finiteCount = 0;
+    m_lastTriangle = -1;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Inserts the given \a point, and returns its id.
+ */
+int IncrementalDelaunay::insert(const QPointF &point)
+{
+    int id;
+    if (!m_freeVertices.isEmpty()) {
+        id = m_freeVertices.takeLast();
+    } else {
+        id = m_vertices.count();
+        m_vertices.append(Vertex());
+    }
+    Vertex &vertex = m_vertices[id];
+    vertex.pos = point;
+    vertex.triangle = -1;
+    vertex.chainIndex = -1;
+    vertex.alive = true;
+    vertex.hidden = false;
+    m_aliveCount++;
+    insertVertex(id);
+    return id;
+}
+
+/*! \brief Moves the point of the given \a id to the given \a point.
+ */
+void IncrementalDelaunay::move(const int id, const QPointF &point)
+{
+    Q_ASSERT(id >= 0 && id < m_vertices.count() && m_vertices.at(id).alive);
+    if (m_vertices.at(id).pos == point)
+        return;
+    const QPointF old = m_vertices.at(id).pos;
+    const bool wasHidden = m_vertices.at(id).hidden;
+    detachVertex(id);
+    m_vertices[id].pos = point;
+    m_vertices[id].alive = true;
+    m_aliveCount++;
+    if (!wasHidden) {
+        showHiddenAt(old);
+    }
+    insertVertex(id);
+}
+
+/*! \brief Removes the point of the given \a id.
+ */
+void IncrementalDelaunay::remove(const int id)
+{
+    Q_ASSERT(id >= 0 && id < m_vertices.count() && m_vertices.at(id).alive);
+    const QPointF old = m_vertices.at(id).pos;
+    const bool wasHidden = m_vertices.at(id).hidden;
+    detachVertex(id);
+    m_freeVertices.append(id);
+    if (!wasHidden) {
+        showHiddenAt(old);
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int IncrementalDelaunay::count() const
+{
+    return m_aliveCount;
+}
+
+QPointF IncrementalDelaunay::point(const int id) const
+{
+    return m_vertices.at(id).pos;
+}
+
+/*! \brief Returns true if the points \a a and \a b are connected by an edge.
+ */
+bool IncrementalDelaunay::hasEdge(const int a, const int b) const
+{
+    if (a < 0 || b < 0 || a >= m_vertices.count() || b >= m_vertices.count())
+        return false;
+    const Vertex &va = m_vertices.at(a);
+    const Vertex &vb = m_vertices.at(b);
+    if (!va.alive || !vb.alive || va.hidden || vb.hidden || a == b)
+        return false;
+
+    if (!m_planar) {
+        return qAbs(va.chainIndex - vb.chainIndex) == 1;
+    }
+    /* Turn around a */
+    const int start = va.triangle;
+    int t = start;
+    do {
+        const Triangle &tri = m_triangles.at(t);
+        int i = 0;
+        while (tri.v[i] != a) {
+            ++i;
+        }
+        if (tri.v[(i + 1) % 3] == b)
+            return true;
+        t = tri.n[(i + 1) % 3];
+    } while (t != start);
+    return false;
+}
+
+/*! \brief Returns the edges, as pairs of ids.
+ */
+QVector<IncrementalDelaunay::Edge> IncrementalDelaunay::edges() const
+{
+    QVector<Edge> res;
+    if (!m_planar) {
+        res.reserve(m_chain.count());
+        for (int i = 1; i < m_chain.count(); ++i) {
+            const int a = m_chain.at(i - 1);
+            const int b = m_chain.at(i);
+            res.append(a < b ? Edge(a, b) : Edge(b, a));
+        }
+        return res;
+    }
+    /* Each edge appears twice, once in each direction,
+     * in the finite triangles and in the ghost triangles. */
+    res.reserve(3 * m_aliveCount);
+    for (int t = 0; t < m_triangles.count(); ++t) {
+        const Triangle &tri = m_triangles.at(t);
+        if (tri.v[0] == Dead)
+            continue;
+        for (int i = 0; i < 3; ++i) {
+            const int a = tri.v[i];
+            const int b = tri.v[(i + 1) % 3];
+            if (a >= 0 && b >= 0 && a < b) {
+                res.append(Edge(a, b));
+            }
+        }
+    }
+    return res;
+}
+
+/*! \brief Returns the edges created, removed or moved since the last call.
+ *
+ * The list can contain duplicates, and edges that don't exist anymore:
+ * use hasEdge() to know whether the edge must be shown.
+ */
+QVector<IncrementalDelaunay::Edge> IncrementalDelaunay::takeChangedEdges()
+{
+    QVector<Edge> res;
+    res.swap(m_changedEdges);
+    return res;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void IncrementalDelaunay::insertVertex(const int id)
+{
+    if (m_planar) {
+        if (!insertIntoTriangulation(id)) {
+            rebuild();
+        }
+    } else {
+        if (!insertIntoChain(id)) {
+            rebuild();
+        }
+    }
+}
+
+/*! \internal
+ * \brief Removes the vertex from the triangulation, and marks it as dead.
+ */
+void IncrementalDelaunay::detachVertex(const int id)
+{
+    Vertex &vertex = m_vertices[id];
+    vertex.alive = false;
+    m_aliveCount--;
+    if (vertex.hidden) {
+        vertex.hidden = false;
+        m_hidden.removeOne(id);
+        return;
+    }
+    if (m_planar) {
+        if (!removeFromTriangulation(id) || m_finiteCount == 0) {
+            rebuild();
+        }
+    } else {
+        removeFromChain(id);
+    }
+}
+
+/*! \internal
+ * \brief Shows the hidden duplicate at the given \a point, if any.
+ */
+void IncrementalDelaunay::showHiddenAt(const QPointF &point)
+{
+    for (int i = 0; i < m_hidden.count(); ++i) {
+        const int id = m_hidden.at(i);
+        if (m_vertices.at(id).pos == point) {
+            m_hidden.remove(i);
+            m_vertices[id].hidden = false;
+            insertVertex(id);
+            return;
+        }
+    }
+}
+
+void IncrementalDelaunay::hide(const int id)
+{
+    m_vertices[id].hidden = true;
+    m_vertices[id].triangle = -1;
+    m_vertices[id].chainIndex = -1;
+    m_hidden.append(id);
+}
+
+/*! \internal
+ * \brief Triangulates all the points from scratch.
+ */
+void IncrementalDelaunay::rebuild()
+{
+    foreach (const Edge &edge, edges()) {
+        touchEdge(edge.first, edge.second);
+    }
+    m_triangles.clear();
+    m_freeTriangles.clear();
+    m_hidden.clear();
+    m_chain.clear();
+    m_planar = false;
+    m_finiteCount = 0;
+    m_lastTriangle = -1;
+
+    QVector<int> ids;
+    ids.reserve(m_aliveCount);
+    for (int id = 0; id < m_vertices.count(); ++id) {
+        Vertex &vertex = m_vertices[id];
+        if (vertex.alive) {
+            vertex.hidden = false;
+            vertex.triangle = -1;
+            vertex.chainIndex = -1;
+            ids.append(id);
+        }
+    }
+    /* Sort, in order to remove the duplicates, and
+     * to insert each point near the previous one. */
+    std::sort(ids.begin(), ids.end(), [this](int a, int b) {
+        return _q_lessThan(pos(a), pos(b));
+    });
+    QVector<int> unique;
+    unique.reserve(ids.count());
+    foreach (const int id, ids) {
+        if (!unique.isEmpty() && pos(unique.last()) == pos(id)) {
+            hide(id);
+        } else {
+            unique.append(id);
+        }
+    }
+
+    int third = -1;
+    for (int i = 2; i < unique.count(); ++i) {
+        if (_q_orient(pos(unique.at(0)), pos(unique.at(1)), pos(unique.at(i))) != 0) {
+            third = i;
+            break;
+        }
+    }
+    if (third < 0) {
+        /* Collinear (or less than 3 points) */
+        m_chain = unique;
+        reindexChain(0);
+        for (int i = 1; i < m_chain.count(); ++i) {
+            touchEdge(m_chain.at(i - 1), m_chain.at(i));
+        }
+        return;
+    }
+
+    /* First triangle, closed by 3 ghost triangles */
+    int a = unique.at(0);
+    int b = unique.at(1);
+    int c = unique.at(third);
+    if (_q_orient(pos(a), pos(b), pos(c)) < 0) {
+        qSwap(b, c);
+    }
+    const int t0 = createTriangle(a, b, c);
+    const int g1 = createTriangle(b, a, Infinite);
+    const int g2 = createTriangle(c, b, Infinite);
+    const int g3 = createTriangle(a, c, Infinite);
+    m_triangles[t0].n[0] = g2;
+    m_triangles[t0].n[1] = g3;
+    m_triangles[t0].n[2] = g1;
+    m_triangles[g1].n[0] = g3;
+    m_triangles[g1].n[1] = g2;
+    m_triangles[g1].n[2] = t0;
+    m_triangles[g2].n[0] = g1;
+    m_triangles[g2].n[1] = g3;
+    m_triangles[g2].n[2] = t0;
+    m_triangles[g3].n[0] = g2;
+    m_triangles[g3].n[1] = g1;
+    m_triangles[g3].n[2] = t0;
+    m_lastTriangle = t0;
+    m_planar = true;
+
+    for (int i = 2; i < unique.count(); ++i) {
+        if (i == third)
+            continue;
+        const int id = unique.at(i);
+        if (!insertIntoTriangulation(id)) {
+            /* Numerical failure: ignore the point */
+            hide(id);
+        }
+    }
+    foreach (const Edge &edge, edges()) {
+        touchEdge(edge.first, edge.second);
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \internal
+ * \brief Inserts the vertex in the chain of collinear points.
+ * Returns false if the vertex is not collinear.
+ */
+bool IncrementalDelaunay::insertIntoChain(const int id)
+{
+    const QPointF p = pos(id);
+    if (m_chain.count() >= 2
+            && _q_orient(pos(m_chain.first()), pos(m_chain.last()), p) != 0) {
+        return false;
+    }
+    QVector<int>::iterator it = std::lower_bound(
+                m_chain.begin(), m_chain.end(), id, [this](int a, int b) {
+        return _q_lessThan(pos(a), pos(b));
+    });
+    const int index = int(it - m_chain.begin());
+    if (index < m_chain.count() && pos(m_chain.at(index)) == p) {
+        hide(id);
+        return true;
+    }
+    const int prev = index > 0 ? m_chain.at(index - 1) : -1;
+    const int next = index < m_chain.count() ? m_chain.at(index) : -1;
+    if (prev >= 0 && next >= 0) touchEdge(prev, next);
+    if (prev >= 0) touchEdge(prev, id);
+    if (next >= 0) touchEdge(id, next);
+    m_chain.insert(index, id);
+    reindexChain(index);
+    return true;
+}
+
+void IncrementalDelaunay::removeFromChain(const int id)
+{
+    const int index = m_vertices.at(id).chainIndex;
+    Q_ASSERT(index >= 0 && index < m_chain.count() && m_chain.at(index) == id);
+    const int prev = index > 0 ? m_chain.at(index - 1) : -1;
+    const int next = index + 1 < m_chain.count() ? m_chain.at(index + 1) : -1;
+    if (prev >= 0) touchEdge(prev, id);
+    if (next >= 0) touchEdge(id, next);
+    if (prev >= 0 && next >= 0) touchEdge(prev, next);
+    m_chain.remove(index);
+    m_vertices[id].chainIndex = -1;
+    reindexChain(index);
+}
+
+void IncrementalDelaunay::reindexChain(const int from)
+{
+    for (int i = from; i < m_chain.count(); ++i) {
+        m_vertices[m_chain.at(i)].chainIndex = i;
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \internal
+ * \brief Inserts the vertex in the triangulation (Bowyer-Watson).
+ * Returns false in case of numerical failure.
+ */
+bool IncrementalDelaunay::insertIntoTriangulation(const int id)
+{
+    const QPointF p = pos(id);
+    const int start = locate(p);
+    if (start < 0)
+        return false;
+
+    for (int i = 0; i < 3; ++i) {
+        const int v = m_triangles.at(start).v[i];
+        if (v >= 0 && pos(v) == p) {
+            hide(id);
+            return true;
+        }
+    }
+
+    /* Find the cavity */
+    const int mark = nextMark();
+    QVector<int> cavity;
+    QVector<int> stack;
+    stack.append(start);
+    m_marks[start] = mark;
+    while (!stack.isEmpty()) {
+        const int t = stack.takeLast();
+        cavity.append(t);
+        for (int i = 0; i < 3; ++i) {
+            const int nb = m_triangles.at(t).n[i];
+            if (m_marks.at(nb) != mark && conflicts(nb, p)) {
+                m_marks[nb] = mark;
+                stack.append(nb);
+            }
+        }
+    }
+
+    /* The point must see each edge of the boundary.
+     * Otherwise (almost degenerate case), grow the cavity. */
+    struct BoundaryEdge { int u; int w; int outside; };
+    QVector<BoundaryEdge> boundary;
+    bool grown = true;
+    while (grown) {
+        grown = false;
+        boundary.clear();
+        for (int k = 0; k < cavity.count() && !grown; ++k) {
+            const Triangle &tri = m_triangles.at(cavity.at(k));
+            for (int i = 0; i < 3; ++i) {
+                const int nb = tri.n[i];
+                if (m_marks.at(nb) == mark)
+                    continue;
+                const int u = tri.v[(i + 1) % 3];
+                const int w = tri.v[(i + 2) % 3];
+                if (u >= 0 && w >= 0 && _q_orient(pos(u), pos(w), p) <= 0) {
+                    m_marks[nb] = mark;
+                    cavity.append(nb);
+                    grown = true;
+                    break;
+                }
+                BoundaryEdge edge = { u, w, nb };
+                boundary.append(edge);
+            }
+        }
+        if (cavity.count() > m_triangles.count())
+            return false;
+    }
+
+    /* Connect the point to the boundary */
+    QHash<int, int> startingAt;
+    QHash<int, int> endingAt;
+    startingAt.reserve(boundary.count());
+    endingAt.reserve(boundary.count());
+    QVector<int> created;
+    created.reserve(boundary.count());
+    foreach (const BoundaryEdge &edge, boundary) {
+        const int t = createTriangle(edge.u, edge.w, id);
+        link(t, 2, edge.outside);
+        startingAt.insert(edge.u, t);
+        endingAt.insert(edge.w, t);
+        created.append(t);
+    }
+    foreach (const int t, created) {
+        const Triangle &tri = m_triangles.at(t);
+        /* Opposite to u: edge (w, p), shared with the triangle starting at w */
+        m_triangles[t].n[0] = startingAt.value(tri.v[1], -1);
+        /* Opposite to w: edge (p, u), shared with the triangle ending at u */
+        m_triangles[t].n[1] = endingAt.value(tri.v[0], -1);
+        Q_ASSERT(m_triangles.at(t).n[0] >= 0 && m_triangles.at(t).n[1] >= 0);
+    }
+    foreach (const int t, cavity) {
+        destroyTriangle(t);
+    }
+    foreach (const int t, created) {
+        touchTriangle(t);
+    }
+    m_lastTriangle = created.first();
+    return true;
+}
+
+/*! \internal
+ * \brief Removes the vertex from the triangulation, and fills the hole.
+ * Returns false in case of numerical failure.
+ */
+bool IncrementalDelaunay::removeFromTriangulation(const int id)
+{
+    /* The star of the vertex, counter-clockwise */
+    QVector<int> star;
+    QVector<int> ring;
+    QVector<int> outer;
+    const int start = m_vertices.at(id).triangle;
+    if (start < 0 || m_triangles.at(start).v[0] == Dead)
+        return false;
+    int t = start;
+    do {
+        const Triangle &tri = m_triangles.at(t);
+        int i = 0;
+        while (tri.v[i] != id) {
+            ++i;
+        }
+        star.append(t);
+        ring.append(tri.v[(i + 1) % 3]);
+        outer.append(tri.n[i]);
+        t = tri.n[(i + 1) % 3];
+        if (star.count() > m_triangles.count())
+            return false;
+    } while (t != start);
+
+    /* Find the Delaunay ears (dry run) */
+    QVector<int> ears;
+    {
+        QVector<int> r = ring;
+        while (r.count() > 3) {
+            const int k = r.count();
+            int ear = -1;
+            for (int j = 0; j < k; ++j) {
+                if (isValidEar(r.at((j + k - 1) % k), r.at(j), r.at((j + 1) % k), r)) {
+                    ear = j;
+                    break;
+                }
+            }
+            if (ear < 0)
+                return false;
+            ears.append(ear);
+            r.remove(ear);
+        }
+        if (r.at(0) >= 0 && r.at(1) >= 0 && r.at(2) >= 0
+                && _q_orient(pos(r.at(0)), pos(r.at(1)), pos(r.at(2))) <= 0) {
+            return false;
+        }
+    }
+
+    foreach (const int s, star) {
+        destroyTriangle(s);
+    }
+    foreach (const int j, ears) {
+        const int k = ring.count();
+        const int jm = (j + k - 1) % k;
+        const int e = createTriangle(ring.at(jm), ring.at(j), ring.at((j + 1) % k));
+        link(e, 2, outer.at(jm));   /* edge (a, b) */
+        link(e, 0, outer.at(j));    /* edge (b, c) */
+        touchTriangle(e);
+        outer[jm] = e;              /* edge (c, a), linked later */
+        ring.remove(j);
+        outer.remove(j);
+    }
+    const int last = createTriangle(ring.at(0), ring.at(1), ring.at(2));
+    link(last, 0, outer.at(1));
+    link(last, 1, outer.at(2));
+    link(last, 2, outer.at(0));
+    touchTriangle(last);
+    m_lastTriangle = last;
+    return true;
+}
+
+/*! \internal
+ * \brief Returns a triangle in conflict with the point \a p,
+ * i.e. that contains it, or -1 if not found.
+ */
+int IncrementalDelaunay::locate(const QPointF &p) const
+{
+    int t = m_lastTriangle;
+    if (t < 0 || t >= m_triangles.count() || m_triangles.at(t).v[0] == Dead) {
+        t = -1;
+        for (int i = 0; i < m_triangles.count() && t < 0; ++i) {
+            if (m_triangles.at(i).v[0] != Dead)
+                t = i;
+        }
+        if (t < 0)
+            return -1;
+    }
+    /* Visibility walk */
+    const int maxSteps = m_triangles.count() + 3;
+    for (int step = 0; step < maxSteps; ++step) {
+        const Triangle &tri = m_triangles.at(t);
+        int infinite = -1;
+        for (int i = 0; i < 3; ++i) {
+            if (tri.v[i] == Infinite)
+                infinite = i;
+        }
+        if (infinite >= 0) {
+            if (conflicts(t, p))
+                return t;
+            t = tri.n[infinite];
+            continue;
+        }
+        bool moved = false;
+        for (int e = 0; e < 3; ++e) {
+            /* Vary the first edge, to avoid cycles */
+            const int i = (step + e) % 3;
+            if (_q_orient(pos(tri.v[(i + 1) % 3]), pos(tri.v[(i + 2) % 3]), p) < 0) {
+                t = tri.n[i];
+                moved = true;
+                break;
+            }
+        }
+        if (!moved)
+            return t;
+    }
+    /* Fallback */
+    for (int i = 0; i < m_triangles.count(); ++i) {
+        const Triangle &tri = m_triangles.at(i);
+        if (tri.v[0] == Dead)
+            continue;
+        if (tri.v[0] == Infinite || tri.v[1] == Infinite || tri.v[2] == Infinite) {
+            if (conflicts(i, p))
+                return i;
+        } else if (_q_orient(pos(tri.v[0]), pos(tri.v[1]), p) >= 0
+                   && _q_orient(pos(tri.v[1]), pos(tri.v[2]), p) >= 0
+                   && _q_orient(pos(tri.v[2]), pos(tri.v[0]), p) >= 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*! \internal
+ * \brief Returns true if the point \a p is inside the circumcircle
+ * of the triangle (a, b, c). For a ghost triangle, the circumcircle
+ * is the half-plane outside the edge of the convex hull.
+ */
+bool IncrementalDelaunay::conflicts(const int a, const int b, const int c, const QPointF &p) const
+{
+    if (c == Infinite || a == Infinite || b == Infinite) {
+        const int u = (a == Infinite) ? b : (b == Infinite) ? c : a;
+        const int w = (a == Infinite) ? c : (b == Infinite) ? a : b;
+        const qreal o = _q_orient(pos(u), pos(w), p);
+        return o > 0 || (o == 0 && _q_isBetween(pos(u), pos(w), p));
+    }
+    return _q_inCircle(pos(a), pos(b), pos(c), p) > 0;
+}
+
+bool IncrementalDelaunay::conflicts(const int t, const QPointF &p) const
+{
+    const Triangle &tri = m_triangles.at(t);
+    return conflicts(tri.v[0], tri.v[1], tri.v[2], p);
+}
+
+/*! \internal
+ * \brief Returns true if the ear (a, b, c) of the hole's \a ring
+ * is a Delaunay triangle of the hole.
+ */
+bool IncrementalDelaunay::isValidEar(const int a, const int b, const int c,
+                                     const QVector<int> &ring) const
+{
+    if (a >= 0 && b >= 0 && c >= 0 && _q_orient(pos(a), pos(b), pos(c)) <= 0)
+        return false;
+    foreach (const int r, ring) {
+        if (r < 0 || r == a || r == b || r == c)
+            continue;
+        if (conflicts(a, b, c, pos(r)))
+            return false;
+    }
+    return true;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int IncrementalDelaunay::createTriangle(const int a, const int b, const int c)
+{
+    int t;
+    if (!m_freeTriangles.isEmpty()) {
+        t = m_freeTriangles.takeLast();
+    } else {
+        t = m_triangles.count();
+        m_triangles.append(Triangle());
+        m_marks.append(0);
+    }
+    Triangle &tri = m_triangles[t];
+    tri.v[0] = a;
+    tri.v[1] = b;
+    tri.v[2] = c;
+    tri.n[0] = tri.n[1] = tri.n[2] = -1;
+    if (a >= 0) m_vertices[a].triangle = t;
+    if (b >= 0) m_vertices[b].triangle = t;
+    if (c >= 0) m_vertices[c].triangle = t;
+    if (a >= 0 && b >= 0 && c >= 0) {
+        m_finiteCount++;
+    }
+    return t;
+}
+
+void IncrementalDelaunay::destroyTriangle(const int t)
+{
+    touchTriangle(t);
+    Triangle &tri = m_triangles[t];
+    if (tri.v[0] >= 0 && tri.v[1] >= 0 && tri.v[2] >= 0) {
+        m_finiteCount--;
+    }
+    tri.v[0] = tri.v[1] = tri.v[2] = Dead;
+    m_freeTriangles.append(t);
+}
+
+/*! \internal
+ * \brief Sets the \a other triangle as the neighbor of the triangle \a t,
+ * opposite to its vertex \a slot, and vice versa.
+ */
+void IncrementalDelaunay::link(const int t, const int slot, const int other)
+{
+    Triangle &tri = m_triangles[t];
+    tri.n[slot] = other;
+    const int u = tri.v[(slot + 1) % 3];
+    const int w = tri.v[(slot + 2) % 3];
+    Triangle &o = m_triangles[other];
+    for (int i = 0; i < 3; ++i) {
+        if (o.v[(i + 1) % 3] == w && o.v[(i + 2) % 3] == u) {
+            o.n[i] = t;
+            return;
+        }
+    }
+    Q_ASSERT(false);
+}
+
+void IncrementalDelaunay::touchTriangle(const int t)
+{
+    const Triangle &tri = m_triangles.at(t);
+    for (int i = 0; i < 3; ++i) {
+        touchEdge(tri.v[i], tri.v[(i + 1) % 3]);
+    }
+}
+
+void IncrementalDelaunay::touchEdge(const int a, const int b)
+{
+    if (a >= 0 && b >= 0) {
+        m_changedEdges.append(a < b ? Edge(a, b) : Edge(b, a));
+    }
+}
+
+int IncrementalDelaunay::nextMark() const
+{
+    if (++m_stamp == 0) {
+        m_marks.fill(0);
+        m_stamp = 1;
+    }
+    return m_stamp;
+}
+
+} // end namespace Math
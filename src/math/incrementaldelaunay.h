@@ -0,0 +1,107 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MATH_INCREMENTAL_DELAUNAY_H
+#define MATH_INCREMENTAL_DELAUNAY_H
+
+#include <QtCore/QPair>
+#include <QtCore/QPointF>
+#include <QtCore/QVector>
+
+namespace Math {
+
+class IncrementalDelaunay
+{
+public:
+    typedef QPair<int, int> Edge;
+
+    IncrementalDelaunay();
+
+    void clear();
+
+    int insert(const QPointF &point);
+    void move(const int id, const QPointF &point);
+    void remove(const int id);
+
+    int count() const;
+    QPointF point(const int id) const;
+
+    bool hasEdge(const int a, const int b) const;
+    QVector<Edge> edges() const;
+    QVector<Edge> takeChangedEdges();
+
+private:
+    enum { Infinite = -1, Dead = -2 };
+
+    struct Vertex {
+        QPointF pos;
+        int triangle;       /* Any triangle incident to the vertex (planar mode) */
+        int chainIndex;     /* Index in m_chain (collinear mode) */
+        bool alive;
+        bool hidden;        /* Duplicate of another vertex, not triangulated */
+    };
+
+    struct Triangle {
+        int v[3];           /* Counter-clockwise, or Infinite for a ghost triangle */
+        int n[3];           /* n[i] is the neighbor opposite to v[i] */
+    };
+
+    QVector<Vertex> m_vertices;
+    QVector<int> m_freeVertices;
+    QVector<Triangle> m_triangles;
+    QVector<int> m_freeTriangles;
+    QVector<int> m_hidden;
+    QVector<int> m_chain;
+    QVector<Edge> m_changedEdges;
+    mutable QVector<int> m_marks;
+    mutable int m_stamp;
+    bool m_planar;
+    int m_aliveCount;
+    int m_finiteCount;
+    int m_lastTriangle;
+
+    inline const QPointF &pos(const int id) const { return m_vertices.at(id).pos; }
+
+    void insertVertex(const int id);
+    void detachVertex(const int id);
+    void showHiddenAt(const QPointF &point);
+    void hide(const int id);
+    void rebuild();
+
+    /* Collinear mode */
+    bool insertIntoChain(const int id);
+    void removeFromChain(const int id);
+    void reindexChain(const int from);
+
+    /* Planar mode */
+    bool insertIntoTriangulation(const int id);
+    bool removeFromTriangulation(const int id);
+    int locate(const QPointF &p) const;
+    bool conflicts(const int a, const int b, const int c, const QPointF &p) const;
+    bool conflicts(const int t, const QPointF &p) const;
+    bool isValidEar(const int a, const int b, const int c, const QVector<int> &ring) const;
+
+    int createTriangle(const int a, const int b, const int c);
+    void destroyTriangle(const int t);
+    void link(const int t, const int slot, const int other);
+    void touchTriangle(const int t);
+    void touchEdge(const int a, const int b);
+    int nextMark() const;
+};
+
+}
+
+#endif // MATH_INCREMENTAL_DELAUNAY_H
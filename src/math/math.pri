@@ -1,6 +1,12 @@
 HEADERS  += \
     $$PWD/delaunay.h \
+    $$PWD/incrementaldelaunay.h \
+    $$PWD/sparsecholesky.h \
+    $$PWD/triangulator.h \
     $$PWD/utils.h
 
 SOURCES += \
-    $$PWD/delaunay.cpp
+    $$PWD/delaunay.cpp \
+    $$PWD/incrementaldelaunay.cpp \
+    $$PWD/sparsecholesky.cpp \
+    $$PWD/triangulator.cpp
@@ -0,0 +1,326 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sparsecholesky.h"
+
+#include <QtCore/QtMath>
+
+namespace Math
+{
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class Math::SparseCholesky
+ * \brief The class SparseCholesky factorizes a sparse symmetric positive
+ * definite matrix A as P.A.P' = L.L', and solves A.x = b.
+ *
+ * The factorization is done in two steps:
+ * \li analyze() computes the elimination tree of the permuted matrix, and
+ * the pattern of L. It only depends on the sparse pattern of A and on the
+ * fill-reducing permutation, given by the caller (e.g. a nested dissection
+ * of the mesh).
+ * \li factorize() computes the values of L, row by row ("up-looking"
+ * Cholesky, as in T. Davis' CSparse).
+ *
+ * Once factorized, solve() costs one forward and one backward substitution.
+ * It solves several right-hand sides at once: they are interleaved, so that
+ * each value of L is read once for all of them.
+ */
+SparseCholesky::SparseCholesky()
+    : m_size(0)
+    , m_factorized(false)
+{
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int SparseCholesky::size() const
+{
+    return m_size;
+}
+
+int SparseCholesky::factorSize() const
+{
+    return m_factorStart.isEmpty() ? 0 : m_factorStart.at(m_size);
+}
+
+bool SparseCholesky::isFactorized() const
+{
+    return m_factorized;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Computes the pattern of the factor of the \a size by \a size matrix,
+ * given in CSR format by \a rowStart and \a columns (both triangles).
+ *
+ * Returns false if the \a permutation is not valid.
+ */
+bool SparseCholesky::analyze(int size, const int *rowStart, const int *columns,
+                             const QVector<int> &permutation)
+{
+    m_size = size;
+    m_factorized = false;
+
+    m_permutation = permutation;
+    if (m_permutation.isEmpty()) {
+        m_permutation.resize(size);
+        for (int k = 0; k < size; ++k) {
+            m_permutation[k] = k;
+        }
+    }
+    if (m_permutation.count() != size) {
+        return false;
+    }
+    m_inverse.fill(-1, size);
+    for (int k = 0; k < size; ++k) {
+        const int i = m_permutation.at(k);
+        if (i < 0 || i >= size || m_inverse.at(i) != -1) {
+            return false;
+        }
+        m_inverse[i] = k;
+    }
+
+    /* ********************************************* */
+    /* Upper triangle of P.A.P'                      */
+    /* ********************************************* */
+    const int count = rowStart[size];
+    QVector<int> work(size + 1, 0);
+    for (int i = 0; i < size; ++i) {
+        for (int p = rowStart[i]; p < rowStart[i + 1]; ++p) {
+            const int row = m_inverse.at(i);
+            const int column = m_inverse.at(columns[p]);
+            if (row <= column) {
+                work[column + 1]++;
+            }
+        }
+    }
+    m_upperStart.resize(size + 1);
+    m_upperStart[0] = 0;
+    for (int k = 0; k < size; ++k) {
+        m_upperStart[k + 1] = m_upperStart.at(k) + work.at(k + 1);
+        work[k] = m_upperStart.at(k);
+    }
+    m_upperRows.resize(m_upperStart.at(size));
+    m_upperMap.resize(count);
+    for (int i = 0; i < size; ++i) {
+        for (int p = rowStart[i]; p < rowStart[i + 1]; ++p) {
+            const int row = m_inverse.at(i);
+            const int column = m_inverse.at(columns[p]);
+            if (row <= column) {
+                const int q = work[column]++;
+                m_upperRows[q] = row;
+                m_upperMap[p] = q;
+            } else {
+                m_upperMap[p] = -1;
+            }
+        }
+    }
+
+    /* ********************************************* */
+    /* Elimination tree                              */
+    /* ********************************************* */
+    m_parent.fill(-1, size);
+    {
+        QVector<int> ancestor(size, -1);
+        for (int k = 0; k < size; ++k) {
+            for (int p = m_upperStart.at(k); p < m_upperStart.at(k + 1); ++p) {
+                /* Path compression */
+                int i = m_upperRows.at(p);
+                while (i != -1 && i < k) {
+                    const int next = ancestor.at(i);
+                    ancestor[i] = k;
+                    if (next == -1) {
+                        m_parent[i] = k;
+                    }
+                    i = next;
+                }
+            }
+        }
+    }
+
+    /* ********************************************* */
+    /* Column counts of L                            */
+    /* ********************************************* */
+    {
+        QVector<int> columnCount(size, 1); /* diagonal */
+        QVector<int> stack(size);
+        QVector<int> marks(size, -1);
+        for (int k = 0; k < size; ++k) {
+            for (int top = reach(k, stack.data(), marks.data()); top < size; ++top) {
+                columnCount[stack.at(top)]++;
+            }
+        }
+        m_factorStart.resize(size + 1);
+        m_factorStart[0] = 0;
+        for (int k = 0; k < size; ++k) {
+            m_factorStart[k + 1] = m_factorStart.at(k) + columnCount.at(k);
+        }
+    }
+    m_factorRows.clear();
+    m_factorValues.clear();
+    return true;
+}
+
+/*! \internal
+ * \brief Returns the pattern of the row \a k of L, in stack[top..n-1],
+ * in topological order. The nodes are marked with \a k in \a marks.
+ */
+int SparseCholesky::reach(int k, int *stack, int *marks) const
+{
+    int top = m_size;
+    marks[k] = k;
+    for (int p = m_upperStart.at(k); p < m_upperStart.at(k + 1); ++p) {
+        int i = m_upperRows.at(p);
+        int length = 0;
+        /* Walk up the elimination tree, until a marked node */
+        for (; marks[i] != k; i = m_parent.at(i)) {
+            stack[length++] = i;
+            marks[i] = k;
+        }
+        while (length > 0) {
+            stack[--top] = stack[--length];
+        }
+    }
+    return top;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Computes L, for the matrix values given in the order of
+ * the \a columns passed to analyze().
+ *
+ * Returns false if the matrix is not positive definite.
+ */
+bool SparseCholesky::factorize(const double *values)
+{
+    m_factorized = false;
+    const int n = m_size;
+
+    m_upperValues.fill(0., m_upperRows.count());
+    for (int p = 0; p < m_upperMap.count(); ++p) {
+        const int q = m_upperMap.at(p);
+        if (q >= 0) {
+            m_upperValues[q] += values[p];
+        }
+    }
+
+    m_factorRows.resize(factorSize());
+    m_factorValues.resize(factorSize());
+    int *rows = m_factorRows.data();
+    double *factor = m_factorValues.data();
+
+    QVector<int> next = m_factorStart; /* Next free entry of each column */
+    QVector<double> x(n, 0.);
+    QVector<int> stack(n);
+    QVector<int> marks(n, -1);
+
+    for (int k = 0; k < n; ++k) {
+        /* Solves L(0:k-1,0:k-1).y = A(0:k-1,k), sparse triangular */
+        int top = reach(k, stack.data(), marks.data());
+        for (int p = m_upperStart.at(k); p < m_upperStart.at(k + 1); ++p) {
+            x[m_upperRows.at(p)] += m_upperValues.at(p);
+        }
+        double d = x.at(k);
+        x[k] = 0.;
+        for (; top < n; ++top) {
+            const int i = stack.at(top);
+            const double lki = x.at(i) / factor[m_factorStart.at(i)];
+            x[i] = 0.;
+            for (int p = m_factorStart.at(i) + 1; p < next.at(i); ++p) {
+                x[rows[p]] -= factor[p] * lki;
+            }
+            d -= lki * lki;
+            const int p = next[i]++;
+            rows[p] = k;
+            factor[p] = lki;
+        }
+        if (d <= 0.) {
+            return false;
+        }
+        const int p = next[k]++;
+        rows[p] = k;
+        factor[p] = qSqrt(d);
+    }
+    m_factorized = true;
+    return true;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Solves A.x = b in place, for \a rhsCount right-hand sides.
+ *
+ * The right-hand sides are interleaved: b[i * rhsCount + r] is the
+ * row i of the right-hand side r.
+ */
+void SparseCholesky::solve(double *b, int rhsCount) const
+{
+    Q_ASSERT(m_factorized);
+    const int n = m_size;
+    const int *start = m_factorStart.constData();
+    const int *rows = m_factorRows.constData();
+    const double *factor = m_factorValues.constData();
+
+    QVector<double> work(n * rhsCount);
+    double *x = work.data();
+    for (int k = 0; k < n; ++k) {
+        const double *from = b + m_permutation.at(k) * rhsCount;
+        for (int r = 0; r < rhsCount; ++r) {
+            x[k * rhsCount + r] = from[r];
+        }
+    }
+
+    /* L.y = P.b */
+    for (int j = 0; j < n; ++j) {
+        double *xj = x + j * rhsCount;
+        const double diagonal = factor[start[j]];
+        for (int r = 0; r < rhsCount; ++r) {
+            xj[r] /= diagonal;
+        }
+        for (int p = start[j] + 1; p < start[j + 1]; ++p) {
+            const double l = factor[p];
+            double *xi = x + rows[p] * rhsCount;
+            for (int r = 0; r < rhsCount; ++r) {
+                xi[r] -= l * xj[r];
+            }
+        }
+    }
+
+    /* L'.(P.x) = y */
+    for (int j = n - 1; j >= 0; --j) {
+        double *xj = x + j * rhsCount;
+        for (int p = start[j] + 1; p < start[j + 1]; ++p) {
+            const double l = factor[p];
+            const double *xi = x + rows[p] * rhsCount;
+            for (int r = 0; r < rhsCount; ++r) {
+                xj[r] -= l * xi[r];
+            }
+        }
+        const double diagonal = factor[start[j]];
+        for (int r = 0; r < rhsCount; ++r) {
+            xj[r] /= diagonal;
+        }
+    }
+
+    for (int k = 0; k < n; ++k) {
+        double *to = b + m_permutation.at(k) * rhsCount;
+        for (int r = 0; r < rhsCount; ++r) {
+            to[r] = x[k * rhsCount + r];
+        }
+    }
+}
+
+} // end namespace Math
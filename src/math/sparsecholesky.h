@@ -0,0 +1,66 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MATH_SPARSE_CHOLESKY_H
+#define MATH_SPARSE_CHOLESKY_H
+
+#include <QtCore/QVector>
+
+namespace Math {
+
+class SparseCholesky
+{
+public:
+    SparseCholesky();
+
+    /* Symmetric matrix in CSR (both triangles), and fill-reducing
+     * permutation: permutation[k] is the row eliminated at step k */
+    bool analyze(int size, const int *rowStart, const int *columns,
+                 const QVector<int> &permutation);
+    bool factorize(const double *values);
+
+    int size() const;
+    int factorSize() const; /* Non-zeros of L */
+    bool isFactorized() const;
+
+    /* In place, for rhsCount interleaved right-hand sides: b[i * rhsCount + r] */
+    void solve(double *b, int rhsCount) const;
+
+private:
+    int m_size;
+    bool m_factorized;
+
+    QVector<int> m_permutation;
+    QVector<int> m_inverse;
+
+    /* Upper triangle of the permuted matrix (CSC) */
+    QVector<int> m_upperStart;
+    QVector<int> m_upperRows;
+    QVector<int> m_upperMap;   /* Per input value, its index in m_upperValues, or -1 */
+    QVector<double> m_upperValues;
+
+    /* Elimination tree, and L (CSC, diagonal first) */
+    QVector<int> m_parent;
+    QVector<int> m_factorStart;
+    QVector<int> m_factorRows;
+    QVector<double> m_factorValues;
+
+    int reach(int k, int *stack, int *marks) const;
+};
+
+}
+
+#endif // MATH_SPARSE_CHOLESKY_H
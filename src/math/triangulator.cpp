@@ -0,0 +1,335 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "triangulator.h"
+
+/* ************************************************************************** */
+/* This header is a copy of the default Triangle's header                     */
+/* (originally located in "3rd/triangle/triangle.h")                          */
+/* with an ' extern "C" {} ' declaration to make it callable.                 */
+/* ************************************************************************** */
+/* BEGIN TRIANGLE DECLARATION */
+#define VOID int
+#ifdef SINGLE
+#  define REAL float
+#else /* not SINGLE */
+#  define REAL double
+#endif /* not SINGLE */
+extern "C" {
+#include "triangle.h"
+}
+/* END TRIANGLE DECLARATION */
+/* ************************************************************************** */
+
+#include <algorithm>
+
+namespace Math
+{
+
+Q_STATIC_ASSERT(sizeof(REAL) == sizeof(double));
+
+/******************************************************************************
+ ******************************************************************************/
+/* Reset all allocated arrays, including those allocated by Triangle. */
+static void _q_initTriangulateIO(triangulateio &io)
+{
+    io.pointlist = Q_NULLPTR;
+    io.pointattributelist = Q_NULLPTR;
+    io.pointmarkerlist = Q_NULLPTR;
+    io.numberofpoints = 0;
+    io.numberofpointattributes = 0;
+    io.trianglelist = Q_NULLPTR;
+    io.triangleattributelist = Q_NULLPTR;
+    io.trianglearealist = Q_NULLPTR;
+    io.neighborlist = Q_NULLPTR;
+    io.numberoftriangles = 0;
+    io.numberofcorners = 0;
+    io.numberoftriangleattributes = 0;
+    io.segmentlist = Q_NULLPTR;
+    io.segmentmarkerlist = Q_NULLPTR;
+    io.numberofsegments = 0;
+    io.holelist = Q_NULLPTR;
+    io.numberofholes = 0;
+    io.regionlist = Q_NULLPTR;
+    io.numberofregions = 0;
+    io.edgelist = Q_NULLPTR;
+    io.edgemarkerlist = Q_NULLPTR;
+    io.normlist = Q_NULLPTR;
+    io.numberofedges = 0;
+}
+
+#define FREE_MEMBER(x) if (x) { free( x ); x = Q_NULLPTR; }
+
+/* Free the arrays that Triangle allocated by itself.
+ * The other arrays belong to the Triangulator. */
+static void _q_freeTriangleOutput(triangulateio &io)
+{
+    FREE_MEMBER( io.pointlist );
+    FREE_MEMBER( io.pointattributelist );
+    FREE_MEMBER( io.pointmarkerlist );
+    FREE_MEMBER( io.triangleattributelist );
+    FREE_MEMBER( io.segmentlist );
+    FREE_MEMBER( io.segmentmarkerlist );
+    FREE_MEMBER( io.edgemarkerlist );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \class Math::Triangulator
+ * \brief The class Triangulator computes the Delaunay triangulation of
+ * a set of points, and keeps its buffers from one call to the next.
+ *
+ * The input of Triangle and its output (the triangle, neighbor and edge
+ * arrays) are stored in buffers owned by the Triangulator, that grow
+ * when needed and are never released between two calls. Thus, an object
+ * that triangulates repeatedly (an editor overlay, a mesh-based solver)
+ * keeps a Triangulator and reads the arrays directly, without copy.
+ *
+ * The duplicate points are removed. With less than 3 points, or with
+ * collinear points, there's no triangle, and the edges link the
+ * consecutive points along the line.
+ *
+ * \remark Triangle still allocates its internal mesh at each call.
+ *
+ * \sa Math::delaunayTriangulation()
+ */
+Triangulator::Triangulator()
+    : m_triangleCount(0)
+    , m_edgeCount(0)
+{
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int Triangulator::pointCount() const
+{
+    return m_points.count();
+}
+
+const QPointF *Triangulator::points() const
+{
+    return m_points.constData();
+}
+
+int Triangulator::triangleCount() const
+{
+    return m_triangleCount;
+}
+
+const int *Triangulator::triangles() const
+{
+    return m_triangles.constData();
+}
+
+const int *Triangulator::neighbors() const
+{
+    return m_neighbors.constData();
+}
+
+int Triangulator::edgeCount() const
+{
+    return m_edgeCount;
+}
+
+const int *Triangulator::edges() const
+{
+    return m_edges.constData();
+}
+
+/*! \brief Returns the edges as lines.
+ */
+QVector<QLineF> Triangulator::lines() const
+{
+    /* Preallocated, and filled in place. */
+    QVector<QLineF> res(m_edgeCount);
+    QLineF *line = res.data();
+    for (int i = 0; i < m_edgeCount; ++i) {
+        line[i] = QLineF(m_points.at(m_edges.at(i * 2)),
+                         m_points.at(m_edges.at(i * 2 + 1)));
+    }
+    return res;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void Triangulator::triangulate(const QVector<QPointF> &points)
+{
+    /***************************************\
+    * Steps for Delaunay Triangulation:     *
+    *                                       *
+    *    - Sanitize the input               *
+    *       - Remove duplicate points       *
+    *       - Verify trivial results        *
+    *       - Verify collinear points       *
+    *    - Define input points              *
+    *    - Triangulate the points           *
+    *                                       *
+    \***************************************/
+    m_triangleCount = 0;
+    m_edgeCount = 0;
+
+    removeDuplicates(points);
+
+    if (m_points.count() < 3) {  /* Triangle needs at least 3 points */
+        if (m_points.count() == 2) { /* trivial */
+            m_edges.resize(2);
+            m_edges[0] = 0;
+            m_edges[1] = 1;
+            m_edgeCount = 1;
+        }
+        return;
+    }
+
+    if (linkCollinearPoints()) {
+        return;
+    }
+
+    /* Define input points. */
+    const int count = m_points.count();
+    m_pointList.resize(count * 2);
+    for (int i = 0; i < count; ++i) {
+        m_pointList[ i * 2 ]     = m_points.at(i).x();
+        m_pointList[ i * 2 + 1 ] = m_points.at(i).y();
+    }
+
+    /* A triangulation of n points has at most 2n-5 triangles and 3n-6 edges.
+     * Triangle writes in the given arrays, instead of allocating them. */
+    m_triangles.resize(count * 2 * 3);
+    m_neighbors.resize(count * 2 * 3);
+    m_edges.resize(count * 3 * 2);
+
+    struct triangulateio in, out;
+    _q_initTriangulateIO( in );
+    _q_initTriangulateIO( out );
+    in.numberofpoints = count;
+    in.pointlist = m_pointList.data();
+    out.trianglelist = m_triangles.data();
+    out.neighborlist = m_neighbors.data();
+    out.edgelist = m_edges.data();
+
+    /******************************************************************\
+    * triangulate()                                                    *
+    *                                                                  *
+    *  p = Read and write a Planar Straight Line Graph                 *
+    *  c = Preserve the convex hull                                    *
+    *  z = Number everything from zero (rather than one)               *
+    *  e = Produce an edge list                                        *
+    *  n = Produce a list of triangle neighbors                        *
+    *  N = No output points (they are the input points)                *
+    *  B = No boundary markers in the output                           *
+    *  P = No output .poly file (saves disk space)                     *
+    *  Q = Quiet, suppresses all messages except when error occurs     *
+    *                                                                  *
+    \******************************************************************/
+    static char options[] = "pczenNBPQ";
+    ::triangulate(options, &in, &out, Q_NULLPTR);
+
+    Q_ASSERT(out.numberoftriangles <= count * 2);
+    Q_ASSERT(out.numberofedges <= count * 3);
+    m_triangleCount = out.numberoftriangles;
+    m_edgeCount = out.numberofedges;
+
+    _q_freeTriangleOutput( out );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/* Removes the duplicate points, and keeps the order of the first occurrences.
+ * Sorting the indexes is O(n log n), instead of comparing each pair of points. */
+void Triangulator::removeDuplicates(const QVector<QPointF> &points)
+{
+    const int count = points.count();
+    m_indexes.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_indexes[i] = i;
+    }
+    std::sort(m_indexes.begin(), m_indexes.end(), [&points](int a, int b) {
+        const QPointF &pa = points.at(a);
+        const QPointF &pb = points.at(b);
+        if (pa.x() != pb.x()) return pa.x() < pb.x();
+        if (pa.y() != pb.y()) return pa.y() < pb.y();
+        return a < b;
+    });
+    m_duplicates.fill(false, count);
+    for (int i = 1; i < count; ++i) {
+        if (points.at(m_indexes.at(i)) == points.at(m_indexes.at(i - 1))) {
+            m_duplicates[m_indexes.at(i)] = true;
+        }
+    }
+    m_points.resize(0);
+    m_points.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        if (!m_duplicates.at(i)) {
+            m_points.append(points.at(i));
+        }
+    }
+}
+
+/* If the points are collinear, links the consecutive points and returns true. */
+bool Triangulator::linkCollinearPoints()
+{
+    /**********************************************************\
+    *        How to verify that 3 points are collinear?        *
+    *                                                          *
+    *   "*" = cross product, also called matrix determinant    *
+    *                                                          *
+    *   v1*v2 = det( [x1 x2] ) = x1*y2 − x2*y1                 *
+    *              ( [y1 y2] )                                 *
+    *                                                          *
+    *   => v1*v2=0 implies v1 and v2 are collinear             *
+    *                                                          *
+    *   With 3 points:                                         *
+    *                                                          *
+    *   (p1−p0)*(p2−p0) = (x1−x0)*(y2−y0)−(x2−x0)*(y1−y0)      *
+    *                   = 0 means p0, p1 and p2 are aligned    *
+    *                                                          *
+    \**********************************************************/
+    Q_ASSERT(m_points.count() > 2);
+
+    const QPointF origin = m_points.first();
+    const QPointF v1 = m_points.at(1) - origin;
+
+    /* Single pass: stop at the first point that is not aligned. */
+    for (int i = 2; i < m_points.count(); ++i) {
+        const QPointF v2 = m_points.at(i) - origin;
+        qreal det = v1.x()*v2.y() - v1.y()*v2.x();
+        if (!qFuzzyCompare(det, 0.0)) {
+            return false;
+        }
+    }
+
+    /* Sort the points along the line, and link the consecutive ones. */
+    const int count = m_points.count();
+    const bool useX = (v1.x()!=0); /* otherwise use y */
+    m_indexes.resize(count);
+    for (int i = 0; i < count; ++i) {
+        m_indexes[i] = i;
+    }
+    const QVector<QPointF> &points = m_points;
+    std::sort(m_indexes.begin(), m_indexes.end(), [&points, useX](int a, int b) {
+        return useX ? points.at(a).x() < points.at(b).x()
+                    : points.at(a).y() < points.at(b).y();
+    });
+    m_edges.resize((count - 1) * 2);
+    for (int i = 1; i < count; ++i) {
+        m_edges[(i-1) * 2]     = m_indexes.at(i-1);
+        m_edges[(i-1) * 2 + 1] = m_indexes.at(i);
+    }
+    m_edgeCount = count - 1;
+    return true;
+}
+
+} // end namespace Math
@@ -0,0 +1,69 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MATH_TRIANGULATOR_H
+#define MATH_TRIANGULATOR_H
+
+#include <QtCore/QLineF>
+#include <QtCore/QPointF>
+#include <QtCore/QVector>
+
+namespace Math {
+
+class Triangulator
+{
+public:
+    Triangulator();
+
+    void triangulate(const QVector<QPointF> &points);
+
+    /* Unique input points, in their input order */
+    int pointCount() const;
+    const QPointF *points() const;
+
+    /* 3 point indexes per triangle, counter-clockwise */
+    int triangleCount() const;
+    const int *triangles() const;
+
+    /* 3 triangle indexes per triangle (opposite to each point), or -1 */
+    const int *neighbors() const;
+
+    /* 2 point indexes per edge */
+    int edgeCount() const;
+    const int *edges() const;
+
+    QVector<QLineF> lines() const;
+
+private:
+    Q_DISABLE_COPY(Triangulator)
+
+    QVector<QPointF> m_points;
+    QVector<int> m_indexes;
+    QVector<bool> m_duplicates;
+    QVector<double> m_pointList;
+    QVector<int> m_triangles;
+    QVector<int> m_neighbors;
+    QVector<int> m_edges;
+    int m_triangleCount;
+    int m_edgeCount;
+
+    void removeDuplicates(const QVector<QPointF> &points);
+    bool linkCollinearPoints();
+};
+
+}
+
+#endif // MATH_TRIANGULATOR_H
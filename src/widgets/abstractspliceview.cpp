@@ -24,6 +24,16 @@
 /*! \class AbstractSpliceView
  *  \brief The class AbstractSpliceView is a view of the AbstractSpliceModel.
  *
+ * The model notifies the changes of the fasteners and the design spaces
+ * by ranges (e.g. fastenersInserted()). By default, the view handles
+ * a range item by item, with onFastenerInserted() and so on.
+ * The views that can handle a range in a single step
+ * (e.g. with a single update) reimplement onFastenersInserted() and so on.
+ *
+ * Likewise, the views with many items reimplement onFastenersSelected()
+ * to update only the items whose selection changed, rather than
+ * onSelectionFastenerChanged().
+ *
  * \sa AbstractSpliceModel
  */
 
@@ -45,24 +55,28 @@ void AbstractSpliceView::setModel(AbstractSpliceModel *model)
         return;
 
     if (m_model) {
-        QObject::disconnect(m_model, SIGNAL(fastenerInserted(int,Fastener)),
-                            this, SLOT(onFastenerInserted(int,Fastener)));
-        QObject::disconnect(m_model, SIGNAL(fastenerChanged(int,Fastener)),
-                            this, SLOT(onFastenerChanged(int,Fastener)));
-        QObject::disconnect(m_model, SIGNAL(fastenerRemoved(int)),
-                            this, SLOT(onFastenerRemoved(int)));
-
-        QObject::disconnect(m_model, SIGNAL(designSpaceInserted(int,DesignSpace)),
-                            this, SLOT(onDesignSpaceInserted(int,DesignSpace)));
-        QObject::disconnect(m_model, SIGNAL(designSpaceChanged(int,DesignSpace)),
-                            this, SLOT(onDesignSpaceChanged(int,DesignSpace)));
-        QObject::disconnect(m_model, SIGNAL(designSpaceRemoved(int)),
-                            this, SLOT(onDesignSpaceRemoved(int)));
+        QObject::disconnect(m_model, SIGNAL(fastenersInserted(int,int)),
+                            this, SLOT(onFastenersInserted(int,int)));
+        QObject::disconnect(m_model, SIGNAL(fastenersChanged(int,int)),
+                            this, SLOT(onFastenersChanged(int,int)));
+        QObject::disconnect(m_model, SIGNAL(fastenersRemoved(int,int)),
+                            this, SLOT(onFastenersRemoved(int,int)));
+
+        QObject::disconnect(m_model, SIGNAL(designSpacesInserted(int,int)),
+                            this, SLOT(onDesignSpacesInserted(int,int)));
+        QObject::disconnect(m_model, SIGNAL(designSpacesChanged(int,int)),
+                            this, SLOT(onDesignSpacesChanged(int,int)));
+        QObject::disconnect(m_model, SIGNAL(designSpacesRemoved(int,int)),
+                            this, SLOT(onDesignSpacesRemoved(int,int)));
 
         QObject::disconnect(m_model, SIGNAL(selectionFastenerChanged()),
                             this, SLOT(onSelectionFastenerChanged()));
         QObject::disconnect(m_model, SIGNAL(selectionDesignSpaceChanged()),
                             this, SLOT(onSelectionDesignSpaceChanged()));
+        QObject::disconnect(m_model, SIGNAL(fastenersSelected(QSet<int>,QSet<int>)),
+                            this, SLOT(onFastenersSelected(QSet<int>,QSet<int>)));
+        QObject::disconnect(m_model, SIGNAL(designSpacesSelected(QSet<int>,QSet<int>)),
+                            this, SLOT(onDesignSpacesSelected(QSet<int>,QSet<int>)));
 
         QObject::disconnect(m_model, SIGNAL(appliedLoadChanged()),
                             this, SLOT(onAppliedLoadChanged()));
@@ -74,24 +88,28 @@ void AbstractSpliceView::setModel(AbstractSpliceModel *model)
     }
     m_model = model;
     if (m_model) {
-        QObject::connect(m_model, SIGNAL(fastenerInserted(int,Fastener)),
-                         this, SLOT(onFastenerInserted(int,Fastener)));
-        QObject::connect(m_model, SIGNAL(fastenerChanged(int,Fastener)),
-                         this, SLOT(onFastenerChanged(int,Fastener)));
-        QObject::connect(m_model, SIGNAL(fastenerRemoved(int)),
-                         this, SLOT(onFastenerRemoved(int)));
-
-        QObject::connect(m_model, SIGNAL(designSpaceInserted(int,DesignSpace)),
-                         this, SLOT(onDesignSpaceInserted(int,DesignSpace)));
-        QObject::connect(m_model, SIGNAL(designSpaceChanged(int,DesignSpace)),
-                         this, SLOT(onDesignSpaceChanged(int,DesignSpace)));
-        QObject::connect(m_model, SIGNAL(designSpaceRemoved(int)),
-                         this, SLOT(onDesignSpaceRemoved(int)));
+        QObject::connect(m_model, SIGNAL(fastenersInserted(int,int)),
+                         this, SLOT(onFastenersInserted(int,int)));
+        QObject::connect(m_model, SIGNAL(fastenersChanged(int,int)),
+                         this, SLOT(onFastenersChanged(int,int)));
+        QObject::connect(m_model, SIGNAL(fastenersRemoved(int,int)),
+                         this, SLOT(onFastenersRemoved(int,int)));
+
+        QObject::connect(m_model, SIGNAL(designSpacesInserted(int,int)),
+                         this, SLOT(onDesignSpacesInserted(int,int)));
+        QObject::connect(m_model, SIGNAL(designSpacesChanged(int,int)),
+                         this, SLOT(onDesignSpacesChanged(int,int)));
+        QObject::connect(m_model, SIGNAL(designSpacesRemoved(int,int)),
+                         this, SLOT(onDesignSpacesRemoved(int,int)));
 
         QObject::connect(m_model, SIGNAL(selectionFastenerChanged()),
                          this, SLOT(onSelectionFastenerChanged()));
         QObject::connect(m_model, SIGNAL(selectionDesignSpaceChanged()),
                          this, SLOT(onSelectionDesignSpaceChanged()));
+        QObject::connect(m_model, SIGNAL(fastenersSelected(QSet<int>,QSet<int>)),
+                         this, SLOT(onFastenersSelected(QSet<int>,QSet<int>)));
+        QObject::connect(m_model, SIGNAL(designSpacesSelected(QSet<int>,QSet<int>)),
+                         this, SLOT(onDesignSpacesSelected(QSet<int>,QSet<int>)));
 
         QObject::connect(m_model, SIGNAL(appliedLoadChanged()),
                          this, SLOT(onAppliedLoadChanged()));
@@ -103,6 +121,52 @@ void AbstractSpliceView::setModel(AbstractSpliceModel *model)
     }
 }
 
+/******************************************************************************
+ ******************************************************************************/
+void AbstractSpliceView::onFastenersInserted(const int first, const int last)
+{
+    for (int index = first; index <= last; ++index) {
+        onFastenerInserted(index, m_model->fastenerAt(index));
+    }
+}
+
+void AbstractSpliceView::onFastenersChanged(const int first, const int last)
+{
+    for (int index = first; index <= last; ++index) {
+        onFastenerChanged(index, m_model->fastenerAt(index));
+    }
+}
+
+void AbstractSpliceView::onFastenersRemoved(const int first, const int last)
+{
+    for (int index = last; index >= first; --index) {
+        onFastenerRemoved(index);
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void AbstractSpliceView::onDesignSpacesInserted(const int first, const int last)
+{
+    for (int index = first; index <= last; ++index) {
+        onDesignSpaceInserted(index, m_model->designSpaceAt(index));
+    }
+}
+
+void AbstractSpliceView::onDesignSpacesChanged(const int first, const int last)
+{
+    for (int index = first; index <= last; ++index) {
+        onDesignSpaceChanged(index, m_model->designSpaceAt(index));
+    }
+}
+
+void AbstractSpliceView::onDesignSpacesRemoved(const int first, const int last)
+{
+    for (int index = last; index >= first; --index) {
+        onDesignSpaceRemoved(index);
+    }
+}
+
 /******************************************************************************
  ******************************************************************************/
 void AbstractSpliceView::onFastenerInserted(const int, const Fastener &)
@@ -141,6 +205,14 @@ void AbstractSpliceView::onSelectionDesignSpaceChanged()
 {
 }
 
+void AbstractSpliceView::onFastenersSelected(const QSet<int> &, const QSet<int> &)
+{
+}
+
+void AbstractSpliceView::onDesignSpacesSelected(const QSet<int> &, const QSet<int> &)
+{
+}
+
 /******************************************************************************
  ******************************************************************************/
 void AbstractSpliceView::onAppliedLoadChanged()
@@ -17,6 +17,7 @@
 #ifndef WIDGETS_ABSTRACT_SPLICE_VIEW_H
 #define WIDGETS_ABSTRACT_SPLICE_VIEW_H
 
+#include <QtCore/QSet>
 #include <QtWidgets/QWidget>
 
 #define C_SHORT_DELAY_MSEC 10
@@ -37,6 +38,14 @@ public:
     AbstractSpliceModel *model() const;
 
 public Q_SLOTS:
+    virtual void onFastenersInserted(const int first, const int last);
+    virtual void onFastenersChanged(const int first, const int last);
+    virtual void onFastenersRemoved(const int first, const int last);
+
+    virtual void onDesignSpacesInserted(const int first, const int last);
+    virtual void onDesignSpacesChanged(const int first, const int last);
+    virtual void onDesignSpacesRemoved(const int first, const int last);
+
     virtual void onFastenerInserted(const int index, const Fastener &fastener);
     virtual void onFastenerChanged(const int index, const Fastener &fastener);
     virtual void onFastenerRemoved(const int index);
@@ -47,6 +56,8 @@ public Q_SLOTS:
 
     virtual void onSelectionFastenerChanged();
     virtual void onSelectionDesignSpaceChanged();
+    virtual void onFastenersSelected(const QSet<int> &selected, const QSet<int> &deselected);
+    virtual void onDesignSpacesSelected(const QSet<int> &selected, const QSet<int> &deselected);
 
     virtual void onAppliedLoadChanged();
     virtual void onSolverParamsChanged();
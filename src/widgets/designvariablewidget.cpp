@@ -90,17 +90,17 @@ void DesignVariableWidget::onItemSelectionChanged()
 
 /******************************************************************************
  ******************************************************************************/
-void DesignVariableWidget::onFastenerInserted(const int, const Fastener &)
+void DesignVariableWidget::onFastenersInserted(const int, const int)
 {
     updateTableLater(C_SHORT_DELAY_MSEC);
 }
 
-void DesignVariableWidget::onFastenerChanged(const int, const Fastener &)
+void DesignVariableWidget::onFastenersChanged(const int, const int)
 {
     updateTableLater(C_LONG_DELAY_MSEC);
 }
 
-void DesignVariableWidget::onFastenerRemoved(const int)
+void DesignVariableWidget::onFastenersRemoved(const int, const int)
 {
     updateTableLater(C_SHORT_DELAY_MSEC);
 }
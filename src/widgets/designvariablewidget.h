@@ -35,9 +35,9 @@ public:
     ~DesignVariableWidget();
 
 public Q_SLOTS:
-    virtual void onFastenerInserted(const int index, const Fastener &fastener) Q_DECL_OVERRIDE;
-    virtual void onFastenerChanged(const int index, const Fastener &fastener) Q_DECL_OVERRIDE;
-    virtual void onFastenerRemoved(const int index) Q_DECL_OVERRIDE;
+    virtual void onFastenersInserted(const int first, const int last) Q_DECL_OVERRIDE;
+    virtual void onFastenersChanged(const int first, const int last) Q_DECL_OVERRIDE;
+    virtual void onFastenersRemoved(const int first, const int last) Q_DECL_OVERRIDE;
     virtual void onSelectionFastenerChanged() Q_DECL_OVERRIDE;
 
 private Q_SLOTS:
@@ -0,0 +1,161 @@
+/* - FastenerPattern - Copyright (C) 2016-2018 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fastenertablemodel.h"
+
+#include <Core/AbstractSpliceModel>
+#include <Core/Fastener>
+
+#define C_COLUMN_COUNT 6
+
+static inline QString DOFToString(Fastener::DOF dof)
+{
+    return (dof == Fastener::Fixed) ? QObject::tr("fixed") : QObject::tr("free");
+}
+
+/* Value in mm, with one decimal. */
+static inline QString lengthToString(const Length &length)
+{
+    return QString::number(length.value() *1000, 'f', 1); // mm !
+}
+
+/*! \class FastenerTableModel
+ *  \brief The class FastenerTableModel is an adapter that presents
+ *  the fasteners of an AbstractSpliceModel to a QTableView.
+ *
+ * The model stores nothing but the row count: the cells are formatted
+ * in data(), only when the view paints them, i.e. for the visible rows.
+ *
+ * The ranges notified by the splice model (e.g. fastenersInserted())
+ * are forwarded as single row insertions, removals or data changes,
+ * so an edit never rebuilds the whole table.
+ */
+FastenerTableModel::FastenerTableModel(QObject *parent) : QAbstractTableModel(parent)
+  , m_spliceModel(Q_NULLPTR)
+  , m_rowCount(0)
+{
+}
+
+/******************************************************************************
+ ******************************************************************************/
+AbstractSpliceModel *FastenerTableModel::spliceModel() const
+{
+    return m_spliceModel;
+}
+
+void FastenerTableModel::setSpliceModel(AbstractSpliceModel *model)
+{
+    if (model == m_spliceModel)
+        return;
+
+    beginResetModel();
+    if (m_spliceModel) {
+        QObject::disconnect(m_spliceModel, SIGNAL(fastenersInserted(int,int)),
+                            this, SLOT(onFastenersInserted(int,int)));
+        QObject::disconnect(m_spliceModel, SIGNAL(fastenersChanged(int,int)),
+                            this, SLOT(onFastenersChanged(int,int)));
+        QObject::disconnect(m_spliceModel, SIGNAL(fastenersRemoved(int,int)),
+                            this, SLOT(onFastenersRemoved(int,int)));
+    }
+    m_spliceModel = model;
+    m_rowCount = 0;
+    if (m_spliceModel) {
+        QObject::connect(m_spliceModel, SIGNAL(fastenersInserted(int,int)),
+                         this, SLOT(onFastenersInserted(int,int)));
+        QObject::connect(m_spliceModel, SIGNAL(fastenersChanged(int,int)),
+                         this, SLOT(onFastenersChanged(int,int)));
+        QObject::connect(m_spliceModel, SIGNAL(fastenersRemoved(int,int)),
+                         this, SLOT(onFastenersRemoved(int,int)));
+        m_rowCount = m_spliceModel->fastenerCount();
+    }
+    endResetModel();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int FastenerTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+int FastenerTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : C_COLUMN_COUNT;
+}
+
+QVariant FastenerTableModel::data(const QModelIndex &index, int role) const
+{
+    if (role != Qt::DisplayRole || !m_spliceModel || !index.isValid())
+        return QVariant();
+
+    const int row = index.row();
+    if (row >= m_spliceModel->fastenerCount())
+        return QVariant();
+
+    const Fastener ft = m_spliceModel->fastenerAt(row);
+    switch (index.column()) {
+    case 0: return lengthToString( ft.positionX );
+    case 1: return lengthToString( ft.positionY );
+    case 2: return lengthToString( ft.diameter );
+    case 3: return lengthToString( ft.thickness );
+    case 4: return DOFToString( ft.DoF_X );
+    case 5: return DOFToString( ft.DoF_Y );
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+QVariant FastenerTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+        return QVariant();
+
+    switch (section) {
+    case 0: return tr("X");
+    case 1: return tr("Y");
+    case 2: return tr("d");
+    case 3: return tr("t");
+    case 4: return tr("dof X");
+    case 5: return tr("dof Y");
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/* The splice model has already changed when it notifies the range.
+ * The row count is updated between begin and end, as the views expect. */
+void FastenerTableModel::onFastenersInserted(const int first, const int last)
+{
+    beginInsertRows(QModelIndex(), first, last);
+    m_rowCount += last - first + 1;
+    endInsertRows();
+}
+
+void FastenerTableModel::onFastenersChanged(const int first, const int last)
+{
+    emit dataChanged(index(first, 0), index(last, C_COLUMN_COUNT - 1));
+}
+
+void FastenerTableModel::onFastenersRemoved(const int first, const int last)
+{
+    beginRemoveRows(QModelIndex(), first, last);
+    m_rowCount -= last - first + 1;
+    endRemoveRows();
+}
@@ -0,0 +1,50 @@
+/* - FastenerPattern - Copyright (C) 2016-2018 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WIDGETS_FASTENER_TABLE_MODEL_H
+#define WIDGETS_FASTENER_TABLE_MODEL_H
+
+#include <QtCore/QAbstractTableModel>
+
+class AbstractSpliceModel;
+
+class FastenerTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit FastenerTableModel(QObject *parent = Q_NULLPTR);
+    virtual ~FastenerTableModel() Q_DECL_NOEXCEPT {}
+
+    AbstractSpliceModel *spliceModel() const;
+    void setSpliceModel(AbstractSpliceModel *model);
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+    virtual QVariant headerData(int section, Qt::Orientation orientation,
+                                int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+
+protected Q_SLOTS:
+    void onFastenersInserted(const int first, const int last);
+    void onFastenersChanged(const int first, const int last);
+    void onFastenersRemoved(const int first, const int last);
+
+private:
+    AbstractSpliceModel *m_spliceModel;
+    int m_rowCount;
+};
+
+#endif // WIDGETS_FASTENER_TABLE_MODEL_H
@@ -18,52 +18,58 @@
 #include "ui_fastenertablewidget.h"
 
 #include <Core/AbstractSpliceModel>
-#include <Core/Fastener>
+#include <Widgets/FastenerTableModel>
 
+#include <QtCore/QItemSelectionModel>
 #include <QtCore/QTimer>
+#include <QtWidgets/QHeaderView>
 #ifdef QT_DEBUG
 #  include <QtCore/QDebug>
 #endif
 
-#define C_COLUMN_COUNT 6
-
-static inline QString DOFToString(Fastener::DOF dof)
-{
-    return (dof == Fastener::Fixed) ? QObject::tr("fixed") : QObject::tr("free");
-}
+#include <algorithm>
 
+/*! \class FastenerTableWidget
+ *  \brief The class FastenerTableWidget shows the fasteners in a table.
+ *
+ * The table is a QTableView over a FastenerTableModel, that formats
+ * only the visible cells. Hence, scrolling and editing cost
+ * O(visible rows), even with a large pattern.
+ *
+ * The selection is exchanged with the splice model as row ranges,
+ * through the QItemSelectionModel of the view.
+ */
 FastenerTableWidget::FastenerTableWidget(QWidget *parent) : AbstractSpliceView(parent)
   , ui(new Ui::FastenerTableWidget)
-  , m_tableTimer(new QTimer(this))
+  , m_tableModel(new FastenerTableModel(this))
   , m_selectionTimer(new QTimer(this))
+  , m_updatingSelection(false)
 {
     ui->setupUi(this);
 
-    QObject::connect(m_tableTimer, SIGNAL(timeout()), this, SLOT(updateTable()));
     QObject::connect(m_selectionTimer, SIGNAL(timeout()), this, SLOT(updateSelection()));
 
-    QStringList labels;
-    labels << tr("X") << tr("Y") << tr("d") << tr("t") << tr("dof X") << tr("dof Y");
-    ui->tableWidget->setColumnCount( C_COLUMN_COUNT );
-    ui->tableWidget->setHorizontalHeaderLabels(labels);
-
-    ui->tableWidget->horizontalHeader()->setVisible(true);
-    ui->tableWidget->verticalHeader()->setVisible(false);
-    int size = ui->tableWidget->verticalHeader()->minimumSectionSize();
-    ui->tableWidget->verticalHeader()->setDefaultSectionSize(size);
-
-    ui->tableWidget->setAlternatingRowColors(false);
-    ui->tableWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
-    ui->tableWidget->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->tableWidget->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
-    ui->tableWidget->setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
-    ui->tableWidget->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    ui->tableWidget->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
-
-    QObject::connect(ui->tableWidget, SIGNAL(itemSelectionChanged()),
-                     this, SLOT(onItemSelectionChanged()));
-
-    this->resizeColumnToContents();
+    ui->tableView->setModel(m_tableModel);
+
+    /* Fixed sizes: the view doesn't measure the rows' contents. */
+    ui->tableView->horizontalHeader()->setVisible(true);
+    ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    ui->tableView->verticalHeader()->setVisible(false);
+    int size = ui->tableView->verticalHeader()->minimumSectionSize();
+    ui->tableView->verticalHeader()->setDefaultSectionSize(size);
+    ui->tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+    ui->tableView->setAlternatingRowColors(false);
+    ui->tableView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    ui->tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    ui->tableView->setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
+    ui->tableView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    ui->tableView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+
+    QObject::connect(ui->tableView->selectionModel(),
+                     SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
+                     this, SLOT(onItemSelectionChanged(QItemSelection,QItemSelection)));
 }
 
 FastenerTableWidget::~FastenerTableWidget()
@@ -73,39 +79,44 @@ FastenerTableWidget::~FastenerTableWidget()
 
 /******************************************************************************
  ******************************************************************************/
-void FastenerTableWidget::resizeColumnToContents()
+void FastenerTableWidget::setModel(AbstractSpliceModel *model)
 {
-    for(int i = 0; i < C_COLUMN_COUNT; i++)
-        ui->tableWidget->resizeColumnToContents(i);
+    AbstractSpliceView::setModel(model);
+    m_tableModel->setSpliceModel(model);
+    updateSelectionLater(C_SHORT_DELAY_MSEC);
 }
 
-void FastenerTableWidget::onItemSelectionChanged()
+/******************************************************************************
+ ******************************************************************************/
+void FastenerTableWidget::onItemSelectionChanged(const QItemSelection &,
+                                                 const QItemSelection &)
 {
+    if (m_updatingSelection || !model())
+        return;
+
     QSet<int> set;
-    int row = ui->tableWidget->rowCount();
-    while (row>0) {
-        row--;
-        if ( ui->tableWidget->item(row,0)->isSelected() )
+    const QItemSelection selection = ui->tableView->selectionModel()->selection();
+    foreach (const QItemSelectionRange &range, selection) {
+        for (int row = range.top(); row <= range.bottom(); ++row) {
             set << row;
+        }
     }
     model()->setFastenerSelection(set);
 }
 
 /******************************************************************************
  ******************************************************************************/
-void FastenerTableWidget::onFastenerInserted(const int, const Fastener &)
+/* The rows are updated by the FastenerTableModel itself. */
+void FastenerTableWidget::onFastenersInserted(const int, const int)
 {
-    updateTableLater(C_SHORT_DELAY_MSEC);
 }
 
-void FastenerTableWidget::onFastenerChanged(const int, const Fastener &)
+void FastenerTableWidget::onFastenersChanged(const int, const int)
 {
-    updateTableLater(C_LONG_DELAY_MSEC);
 }
 
-void FastenerTableWidget::onFastenerRemoved(const int)
+void FastenerTableWidget::onFastenersRemoved(const int, const int)
 {
-    updateTableLater(C_SHORT_DELAY_MSEC);
 }
 
 void FastenerTableWidget::onSelectionFastenerChanged()
@@ -113,50 +124,6 @@ void FastenerTableWidget::onSelectionFastenerChanged()
     updateSelectionLater(C_SHORT_DELAY_MSEC);
 }
 
-/******************************************************************************
- ******************************************************************************/
-void FastenerTableWidget::updateTableLater(int msec)
-{
-    m_tableTimer->stop();
-    m_tableTimer->start(msec);
-}
-
-void FastenerTableWidget::updateTable()
-{
-    m_tableTimer->stop();
-
-    const int count = model()->fastenerCount();
-    ui->tableWidget->setRowCount(count);
-
-    Q_ASSERT( ui->tableWidget->rowCount() == count );
-    for (int row = 0; row < count; ++row) {
-
-        const Fastener ft = model()->fastenerAt(row);
-        const double x = ft.positionX.value() *1000; // mm !
-        const double y = ft.positionY.value() *1000; // mm !
-        const double d = ft.diameter.value()  *1000; // mm !
-        const double t = ft.thickness.value() *1000; // mm !
-
-        QTableWidgetItem *item_0 = new QTableWidgetItem( ft.name );
-        QTableWidgetItem *item_1 = new QTableWidgetItem( QString("%0").arg( x, 0, 'f', 1) );
-        QTableWidgetItem *item_2 = new QTableWidgetItem( QString("%0").arg( y, 0, 'f', 1) );
-        QTableWidgetItem *item_3 = new QTableWidgetItem( QString("%0").arg( d, 0, 'f', 1) );
-        QTableWidgetItem *item_4 = new QTableWidgetItem( QString("%0").arg( t, 0, 'f', 1) );
-        QTableWidgetItem *item_5 = new QTableWidgetItem( DOFToString( ft.DoF_X ) );
-        QTableWidgetItem *item_6 = new QTableWidgetItem( DOFToString( ft.DoF_Y ) );
-
-        ui->tableWidget->setItem(row, 0, item_0);
-        ui->tableWidget->setItem(row, 1, item_1);
-        ui->tableWidget->setItem(row, 2, item_2);
-        ui->tableWidget->setItem(row, 3, item_3);
-        ui->tableWidget->setItem(row, 4, item_4);
-        ui->tableWidget->setItem(row, 5, item_5);
-        ui->tableWidget->setItem(row, 6, item_6);
-    }
-
-    this->resizeColumnToContents();
-}
-
 /******************************************************************************
  ******************************************************************************/
 void FastenerTableWidget::updateSelectionLater(int msec)
@@ -165,30 +132,34 @@ void FastenerTableWidget::updateSelectionLater(int msec)
     m_selectionTimer->start(msec);
 }
 
+/* Selects the consecutive selected fasteners as a single range of rows. */
 void FastenerTableWidget::updateSelection()
 {
-    while (m_tableTimer->isActive()) {
-        /* Ensure the table is updated before updating the selection. */
-        updateTable();
-    }
-    Q_ASSERT(!m_tableTimer->isActive());
     m_selectionTimer->stop();
-
-    bool blocked1 = ui->tableWidget->blockSignals(true);
-    bool blocked2 = m_selectionTimer->blockSignals(true);
-    bool blocked3 = m_tableTimer->blockSignals(true);
-
-    QSet<int> set = model()->selectedFastenerIndexes();
-    int row = ui->tableWidget->rowCount();
-    while (row>0) {
-        row--;
-        bool selected = set.contains(row);
-        for (int col = 0; col < C_COLUMN_COUNT; ++col) {
-            ui->tableWidget->item(row, col)->setSelected( selected );
+    if (!model())
+        return;
+
+    QList<int> rows = model()->selectedFastenerIndexes().toList();
+    std::sort(rows.begin(), rows.end());
+
+    const int lastColumn = m_tableModel->columnCount() - 1;
+    QItemSelection selection;
+    int i = 0;
+    while (i < rows.count()) {
+        const int top = rows.at(i);
+        int bottom = top;
+        while (++i < rows.count() && rows.at(i) == bottom + 1) {
+            ++bottom;
+        }
+        if (top >= m_tableModel->rowCount()) {
+            break;
         }
+        bottom = qMin(bottom, m_tableModel->rowCount() - 1);
+        selection.append(QItemSelectionRange(m_tableModel->index(top, 0),
+                                             m_tableModel->index(bottom, lastColumn)));
     }
 
-    ui->tableWidget->blockSignals(blocked1);
-    m_selectionTimer->blockSignals(blocked2);
-    m_tableTimer->blockSignals(blocked3);
+    m_updatingSelection = true;
+    ui->tableView->selectionModel()->select(selection, QItemSelectionModel::ClearAndSelect);
+    m_updatingSelection = false;
 }
@@ -19,9 +19,12 @@
 
 #include <Widgets/AbstractSpliceView>
 
+QT_BEGIN_NAMESPACE
+class QItemSelection;
 class QTimer;
+QT_END_NAMESPACE
 
-class Fastener;
+class FastenerTableModel;
 
 namespace Ui {
 class FastenerTableWidget;
@@ -34,23 +37,24 @@ public:
     explicit FastenerTableWidget(QWidget *parent = 0);
     virtual ~FastenerTableWidget();
 
+    virtual void setModel(AbstractSpliceModel *model) Q_DECL_OVERRIDE;
+
 public Q_SLOTS:
-    virtual void onFastenerInserted(const int index, const Fastener &fastener) Q_DECL_OVERRIDE;
-    virtual void onFastenerChanged(const int index, const Fastener &fastener) Q_DECL_OVERRIDE;
-    virtual void onFastenerRemoved(const int index) Q_DECL_OVERRIDE;
+    virtual void onFastenersInserted(const int first, const int last) Q_DECL_OVERRIDE;
+    virtual void onFastenersChanged(const int first, const int last) Q_DECL_OVERRIDE;
+    virtual void onFastenersRemoved(const int first, const int last) Q_DECL_OVERRIDE;
     virtual void onSelectionFastenerChanged() Q_DECL_OVERRIDE;
 
 protected Q_SLOTS:
-    void onItemSelectionChanged();
-    void updateTable();
+    void onItemSelectionChanged(const QItemSelection &selected,
+                                const QItemSelection &deselected);
     void updateSelection();
 
 private:
     Ui::FastenerTableWidget *ui;
-    QTimer *m_tableTimer;
+    FastenerTableModel *m_tableModel;
     QTimer *m_selectionTimer;
-    void resizeColumnToContents();
-    void updateTableLater(int msec = 100);
+    bool m_updatingSelection;
     void updateSelectionLater(int msec = 100);
 };
 
@@ -84,7 +84,7 @@ void FastenerWidget::onChanged()
 
 /******************************************************************************
  ******************************************************************************/
-void FastenerWidget::onFastenerChanged(const int, const Fastener &)
+void FastenerWidget::onFastenersChanged(const int, const int)
 {
     updateInfoLater(C_SHORT_DELAY_MSEC);
 }
@@ -39,7 +39,7 @@ public:
     void setDecimals(int digits);
 
 public Q_SLOTS:
-    virtual void onFastenerChanged(const int index, const Fastener &fastener) Q_DECL_OVERRIDE;
+    virtual void onFastenersChanged(const int first, const int last) Q_DECL_OVERRIDE;
     virtual void onSelectionFastenerChanged() Q_DECL_OVERRIDE;
 
 private Q_SLOTS:
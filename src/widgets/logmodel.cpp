@@ -0,0 +1,169 @@
+/* - FastenerPattern - Copyright (C) 2016-2018 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logmodel.h"
+
+#include <QtCore/QDateTime>
+#include <QtGui/QBrush>
+
+#define C_DEFAULT_CAPACITY 1000
+
+/*! \class LogModel
+ *  \brief The class LogModel keeps the last messages of the optimisation,
+ *  for a QListView.
+ *
+ * The records are stored in a ring buffer of fixed capacity: when the
+ * buffer is full, appending a record discards the oldest one. Hence
+ * a long optimisation can't grow the console without bound.
+ *
+ * A record is stored as is (level, timestamp and message). It's formatted
+ * in data(), only when the view paints it, i.e. for the visible rows.
+ */
+LogModel::LogModel(QObject *parent) : QAbstractListModel(parent)
+  , m_records(C_DEFAULT_CAPACITY)
+  , m_first(0)
+  , m_count(0)
+  , m_timestampShown(false)
+{
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Returns the maximum number of records.
+ *
+ * The default is 1000.
+ */
+int LogModel::capacity() const
+{
+    return m_records.count();
+}
+
+/*! \brief Sets the maximum number of records, and discards the records
+ * in excess, starting with the oldest ones.
+ */
+void LogModel::setCapacity(int capacity)
+{
+    capacity = qMax(1, capacity);
+    if (capacity == m_records.count())
+        return;
+
+    const int excess = qMax(0, m_count - capacity);
+    if (excess > 0) {
+        beginRemoveRows(QModelIndex(), 0, excess - 1);
+    }
+    /* Unroll the ring: the oldest kept record goes first. */
+    QVector<Record> records(capacity);
+    const int count = m_count - excess;
+    for (int row = 0; row < count; ++row) {
+        records[row] = recordAt(excess + row);
+    }
+    m_records = records;
+    m_first = 0;
+    m_count = count;
+    if (excess > 0) {
+        endRemoveRows();
+    }
+}
+
+bool LogModel::isTimestampShown() const
+{
+    return m_timestampShown;
+}
+
+void LogModel::setTimestampShown(bool shown)
+{
+    if (m_timestampShown == shown)
+        return;
+    m_timestampShown = shown;
+    if (m_count > 0) {
+        emit dataChanged(index(0), index(m_count - 1));
+    }
+}
+
+/*! \brief Returns the record at the given \a row, the oldest first.
+ */
+const LogModel::Record &LogModel::recordAt(int row) const
+{
+    Q_ASSERT(row >= 0 && row < m_count);
+    return m_records.at((m_first + row) % m_records.count());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int LogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_count)
+        return QVariant();
+
+    const Record &record = recordAt(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        if (m_timestampShown) {
+            QDateTime datetime = QDateTime::fromMSecsSinceEpoch(record.timestamp);
+            QString str = datetime.toString("yyyy-MM-dd_hh:mm:ss.zzz");
+            return QString("[%0] %1").arg(str).arg(record.message);
+        }
+        return record.message;
+
+    case Qt::ForegroundRole:
+        switch (record.level) {
+        case Info:    return QBrush(Qt::black);
+        case Warning: return QBrush(Qt::blue);
+        case Fatal:   return QBrush(Qt::red);
+        default:
+            break;
+        }
+        break;
+
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void LogModel::append(LogModel::Level level, qint64 timestamp, const QString &message)
+{
+    const int capacity = m_records.count();
+    if (m_count == capacity) {
+        /* Full: discard the oldest record. */
+        beginRemoveRows(QModelIndex(), 0, 0);
+        m_first = (m_first + 1) % capacity;
+        m_count--;
+        endRemoveRows();
+    }
+    beginInsertRows(QModelIndex(), m_count, m_count);
+    Record &record = m_records[(m_first + m_count) % capacity];
+    record.level = level;
+    record.timestamp = timestamp;
+    record.message = message;
+    m_count++;
+    endInsertRows();
+}
+
+void LogModel::clear()
+{
+    beginResetModel();
+    m_first = 0;
+    m_count = 0;
+    endResetModel();
+}
@@ -0,0 +1,62 @@
+/* - FastenerPattern - Copyright (C) 2016-2018 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WIDGETS_LOG_MODEL_H
+#define WIDGETS_LOG_MODEL_H
+
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Level { Info, Warning, Fatal };
+
+    struct Record
+    {
+        Level level;
+        qint64 timestamp; /* msecs since epoch */
+        QString message;
+    };
+
+    explicit LogModel(QObject *parent = Q_NULLPTR);
+    virtual ~LogModel() Q_DECL_NOEXCEPT {}
+
+    int capacity() const;
+    void setCapacity(int capacity);
+
+    bool isTimestampShown() const;
+
+    const Record &recordAt(int row) const;
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+
+public Q_SLOTS:
+    void setTimestampShown(bool shown);
+    void append(LogModel::Level level, qint64 timestamp, const QString &message);
+    void clear();
+
+private:
+    QVector<Record> m_records; /* Ring buffer */
+    int m_first;
+    int m_count;
+    bool m_timestampShown;
+};
+
+#endif // WIDGETS_LOG_MODEL_H
@@ -21,11 +21,11 @@
 #include <Core/Splice>
 #include <Core/Optimizer/Controller>
 #include <Core/Optimizer/OptimisationSolver>
+#include <Widgets/LogModel>
 
 #include <boost/units/cmath.hpp> /* pow<>() */
 
 #include <QtCore/QDebug>
-#include <QtCore/QDateTime>
 #include <QtCore/QSharedPointer>
 
 /*! \class OptimisationWidget
@@ -45,14 +45,21 @@ OptimisationWidget::OptimisationWidget(QWidget *parent) : QWidget(parent)
   , ui(new Ui::OptimisationWidget)
   , m_controller(new Controller(this))
   , m_calculator(Q_NULLPTR)
+  , m_logModel(new LogModel(this))
 {
     ui->setupUi(this);
-    ui->console->clear();
     ui->detailOutput->clear();
 
-    ui->console->setWordWrapMode(QTextOption::NoWrap);
+    /* The console shows the last records only, and formats the visible ones. */
+    ui->console->setModel(m_logModel);
+    ui->console->setUniformItemSizes(true);
+    ui->console->setWordWrap(false);
     ui->console->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
     ui->console->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    connect(m_logModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+            ui->console, SLOT(scrollToBottom()));
+    connect(ui->showTimestampCheckBox, SIGNAL(toggled(bool)),
+            m_logModel, SLOT(setTimestampShown(bool)));
 
     ui->detailOutput->setWordWrapMode(QTextOption::NoWrap);
     ui->detailOutput->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
@@ -116,9 +123,12 @@ void OptimisationWidget::onShowResultToggled(bool checked)
 {
     QSharedPointer<Splice> splice = (checked ? m_controller->output()
                                              : m_controller->input() );
+    m_calculator->beginTransaction(checked ? QStringLiteral("Show Optimisation Result")
+                                           : QStringLiteral("Show Optimisation Input"));
     for (int i = 0; i < splice->fastenerCount(); ++i) {
         m_calculator->setFastener(i, splice->fastenerAt(i));
     }
+    m_calculator->endTransaction();
 }
 
 /******************************************************************************
@@ -148,17 +158,17 @@ void OptimisationWidget::onControllerStopped()
  ******************************************************************************/
 void OptimisationWidget::onControllerMessageInfo(qint64 timestamp, QString message)
 {
-    log(0, timestamp, message);
+    log(LogModel::Info, timestamp, message);
 }
 
 void OptimisationWidget::onControllerMessageWarning(qint64 timestamp, QString message)
 {
-    log(1, timestamp, message);
+    log(LogModel::Warning, timestamp, message);
 }
 
 void OptimisationWidget::onControllerMessageFatal(qint64 timestamp, QString message)
 {
-    log(2, timestamp, message);
+    log(LogModel::Fatal, timestamp, message);
 }
 
 void OptimisationWidget::onControllerMessageDebug(QString message)
@@ -169,30 +179,16 @@ void OptimisationWidget::onControllerMessageDebug(QString message)
 /******************************************************************************
  ******************************************************************************/
 /*! \brief Append the given \a message to the console with the given \a timestamp,
- * and colors the message according to the \a type of message.
+ * and colors the message according to the \a level of message.
  *
- * \remark Due to the limited width of the QTextEdit in the OptimisationWidget's UI,
+ * The console keeps the last LogModel::capacity() messages only.
+ *
+ * \remark Due to the limited width of the console in the OptimisationWidget's UI,
  * you'd better off to log messages with less than 40 characters.
  */
-void OptimisationWidget::log(int type, qint64 timestamp, const QString &message)
-{
-    switch (type) {
-    case 0: ui->console->setTextColor(Qt::black); break;
-    case 1: ui->console->setTextColor(Qt::blue); break;
-    case 2: ui->console->setTextColor(Qt::red); break;
-    default:
-        Q_UNREACHABLE();
-        break;
-    }
-
-    if (ui->showTimestampCheckBox->isChecked()) {
-        QDateTime datetime = QDateTime::fromMSecsSinceEpoch(timestamp);
-        QString str = datetime.toString("yyyy-mm-dd_hh:mm:ss.zzz");
-        QString text = QString("[%0] %1").arg(str).arg(message);
-        ui->console->append(text);
-    } else {
-        ui->console->append(message);
-    }
+void OptimisationWidget::log(LogModel::Level level, qint64 timestamp, const QString &message)
+{
+    m_logModel->append(level, timestamp, message);
 }
 
 
@@ -203,6 +199,9 @@ static inline QSharedPointer<Splice> currentSpliceCopy(AbstractSpliceModel *calc
     Q_ASSERT(calculator);
     QSharedPointer<Splice> splice = QSharedPointer<Splice>(new Splice);
     splice->setAppliedLoad( calculator->appliedLoad() );
+    for (int i = 0; i < calculator->loadCaseCount(); ++i) {
+        splice->addLoadCase( calculator->loadCaseAt(i) );
+    }
     for (int i = 0; i < calculator->designSpaceCount(); ++i) {
         splice->addDesignSpace( calculator->designSpaceAt(i) );
     }
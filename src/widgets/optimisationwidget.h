@@ -22,6 +22,7 @@
 
 #include <Core/Optimizer/Controller>
 #include <Core/Optimizer/OptimisationSolver>
+#include <Widgets/LogModel>
 
 class Splice;
 class AbstractSpliceModel;
@@ -61,8 +62,9 @@ private:
     Ui::OptimisationWidget *ui;
     Controller *m_controller;
     AbstractSpliceModel *m_calculator;
+    LogModel *m_logModel;
 
-    void log(int type, qint64 timestamp, const QString &message);
+    void log(LogModel::Level level, qint64 timestamp, const QString &message);
 };
 
 #endif // WIDGETS_OPTIMISATION_WIDGET_H
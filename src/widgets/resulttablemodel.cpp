@@ -0,0 +1,269 @@
+/* - FastenerPattern - Copyright (C) 2016-2018 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resulttablemodel.h"
+
+#include <Core/AbstractSpliceModel>
+#include <Core/Fastener>
+
+#include <QtCore/QPair>
+
+#include <algorithm>
+
+#define C_COLUMN_COUNT 4
+
+/* Displayed value, in N with one decimal. */
+static inline qint64 displayed(const Force &force)
+{
+    return qRound64(force.value() * 10);
+}
+
+static inline QString forceToString(const Force &force)
+{
+    return QString::number(force.value(), 'f', 1);
+}
+
+static inline bool isDisplayedDifferently(const Tensor &t1, const Tensor &t2)
+{
+    return displayed(t1.force_x) != displayed(t2.force_x)
+            || displayed(t1.force_y) != displayed(t2.force_y)
+            || displayed(t1.resultantFxy()) != displayed(t2.resultantFxy());
+}
+
+/*! \class ResultTableModel
+ *  \brief The class ResultTableModel presents the results of the solver
+ *  to a QTableView.
+ *
+ * The model keeps a shallow copy of the solver's output (see
+ * AbstractSpliceModel::results()), and formats a cell in data() only,
+ * i.e. for the visible rows.
+ *
+ * When the results are updated, the model compares them with the
+ * previous ones, as displayed (one decimal). Only the rows that look
+ * different are notified with dataChanged(). Hence dragging a fastener
+ * doesn't repaint the rows whose load changes by a few mN only.
+ *
+ * If topCount() is positive, the model shows only the topCount() most
+ * loaded fasteners (by resultant), in decreasing order. The top rows
+ * are found by a partial sort, in O(n log k).
+ */
+ResultTableModel::ResultTableModel(QObject *parent) : QAbstractTableModel(parent)
+  , m_spliceModel(Q_NULLPTR)
+  , m_topCount(0)
+{
+}
+
+/******************************************************************************
+ ******************************************************************************/
+AbstractSpliceModel *ResultTableModel::spliceModel() const
+{
+    return m_spliceModel;
+}
+
+void ResultTableModel::setSpliceModel(AbstractSpliceModel *model)
+{
+    if (model == m_spliceModel)
+        return;
+
+    beginResetModel();
+    m_spliceModel = model;
+    m_results = m_spliceModel ? m_spliceModel->results() : QList<Tensor>();
+    m_topIndexes = sortTopIndexes(m_results);
+    endResetModel();
+}
+
+/*! \brief Returns the maximum number of rows, or 0 to show all the results.
+ *
+ * The default is 0.
+ */
+int ResultTableModel::topCount() const
+{
+    return m_topCount;
+}
+
+void ResultTableModel::setTopCount(int count)
+{
+    count = qMax(0, count);
+    if (count == m_topCount)
+        return;
+
+    beginResetModel();
+    m_topCount = count;
+    m_topIndexes = sortTopIndexes(m_results);
+    endResetModel();
+}
+
+/*! \brief Returns the index of the fastener shown at the given \a row,
+ * or -1 if the row doesn't exist.
+ */
+int ResultTableModel::fastenerIndex(int row) const
+{
+    if (row < 0 || row >= rowCount())
+        return -1;
+    return (m_topCount > 0) ? m_topIndexes.at(row) : row;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+int ResultTableModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return (m_topCount > 0) ? m_topIndexes.count() : m_results.count();
+}
+
+int ResultTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : C_COLUMN_COUNT;
+}
+
+QVariant ResultTableModel::data(const QModelIndex &index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid())
+        return QVariant();
+
+    const int fastener = fastenerIndex(index.row());
+    if (fastener < 0)
+        return QVariant();
+
+    const Tensor &res = m_results.at(fastener);
+    switch (index.column()) {
+    case 0:
+        if (m_spliceModel && fastener < m_spliceModel->fastenerCount()) {
+            return m_spliceModel->fastenerAt(fastener).name;
+        }
+        break;
+    case 1: return forceToString( res.force_x );
+    case 2: return forceToString( res.force_y );
+    case 3: return forceToString( res.resultantFxy() );
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+QVariant ResultTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+        return QVariant();
+
+    switch (section) {
+    case 0: return tr("Name");
+    case 1: return tr("FX");
+    case 2: return tr("FY");
+    case 3: return tr("Resultant");
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/*! \brief Reads the results of the splice model, and notifies the rows
+ * that are displayed differently.
+ */
+void ResultTableModel::updateResults()
+{
+    setResults(m_spliceModel ? m_spliceModel->results() : QList<Tensor>());
+}
+
+/*! \brief Notifies that the names of the fasteners from \a first
+ * to \a last may have changed.
+ */
+void ResultTableModel::updateNames(const int first, const int last)
+{
+    const int count = rowCount();
+    if (count == 0)
+        return;
+    if (m_topCount > 0) {
+        /* Few rows, in any order. */
+        emit dataChanged(index(0, 0), index(count - 1, 0));
+    } else if (first < count) {
+        emit dataChanged(index(first, 0), index(qMin(last, count - 1), 0));
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void ResultTableModel::setResults(const QList<Tensor> &results)
+{
+    const QVector<int> topIndexes = sortTopIndexes(results);
+    const int oldCount = rowCount();
+    const int newCount = (m_topCount > 0) ? topIndexes.count() : results.count();
+
+    /* Ranges of the rows that exist before and after, and look different. */
+    QVector<QPair<int, int> > changes;
+    const int commonCount = qMin(oldCount, newCount);
+    for (int row = 0; row < commonCount; ++row) {
+        const int oldIndex = (m_topCount > 0) ? m_topIndexes.at(row) : row;
+        const int newIndex = (m_topCount > 0) ? topIndexes.at(row) : row;
+        if (oldIndex == newIndex
+                && !isDisplayedDifferently(m_results.at(oldIndex), results.at(newIndex))) {
+            continue;
+        }
+        if (!changes.isEmpty() && changes.last().second == row - 1) {
+            changes.last().second = row;
+        } else {
+            changes.append(qMakePair(row, row));
+        }
+    }
+
+    if (newCount < oldCount) {
+        beginRemoveRows(QModelIndex(), newCount, oldCount - 1);
+        m_results = results;
+        m_topIndexes = topIndexes;
+        endRemoveRows();
+    } else if (newCount > oldCount) {
+        beginInsertRows(QModelIndex(), oldCount, newCount - 1);
+        m_results = results;
+        m_topIndexes = topIndexes;
+        endInsertRows();
+    } else {
+        m_results = results;
+        m_topIndexes = topIndexes;
+    }
+
+    typedef QPair<int, int> Range;
+    foreach (const Range &range, changes) {
+        emit dataChanged(index(range.first, 0), index(range.second, C_COLUMN_COUNT - 1));
+    }
+}
+
+/* Returns the indexes of the topCount() most loaded fasteners,
+ * in decreasing order of resultant, or nothing if topCount() is 0. */
+QVector<int> ResultTableModel::sortTopIndexes(const QList<Tensor> &results) const
+{
+    if (m_topCount <= 0)
+        return QVector<int>();
+
+    const int count = results.count();
+    QVector<double> resultants(count);
+    QVector<int> indexes(count);
+    for (int i = 0; i < count; ++i) {
+        resultants[i] = results.at(i).resultantFxy().value();
+        indexes[i] = i;
+    }
+    const int topCount = qMin(m_topCount, count);
+    std::partial_sort(indexes.begin(), indexes.begin() + topCount, indexes.end(),
+                      [&resultants](int a, int b) {
+        if (resultants.at(a) != resultants.at(b))
+            return resultants.at(a) > resultants.at(b);
+        return a < b;
+    });
+    indexes.resize(topCount);
+    return indexes;
+}
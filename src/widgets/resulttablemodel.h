@@ -0,0 +1,63 @@
+/* - FastenerPattern - Copyright (C) 2016-2018 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WIDGETS_RESULT_TABLE_MODEL_H
+#define WIDGETS_RESULT_TABLE_MODEL_H
+
+#include <Core/Tensor>
+
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QList>
+#include <QtCore/QVector>
+
+class AbstractSpliceModel;
+
+class ResultTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit ResultTableModel(QObject *parent = Q_NULLPTR);
+    virtual ~ResultTableModel() Q_DECL_NOEXCEPT {}
+
+    AbstractSpliceModel *spliceModel() const;
+    void setSpliceModel(AbstractSpliceModel *model);
+
+    int topCount() const;
+    void setTopCount(int count);
+
+    int fastenerIndex(int row) const;
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    virtual int columnCount(const QModelIndex &parent = QModelIndex()) const Q_DECL_OVERRIDE;
+    virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+    virtual QVariant headerData(int section, Qt::Orientation orientation,
+                                int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+
+public Q_SLOTS:
+    void updateResults();
+    void updateNames(const int first, const int last);
+
+private:
+    AbstractSpliceModel *m_spliceModel;
+    QList<Tensor> m_results;   /* Shared with the solver's output */
+    QVector<int> m_topIndexes; /* Fastener of each row, if topCount() > 0 */
+    int m_topCount;
+
+    void setResults(const QList<Tensor> &results);
+    QVector<int> sortTopIndexes(const QList<Tensor> &results) const;
+};
+
+#endif // WIDGETS_RESULT_TABLE_MODEL_H
@@ -18,51 +18,69 @@
 #include "ui_resultwidget.h"
 
 #include <Core/AbstractSpliceModel>
-#include <Core/Fastener>
-#include <Core/Tensor>
+#include <Widgets/ResultTableModel>
 
+#include <QtCore/QItemSelectionModel>
 #include <QtCore/QTimer>
-#include <QtWidgets/QTableWidget>
+#include <QtWidgets/QHeaderView>
 #ifdef QT_DEBUG
 #  include <QtCore/QDebug>
 #endif
 
-#include <boost/units/cmath.hpp> /* pow<>() */
+#include <algorithm>
 
-#define C_COLUMN_COUNT 4
+#define C_DEFAULT_TOP_COUNT 20
 
+/*! \class ResultWidget
+ *  \brief The class ResultWidget shows the results in a table.
+ *
+ * The table is a QTableView over a ResultTableModel. Optionally, it shows
+ * only the most loaded fasteners (the "critical" ones), that is enough
+ * to review a large pattern.
+ */
 ResultWidget::ResultWidget(QWidget *parent) : AbstractSpliceView(parent)
   , ui(new Ui::ResultWidget)
+  , m_resultModel(new ResultTableModel(this))
   , m_selectionTimer(new QTimer(this))
   , m_resultTimer(new QTimer(this))
+  , m_updatingSelection(false)
 {
     ui->setupUi(this);
 
     QObject::connect(m_selectionTimer, SIGNAL(timeout()), this, SLOT(updateSelection()));
     QObject::connect(m_resultTimer, SIGNAL(timeout()), this, SLOT(updateResult()));
 
-    QStringList labels;
-    labels << tr("Name") <<  tr("FX") << tr("FY") << tr("Resultant");
-    ui->tableWidget->setColumnCount( C_COLUMN_COUNT );
-    ui->tableWidget->setHorizontalHeaderLabels(labels);
-
-    ui->tableWidget->horizontalHeader()->setVisible(true);
-    ui->tableWidget->verticalHeader()->setVisible(false);
-    int size = ui->tableWidget->verticalHeader()->minimumSectionSize();
-    ui->tableWidget->verticalHeader()->setDefaultSectionSize(size);
-
-    ui->tableWidget->setAlternatingRowColors(false);
-    ui->tableWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
-    ui->tableWidget->setSelectionBehavior(QAbstractItemView::SelectRows);
-    ui->tableWidget->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
-    ui->tableWidget->setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
-    ui->tableWidget->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    ui->tableWidget->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
-
-    QObject::connect(ui->tableWidget, SIGNAL(itemSelectionChanged()),
-                     this, SLOT(onItemSelectionChanged()));
-
-    this->resizeColumnToContents();
+    ui->tableView->setModel(m_resultModel);
+
+    /* Fixed sizes: the view doesn't measure the rows' contents. */
+    ui->tableView->horizontalHeader()->setVisible(true);
+    ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    ui->tableView->verticalHeader()->setVisible(false);
+    int size = ui->tableView->verticalHeader()->minimumSectionSize();
+    ui->tableView->verticalHeader()->setDefaultSectionSize(size);
+    ui->tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+    ui->tableView->setAlternatingRowColors(false);
+    ui->tableView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    ui->tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    ui->tableView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    ui->tableView->setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
+    ui->tableView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    ui->tableView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+
+    QObject::connect(ui->tableView->selectionModel(),
+                     SIGNAL(selectionChanged(QItemSelection,QItemSelection)),
+                     this, SLOT(onItemSelectionChanged(QItemSelection,QItemSelection)));
+
+    ui->topCountSpinBox->setRange(1, 1000000);
+    ui->topCountSpinBox->setValue(C_DEFAULT_TOP_COUNT);
+    ui->topCountSpinBox->setEnabled(false);
+    QObject::connect(ui->topCountCheckBox, SIGNAL(toggled(bool)),
+                     ui->topCountSpinBox, SLOT(setEnabled(bool)));
+    QObject::connect(ui->topCountCheckBox, SIGNAL(toggled(bool)),
+                     this, SLOT(onTopCountChanged()));
+    QObject::connect(ui->topCountSpinBox, SIGNAL(valueChanged(int)),
+                     this, SLOT(onTopCountChanged()));
 }
 
 ResultWidget::~ResultWidget()
@@ -72,26 +90,58 @@ ResultWidget::~ResultWidget()
 
 /******************************************************************************
  ******************************************************************************/
-void ResultWidget::resizeColumnToContents()
+void ResultWidget::setModel(AbstractSpliceModel *model)
 {
-    for(int i = 0; i < C_COLUMN_COUNT; i++)
-        ui->tableWidget->resizeColumnToContents(i);
+    AbstractSpliceView::setModel(model);
+    m_resultModel->setSpliceModel(model);
+    updateSelectionLater(C_SHORT_DELAY_MSEC);
 }
 
-void ResultWidget::onItemSelectionChanged()
+/******************************************************************************
+ ******************************************************************************/
+void ResultWidget::onItemSelectionChanged(const QItemSelection &,
+                                          const QItemSelection &)
 {
+    if (m_updatingSelection || !model())
+        return;
+
     QSet<int> set;
-    int row = ui->tableWidget->rowCount();
-    while (row>0) {
-        row--;
-        if ( ui->tableWidget->item(row,0)->isSelected() )
-            set << row;
+    const QItemSelection selection = ui->tableView->selectionModel()->selection();
+    foreach (const QItemSelectionRange &range, selection) {
+        for (int row = range.top(); row <= range.bottom(); ++row) {
+            set << m_resultModel->fastenerIndex(row);
+        }
     }
+    set.remove(-1);
     model()->setFastenerSelection(set);
 }
 
+void ResultWidget::onTopCountChanged()
+{
+    const bool top = ui->topCountCheckBox->isChecked();
+    m_resultModel->setTopCount(top ? ui->topCountSpinBox->value() : 0);
+    /* The model was reset. */
+    updateSelection();
+}
+
 /******************************************************************************
  ******************************************************************************/
+/* The rows follow the results. Only the names are read from the fasteners. */
+void ResultWidget::onFastenersInserted(const int first, const int)
+{
+    m_resultModel->updateNames(first, model()->fastenerCount() - 1);
+}
+
+void ResultWidget::onFastenersChanged(const int first, const int last)
+{
+    m_resultModel->updateNames(first, last);
+}
+
+void ResultWidget::onFastenersRemoved(const int first, const int)
+{
+    m_resultModel->updateNames(first, model()->fastenerCount() - 1);
+}
+
 void ResultWidget::onSelectionFastenerChanged()
 {
     updateSelectionLater(C_SHORT_DELAY_MSEC);
@@ -110,32 +160,47 @@ void ResultWidget::updateSelectionLater(int msec)
     m_selectionTimer->start(msec);
 }
 
+/* Selects the consecutive selected rows as a single range. */
 void ResultWidget::updateSelection()
 {
-    while (m_resultTimer->isActive()) {
-        /* Ensure the table is updated before updating the selection. */
-        updateResult();
-    }
-    Q_ASSERT(!m_resultTimer->isActive());
     m_selectionTimer->stop();
+    if (!model())
+        return;
+
+    const QSet<int> set = model()->selectedFastenerIndexes();
+    QList<int> rows;
+    if (m_resultModel->topCount() > 0) {
+        /* Few rows, not in the fasteners' order. */
+        for (int row = 0; row < m_resultModel->rowCount(); ++row) {
+            if (set.contains(m_resultModel->fastenerIndex(row)))
+                rows << row;
+        }
+    } else {
+        rows = set.toList();
+        std::sort(rows.begin(), rows.end());
+    }
 
-    bool blocked1 = ui->tableWidget->blockSignals(true);
-    bool blocked2 = m_selectionTimer->blockSignals(true);
-    bool blocked3 = m_resultTimer->blockSignals(true);
-
-    QSet<int> set = model()->selectedFastenerIndexes();
-    int row = ui->tableWidget->rowCount();
-    while (row>0) {
-        row--;
-        bool selected = set.contains(row);
-        for (int col = 0; col < C_COLUMN_COUNT; ++col) {
-            ui->tableWidget->item(row, col)->setSelected( selected );
+    const int rowCount = m_resultModel->rowCount();
+    const int lastColumn = m_resultModel->columnCount() - 1;
+    QItemSelection selection;
+    int i = 0;
+    while (i < rows.count()) {
+        const int top = rows.at(i);
+        int bottom = top;
+        while (++i < rows.count() && rows.at(i) == bottom + 1) {
+            ++bottom;
+        }
+        if (top >= rowCount) {
+            break;
         }
+        bottom = qMin(bottom, rowCount - 1);
+        selection.append(QItemSelectionRange(m_resultModel->index(top, 0),
+                                             m_resultModel->index(bottom, lastColumn)));
     }
 
-    ui->tableWidget->blockSignals(blocked1);
-    m_selectionTimer->blockSignals(blocked2);
-    m_resultTimer->blockSignals(blocked3);
+    m_updatingSelection = true;
+    ui->tableView->selectionModel()->select(selection, QItemSelectionModel::ClearAndSelect);
+    m_updatingSelection = false;
 }
 
 
@@ -150,31 +215,10 @@ void ResultWidget::updateResultLater(int msec)
 void ResultWidget::updateResult()
 {
     m_resultTimer->stop();
+    m_resultModel->updateResults();
 
-    const int count = model()->fastenerCount();
-    ui->tableWidget->setRowCount(count);
-
-    Q_ASSERT( ui->tableWidget->rowCount() == count );
-    for (int row = 0; row < count; ++row) {
-        Tensor res = model()->resultAt(row);
-        Fastener ft = model()->fastenerAt(row);
-
-        Force resultant =
-                boost::units::root<2>(
-                    boost::units::pow<2>(res.force_x)
-                    + boost::units::pow<2>(res.force_y));
-
-        QTableWidgetItem *item_0 = new QTableWidgetItem( ft.name );
-        QTableWidgetItem *item_1 = new QTableWidgetItem( QString("%0").arg( res.force_x.value(), 0, 'f', 1) );
-        QTableWidgetItem *item_2 = new QTableWidgetItem( QString("%0").arg( res.force_y.value(), 0, 'f', 1) );
-        QTableWidgetItem *item_3 = new QTableWidgetItem( QString("%0").arg( resultant.value(), 0, 'f', 1) );
-
-        ui->tableWidget->setItem(row, 0, item_0);
-        ui->tableWidget->setItem(row, 1, item_1);
-        ui->tableWidget->setItem(row, 2, item_2);
-        ui->tableWidget->setItem(row, 3, item_3);
+    if (m_resultModel->topCount() > 0) {
+        /* The critical fasteners may have moved to other rows. */
+        updateSelection();
     }
-
-    this->resizeColumnToContents();
 }
-
@@ -19,7 +19,12 @@
 
 #include <Widgets/AbstractSpliceView>
 
+QT_BEGIN_NAMESPACE
+class QItemSelection;
 class QTimer;
+QT_END_NAMESPACE
+
+class ResultTableModel;
 
 namespace Ui {
 class ResultWidget;
@@ -32,20 +37,28 @@ public:
     explicit ResultWidget(QWidget *parent = 0);
     ~ResultWidget();
 
+    virtual void setModel(AbstractSpliceModel *model) Q_DECL_OVERRIDE;
+
 public Q_SLOTS:
+    virtual void onFastenersInserted(const int first, const int last) Q_DECL_OVERRIDE;
+    virtual void onFastenersChanged(const int first, const int last) Q_DECL_OVERRIDE;
+    virtual void onFastenersRemoved(const int first, const int last) Q_DECL_OVERRIDE;
     virtual void onSelectionFastenerChanged() Q_DECL_OVERRIDE;
     virtual void onResultsChanged() Q_DECL_OVERRIDE;
 
 private Q_SLOTS:
-    void onItemSelectionChanged();
+    void onItemSelectionChanged(const QItemSelection &selected,
+                                const QItemSelection &deselected);
+    void onTopCountChanged();
     void updateSelection();
     void updateResult();
 
 private:
     Ui::ResultWidget *ui;
+    ResultTableModel *m_resultModel;
     QTimer *m_selectionTimer;
     QTimer *m_resultTimer;
-    void resizeColumnToContents();
+    bool m_updatingSelection;
     void updateSelectionLater(int msec = 100);
     void updateResultLater(int msec = 100);
 };
@@ -20,6 +20,7 @@
 #include <Core/DesignSpace>
 #include <Core/Fastener>
 
+#include <QtCore/QList>
 #include <QtCore/QSet>
 #include <QtGui/QIcon>
 #include <QtWidgets/QAction>
@@ -397,15 +398,16 @@ void SpliceToolbar::fastenerAdd()
 void SpliceToolbar::fastenerDuplicate()
 {
     QSet<int> newSet;
+    QList<Fastener> newFasteners;
+    const int count = model()->fastenerCount();
     QSet<int> set = model()->selectedFastenerIndexes();
     QSetIterator<int> it(set);
     while (it.hasNext()) {
         int index = it.next();
-        int newIndex = model()->fastenerCount();
-        Fastener newFastener( model()->fastenerAt(index) );
-        model()->insertFastener(newIndex, newFastener);
-        newSet << newIndex;
+        newSet << count + newFasteners.count();
+        newFasteners << model()->fastenerAt(index);
     }
+    model()->insertFasteners(count, newFasteners);
     model()->setFastenerSelection(newSet);
 }
 
@@ -422,18 +424,7 @@ void SpliceToolbar::fastenerSelectAll()
 
 void SpliceToolbar::fastenerRemove()
 {
-    /*
-     * REMARK: Here the selection changes during the removal, thus
-     * we need to remove the indexes from the highest to the lowest.
-     */
-    QSet<int> set = model()->selectedFastenerIndexes();
-    QList<int> list = set.toList();
-    qSort(list);
-    while (!list.isEmpty()) {
-        int index = list.last();
-        list.removeLast();
-        model()->removeFastener(index);
-    }
+    model()->removeFasteners(model()->selectedFastenerIndexes());
 }
 
 
@@ -5,10 +5,13 @@ HEADERS  += \
     $$PWD/designspacewidget.h \
     $$PWD/designvariablewidget.h \
     $$PWD/appliedloadwidget.h \
+    $$PWD/fastenertablemodel.h \
     $$PWD/fastenertablewidget.h \
     $$PWD/fastenerwidget.h \
+    $$PWD/logmodel.h \
     $$PWD/mainwidget.h \
     $$PWD/optimisationwidget.h \
+    $$PWD/resulttablemodel.h \
     $$PWD/resultwidget.h \
     $$PWD/solverwidget.h \
     $$PWD/splicetoolbar.h
@@ -20,10 +23,13 @@ SOURCES += \
     $$PWD/designspacewidget.cpp \
     $$PWD/designvariablewidget.cpp \
     $$PWD/appliedloadwidget.cpp \
+    $$PWD/fastenertablemodel.cpp \
     $$PWD/fastenertablewidget.cpp \
     $$PWD/fastenerwidget.cpp \
+    $$PWD/logmodel.cpp \
     $$PWD/mainwidget.cpp \
     $$PWD/optimisationwidget.cpp \
+    $$PWD/resulttablemodel.cpp \
     $$PWD/resultwidget.cpp \
     $$PWD/solverwidget.cpp \
     $$PWD/splicetoolbar.cpp
@@ -0,0 +1,32 @@
+#isEmpty(TEMPLATE):TEMPLATE=app
+TARGET       = tst_calculator
+CONFIG      += testcase
+QT           = core gui widgets testlib
+SOURCES     += tst_calculator.cpp
+
+# Include:
+INCLUDEPATH += ../../include
+
+# Dependancies:
+include($$PWD/../../src/core/core.pri)
+include($$PWD/../../src/math/math.pri)
+
+#-------------------------------------------------
+# Boost
+#-------------------------------------------------
+
+# INSTRUCTION: Replace the following path by your path:
+Boost_INCLUDE_DIR  = "C:/Qt/Boost/boost_1_61_0/"
+Boost_LIB_DIR      = "C:/Qt/Boost/boost_1_61_0/stage/lib/"
+#
+
+
+INCLUDEPATH += $$Boost_INCLUDE_DIR
+LIBS        += -L$$Boost_LIB_DIR
+DEFINES     += BOOST_MATH_DISABLE_FLOAT128
+
+#-------------------------------------------------
+# TRIANGLE
+#-------------------------------------------------
+include($$PWD/../../FastenerPattern_config.pri)
+include($$PWD/../../3rd/3rd.pri)
@@ -0,0 +1,452 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/Calculator>
+#include <Core/DesignSpace>
+#include <Core/Fastener>
+#include <Core/SpliceCommand>
+#include <Core/Tensor>
+
+#include <QtTest/QtTest>
+#include <QtCore/QDebug>
+#include <QtWidgets/QUndoStack>
+
+using namespace boost;
+using namespace units;
+using namespace si;
+
+class tst_Calculator : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /* Load Cases */
+    void test_loadCases_undoRedo();
+    void test_setLoadCase_merge();
+
+    /* Design Space Delta */
+    void test_designSpaceDelta_data();
+    void test_designSpaceDelta();
+    void test_designSpaceDelta_exactOffset();
+
+    /* Transactions */
+    void test_transaction_setDesignSpace_merge();
+    void test_transaction_setFastener_merge();
+
+    /* Undo Memory Limit */
+    void test_trimUndoStack_hysteresis();
+    void test_trimUndoStack_redoKept();
+    void test_trimUndoStack_cleanIndex();
+
+private:
+    DesignSpace createDesignSpace(const QString &name, const QPolygonF &polygon) const;
+    bool isExactlyEqual(const QPolygonF &actual, const QPolygonF &expected) const;
+    Fastener createFastener(int i) const;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+DesignSpace tst_Calculator::createDesignSpace(const QString &name, const QPolygonF &polygon) const
+{
+    DesignSpace res;
+    res.name = name;
+    res.polygon = polygon;
+    return res;
+}
+
+/* Unlike QPolygonF::operator==(), compares exactly. */
+bool tst_Calculator::isExactlyEqual(const QPolygonF &actual, const QPolygonF &expected) const
+{
+    if (actual.count() != expected.count()) {
+        return false;
+    }
+    for (int i = 0; i < actual.count(); ++i) {
+        if (actual.at(i).x() != expected.at(i).x() || actual.at(i).y() != expected.at(i).y()) {
+            qDebug() << i << actual.at(i) << expected.at(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+Fastener tst_Calculator::createFastener(int i) const
+{
+    return Fastener( (10. * i) *_mm, 0.*_mm, 4.83*_mm, 3.*_mm );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Calculator::test_loadCases_undoRedo()
+{
+    // Given
+    Calculator target;
+    Tensor first( 100.*N, 0.*N, 0.*N_m );
+    Tensor second( 0.*N, 200.*N, 0.*N_m );
+    Tensor third( 0.*N, 0.*N, 30.*N_m );
+    target.insertLoadCase(0, first);
+    target.insertLoadCase(1, second);
+    target.setLoadCase(0, third);
+    target.removeLoadCase(1);
+    target.removeLoadCase(1); /* invalid, not recorded */
+
+    // When
+    QCOMPARE( target.undoStack()->count(), 4 );
+    target.undoStack()->undo();
+
+    // Then
+    QCOMPARE( target.loadCaseCount(), 2 );
+    QCOMPARE( target.loadCaseAt(0), third );
+    QCOMPARE( target.loadCaseAt(1), second );
+
+    // When
+    target.undoStack()->undo();
+
+    // Then
+    QCOMPARE( target.loadCaseAt(0), first );
+
+    // When
+    target.undoStack()->setIndex(0);
+
+    // Then
+    QCOMPARE( target.loadCaseCount(), 0 );
+
+    // When
+    target.undoStack()->setIndex(4);
+
+    // Then
+    QCOMPARE( target.loadCaseCount(), 1 );
+    QCOMPARE( target.loadCaseAt(0), third );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Calculator::test_setLoadCase_merge()
+{
+    // Given
+    Calculator target;
+    Tensor first( 100.*N, 0.*N, 0.*N_m );
+    target.insertLoadCase(0, first);
+    target.insertLoadCase(1, first);
+
+    // When
+    /* Consecutive edits of the same load case: one command */
+    target.setLoadCase(0, Tensor( 110.*N, 0.*N, 0.*N_m ));
+    target.setLoadCase(0, Tensor( 120.*N, 0.*N, 0.*N_m ));
+    target.setLoadCase(1, Tensor( 130.*N, 0.*N, 0.*N_m ));
+
+    // Then
+    QCOMPARE( target.undoStack()->count(), 4 );
+
+    // When
+    target.undoStack()->undo();
+    target.undoStack()->undo();
+
+    // Then
+    QCOMPARE( target.loadCaseAt(0), first );
+    QCOMPARE( target.loadCaseAt(1), first );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Calculator::test_designSpaceDelta_data()
+{
+    QTest::addColumn<QPolygonF>("before");
+    QTest::addColumn<QPolygonF>("after");
+    QTest::addColumn<bool>("compact"); /* Stores less than the polygons */
+
+    QPolygonF square;
+    square << QPointF(0., 0.) << QPointF(1., 0.) << QPointF(1., 1.) << QPointF(0., 1.);
+
+    QPolygonF moved = square;
+    moved[2] = QPointF(2., 3.);
+
+    QPolygonF replaced;
+    replaced << QPointF(5., 5.) << QPointF(6., 5.) << QPointF(6., 6.);
+
+    QTest::newRow("unchanged") << square << square << true;
+    QTest::newRow("translated") << square << square.translated(0.5, -2.) << true;
+    QTest::newRow("moved") << square << moved << true;
+    QTest::newRow("replaced") << square << replaced << false;
+    QTest::newRow("from empty") << QPolygonF() << square << false;
+    QTest::newRow("to empty") << square << QPolygonF() << false;
+}
+
+void tst_Calculator::test_designSpaceDelta()
+{
+    QFETCH(QPolygonF, before);
+    QFETCH(QPolygonF, after);
+    QFETCH(bool, compact);
+
+    // Given
+    const DesignSpace first = createDesignSpace(QStringLiteral("first"), before);
+    const DesignSpace last = createDesignSpace(QStringLiteral("last"), after);
+    const DesignSpace unnamed = createDesignSpace(QStringLiteral("first"), after);
+
+    // When
+    SpliceCommand::DesignSpaceDelta delta(first, last);
+    SpliceCommand::DesignSpaceDelta polygonOnly(first, unnamed);
+
+    // Then
+    QCOMPARE( delta.after(first).name, last.name );
+    QCOMPARE( delta.before(last).name, first.name );
+    QVERIFY( isExactlyEqual(delta.after(first).polygon, after) );
+    QVERIFY( isExactlyEqual(delta.before(last).polygon, before) );
+    const qint64 polygons = qint64(before.count() + after.count()) * qint64(sizeof(QPointF));
+    const qint64 stored = polygonOnly.cost() - SpliceCommand::DesignSpaceDelta().cost();
+    QCOMPARE( stored < polygons, compact );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Calculator::test_designSpaceDelta_exactOffset()
+{
+    // Given
+    /* 0.1 + 0.2 - 0.2 != 0.1: the offset doesn't give back the vertices. */
+    const QPointF offset(0.2, 0.);
+    QPolygonF before;
+    before << QPointF(0., 0.) << QPointF(0.1, 0.) << QPointF(1., 1.);
+    QPolygonF after;
+    foreach (auto &point, before) {
+        after << point + offset;
+    }
+    QVERIFY( after.at(1).x() - offset.x() != before.at(1).x() );
+    const DesignSpace first = createDesignSpace(QString(), before);
+    const DesignSpace last = createDesignSpace(QString(), after);
+
+    // When
+    SpliceCommand::DesignSpaceDelta delta(first, last);
+
+    // Then
+    QVERIFY( isExactlyEqual(delta.before(last).polygon, before) );
+    QVERIFY( isExactlyEqual(delta.after(first).polygon, after) );
+    QVERIFY( isExactlyEqual(delta.after(delta.before(last)).polygon, after) );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Calculator::test_transaction_setDesignSpace_merge()
+{
+    // Given
+    Calculator target;
+    QPolygonF square;
+    square << QPointF(0., 0.) << QPointF(1., 0.) << QPointF(1., 1.) << QPointF(0., 1.);
+    const DesignSpace first = createDesignSpace(QStringLiteral("first"), square);
+    const DesignSpace second = createDesignSpace(QStringLiteral("second"), square.translated(5., 0.));
+    target.insertDesignSpace(0, first);
+    target.insertDesignSpace(1, second);
+    QCOMPARE( target.undoStack()->count(), 2 );
+
+    // When
+    /* A drag of both design spaces, then a vertex of the first */
+    target.beginTransaction();
+    for (int i = 1; i <= 10; ++i) {
+        target.setDesignSpace(0, createDesignSpace(first.name, square.translated(0.1 * i, 0.)));
+        target.setDesignSpace(1, createDesignSpace(second.name, square.translated(5. + 0.1 * i, 0.)));
+    }
+    DesignSpace edited = target.designSpaceAt(0);
+    edited.polygon[2] = QPointF(3., 3.);
+    target.setDesignSpace(0, edited);
+    target.endTransaction();
+    const DesignSpace lastFirst = target.designSpaceAt(0);
+    const DesignSpace lastSecond = target.designSpaceAt(1);
+
+    // Then
+    QCOMPARE( target.undoStack()->count(), 3 );
+    auto transaction = static_cast<const SpliceCommand::Transaction*>(target.undoStack()->command(2));
+    QCOMPARE( transaction->commandCount(), 1 ); /* Merged */
+
+    // When
+    target.undoStack()->undo();
+
+    // Then
+    QCOMPARE( target.designSpaceAt(0), first );
+    QCOMPARE( target.designSpaceAt(1), second );
+    QVERIFY( isExactlyEqual(target.designSpaceAt(0).polygon, first.polygon) );
+    QVERIFY( isExactlyEqual(target.designSpaceAt(1).polygon, second.polygon) );
+
+    // When
+    target.undoStack()->redo();
+
+    // Then
+    QVERIFY( isExactlyEqual(target.designSpaceAt(0).polygon, lastFirst.polygon) );
+    QVERIFY( isExactlyEqual(target.designSpaceAt(1).polygon, lastSecond.polygon) );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Calculator::test_transaction_setFastener_merge()
+{
+    // Given
+    Calculator target;
+    target.insertFastener(0, createFastener(0));
+    target.insertFastener(1, createFastener(1));
+
+    // When
+    target.beginTransaction();
+    target.setFastener(0, createFastener(2));
+    target.setFastener(1, createFastener(3));
+    target.setFastener(0, createFastener(4));
+    target.endTransaction();
+
+    // Then
+    QCOMPARE( target.undoStack()->count(), 3 );
+    auto transaction = static_cast<const SpliceCommand::Transaction*>(target.undoStack()->command(2));
+    QCOMPARE( transaction->commandCount(), 1 );
+    QCOMPARE( target.fastenerAt(0), createFastener(4) );
+
+    // When
+    target.undoStack()->undo();
+
+    // Then
+    /* The first previous value is restored */
+    QCOMPARE( target.fastenerAt(0), createFastener(0) );
+    QCOMPARE( target.fastenerAt(1), createFastener(1) );
+
+    // When
+    target.undoStack()->redo();
+
+    // Then
+    QCOMPARE( target.fastenerAt(0), createFastener(4) );
+    QCOMPARE( target.fastenerAt(1), createFastener(3) );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Calculator::test_trimUndoStack_hysteresis()
+{
+    // Given
+    Calculator target;
+    target.insertFastener(0, createFastener(0));
+    const qint64 cost = target.undoMemoryCost(); /* of each insertion */
+    target.setUndoMemoryLimit(8 * cost + cost / 2);
+    for (int i = 1; i < 8; ++i) {
+        target.insertFastener(i, createFastener(i));
+    }
+    QCOMPARE( target.undoStack()->count(), 8 );
+
+    // When
+    target.insertFastener(8, createFastener(8));
+
+    // Then
+    /* Trimmed down to 75% of the limit */
+    QCOMPARE( target.undoStack()->count(), 6 );
+    QVERIFY( target.undoMemoryCost() <= (8 * cost + cost / 2) * 75 / 100 );
+
+    // When
+    target.insertFastener(9, createFastener(9));
+    target.insertFastener(10, createFastener(10));
+
+    // Then
+    /* Not trimmed again until the limit */
+    QCOMPARE( target.undoStack()->count(), 8 );
+
+    // When
+    target.undoStack()->setIndex(0);
+
+    // Then
+    /* The discarded insertions can't be undone */
+    QCOMPARE( target.fastenerCount(), 3 );
+
+    // When
+    target.undoStack()->setIndex(8);
+
+    // Then
+    QCOMPARE( target.fastenerCount(), 11 );
+    QCOMPARE( target.fastenerAt(10), createFastener(10) );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Calculator::test_trimUndoStack_redoKept()
+{
+    // Given
+    Calculator target;
+    for (int i = 0; i < 8; ++i) {
+        target.insertFastener(i, createFastener(i));
+    }
+    const qint64 cost = target.undoMemoryCost() / 8;
+    target.undoStack()->setIndex(5);
+    QCOMPARE( target.fastenerCount(), 5 );
+
+    // When
+    target.setUndoMemoryLimit(4 * cost + cost / 2);
+
+    // Then
+    /* The 5 done commands are discarded, the 3 undone commands are kept */
+    QCOMPARE( target.undoStack()->count(), 3 );
+    QCOMPARE( target.undoStack()->index(), 0 );
+    QCOMPARE( target.fastenerCount(), 5 );
+
+    // When
+    /* The clones are in the undone state: redo executes them */
+    target.undoStack()->redo();
+    target.undoStack()->redo();
+    target.undoStack()->redo();
+
+    // Then
+    QCOMPARE( target.fastenerCount(), 8 );
+    QCOMPARE( target.fastenerAt(7), createFastener(7) );
+
+    // When
+    target.undoStack()->undo();
+
+    // Then
+    QCOMPARE( target.fastenerCount(), 7 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Calculator::test_trimUndoStack_cleanIndex()
+{
+    // Given
+    Calculator target;
+    target.insertFastener(0, createFastener(0));
+    const qint64 cost = target.undoMemoryCost();
+    for (int i = 1; i < 7; ++i) {
+        target.insertFastener(i, createFastener(i));
+    }
+    target.undoStack()->setClean(); /* Saved at 7 */
+    target.insertFastener(7, createFastener(7));
+    target.setUndoMemoryLimit(8 * cost + cost / 2);
+
+    // When
+    target.insertFastener(8, createFastener(8));
+
+    // Then
+    /* 3 commands discarded: the clean index follows */
+    QCOMPARE( target.undoStack()->count(), 6 );
+    QCOMPARE( target.undoStack()->cleanIndex(), 4 );
+    QVERIFY( !target.undoStack()->isClean() );
+
+    // When
+    target.undoStack()->undo();
+    target.undoStack()->undo();
+
+    // Then
+    QVERIFY( target.undoStack()->isClean() );
+    QCOMPARE( target.fastenerCount(), 7 );
+
+    // When
+    target.undoStack()->redo();
+
+    // Then
+    QVERIFY( !target.undoStack()->isClean() );
+    QCOMPARE( target.fastenerCount(), 8 );
+}
+
+QTEST_GUILESS_MAIN(tst_Calculator)
+
+#include "tst_calculator.moc"
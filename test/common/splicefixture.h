@@ -0,0 +1,61 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEST_COMMON_SPLICE_FIXTURE_H
+#define TEST_COMMON_SPLICE_FIXTURE_H
+
+#include <Core/DesignSpace>
+#include <Core/Fastener>
+#include <Core/Splice>
+#include <Core/Tensor>
+
+#include <QtCore/QPointF>
+#include <QtCore/QString>
+
+namespace Fixture {
+
+/* Splice shared by the file format tests: it uses all the members,
+ * a string that needs escaping, the DoFs, and an empty design space. */
+inline Splice createSplice()
+{
+    Splice splice;
+    splice.setTitle(QStringLiteral("Test"));
+    splice.setAuthor(QStringLiteral("Me"));
+    splice.setDate(QStringLiteral("2017-01-01"));
+    splice.setDescription(QString::fromUtf8("Splice with \"quotes\"\nand accents: \xC3\xA9\xC3\xA8"));
+    splice.setAppliedLoad( Tensor( 100.*N, -50.*N, 12.5*N_m ) );
+    splice.addLoadCase( Tensor( 100.*N, -50.*N, 12.5*N_m ) );
+    splice.addLoadCase( Tensor( -20.*N, 300.*N, 0.*N_m ) );
+
+    Fastener f1(  1.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm );
+    Fastener f2( 21.*_mm, 5.*_mm, 4.83*_mm, 3.*_mm, Fastener::Free, Fastener::Fixed );
+    Fastener f3( 41.*_mm, 0.*_mm, 6.35*_mm, 2.*_mm, Fastener::Fixed, Fastener::Free );
+    f3.name = QStringLiteral("Last");
+    splice.addFastener(f1);
+    splice.addFastener(f2);
+    splice.addFastener(f3);
+
+    DesignSpace ds;
+    ds.name = QStringLiteral("Area");
+    ds.polygon << QPointF(0., 0.) << QPointF(0.1, 0.) << QPointF(0.1, 0.05);
+    splice.addDesignSpace(ds);
+    splice.addDesignSpace(DesignSpace());
+    return splice;
+}
+
+} // namespace Fixture
+
+#endif // TEST_COMMON_SPLICE_FIXTURE_H
@@ -15,6 +15,8 @@
  */
 
 #include <Math/Delaunay>
+#include <Math/IncrementalDelaunay>
+#include <Math/Triangulator>
 
 #include <QtTest/QtTest>
 #include <QtCore/QDebug>
@@ -38,17 +40,65 @@ private slots:
     void test_collinear_points_along_y();
     void test_collinear_points_along_y_2();
     void test_collinear_points_along_xy();
+
+    void test_incremental_insert();
+    void test_incremental_move();
+    void test_incremental_remove();
+    void test_incremental_coincident_points();
+    void test_incremental_changedEdges();
+
+    void test_triangulator_reuse();
+
+    void benchmark_delaunayTriangulation_data();
+    void benchmark_delaunayTriangulation();
+
+private:
+    QVector<QPointF> randomPoints(int count) const;
+    QSet<QString> toSet(const QVector<QLineF> &lines) const;
+    QSet<QString> toSet(const Math::IncrementalDelaunay &triangulation) const;
 };
 
+/******************************************************************************
+ ******************************************************************************/
+QVector<QPointF> tst_Delaunay::randomPoints(int count) const
+{
+    QVector<QPointF> points;
+    for (int i = 0; i < count; ++i) {
+        points << QPointF(qrand() % 100000 / 100., qrand() % 100000 / 100.);
+    }
+    return points;
+}
+
+/* The edges, as strings independent of the direction and of the order. */
+QSet<QString> tst_Delaunay::toSet(const QVector<QLineF> &lines) const
+{
+    QSet<QString> set;
+    foreach (auto &line, lines) {
+        QString a = QString("%0,%1").arg(line.x1()).arg(line.y1());
+        QString b = QString("%0,%1").arg(line.x2()).arg(line.y2());
+        set << (a < b ? a + " " + b : b + " " + a);
+    }
+    return set;
+}
+
+QSet<QString> tst_Delaunay::toSet(const Math::IncrementalDelaunay &triangulation) const
+{
+    QVector<QLineF> lines;
+    foreach (auto &edge, triangulation.edges()) {
+        lines << QLineF(triangulation.point(edge.first), triangulation.point(edge.second));
+    }
+    return toSet(lines);
+}
+
 
 /******************************************************************************
  ******************************************************************************/
 void tst_Delaunay::test_empty()
 {
     // Given, When
-    QList<QPointF> points;
-    QList<QLineF> expected;
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QPointF> points;
+    QVector<QLineF> expected;
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
@@ -59,13 +109,13 @@ void tst_Delaunay::test_empty()
 void tst_Delaunay::test_one_point()
 {
     // Given
-    QList<QPointF> points;
+    QVector<QPointF> points;
     points << QPointF(10,20);
 
-    QList<QLineF> expected;
+    QVector<QLineF> expected;
 
     // When
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
@@ -76,13 +126,13 @@ void tst_Delaunay::test_one_point()
 void tst_Delaunay::test_coincident_points()
 {
     // Given
-    QList<QPointF> points;
+    QVector<QPointF> points;
     points << QPointF(10,20) << QPointF(10,20);
 
-    QList<QLineF> expected;
+    QVector<QLineF> expected;
 
     // When
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
@@ -93,13 +143,13 @@ void tst_Delaunay::test_coincident_points()
 void tst_Delaunay::test_coincident_points_2()
 {
     // Given
-    QList<QPointF> points;
+    QVector<QPointF> points;
     points << QPointF(0,0) << QPointF(0,0) << QPointF(0,0) << QPointF(0,0);
 
-    QList<QLineF> expected;
+    QVector<QLineF> expected;
 
     // When
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
@@ -111,14 +161,14 @@ void tst_Delaunay::test_coincident_points_2()
 void tst_Delaunay::test_coincident_points_3()
 {
     // Given
-    QList<QPointF> points;
+    QVector<QPointF> points;
     points << QPointF(10,20) << QPointF(10,20) << QPointF(5,0);
 
-    QList<QLineF> expected;
+    QVector<QLineF> expected;
     expected << QLineF(10,20,5,0);
 
     // When
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
@@ -129,14 +179,14 @@ void tst_Delaunay::test_coincident_points_3()
 void tst_Delaunay::test_two_points()
 {
     // Given
-    QList<QPointF> points;
+    QVector<QPointF> points;
     points << QPointF(0,0) << QPointF(10,0);
 
-    QList<QLineF> expected;
+    QVector<QLineF> expected;
     expected << QLineF(0,0,10,0);
 
     // When
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
@@ -147,14 +197,14 @@ void tst_Delaunay::test_two_points()
 void tst_Delaunay::test_three_points()
 {
     // Given
-    QList<QPointF> points;
+    QVector<QPointF> points;
     points << QPointF(-10,0) << QPointF(10,0) << QPointF(0,10);
 
-    QList<QLineF> expected;
+    QVector<QLineF> expected;
     expected << QLineF(-10,0,10,0) << QLineF(10,0,0,10) << QLineF(0,10,-10,0);
 
     // When
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
@@ -165,14 +215,14 @@ void tst_Delaunay::test_three_points()
 void tst_Delaunay::test_collinear_points()
 {
     // Given
-    QList<QPointF> points;
+    QVector<QPointF> points;
     points << QPointF(0,0) << QPointF(10,0) << QPointF(20,0); // collinear
 
-    QList<QLineF> expected;
+    QVector<QLineF> expected;
     expected << QLineF(0,0,10,0) << QLineF(10,0,20,0);
 
     // When
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
@@ -183,14 +233,14 @@ void tst_Delaunay::test_collinear_points()
 void tst_Delaunay::test_collinear_points_along_x()
 {
     // Given
-    QList<QPointF> points;
+    QVector<QPointF> points;
     points << QPointF(0,0) << QPointF(10,0) << QPointF(-10,0); // collinear
 
-    QList<QLineF> expected;
+    QVector<QLineF> expected;
     expected << QLineF(-10,0,0,0) << QLineF(0,0,10,0);
 
     // When
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
@@ -201,14 +251,14 @@ void tst_Delaunay::test_collinear_points_along_x()
 void tst_Delaunay::test_collinear_points_along_y()
 {
     // Given
-    QList<QPointF> points;
+    QVector<QPointF> points;
     points << QPointF(0,0) << QPointF(0,10) << QPointF(0,-10); // collinear
 
-    QList<QLineF> expected;
+    QVector<QLineF> expected;
     expected << QLineF(0,-10,0,0) << QLineF(0,0,0,10);
 
     // When
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
@@ -219,14 +269,14 @@ void tst_Delaunay::test_collinear_points_along_y()
 void tst_Delaunay::test_collinear_points_along_y_2()
 {
     // Given
-    QList<QPointF> points;
+    QVector<QPointF> points;
     points << QPointF(0,0) << QPointF(0,-10) << QPointF(0,10); // collinear
 
-    QList<QLineF> expected;
+    QVector<QLineF> expected;
     expected << QLineF(0,-10,0,0) << QLineF(0,0,0,10);
 
     // When
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
@@ -237,19 +287,232 @@ void tst_Delaunay::test_collinear_points_along_y_2()
 void tst_Delaunay::test_collinear_points_along_xy()
 {
     // Given
-    QList<QPointF> points;
+    QVector<QPointF> points;
     points << QPointF(0,0) << QPointF(10,-2) << QPointF(-10,2); // collinear
 
-    QList<QLineF> expected;
+    QVector<QLineF> expected;
     expected << QLineF(-10,2,0,0) << QLineF(0,0,10,-2);
 
     // When
-    QList<QLineF> actual = Math::delaunayTriangulation(points);
+    QVector<QLineF> actual = Math::delaunayTriangulation(points);
 
     // Then
     QCOMPARE(actual, expected);
 }
 
+/******************************************************************************
+ ******************************************************************************/
+void tst_Delaunay::test_incremental_insert()
+{
+    // Given
+    qsrand(1);
+    QVector<QPointF> points = randomPoints(200);
+
+    // When
+    Math::IncrementalDelaunay triangulation;
+    foreach (auto &point, points) {
+        triangulation.insert(point);
+    }
+
+    // Then
+    QCOMPARE(triangulation.count(), points.count());
+    QCOMPARE(toSet(triangulation), toSet(Math::delaunayTriangulation(points)));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Delaunay::test_incremental_move()
+{
+    // Given
+    qsrand(2);
+    QVector<QPointF> points = randomPoints(200);
+    Math::IncrementalDelaunay triangulation;
+    QList<int> ids;
+    foreach (auto &point, points) {
+        ids << triangulation.insert(point);
+    }
+
+    // When
+    for (int i = 0; i < 100; ++i) {
+        const int index = qrand() % points.count();
+        points[index] = randomPoints(1).first();
+        triangulation.move(ids.at(index), points.at(index));
+    }
+
+    // Then
+    QCOMPARE(toSet(triangulation), toSet(Math::delaunayTriangulation(points)));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Delaunay::test_incremental_remove()
+{
+    // Given
+    qsrand(3);
+    QVector<QPointF> points = randomPoints(200);
+    Math::IncrementalDelaunay triangulation;
+    QList<int> ids;
+    foreach (auto &point, points) {
+        ids << triangulation.insert(point);
+    }
+
+    // When
+    while (points.count() > 3) {
+        const int index = qrand() % points.count();
+        triangulation.remove(ids.takeAt(index));
+        points.removeAt(index);
+    }
+
+    // Then
+    QCOMPARE(triangulation.count(), 3);
+    QCOMPARE(toSet(triangulation), toSet(Math::delaunayTriangulation(points)));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Delaunay::test_incremental_coincident_points()
+{
+    // Given
+    Math::IncrementalDelaunay triangulation;
+    int a = triangulation.insert(QPointF(10,20));
+    int b = triangulation.insert(QPointF(10,20));
+    int c = triangulation.insert(QPointF(30,20));
+
+    // When
+    QVERIFY(triangulation.hasEdge(a, c) != triangulation.hasEdge(b, c));
+    triangulation.move(a, QPointF(20,50));
+
+    // Then
+    QCOMPARE(triangulation.edges().count(), 3);
+    QVERIFY(triangulation.hasEdge(a, b));
+    QVERIFY(triangulation.hasEdge(b, c));
+    QVERIFY(triangulation.hasEdge(a, c));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Delaunay::test_incremental_changedEdges()
+{
+    // Given
+    qsrand(4);
+    Math::IncrementalDelaunay triangulation;
+    QList<int> ids;
+    QSet<Math::IncrementalDelaunay::Edge> shown;
+
+    // When
+    for (int i = 0; i < 300; ++i) {
+        const int operation = qrand() % 4;
+        if (ids.count() < 3 || operation < 2) {
+            ids << triangulation.insert(randomPoints(1).first());
+        } else if (operation == 2) {
+            triangulation.remove(ids.takeAt(qrand() % ids.count()));
+        } else {
+            triangulation.move(ids.at(qrand() % ids.count()), randomPoints(1).first());
+        }
+        /* Update only the changed edges, like a view does */
+        foreach (auto &edge, triangulation.takeChangedEdges()) {
+            if (triangulation.hasEdge(edge.first, edge.second)) {
+                shown.insert(edge);
+            } else {
+                shown.remove(edge);
+            }
+        }
+    }
+
+    // Then
+    QSet<Math::IncrementalDelaunay::Edge> expected;
+    foreach (auto &edge, triangulation.edges()) {
+        expected.insert(edge);
+    }
+    QCOMPARE(shown, expected);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Delaunay::test_triangulator_reuse()
+{
+    // Given
+    qsrand(6);
+    QVector<QPointF> manyPoints = randomPoints(1000);
+    QVector<QPointF> points;
+    points << QPointF(0,0) << QPointF(10,0) << QPointF(10,10) << QPointF(0,10)
+           << QPointF(5,4) << QPointF(0,0); /* duplicate */
+
+    QVector<QLineF> expected;
+    expected << QLineF(0,0,10,0) << QLineF(10,0,10,10)
+             << QLineF(10,10,0,10) << QLineF(0,10,0,0)
+             << QLineF(5,4,0,0) << QLineF(5,4,10,0)
+             << QLineF(5,4,10,10) << QLineF(5,4,0,10);
+
+    Math::Triangulator triangulator;
+    triangulator.triangulate(manyPoints);
+
+    // When
+    triangulator.triangulate(points);
+
+    // Then
+    QCOMPARE(triangulator.pointCount(), 5);
+    QCOMPARE(triangulator.edgeCount(), 8);
+    QCOMPARE(triangulator.triangleCount(), 4);
+    QCOMPARE(toSet(triangulator.lines()), toSet(expected));
+    for (int i = 0; i < triangulator.triangleCount(); ++i) {
+        for (int j = 0; j < 3; ++j) {
+            const int neighbor = triangulator.neighbors()[i * 3 + j];
+            QVERIFY(neighbor >= -1 && neighbor < triangulator.triangleCount());
+        }
+    }
+
+    // When
+    /* Reused again, checked against the independent incremental algorithm */
+    QVector<QPointF> randomSet = randomPoints(50);
+    Math::IncrementalDelaunay incremental;
+    foreach (auto &point, randomSet) {
+        incremental.insert(point);
+    }
+    triangulator.triangulate(randomSet);
+
+    // Then
+    QCOMPARE(toSet(triangulator.lines()), toSet(incremental));
+    /* Euler's formula for a triangulated convex polygon */
+    QCOMPARE(triangulator.pointCount() - triangulator.edgeCount()
+             + triangulator.triangleCount(), 1);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_Delaunay::benchmark_delaunayTriangulation_data()
+{
+    QTest::addColumn<QVector<QPointF> >("points");
+
+    qsrand(5);
+    QTest::newRow("10k points") << randomPoints(10000);
+    QTest::newRow("100k points") << randomPoints(100000);
+
+    /* Half of the points are duplicates */
+    QVector<QPointF> points = randomPoints(50000);
+    points += points;
+    QTest::newRow("100k points with duplicates") << points;
+
+    QVector<QPointF> collinear;
+    collinear.reserve(100000);
+    for (int i = 0; i < 100000; ++i) {
+        collinear << QPointF((i * 7919) % 100000, 0.5 * ((i * 7919) % 100000));
+    }
+    QTest::newRow("10k collinear points") << collinear.mid(0, 10000);
+    QTest::newRow("100k collinear points") << collinear;
+}
+
+void tst_Delaunay::benchmark_delaunayTriangulation()
+{
+    QFETCH(QVector<QPointF>, points);
+
+    QVector<QLineF> edges;
+    QBENCHMARK {
+        edges = Math::delaunayTriangulation(points);
+    }
+    QVERIFY(!edges.isEmpty());
+}
+
 QTEST_APPLESS_MAIN(tst_Delaunay)
 
 #include "tst_delaunay.moc"
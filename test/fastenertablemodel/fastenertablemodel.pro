@@ -0,0 +1,45 @@
+#isEmpty(TEMPLATE):TEMPLATE=app
+TARGET       = tst_fastenertablemodel
+CONFIG      += testcase
+QT           = core gui widgets testlib
+SOURCES     += tst_fastenertablemodel.cpp
+
+# Include:
+INCLUDEPATH += ../../include
+
+# Dependancies:
+include($$PWD/../../src/core/core.pri)
+include($$PWD/../../src/math/math.pri)
+
+HEADERS  += \
+    $$PWD/../../src/widgets/abstractspliceview.h \
+    $$PWD/../../src/widgets/fastenertablemodel.h \
+    $$PWD/../../src/widgets/fastenertablewidget.h
+
+SOURCES += \
+    $$PWD/../../src/widgets/abstractspliceview.cpp \
+    $$PWD/../../src/widgets/fastenertablemodel.cpp \
+    $$PWD/../../src/widgets/fastenertablewidget.cpp
+
+FORMS += \
+    $$PWD/../../src/widgets/fastenertablewidget.ui
+
+#-------------------------------------------------
+# Boost
+#-------------------------------------------------
+
+# INSTRUCTION: Replace the following path by your path:
+Boost_INCLUDE_DIR  = "C:/Qt/Boost/boost_1_61_0/"
+Boost_LIB_DIR      = "C:/Qt/Boost/boost_1_61_0/stage/lib/"
+#
+
+
+INCLUDEPATH += $$Boost_INCLUDE_DIR
+LIBS        += -L$$Boost_LIB_DIR
+DEFINES     += BOOST_MATH_DISABLE_FLOAT128
+
+#-------------------------------------------------
+# TRIANGLE
+#-------------------------------------------------
+include($$PWD/../../FastenerPattern_config.pri)
+include($$PWD/../../3rd/3rd.pri)
@@ -0,0 +1,298 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/Fastener>
+#include <Core/SpliceCalculator>
+#include <Widgets/FastenerTableModel>
+#include <Widgets/FastenerTableWidget>
+
+#include <QtTest/QtTest>
+#include <QtCore/QDebug>
+#include <QtCore/QItemSelectionModel>
+#include <QtWidgets/QTableView>
+
+using namespace boost;
+using namespace units;
+using namespace si;
+
+class tst_FastenerTableModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /* Model */
+    void test_setSpliceModel();
+    void test_insert();
+    void test_insert_outOfRange();
+    void test_transaction_insert();
+    void test_transaction_change();
+    void test_transaction_remove();
+
+    /* Widget */
+    void test_updateSelection();
+    void test_itemSelectionChanged();
+
+private:
+    Fastener createFastener(int i) const;
+    QList<int> range(const QSignalSpy &spy, int i) const;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+Fastener tst_FastenerTableModel::createFastener(int i) const
+{
+    return Fastener( double(i)*_mm, 0.*_mm, 4.83*_mm, 3.*_mm );
+}
+
+/* The first and last rows of the \a i-th rowsInserted() or rowsRemoved(). */
+QList<int> tst_FastenerTableModel::range(const QSignalSpy &spy, int i) const
+{
+    return QList<int>() << spy.at(i).at(1).toInt() << spy.at(i).at(2).toInt();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FastenerTableModel::test_setSpliceModel()
+{
+    // Given
+    SpliceCalculator splice;
+    splice.insertFastener(0, createFastener(1));
+    splice.insertFastener(1, createFastener(2));
+    FastenerTableModel target;
+    QSignalSpy spyReset(&target, SIGNAL(modelReset()));
+
+    // When
+    target.setSpliceModel(&splice);
+
+    // Then
+    QCOMPARE( spyReset.count(), 1 );
+    QCOMPARE( target.rowCount(), 2 );
+    QCOMPARE( target.columnCount(), 6 );
+    QCOMPARE( target.data(target.index(1, 0)).toString(), QString("2.0") );
+    QCOMPARE( target.data(target.index(1, 2)).toString(), QString("4.8") );
+
+    // When
+    target.setSpliceModel(Q_NULLPTR);
+    splice.insertFastener(2, createFastener(3));
+
+    // Then
+    /* Disconnected */
+    QCOMPARE( target.rowCount(), 0 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FastenerTableModel::test_insert()
+{
+    // Given
+    SpliceCalculator splice;
+    FastenerTableModel target;
+    target.setSpliceModel(&splice);
+    QSignalSpy spyInserted(&target, SIGNAL(rowsInserted(QModelIndex,int,int)));
+
+    // When
+    splice.insertFastener(0, createFastener(1));
+    splice.insertFastener(0, createFastener(2));
+
+    // Then
+    QCOMPARE( spyInserted.count(), 2 );
+    QCOMPARE( range(spyInserted, 0), QList<int>() << 0 << 0 );
+    QCOMPARE( range(spyInserted, 1), QList<int>() << 0 << 0 );
+    QCOMPARE( target.rowCount(), 2 );
+    QCOMPARE( target.data(target.index(0, 0)).toString(), QString("2.0") );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FastenerTableModel::test_insert_outOfRange()
+{
+    // Given
+    SpliceCalculator splice;
+    splice.insertFastener(0, createFastener(1));
+    FastenerTableModel target;
+    target.setSpliceModel(&splice);
+    QSignalSpy spyInserted(&target, SIGNAL(rowsInserted(QModelIndex,int,int)));
+
+    // When
+    /* beginInsertRows() asserts that the rows are valid */
+    splice.insertFastener(-1, createFastener(2));
+    splice.insertFastener(splice.fastenerCount() + 5, createFastener(3));
+
+    // Then
+    QCOMPARE( spyInserted.count(), 2 );
+    QCOMPARE( range(spyInserted, 0), QList<int>() << 0 << 0 );
+    QCOMPARE( range(spyInserted, 1), QList<int>() << 2 << 2 );
+    QCOMPARE( target.rowCount(), 3 );
+    QCOMPARE( target.data(target.index(2, 0)).toString(), QString("3.0") );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FastenerTableModel::test_transaction_insert()
+{
+    // Given
+    SpliceCalculator splice;
+    splice.insertFastener(0, createFastener(0));
+    FastenerTableModel target;
+    target.setSpliceModel(&splice);
+    QSignalSpy spyAboutToBeInserted(&target, SIGNAL(rowsAboutToBeInserted(QModelIndex,int,int)));
+    QSignalSpy spyInserted(&target, SIGNAL(rowsInserted(QModelIndex,int,int)));
+
+    // When
+    splice.beginTransaction();
+    for (int i = 1; i <= 100; ++i) {
+        splice.insertFastener(i, createFastener(i));
+    }
+    splice.endTransaction();
+
+    // Then
+    /* A single range */
+    QCOMPARE( spyAboutToBeInserted.count(), 1 );
+    QCOMPARE( spyInserted.count(), 1 );
+    QCOMPARE( range(spyInserted, 0), QList<int>() << 1 << 100 );
+    QCOMPARE( target.rowCount(), 101 );
+    QCOMPARE( target.data(target.index(100, 0)).toString(), QString("100.0") );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FastenerTableModel::test_transaction_change()
+{
+    // Given
+    SpliceCalculator splice;
+    for (int i = 0; i < 10; ++i) {
+        splice.insertFastener(i, createFastener(i));
+    }
+    FastenerTableModel target;
+    target.setSpliceModel(&splice);
+    QSignalSpy spyChanged(&target, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+
+    // When
+    splice.beginTransaction();
+    for (int i = 4; i >= 2; --i) {
+        splice.setFastener(i, createFastener(10 * i));
+    }
+    splice.endTransaction();
+
+    // Then
+    QCOMPARE( spyChanged.count(), 1 );
+    const QModelIndex topLeft = spyChanged.at(0).at(0).value<QModelIndex>();
+    const QModelIndex bottomRight = spyChanged.at(0).at(1).value<QModelIndex>();
+    QCOMPARE( topLeft, target.index(2, 0) );
+    QCOMPARE( bottomRight, target.index(4, 5) );
+    QCOMPARE( target.rowCount(), 10 );
+    QCOMPARE( target.data(target.index(3, 0)).toString(), QString("30.0") );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FastenerTableModel::test_transaction_remove()
+{
+    // Given
+    SpliceCalculator splice;
+    for (int i = 0; i < 10; ++i) {
+        splice.insertFastener(i, createFastener(i));
+    }
+    FastenerTableModel target;
+    target.setSpliceModel(&splice);
+    QSignalSpy spyRemoved(&target, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+
+    // When
+    splice.beginTransaction();
+    for (int i = 0; i < 3; ++i) {
+        splice.removeFastener(5);
+    }
+    splice.removeFastener(0); /* Not adjacent */
+    splice.endTransaction();
+
+    // Then
+    QCOMPARE( spyRemoved.count(), 2 );
+    QCOMPARE( range(spyRemoved, 0), QList<int>() << 5 << 7 );
+    QCOMPARE( range(spyRemoved, 1), QList<int>() << 0 << 0 );
+    QCOMPARE( target.rowCount(), 6 );
+    QCOMPARE( target.rowCount(), splice.fastenerCount() );
+    QCOMPARE( target.data(target.index(4, 0)).toString(), QString("8.0") );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FastenerTableModel::test_updateSelection()
+{
+    // Given
+    SpliceCalculator splice;
+    for (int i = 0; i < 8; ++i) {
+        splice.insertFastener(i, createFastener(i));
+    }
+    FastenerTableWidget target;
+    target.setModel(&splice);
+    QTableView *view = target.findChild<QTableView*>();
+    QVERIFY( view );
+    splice.setFastenerSelection( {1, 2, 3, 5, 42} ); /* 42 doesn't exist */
+
+    // When
+    target.updateSelection();
+
+    // Then
+    /* Consecutive rows in a single range */
+    const QItemSelection selection = view->selectionModel()->selection();
+    QCOMPARE( selection.count(), 2 );
+    QCOMPARE( selection.at(0).top(), 1 );
+    QCOMPARE( selection.at(0).bottom(), 3 );
+    QCOMPARE( selection.at(0).left(), 0 );
+    QCOMPARE( selection.at(0).right(), 5 );
+    QCOMPARE( selection.at(1).top(), 5 );
+    QCOMPARE( selection.at(1).bottom(), 5 );
+    QCOMPARE( view->selectionModel()->selectedRows().count(), 4 );
+
+    /* Not sent back to the splice model */
+    QCOMPARE( splice.selectedFastenerIndexes(), QSet<int>({1, 2, 3, 5, 42}) );
+
+    // When
+    splice.setFastenerSelection( QSet<int>() );
+    target.updateSelection();
+
+    // Then
+    QVERIFY( !view->selectionModel()->hasSelection() );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FastenerTableModel::test_itemSelectionChanged()
+{
+    // Given
+    SpliceCalculator splice;
+    for (int i = 0; i < 8; ++i) {
+        splice.insertFastener(i, createFastener(i));
+    }
+    FastenerTableWidget target;
+    target.setModel(&splice);
+    QTableView *view = target.findChild<QTableView*>();
+    QVERIFY( view );
+    QItemSelectionModel *selectionModel = view->selectionModel();
+    QAbstractItemModel *model = view->model();
+
+    // When
+    QItemSelection selection(model->index(2, 0), model->index(4, 5));
+    selection.select(model->index(6, 0), model->index(6, 5));
+    selectionModel->select(selection, QItemSelectionModel::ClearAndSelect);
+
+    // Then
+    QCOMPARE( splice.selectedFastenerIndexes(), QSet<int>({2, 3, 4, 6}) );
+}
+
+QTEST_MAIN(tst_FastenerTableModel)
+
+#include "tst_fastenertablemodel.moc"
@@ -0,0 +1,278 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/Solvers/FiniteElementSolver>
+#include <Core/Splice>
+
+#include <QtTest/QtTest>
+#include <QtCore/QDebug>
+#include <QtCore/QList>
+
+/* Relative tolerance of the mesh-based results */
+#define C_TOLERANCE 0.01
+
+
+class tst_FiniteElementSolver : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_empty_splice();
+    void test_undefined_load();
+
+    void test_simple();
+    void test_equilibrium();
+    void test_different_degrees_of_freedom();
+
+    void test_threads();
+    void test_direct_and_iterative();
+
+    void test_load_cases();
+    void test_geometry_changed();
+
+private:
+    static bool fuzzyCompare(const Force &actual, const Force &expected, const Force &scale);
+};
+
+/******************************************************************************
+ ******************************************************************************/
+bool tst_FiniteElementSolver::fuzzyCompare(const Force &actual, const Force &expected,
+                                           const Force &scale)
+{
+    return qAbs(actual.value() - expected.value()) <= C_TOLERANCE * qAbs(scale.value());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FiniteElementSolver::test_empty_splice()
+{
+    // Given, When
+    FiniteElementSolver solver;
+    Splice splice;
+    QList<Tensor> actual = solver.calculate( &splice );
+
+    // Then
+    QCOMPARE( actual.count(), 0);  /* No results */
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FiniteElementSolver::test_undefined_load()
+{
+    // Given, When
+    FiniteElementSolver solver;
+    Splice splice;
+    splice.addFastener( Fastener(  0.*_mm, 1.*_mm, 4.83*_mm, 3.*_mm ) );
+    splice.addFastener( Fastener( 20.*_mm, 1.*_mm, 4.83*_mm, 3.*_mm ) );
+    QList<Tensor> actual = solver.calculate( &splice );
+
+    // Then
+    QCOMPARE( actual.count(), 2);
+    QCOMPARE( actual.at(0), Tensor() );  /* No results */
+    QCOMPARE( actual.at(1), Tensor() );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FiniteElementSolver::test_simple()
+{
+    /* Two identical fasteners: the plate is stiff compared to the
+     * fasteners, so the results are close to the rigid body solution. */
+    // Given, When
+    FiniteElementSolver solver;
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 1205.*N, 0.*N, 0.*N_m ) );
+    splice.addFastener( Fastener(  0.*_mm, 1.*_mm, 4.83*_mm, 3.*_mm ) );
+    splice.addFastener( Fastener( 20.*_mm, 1.*_mm, 4.83*_mm, 3.*_mm ) );
+    QList<Tensor> actual = solver.calculate( &splice );
+
+    // Then
+    const Force scale = 1205.*N;
+    QCOMPARE( actual.count(), 2);
+    QVERIFY( fuzzyCompare( actual.at(0).force_x,  602.50*N, scale) );
+    QVERIFY( fuzzyCompare( actual.at(0).force_y,  -60.25*N, scale) );
+    QVERIFY( fuzzyCompare( actual.at(1).force_x,  602.50*N, scale) );
+    QVERIFY( fuzzyCompare( actual.at(1).force_y,   60.25*N, scale) );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FiniteElementSolver::test_equilibrium()
+{
+    // Given, When
+    FiniteElementSolver solver;
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 1000.*N, 1000.*N, 1000.*N_mm) );
+    splice.addFastener( Fastener( -10.*_mm, -5.*_mm, 6.45*_mm, 3.*_mm ) );
+    splice.addFastener( Fastener(  10.*_mm, -5.*_mm, 4.83*_mm, 2.*_mm ) );
+    splice.addFastener( Fastener(   0.*_mm, 10.*_mm, 2.20*_mm, 1.*_mm ) );
+    QList<Tensor> actual = solver.calculate( &splice );
+
+    // Then
+    QCOMPARE( actual.count(), 3);
+
+    /* The loads of the fasteners balance the applied load,
+     * and its moment about the origin. */
+    double sumX = 0;
+    double sumY = 0;
+    double sumM = 0;
+    for (int i = 0; i < actual.count(); ++i) {
+        const Fastener &fastener = splice.fastenerAt(i);
+        sumX += actual.at(i).force_x.value();
+        sumY += actual.at(i).force_y.value();
+        sumM += fastener.positionX.value() * actual.at(i).force_y.value()
+                - fastener.positionY.value() * actual.at(i).force_x.value();
+    }
+    QVERIFY( qAbs(sumX - 1000.) <= C_TOLERANCE * 1000. );
+    QVERIFY( qAbs(sumY - 1000.) <= C_TOLERANCE * 1000. );
+    QVERIFY( qAbs(sumM - 1.) <= C_TOLERANCE * 1. );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FiniteElementSolver::test_different_degrees_of_freedom()
+{
+    // Given, When
+    FiniteElementSolver solver;
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 1000.*N, 0.*N, 0.*N_mm) );
+    splice.addFastener( Fastener(  0.*_mm,  1.*_mm, 4.83*_mm, 3.*_mm, Fastener::Free , Fastener::Fixed));
+    splice.addFastener( Fastener( 20.*_mm,  1.*_mm, 4.83*_mm, 3.*_mm, Fastener::Fixed, Fastener::Fixed));
+    splice.addFastener( Fastener( 10.*_mm, 10.*_mm, 4.83*_mm, 3.*_mm, Fastener::Fixed, Fastener::Free ));
+    QList<Tensor> actual = solver.calculate( &splice );
+
+    // Then
+    QCOMPARE( actual.count(), 3);
+    QCOMPARE( actual.at(0).force_x, 0.*N );  /* Free */
+    QCOMPARE( actual.at(2).force_y, 0.*N );  /* Free */
+    QVERIFY( fuzzyCompare( actual.at(1).force_x + actual.at(2).force_x, 1000.*N, 1000.*N) );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FiniteElementSolver::test_threads()
+{
+    // Given
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 1000.*N, 500.*N, 10000.*N_mm) );
+    for (int i = 0; i < 20; ++i) {
+        splice.addFastener( Fastener( (i % 5) * 20.*_mm, (i / 5) * 20.*_mm,
+                                      4.83*_mm, 3.*_mm ) );
+    }
+    FiniteElementSolver solver1;
+    FiniteElementSolver solver4;
+    solver1.setNodeCount(20000);
+    solver4.setNodeCount(20000);
+    solver1.setThreadCount(1);
+    solver4.setThreadCount(4);
+    solver1.setMaxFactorSize(0); /* The conjugate gradient runs on the threads */
+    solver4.setMaxFactorSize(0);
+
+    // When
+    QList<Tensor> expected = solver1.calculate( &splice );
+    QList<Tensor> actual = solver4.calculate( &splice );
+
+    // Then
+    QCOMPARE( actual.count(), expected.count());
+    for (int i = 0; i < actual.count(); ++i) {
+        QVERIFY( fuzzyCompare( actual.at(i).force_x, expected.at(i).force_x, 1000.*N) );
+        QVERIFY( fuzzyCompare( actual.at(i).force_y, expected.at(i).force_y, 1000.*N) );
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FiniteElementSolver::test_direct_and_iterative()
+{
+    // Given
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 1000.*N, 500.*N, 10000.*N_mm) );
+    for (int i = 0; i < 6; ++i) {
+        splice.addFastener( Fastener( (i % 3) * 20.*_mm, (i / 3) * 20.*_mm,
+                                      4.83*_mm, 3.*_mm ) );
+    }
+    FiniteElementSolver direct;
+    FiniteElementSolver iterative;
+    iterative.setMaxFactorSize(0);
+
+    // When
+    QList<Tensor> expected = direct.calculate( &splice );
+    QList<Tensor> actual = iterative.calculate( &splice );
+
+    // Then
+    QVERIFY( direct.maxFactorSize() > 0 ); /* Cholesky by default */
+    QCOMPARE( actual.count(), expected.count());
+    for (int i = 0; i < actual.count(); ++i) {
+        QVERIFY( fuzzyCompare( actual.at(i).force_x, expected.at(i).force_x, 1000.*N) );
+        QVERIFY( fuzzyCompare( actual.at(i).force_y, expected.at(i).force_y, 1000.*N) );
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FiniteElementSolver::test_load_cases()
+{
+    /* The factorization is reused when only the applied load changes */
+    // Given
+    FiniteElementSolver solver;
+    Splice splice;
+    splice.addFastener( Fastener( -10.*_mm, -5.*_mm, 6.45*_mm, 3.*_mm ) );
+    splice.addFastener( Fastener(  10.*_mm, -5.*_mm, 4.83*_mm, 2.*_mm ) );
+    splice.addFastener( Fastener(   0.*_mm, 10.*_mm, 2.20*_mm, 1.*_mm ) );
+    splice.setAppliedLoad( Tensor( 1000.*N, 0.*N, 0.*N_mm) );
+    solver.calculate( &splice );
+
+    // When
+    splice.setAppliedLoad( Tensor( -200.*N, 1500.*N, 3000.*N_mm) );
+    QList<Tensor> actual = solver.calculate( &splice );
+
+    FiniteElementSolver other;
+    QList<Tensor> expected = other.calculate( &splice );
+
+    // Then
+    QCOMPARE( actual.count(), 3);
+    for (int i = 0; i < actual.count(); ++i) {
+        QVERIFY( fuzzyCompare( actual.at(i).force_x, expected.at(i).force_x, 1500.*N) );
+        QVERIFY( fuzzyCompare( actual.at(i).force_y, expected.at(i).force_y, 1500.*N) );
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_FiniteElementSolver::test_geometry_changed()
+{
+    // Given
+    FiniteElementSolver solver;
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 1205.*N, 0.*N, 0.*N_m ) );
+    splice.addFastener( Fastener(  0.*_mm, 1.*_mm, 4.83*_mm, 3.*_mm ) );
+    splice.addFastener( Fastener( 20.*_mm, 1.*_mm, 4.83*_mm, 3.*_mm ) );
+    solver.calculate( &splice );
+
+    // When
+    splice.setFastenerAt(1, Fastener( 20.*_mm, 1.*_mm, 4.83*_mm, 3.*_mm,
+                                      Fastener::Free, Fastener::Fixed ) );
+    QList<Tensor> actual = solver.calculate( &splice );
+
+    // Then
+    QCOMPARE( actual.count(), 2);
+    QVERIFY( fuzzyCompare( actual.at(0).force_x, 1205.*N, 1205.*N) );
+    QCOMPARE( actual.at(1).force_x, 0.*N );  /* Free */
+}
+
+QTEST_APPLESS_MAIN(tst_FiniteElementSolver)
+
+#include "tst_finiteelementsolver.moc"
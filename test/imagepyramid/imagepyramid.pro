@@ -0,0 +1,12 @@
+#isEmpty(TEMPLATE):TEMPLATE=app
+TARGET       = tst_imagepyramid
+CONFIG      += testcase
+QT           = core gui testlib
+SOURCES     += tst_imagepyramid.cpp
+
+# Include:
+INCLUDEPATH += ../../include
+
+# Dependancies:
+HEADERS  += $$PWD/../../src/editor/imagepyramid.h
+SOURCES  += $$PWD/../../src/editor/imagepyramid.cpp
@@ -0,0 +1,280 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Editor/ImagePyramid>
+
+#include <QtTest/QtTest>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+#include <QtGui/QImage>
+
+#define C_TIMEOUT 10000 /* ms */
+#define C_MANIFEST "/pyramid.txt"
+
+class tst_ImagePyramid : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_levels();
+    void test_levelForScale();
+    void test_tile();
+    void test_cache_roundTrip();
+    void test_cache_missingTile();
+    void test_trimCache();
+    void test_trimCache_noLimit();
+
+private:
+    QString createImage(const QTemporaryDir &dir, const QString &name, QRgb color) const;
+    QStringList tileDirectories(const QString &cacheDirectory) const;
+    bool waitForLoaded(ImagePyramid *pyramid, const QString &fileName) const;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+/* 600x400 pixels: 3x2 tiles, then 2x1 tiles (300x200), then 1 tile (150x100) */
+QString tst_ImagePyramid::createImage(const QTemporaryDir &dir, const QString &name, QRgb color) const
+{
+    QImage image(600, 400, QImage::Format_RGB32);
+    image.fill(color);
+    const QString fileName = dir.path() + QLatin1Char('/') + name;
+    return image.save(fileName, "PNG") ? fileName : QString();
+}
+
+QStringList tst_ImagePyramid::tileDirectories(const QString &cacheDirectory) const
+{
+    QStringList paths;
+    const QDir root(cacheDirectory);
+    foreach (auto &name, root.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        paths << root.absoluteFilePath(name);
+    }
+    return paths;
+}
+
+bool tst_ImagePyramid::waitForLoaded(ImagePyramid *pyramid, const QString &fileName) const
+{
+    QSignalSpy spyLoaded(pyramid, SIGNAL(loaded(QString)));
+    if (!pyramid->load(fileName)) {
+        return false;
+    }
+    return spyLoaded.wait(C_TIMEOUT) && pyramid->isReady();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ImagePyramid::test_levels()
+{
+    // Given
+    QTemporaryDir dir;
+    const QString fileName = createImage(dir, "image.png", qRgb(0, 0, 255));
+    ImagePyramid target;
+
+    // When
+    QVERIFY( waitForLoaded(&target, fileName) );
+
+    // Then
+    QVERIFY( target.cacheDirectory().isEmpty() ); /* Opt-in */
+    QCOMPARE( target.size(), QSize(600, 400) );
+    QCOMPARE( target.levelCount(), 3 );
+    QCOMPARE( target.levelSize(1), QSize(300, 200) );
+    QCOMPARE( target.levelSize(2), QSize(150, 100) );
+    QCOMPARE( target.columnCount(0), 3 );
+    QCOMPARE( target.rowCount(0), 2 );
+    QCOMPARE( target.columnCount(2), 1 );
+    QCOMPARE( target.rowCount(2), 1 );
+    QVERIFY( tileDirectories(dir.path()).isEmpty() );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ImagePyramid::test_levelForScale()
+{
+    // Given
+    QTemporaryDir dir;
+    const QString fileName = createImage(dir, "image.png", qRgb(0, 0, 255));
+    ImagePyramid target;
+
+    // Then
+    /* No level yet */
+    QCOMPARE( target.levelForScale(0.1), 0 );
+
+    // When
+    QVERIFY( waitForLoaded(&target, fileName) );
+
+    // Then
+    QCOMPARE( target.levelForScale(4.0), 0 );
+    QCOMPARE( target.levelForScale(1.0), 0 );
+    QCOMPARE( target.levelForScale(0.6), 0 );
+    QCOMPARE( target.levelForScale(0.5), 1 );
+    QCOMPARE( target.levelForScale(0.3), 1 );
+    QCOMPARE( target.levelForScale(0.25), 2 );
+    QCOMPARE( target.levelForScale(0.01), 2 ); /* Smallest level */
+    QCOMPARE( target.levelForScale(0.0), 0 );
+    QCOMPARE( target.levelForScale(-1.0), 0 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ImagePyramid::test_tile()
+{
+    // Given
+    QTemporaryDir dir;
+    const QString fileName = createImage(dir, "image.png", qRgb(0, 0, 255));
+    ImagePyramid target;
+    QVERIFY( waitForLoaded(&target, fileName) );
+
+    // When
+    const QPixmap first = target.tile(0, 0, 0);
+    const QPixmap last = target.tile(0, 2, 1);
+
+    // Then
+    QCOMPARE( first.size(), QSize(256, 256) );
+    QCOMPARE( last.size(), QSize(600 - 512, 400 - 256) );
+    QCOMPARE( last.toImage().pixel(0, 0), qRgb(0, 0, 255) );
+    QVERIFY( target.tile(0, 3, 0).isNull() );
+    QVERIFY( target.tile(3, 0, 0).isNull() );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ImagePyramid::test_cache_roundTrip()
+{
+    // Given
+    QTemporaryDir dir;
+    QTemporaryDir cache;
+    const QString fileName = createImage(dir, "image.png", qRgb(0, 0, 255));
+    ImagePyramid target;
+    target.setCacheDirectory(cache.path());
+
+    // When
+    QVERIFY( waitForLoaded(&target, fileName) );
+
+    // Then
+    /* The cache is written after loaded() */
+    QTRY_COMPARE_WITH_TIMEOUT( tileDirectories(cache.path()).count(), 1, C_TIMEOUT );
+    const QString tileDirectory = tileDirectories(cache.path()).first();
+    QTRY_VERIFY_WITH_TIMEOUT( QFile::exists(tileDirectory + C_MANIFEST), C_TIMEOUT );
+    QCOMPARE( QDir(tileDirectory).entryList(QStringList("*.png"), QDir::Files).count(), 6 + 2 + 1 );
+
+    // Given
+    /* Marks a tile, to check that the tiles are read from the cache */
+    QImage marked(150, 100, QImage::Format_RGB32);
+    marked.fill(qRgb(255, 0, 0));
+    QVERIFY( marked.save(tileDirectory + "/2_0_0.png", "PNG") );
+
+    // When
+    ImagePyramid other;
+    other.setCacheDirectory(cache.path());
+    QVERIFY( waitForLoaded(&other, fileName) );
+
+    // Then
+    QCOMPARE( other.levelCount(), 3 );
+    QCOMPARE( other.size(), QSize(600, 400) );
+    QCOMPARE( other.levelSize(2), QSize(150, 100) );
+    QCOMPARE( other.tile(2, 0, 0).toImage().pixel(0, 0), qRgb(255, 0, 0) );
+    QCOMPARE( other.tile(0, 0, 0).toImage().pixel(0, 0), qRgb(0, 0, 255) );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ImagePyramid::test_cache_missingTile()
+{
+    // Given
+    QTemporaryDir dir;
+    QTemporaryDir cache;
+    const QString fileName = createImage(dir, "image.png", qRgb(0, 0, 255));
+    {
+        ImagePyramid pyramid;
+        pyramid.setCacheDirectory(cache.path());
+        QVERIFY( waitForLoaded(&pyramid, fileName) );
+        QTRY_COMPARE_WITH_TIMEOUT( tileDirectories(cache.path()).count(), 1, C_TIMEOUT );
+        QTRY_VERIFY_WITH_TIMEOUT( QFile::exists(tileDirectories(cache.path()).first() + C_MANIFEST), C_TIMEOUT );
+    }
+    const QString tileDirectory = tileDirectories(cache.path()).first();
+    const QString tilePath = tileDirectory + "/0_1_1.png";
+    QVERIFY( QFile::remove(tilePath) );
+
+    ImagePyramid target;
+    target.setCacheDirectory(cache.path());
+
+    // When
+    QVERIFY( waitForLoaded(&target, fileName) );
+
+    // Then
+    /* Built again from the image */
+    QCOMPARE( target.tile(0, 1, 1).toImage().pixel(0, 0), qRgb(0, 0, 255) );
+    QTRY_VERIFY_WITH_TIMEOUT( QFile::exists(tilePath), C_TIMEOUT );
+    QTRY_VERIFY_WITH_TIMEOUT( QFile::exists(tileDirectory + C_MANIFEST), C_TIMEOUT );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ImagePyramid::test_trimCache()
+{
+    // Given
+    QTemporaryDir dir;
+    QTemporaryDir cache;
+    const QString first = createImage(dir, "first.png", qRgb(0, 0, 255));
+    const QString second = createImage(dir, "second.png", qRgb(0, 255, 0));
+    ImagePyramid target;
+    target.setCacheDirectory(cache.path());
+    target.setCacheSizeLimit(1); /* byte */
+
+    QVERIFY( waitForLoaded(&target, first) );
+    QTRY_COMPARE_WITH_TIMEOUT( tileDirectories(cache.path()).count(), 1, C_TIMEOUT );
+    const QString firstDirectory = tileDirectories(cache.path()).first();
+    /* The tiles of the current image are kept, even larger than the limit */
+    QTRY_VERIFY_WITH_TIMEOUT( QFile::exists(firstDirectory + C_MANIFEST), C_TIMEOUT );
+
+    // When
+    QVERIFY( waitForLoaded(&target, second) );
+
+    // Then
+    QTRY_VERIFY_WITH_TIMEOUT( !QFile::exists(firstDirectory), C_TIMEOUT );
+    QCOMPARE( tileDirectories(cache.path()).count(), 1 );
+    const QString secondDirectory = tileDirectories(cache.path()).first();
+    QVERIFY( secondDirectory != firstDirectory );
+    QVERIFY( QFile::exists(secondDirectory + C_MANIFEST) );
+}
+
+void tst_ImagePyramid::test_trimCache_noLimit()
+{
+    // Given
+    QTemporaryDir dir;
+    QTemporaryDir cache;
+    const QString first = createImage(dir, "first.png", qRgb(0, 0, 255));
+    const QString second = createImage(dir, "second.png", qRgb(0, 255, 0));
+    ImagePyramid target;
+    target.setCacheDirectory(cache.path());
+    target.setCacheSizeLimit(0);
+
+    // When
+    QVERIFY( waitForLoaded(&target, first) );
+    QTRY_COMPARE_WITH_TIMEOUT( tileDirectories(cache.path()).count(), 1, C_TIMEOUT );
+    QTRY_VERIFY_WITH_TIMEOUT( QFile::exists(tileDirectories(cache.path()).first() + C_MANIFEST), C_TIMEOUT );
+    QVERIFY( waitForLoaded(&target, second) );
+
+    // Then
+    QTRY_COMPARE_WITH_TIMEOUT( tileDirectories(cache.path()).count(), 2, C_TIMEOUT );
+    foreach (auto &path, tileDirectories(cache.path())) {
+        QTRY_VERIFY_WITH_TIMEOUT( QFile::exists(path + C_MANIFEST), C_TIMEOUT );
+    }
+}
+
+QTEST_MAIN(tst_ImagePyramid)
+
+#include "tst_imagepyramid.moc"
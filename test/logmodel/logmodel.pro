@@ -0,0 +1,12 @@
+#isEmpty(TEMPLATE):TEMPLATE=app
+TARGET       = tst_logmodel
+CONFIG      += testcase
+QT           = core gui testlib
+SOURCES     += tst_logmodel.cpp
+
+# Include:
+INCLUDEPATH += ../../include
+
+# Dependancies:
+HEADERS  += $$PWD/../../src/widgets/logmodel.h
+SOURCES  += $$PWD/../../src/widgets/logmodel.cpp
@@ -0,0 +1,175 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Widgets/LogModel>
+
+#include <QtTest/QtTest>
+#include <QtCore/QDebug>
+
+class tst_LogModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_append();
+    void test_eviction();
+    void test_setCapacity_shrink();
+    void test_setCapacity_grow();
+    void test_clear();
+
+private:
+    void fill(LogModel *model, int first, int count) const;
+    QStringList messages(const LogModel &model) const;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_LogModel::fill(LogModel *model, int first, int count) const
+{
+    for (int i = first; i < first + count; ++i) {
+        model->append(LogModel::Info, i, QString::number(i));
+    }
+}
+
+/* The messages, the oldest first. */
+QStringList tst_LogModel::messages(const LogModel &model) const
+{
+    QStringList res;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        res << model.data(model.index(row)).toString();
+    }
+    return res;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_LogModel::test_append()
+{
+    // Given
+    LogModel model;
+    QSignalSpy spyInserted(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+
+    // When
+    model.append(LogModel::Warning, 42, QStringLiteral("hello"));
+
+    // Then
+    QCOMPARE(model.capacity(), 1000);
+    QCOMPARE(model.rowCount(), 1);
+    QCOMPARE(model.recordAt(0).level, LogModel::Warning);
+    QCOMPARE(model.recordAt(0).timestamp, qint64(42));
+    QCOMPARE(model.data(model.index(0)).toString(), QString("hello"));
+    QCOMPARE(spyInserted.count(), 1);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_LogModel::test_eviction()
+{
+    // Given
+    LogModel model;
+    model.setCapacity(3);
+    fill(&model, 0, 3);
+    QSignalSpy spyRemoved(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy spyInserted(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+
+    // When
+    /* The ring wraps around several times */
+    fill(&model, 3, 5);
+
+    // Then
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(messages(model), QStringList() << "5" << "6" << "7");
+    QCOMPARE(spyRemoved.count(), 5);
+    QCOMPARE(spyRemoved.at(0).at(1).toInt(), 0); /* the oldest */
+    QCOMPARE(spyRemoved.at(0).at(2).toInt(), 0);
+    QCOMPARE(spyInserted.count(), 5);
+    QCOMPARE(spyInserted.at(0).at(1).toInt(), 2); /* the last row */
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_LogModel::test_setCapacity_shrink()
+{
+    // Given
+    LogModel model;
+    model.setCapacity(4);
+    fill(&model, 0, 6); /* wrapped: 2, 3, 4, 5 */
+    QSignalSpy spyRemoved(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+
+    // When
+    model.setCapacity(2);
+
+    // Then
+    QCOMPARE(model.capacity(), 2);
+    QCOMPARE(messages(model), QStringList() << "4" << "5");
+    QCOMPARE(spyRemoved.count(), 1);
+    QCOMPARE(spyRemoved.at(0).at(1).toInt(), 0);
+    QCOMPARE(spyRemoved.at(0).at(2).toInt(), 1);
+
+    // When
+    fill(&model, 6, 1);
+
+    // Then
+    QCOMPARE(messages(model), QStringList() << "5" << "6");
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_LogModel::test_setCapacity_grow()
+{
+    // Given
+    LogModel model;
+    model.setCapacity(3);
+    fill(&model, 0, 5); /* wrapped: 2, 3, 4 */
+    QSignalSpy spyRemoved(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+
+    // When
+    model.setCapacity(5);
+    fill(&model, 5, 2);
+
+    // Then
+    QCOMPARE(spyRemoved.count(), 0);
+    QCOMPARE(messages(model), QStringList() << "2" << "3" << "4" << "5" << "6");
+
+    // When
+    model.setCapacity(0); /* at least one record */
+
+    // Then
+    QCOMPARE(model.capacity(), 1);
+    QCOMPARE(messages(model), QStringList() << "6");
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_LogModel::test_clear()
+{
+    // Given
+    LogModel model;
+    model.setCapacity(2);
+    fill(&model, 0, 3);
+
+    // When
+    model.clear();
+    fill(&model, 3, 1);
+
+    // Then
+    QCOMPARE(model.capacity(), 2);
+    QCOMPARE(messages(model), QStringList() << "3");
+}
+
+QTEST_GUILESS_MAIN(tst_LogModel)
+
+#include "tst_logmodel.moc"
@@ -34,6 +34,9 @@ HEADERS += $$PWD/../../src/core/tensor.h
 SOURCES += $$PWD/../../src/core/tensor.cpp
 
 HEADERS += $$PWD/../../src/core/solvers/isolver.h
+SOURCES += $$PWD/../../src/core/solvers/isolver.cpp
+HEADERS += $$PWD/../../src/core/solvers/solvercache.h
+SOURCES += $$PWD/../../src/core/solvers/solvercache.cpp
 HEADERS += $$PWD/../../src/core/units/unit_system.h
 HEADERS += $$PWD/../../src/math/utils.h
 
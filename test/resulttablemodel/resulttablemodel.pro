@@ -0,0 +1,40 @@
+#isEmpty(TEMPLATE):TEMPLATE=app
+TARGET       = tst_resulttablemodel
+CONFIG      += testcase
+QT           = core gui testlib
+SOURCES     += tst_resulttablemodel.cpp
+
+# Include:
+INCLUDEPATH += ../../include
+
+# Dependancies:
+HEADERS  += \
+    $$PWD/../../src/core/solvers/parameters.h \
+    $$PWD/../../src/core/abstractsplicemodel.h \
+    $$PWD/../../src/core/designspace.h \
+    $$PWD/../../src/core/fastener.h \
+    $$PWD/../../src/core/tensor.h \
+    $$PWD/../../src/math/utils.h \
+    $$PWD/../../src/widgets/resulttablemodel.h
+
+SOURCES += \
+    $$PWD/../../src/core/solvers/parameters.cpp \
+    $$PWD/../../src/core/abstractsplicemodel.cpp \
+    $$PWD/../../src/core/designspace.cpp \
+    $$PWD/../../src/core/fastener.cpp \
+    $$PWD/../../src/core/tensor.cpp \
+    $$PWD/../../src/widgets/resulttablemodel.cpp
+
+#-------------------------------------------------
+# Boost
+#-------------------------------------------------
+
+# INSTRUCTION: Replace the following path by your path:
+Boost_INCLUDE_DIR  = "C:/Qt/Boost/boost_1_61_0/"
+Boost_LIB_DIR      = "C:/Qt/Boost/boost_1_61_0/stage/lib/"
+#
+
+
+INCLUDEPATH += $$Boost_INCLUDE_DIR
+LIBS        += -L$$Boost_LIB_DIR
+DEFINES     += BOOST_MATH_DISABLE_FLOAT128
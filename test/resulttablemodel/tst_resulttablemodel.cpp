@@ -0,0 +1,309 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/AbstractSpliceModel>
+#include <Core/Tensor>
+#include <Widgets/ResultTableModel>
+
+#include <QtTest/QtTest>
+#include <QtCore/QDebug>
+
+using namespace boost;
+using namespace units;
+using namespace si;
+
+/* Splice model whose results are set by the test. */
+class FakeSpliceModel : public AbstractSpliceModel
+{
+public:
+    virtual int fastenerCount() const Q_DECL_OVERRIDE { return 0; }
+    virtual Fastener fastenerAt(const int) const Q_DECL_OVERRIDE { return Fastener(); }
+    virtual int designSpaceCount() const Q_DECL_OVERRIDE { return 0; }
+    virtual DesignSpace designSpaceAt(const int) const Q_DECL_OVERRIDE { return DesignSpace(); }
+    virtual QSet<int> selectedFastenerIndexes() const Q_DECL_OVERRIDE { return QSet<int>(); }
+    virtual QSet<int> selectedDesignSpaceIndexes() const Q_DECL_OVERRIDE { return QSet<int>(); }
+    virtual Tensor appliedLoad() const Q_DECL_OVERRIDE { return Tensor(); }
+    virtual int loadCaseCount() const Q_DECL_OVERRIDE { return 0; }
+    virtual Tensor loadCaseAt(const int) const Q_DECL_OVERRIDE { return Tensor(); }
+    virtual SolverParameters solverParameters() const Q_DECL_OVERRIDE { return SolverParameters::NoSolver; }
+    virtual Tensor resultAt(const int index) const Q_DECL_OVERRIDE { return m_results.value(index); }
+    virtual QList<Tensor> results() const Q_DECL_OVERRIDE { return m_results; }
+    virtual ISolver* solver() const Q_DECL_OVERRIDE { return Q_NULLPTR; }
+
+    /* The forces along X, in N */
+    void setResults(const QList<double> &forces)
+    {
+        m_results.clear();
+        foreach (const double force, forces) {
+            m_results << Tensor( force*N, 0.*N, 0.*N_m );
+        }
+    }
+
+private:
+    QList<Tensor> m_results;
+};
+
+class tst_ResultTableModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /* All the results */
+    void test_setResults_belowDisplayPrecision();
+    void test_setResults_mergedRanges();
+    void test_setResults_countChanged();
+
+    /* Top-K */
+    void test_topCount();
+    void test_topCount_reorder();
+    void test_topCount_countChanged();
+
+private:
+    QList<int> fastenerIndexes(const ResultTableModel &model) const;
+    QList<int> changedRows(const QSignalSpy &spy, int i) const;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+QList<int> tst_ResultTableModel::fastenerIndexes(const ResultTableModel &model) const
+{
+    QList<int> res;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        res << model.fastenerIndex(row);
+    }
+    return res;
+}
+
+/* The first and last rows of the \a i-th dataChanged(), that must span all the columns. */
+QList<int> tst_ResultTableModel::changedRows(const QSignalSpy &spy, int i) const
+{
+    const QModelIndex topLeft = spy.at(i).at(0).value<QModelIndex>();
+    const QModelIndex bottomRight = spy.at(i).at(1).value<QModelIndex>();
+    if (topLeft.column() != 0 || bottomRight.column() != 3) {
+        return QList<int>();
+    }
+    return QList<int>() << topLeft.row() << bottomRight.row();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ResultTableModel::test_setResults_belowDisplayPrecision()
+{
+    // Given
+    FakeSpliceModel splice;
+    splice.setResults({100., 200., 300.});
+    ResultTableModel target;
+    target.setSpliceModel(&splice);
+    QSignalSpy spyChanged(&target, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+    QSignalSpy spyInserted(&target, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy spyRemoved(&target, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+
+    // When
+    /* Less than 0.05 N: displayed the same */
+    splice.setResults({100.01, 199.98, 300.04});
+    target.updateResults();
+
+    // Then
+    QCOMPARE( spyChanged.count(), 0 );
+    QCOMPARE( spyInserted.count(), 0 );
+    QCOMPARE( spyRemoved.count(), 0 );
+    QCOMPARE( target.rowCount(), 3 );
+    QCOMPARE( target.data(target.index(1, 1)).toString(), QString("200.0") );
+    QCOMPARE( target.data(target.index(2, 3)).toString(), QString("300.0") );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ResultTableModel::test_setResults_mergedRanges()
+{
+    // Given
+    FakeSpliceModel splice;
+    splice.setResults({10., 20., 30., 40., 50., 60.});
+    ResultTableModel target;
+    target.setSpliceModel(&splice);
+    QSignalSpy spyChanged(&target, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+
+    // When
+    splice.setResults({10., 21., 22., 40., 51., 60.02});
+    target.updateResults();
+
+    // Then
+    /* The adjacent rows are notified together */
+    QCOMPARE( spyChanged.count(), 2 );
+    QCOMPARE( changedRows(spyChanged, 0), QList<int>() << 1 << 2 );
+    QCOMPARE( changedRows(spyChanged, 1), QList<int>() << 4 << 4 );
+    QCOMPARE( target.data(target.index(4, 1)).toString(), QString("51.0") );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ResultTableModel::test_setResults_countChanged()
+{
+    // Given
+    FakeSpliceModel splice;
+    splice.setResults({10., 20., 30.});
+    ResultTableModel target;
+    target.setSpliceModel(&splice);
+    QSignalSpy spyChanged(&target, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+    QSignalSpy spyInserted(&target, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy spyRemoved(&target, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+
+    // When
+    splice.setResults({10., 25., 30., 40., 50.});
+    target.updateResults();
+
+    // Then
+    QCOMPARE( target.rowCount(), 5 );
+    QCOMPARE( spyInserted.count(), 1 );
+    QCOMPARE( spyInserted.at(0).at(1).toInt(), 3 );
+    QCOMPARE( spyInserted.at(0).at(2).toInt(), 4 );
+    QCOMPARE( spyChanged.count(), 1 );
+    QCOMPARE( changedRows(spyChanged, 0), QList<int>() << 1 << 1 );
+
+    // When
+    spyChanged.clear();
+    splice.setResults({10., 25.});
+    target.updateResults();
+
+    // Then
+    QCOMPARE( target.rowCount(), 2 );
+    QCOMPARE( spyRemoved.count(), 1 );
+    QCOMPARE( spyRemoved.at(0).at(1).toInt(), 2 );
+    QCOMPARE( spyRemoved.at(0).at(2).toInt(), 4 );
+    QCOMPARE( spyChanged.count(), 0 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ResultTableModel::test_topCount()
+{
+    // Given
+    FakeSpliceModel splice;
+    splice.setResults({10., 50., 30., 50., 20.});
+    ResultTableModel target;
+    target.setSpliceModel(&splice);
+    QSignalSpy spyReset(&target, SIGNAL(modelReset()));
+
+    // When
+    target.setTopCount(3);
+
+    // Then
+    /* Decreasing resultant, the ties by fastener index */
+    QCOMPARE( spyReset.count(), 1 );
+    QCOMPARE( target.rowCount(), 3 );
+    QCOMPARE( fastenerIndexes(target), QList<int>() << 1 << 3 << 2 );
+    QCOMPARE( target.fastenerIndex(3), -1 );
+    QCOMPARE( target.data(target.index(2, 3)).toString(), QString("30.0") );
+
+    // When
+    target.setTopCount(0);
+
+    // Then
+    QCOMPARE( target.rowCount(), 5 );
+    QCOMPARE( target.fastenerIndex(2), 2 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ResultTableModel::test_topCount_reorder()
+{
+    // Given
+    FakeSpliceModel splice;
+    splice.setResults({10., 50., 30., 50., 20.});
+    ResultTableModel target;
+    target.setTopCount(3);
+    target.setSpliceModel(&splice);
+    QSignalSpy spyChanged(&target, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+    QSignalSpy spyInserted(&target, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy spyRemoved(&target, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+
+    // When
+    splice.setResults({10., 50., 60., 50., 20.});
+    target.updateResults();
+
+    // Then
+    /* Each row shows another fastener */
+    QCOMPARE( fastenerIndexes(target), QList<int>() << 2 << 1 << 3 );
+    QCOMPARE( spyChanged.count(), 1 );
+    QCOMPARE( changedRows(spyChanged, 0), QList<int>() << 0 << 2 );
+
+    // When
+    spyChanged.clear();
+    splice.setResults({10.01, 50.02, 60., 50., 20.});
+    target.updateResults();
+
+    // Then
+    /* Same order, displayed the same */
+    QCOMPARE( fastenerIndexes(target), QList<int>() << 2 << 1 << 3 );
+    QCOMPARE( spyChanged.count(), 0 );
+
+    // When
+    splice.setResults({10., 50., 60., 50.5, 20.});
+    target.updateResults();
+
+    // Then
+    QCOMPARE( fastenerIndexes(target), QList<int>() << 2 << 3 << 1 );
+    QCOMPARE( spyChanged.count(), 1 );
+    QCOMPARE( changedRows(spyChanged, 0), QList<int>() << 1 << 2 );
+    QCOMPARE( spyInserted.count(), 0 );
+    QCOMPARE( spyRemoved.count(), 0 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_ResultTableModel::test_topCount_countChanged()
+{
+    // Given
+    FakeSpliceModel splice;
+    splice.setResults({10., 20.});
+    ResultTableModel target;
+    target.setTopCount(3);
+    target.setSpliceModel(&splice);
+    QSignalSpy spyChanged(&target, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+    QSignalSpy spyInserted(&target, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy spyRemoved(&target, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QCOMPARE( fastenerIndexes(target), QList<int>() << 1 << 0 );
+
+    // When
+    splice.setResults({10., 20., 30., 40.});
+    target.updateResults();
+
+    // Then
+    /* Bounded by topCount() */
+    QCOMPARE( fastenerIndexes(target), QList<int>() << 3 << 2 << 1 );
+    QCOMPARE( spyInserted.count(), 1 );
+    QCOMPARE( spyInserted.at(0).at(1).toInt(), 2 );
+    QCOMPARE( spyInserted.at(0).at(2).toInt(), 2 );
+    QCOMPARE( spyChanged.count(), 1 );
+    QCOMPARE( changedRows(spyChanged, 0), QList<int>() << 0 << 1 );
+
+    // When
+    spyChanged.clear();
+    splice.setResults({5.});
+    target.updateResults();
+
+    // Then
+    QCOMPARE( fastenerIndexes(target), QList<int>() << 0 );
+    QCOMPARE( spyRemoved.count(), 1 );
+    QCOMPARE( spyRemoved.at(0).at(1).toInt(), 1 );
+    QCOMPARE( spyRemoved.at(0).at(2).toInt(), 2 );
+    QCOMPARE( spyChanged.count(), 1 );
+    QCOMPARE( changedRows(spyChanged, 0), QList<int>() << 0 << 0 );
+}
+
+QTEST_GUILESS_MAIN(tst_ResultTableModel)
+
+#include "tst_resulttablemodel.moc"
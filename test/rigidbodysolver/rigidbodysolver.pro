@@ -9,6 +9,7 @@ INCLUDEPATH += ../../include
 
 # Dependancies:
 include($$PWD/../../src/core/core.pri)
+include($$PWD/../../src/math/math.pri)
 
 #-------------------------------------------------
 # Boost
@@ -23,3 +24,9 @@ Boost_LIB_DIR      = "C:/Qt/Boost/boost_1_61_0/stage/lib/"
 INCLUDEPATH += $$Boost_INCLUDE_DIR
 LIBS        += -L$$Boost_LIB_DIR
 DEFINES     += BOOST_MATH_DISABLE_FLOAT128
+
+#-------------------------------------------------
+# TRIANGLE
+#-------------------------------------------------
+include($$PWD/../../FastenerPattern_config.pri)
+include($$PWD/../../3rd/3rd.pri)
@@ -17,7 +17,9 @@
 #include <Core/Solvers/RigidBodySolver>
 #include <Core/Solvers/Parameters>
 #include <Core/Splice>
+#include <Core/Units/AreaMomentOfInertia>
 
+#include <boost/units/cmath.hpp>   /* pow() */
 #include <QtTest/QtTest>
 #include <QtCore/QDebug>
 #include <QtCore/QList>
@@ -45,8 +47,99 @@ private slots:
     void test_isobearing();
     void test_isoshear();
 
+    void test_calculateIncremental();
+
+    void test_calculateLoadCases();
+    void test_calculateEnvelope();
+
+    void test_rawKernel();
+
+    void benchmark_calculate_data();
+    void benchmark_calculate();
+    void benchmark_calculateWithUnits_data();
+    void benchmark_calculateWithUnits();
+
+private:
+    void addRandomFasteners(Splice *splice, int count) const;
 };
 
+/******************************************************************************
+ ******************************************************************************/
+/* Reference implementation of RigidBodySolver::calculate(), with the
+ * quantities of Boost.Units, as before the raw kernel. */
+static QList<Tensor> calculateWithUnits(const Splice *splice)
+{
+    using namespace boost::units;
+
+    struct Data {
+        quantity<si::area> Ax;
+        quantity<si::area> Ay;
+    };
+
+    const int count = splice->fastenerCount();
+    QVector<Data> _list;
+    _list.reserve(count);
+    quantity<si::area> sumAx = 0.*m_2;
+    quantity<si::area> sumAy = 0.*m_2;
+    quantity<si::volume> sumBx = 0.*m_3;
+    quantity<si::volume> sumBy = 0.*m_3;
+    for (int i = 0 ; i < count ; ++i) {
+        const Fastener &f = splice->fastenerAt(i);
+        Data d { 0.*m_2, 0.*m_2 };
+        if (f.DoF_X == Fastener::Fixed) d.Ax = f.diameter * f.thickness;
+        if (f.DoF_Y == Fastener::Fixed) d.Ay = f.diameter * f.thickness;
+        _list.append(d);
+        sumAx += d.Ax;
+        sumAy += d.Ay;
+        sumBx += d.Ax * f.positionY;
+        sumBy += d.Ay * f.positionX;
+    }
+
+    const quantity<si::length> CoG_x = sumBy / sumAy;
+    const quantity<si::length> CoG_y = sumBx / sumAx;
+
+    quantity<si::area_moment_of_inertia> Ix = 0.*si::quadratic_meters;
+    quantity<si::area_moment_of_inertia> Iy = 0.*si::quadratic_meters;
+    for (int i = 0 ; i < count ; ++i) {
+        const Fastener &f = splice->fastenerAt(i);
+        Ix += _list[i].Ax * boost::units::pow<2>(f.positionY - CoG_y);
+        Iy += _list[i].Ay * boost::units::pow<2>(f.positionX - CoG_x);
+    }
+
+    const Tensor &load = splice->appliedLoad();
+    const Torque torque_z = load.torque_z
+            + (CoG_y * load.force_x - CoG_x * load.force_y) / (si::radian);
+
+    QList<Tensor> res;
+    res.reserve(count);
+    for (int i = 0 ; i < count ; ++i) {
+        const Fastener &f = splice->fastenerAt(i);
+        Tensor fastenerload;
+        fastenerload.force_x = -1.0/(Iy + Ix) * torque_z
+                * (f.positionY - CoG_y) * _list[i].Ax * si::radians
+                + load.force_x * (_list[i].Ax / sumAx);
+        fastenerload.force_y =  1.0/(Iy + Ix) * torque_z
+                * (f.positionX - CoG_x) * _list[i].Ay * si::radians
+                + load.force_y * (_list[i].Ay / sumAy);
+        fastenerload.torque_z = 0.*N_m;
+        res.append(fastenerload);
+    }
+    return res;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_RigidBodySolver::addRandomFasteners(Splice *splice, int count) const
+{
+    for (int i = 0; i < count; ++i) {
+        splice->addFastener( Fastener( (qrand() % 100000 / 100.) *_mm,
+                                       (qrand() % 100000 / 100.) *_mm,
+                                       4.83*_mm, 3.*_mm,
+                                       (i % 7 == 0) ? Fastener::Free : Fastener::Fixed,
+                                       (i % 5 == 0) ? Fastener::Free : Fastener::Fixed ) );
+    }
+}
+
 
 /******************************************************************************
  ******************************************************************************/
@@ -200,6 +293,164 @@ void tst_RigidBodySolver::test_isoshear()
     QCOMPARE( actual.at(2).around(2), Tensor(  72.64*N,  68.76*N, 0.*N_m ) );
 }
 
+/******************************************************************************
+ ******************************************************************************/
+void tst_RigidBodySolver::test_calculateIncremental()
+{
+    // Given
+    RigidBodySolver solver;
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 1000.*N, 1000.*N, 1000.*N_mm) );
+    splice.addFastener( Fastener( -10.*_mm, -5.*_mm, 6.45*_mm, 3.*_mm ) );
+    splice.addFastener( Fastener(  10.*_mm, -5.*_mm, 4.83*_mm, 2.*_mm ) );
+    splice.addFastener( Fastener(   0.*_mm, 10.*_mm, 2.20*_mm, 1.*_mm ) );
+    solver.setParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+    solver.calculateIncremental( &splice, -1 );
+
+    // When
+    splice.setFastenerAt(1, Fastener( 15.*_mm, -2.*_mm, 4.83*_mm, 2.*_mm,
+                                      Fastener::Fixed, Fastener::Free ) );
+    QList<Tensor> actual = solver.calculateIncremental( &splice, 1 );
+    QList<Tensor> expected = solver.calculate( &splice );
+
+    // Then
+    QCOMPARE( actual.count(), 3);
+    QCOMPARE( actual.at(0).around(2), expected.at(0).around(2) );
+    QCOMPARE( actual.at(1).around(2), expected.at(1).around(2) );
+    QCOMPARE( actual.at(2).around(2), expected.at(2).around(2) );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_RigidBodySolver::test_calculateLoadCases()
+{
+    // Given
+    RigidBodySolver solver;
+    Splice splice;
+    splice.addFastener( Fastener( -10.*_mm, -5.*_mm, 6.45*_mm, 3.*_mm ) );
+    splice.addFastener( Fastener(  10.*_mm, -5.*_mm, 4.83*_mm, 2.*_mm ) );
+    splice.addFastener( Fastener(   0.*_mm, 10.*_mm, 2.20*_mm, 1.*_mm ) );
+    solver.setParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+
+    QVector<Tensor> loadCases;
+    loadCases << Tensor( 1000.*N, 1000.*N, 1000.*N_mm);
+    loadCases << Tensor( -500.*N,    0.*N,    0.*N_mm);
+    loadCases << Tensor(    0.*N,  200.*N, -500.*N_mm);
+
+    // When
+    QList<QList<Tensor> > actual = solver.calculateLoadCases( &splice, loadCases );
+
+    // Then
+    QCOMPARE( actual.count(), 3);
+    for (int i = 0; i < loadCases.count(); ++i) {
+        splice.setAppliedLoad( loadCases.at(i) );
+        QList<Tensor> expected = solver.calculate( &splice );
+        QCOMPARE( actual.at(i).count(), 3);
+        QCOMPARE( actual.at(i).at(0).around(2), expected.at(0).around(2) );
+        QCOMPARE( actual.at(i).at(1).around(2), expected.at(1).around(2) );
+        QCOMPARE( actual.at(i).at(2).around(2), expected.at(2).around(2) );
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_RigidBodySolver::test_calculateEnvelope()
+{
+    // Given
+    RigidBodySolver solver;
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 100.*N, 0.*N, 0.*N_mm) );
+    splice.addLoadCase( Tensor( 0.*N, 1000.*N, 0.*N_mm) );
+    splice.addFastener( Fastener( -10.*_mm, 0.*_mm, 4.83*_mm, 2.*_mm ) );
+    splice.addFastener( Fastener(  10.*_mm, 0.*_mm, 4.83*_mm, 2.*_mm ) );
+    solver.setParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+
+    // When
+    QList<Tensor> actual = solver.calculateEnvelope( &splice );
+
+    // Then
+    /* The load case is the most critical for both fasteners. */
+    QCOMPARE( actual.count(), 2);
+    QCOMPARE( actual.at(0).around(2), Tensor( 0.*N, 500.*N, 0.*N_m ) );
+    QCOMPARE( actual.at(1).around(2), Tensor( 0.*N, 500.*N, 0.*N_m ) );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_RigidBodySolver::test_rawKernel()
+{
+    // Given
+    RigidBodySolver solver;
+    solver.setParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 1000.*N, -500.*N, 2000.*N_mm) );
+    qsrand(7);
+    addRandomFasteners(&splice, 100);
+
+    // When
+    QList<Tensor> actual = solver.calculate( &splice );
+    QList<Tensor> expected = calculateWithUnits( &splice );
+
+    // Then
+    /* The raw kernel gives the results of the implementation with units. */
+    QCOMPARE( actual.count(), 100);
+    for (int i = 0; i < actual.count(); ++i) {
+        QCOMPARE( actual.at(i).around(6), expected.at(i).around(6) );
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+/* Run the benchmarks in both Debug and Release: the gain of the raw kernel
+ * over the implementation with units is the largest in Debug, where the
+ * operators of Boost.Units are not inlined. */
+void tst_RigidBodySolver::benchmark_calculate_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("100 fasteners") << 100;
+    QTest::newRow("10k fasteners") << 10000;
+}
+
+void tst_RigidBodySolver::benchmark_calculate()
+{
+    QFETCH(int, count);
+
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 1000.*N, -500.*N, 2000.*N_mm) );
+    qsrand(5);
+    addRandomFasteners(&splice, count);
+
+    RigidBodySolver solver;
+    solver.setParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+    QList<Tensor> results;
+    QBENCHMARK {
+        results = solver.calculate( &splice );
+    }
+    QCOMPARE( results.count(), count );
+}
+
+void tst_RigidBodySolver::benchmark_calculateWithUnits_data()
+{
+    benchmark_calculate_data();
+}
+
+void tst_RigidBodySolver::benchmark_calculateWithUnits()
+{
+    QFETCH(int, count);
+
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 1000.*N, -500.*N, 2000.*N_mm) );
+    qsrand(5);
+    addRandomFasteners(&splice, count);
+
+    QList<Tensor> results;
+    QBENCHMARK {
+        results = calculateWithUnits( &splice );
+    }
+    QCOMPARE( results.count(), count );
+}
+
 QTEST_APPLESS_MAIN(tst_RigidBodySolver)
 
 #include "tst_rigidbodysolver.moc"
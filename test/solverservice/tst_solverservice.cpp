@@ -0,0 +1,261 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/Service/SolverService>
+#include <Core/Service/SolverSession>
+#include <Core/Fastener>
+#include <Core/SpliceCalculator>
+#include <Core/Tensor>
+
+#include <QtTest/QtTest>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtNetwork/QLocalSocket>
+
+using namespace boost;
+using namespace units;
+using namespace si;
+
+class tst_SolverService : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    /* Session */
+    void test_session_insertFastener();
+    void test_session_invalidIndex_data();
+    void test_session_invalidIndex();
+    void test_session_moveFastener();
+    void test_session_unknownCommand();
+
+    /* Service */
+    void test_service_request();
+    void test_service_parseError();
+    void test_service_listen_inUse();
+
+private:
+    QString uniqueName() const;
+    QJsonObject insertRequest(int index, const Fastener &fastener) const;
+    QJsonObject send(QLocalSocket *socket, const QByteArray &line) const;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+QString tst_SolverService::uniqueName() const
+{
+    return QString("tst_solverservice_%0").arg(QCoreApplication::applicationPid());
+}
+
+QJsonObject tst_SolverService::insertRequest(int index, const Fastener &fastener) const
+{
+    QJsonObject fastenerObject;
+    fastener.write(fastenerObject);
+    QJsonObject request;
+    request["command"] = QStringLiteral("insertFastener");
+    request["index"] = index;
+    request["fastener"] = fastenerObject;
+    return request;
+}
+
+/* Sends the request \a line and waits for the reply. */
+QJsonObject tst_SolverService::send(QLocalSocket *socket, const QByteArray &line) const
+{
+    socket->write(line);
+    socket->write("\n");
+    socket->flush();
+    for (int i = 0; i < 50 && !socket->canReadLine(); ++i) {
+        QTest::qWait(100); /* the server runs in the same event loop */
+    }
+    if (!socket->canReadLine()) {
+        return QJsonObject();
+    }
+    return QJsonDocument::fromJson(socket->readLine()).object();
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SolverService::test_session_insertFastener()
+{
+    // Given
+    SolverSession session;
+    QJsonObject load;
+    Tensor( 1000.*N, 0.*N, 0.*N_m ).write(load);
+    QJsonObject request;
+    request["command"] = QStringLiteral("setAppliedLoad");
+    request["load"] = load;
+    session.process(request);
+
+    // When
+    session.process(insertRequest(0, Fastener(  0.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm )));
+    QJsonObject reply = session.process(insertRequest(1, Fastener( 20.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm )));
+
+    // Then
+    QCOMPARE( reply["status"].toString(), QString("ok") );
+    QCOMPARE( session.calculator()->fastenerCount(), 2 );
+    const QJsonArray results = reply["results"].toArray();
+    QCOMPARE( results.count(), 2 );
+    QCOMPARE( results.at(0).toObject()["fx"].toDouble(), 500. );
+    QCOMPARE( results.at(1).toObject()["fx"].toDouble(), 500. );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SolverService::test_session_invalidIndex_data()
+{
+    QTest::addColumn<QString>("command");
+    QTest::addColumn<int>("index");
+
+    /* The session contains 2 fasteners. */
+    QTest::newRow("insert before the first") << QString("insertFastener") << -1;
+    QTest::newRow("insert after the end") << QString("insertFastener") << 3;
+    QTest::newRow("set negative") << QString("setFastener") << -1;
+    QTest::newRow("set at count") << QString("setFastener") << 2;
+    QTest::newRow("move at count") << QString("moveFastener") << 2;
+    QTest::newRow("remove at count") << QString("removeFastener") << 2;
+}
+
+void tst_SolverService::test_session_invalidIndex()
+{
+    QFETCH(QString, command);
+    QFETCH(int, index);
+
+    // Given
+    SolverSession session;
+    session.process(insertRequest(0, Fastener(  0.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm )));
+    session.process(insertRequest(1, Fastener( 20.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm )));
+
+    // When
+    QJsonObject request = insertRequest(index, Fastener( 10.*_mm, 5.*_mm, 4.83*_mm, 3.*_mm ));
+    request["command"] = command;
+    request["x"] = 0.01;
+    request["y"] = 0.01;
+    QJsonObject reply = session.process(request);
+
+    // Then
+    QCOMPARE( reply["status"].toString(), QString("error") );
+    QVERIFY( !reply["error"].toString().isEmpty() );
+    QCOMPARE( session.calculator()->fastenerCount(), 2 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SolverService::test_session_moveFastener()
+{
+    // Given
+    SolverSession session;
+    session.process(insertRequest(0, Fastener(  0.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm )));
+
+    // When
+    QJsonObject request;
+    request["command"] = QStringLiteral("moveFastener");
+    request["id"] = 42;
+    request["index"] = 0;
+    request["x"] = 0.01;
+    request["y"] = 0.02;
+    QJsonObject reply = session.process(request);
+
+    // Then
+    QCOMPARE( reply["status"].toString(), QString("ok") );
+    QCOMPARE( reply["id"].toInt(), 42 ); /* echoed */
+    QCOMPARE( session.calculator()->fastenerAt(0).positionX.value(), 0.01 );
+    QCOMPARE( session.calculator()->fastenerAt(0).positionY.value(), 0.02 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SolverService::test_session_unknownCommand()
+{
+    // Given
+    SolverSession session;
+    QJsonObject request;
+    request["command"] = QStringLiteral("explode");
+
+    // When
+    QJsonObject reply = session.process(request);
+
+    // Then
+    QCOMPARE( reply["status"].toString(), QString("error") );
+    QVERIFY( !reply.contains("results") );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SolverService::test_service_request()
+{
+    // Given
+    SolverService service;
+    QVERIFY2( service.listen(uniqueName()), qPrintable(service.errorString()) );
+    QLocalSocket client;
+    client.connectToServer(uniqueName());
+    QVERIFY( client.waitForConnected(1000) );
+
+    // When
+    QJsonObject request = insertRequest(0, Fastener( 0.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    request["id"] = 1;
+    QJsonObject reply = send(&client, QJsonDocument(request).toJson(QJsonDocument::Compact));
+
+    // Then
+    QCOMPARE( reply["status"].toString(), QString("ok") );
+    QCOMPARE( reply["id"].toInt(), 1 );
+    QCOMPARE( reply["results"].toArray().count(), 1 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SolverService::test_service_parseError()
+{
+    // Given
+    SolverService service;
+    QVERIFY2( service.listen(uniqueName()), qPrintable(service.errorString()) );
+    QLocalSocket client;
+    client.connectToServer(uniqueName());
+    QVERIFY( client.waitForConnected(1000) );
+
+    // When
+    QJsonObject reply = send(&client, "{ not json");
+
+    // Then
+    QCOMPARE( reply["status"].toString(), QString("error") );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SolverService::test_service_listen_inUse()
+{
+    // Given
+    SolverService running;
+    QVERIFY2( running.listen(uniqueName()), qPrintable(running.errorString()) );
+
+    // When
+    SolverService other;
+    const bool listening = other.listen(uniqueName());
+
+    // Then
+    /* The socket of the running instance is kept. */
+    QVERIFY( !listening );
+    QLocalSocket client;
+    client.connectToServer(uniqueName());
+    QVERIFY( client.waitForConnected(1000) );
+    QJsonObject request;
+    request["command"] = QStringLiteral("solve");
+    QJsonObject reply = send(&client, QJsonDocument(request).toJson(QJsonDocument::Compact));
+    QCOMPARE( reply["status"].toString(), QString("ok") );
+}
+
+QTEST_GUILESS_MAIN(tst_SolverService)
+
+#include "tst_solverservice.moc"
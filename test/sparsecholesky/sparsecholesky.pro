@@ -0,0 +1,12 @@
+#isEmpty(TEMPLATE):TEMPLATE=app
+TARGET       = tst_sparsecholesky
+CONFIG      += testcase
+QT           = core testlib
+SOURCES     += tst_sparsecholesky.cpp
+
+# Include:
+INCLUDEPATH += ../../include
+
+# Dependancies:
+HEADERS  += $$PWD/../../src/math/sparsecholesky.h
+SOURCES  += $$PWD/../../src/math/sparsecholesky.cpp
@@ -0,0 +1,352 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Math/SparseCholesky>
+
+#include <QtTest/QtTest>
+#include <QtCore/QDebug>
+#include <QtCore/QtMath>
+
+class tst_SparseCholesky : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_empty();
+    void test_diagonal();
+    void test_tridiagonal_data();
+    void test_tridiagonal();
+    void test_several_right_hand_sides();
+    void test_fill_in();
+    void test_refactorize();
+    void test_not_positive_definite();
+    void test_invalid_permutation();
+
+private:
+    /* Dense symmetric matrix, row by row, converted to CSR */
+    struct Matrix {
+        int size;
+        QVector<int> rowStart;
+        QVector<int> columns;
+        QVector<double> values;
+    };
+    Matrix toCsr(int size, const QVector<double> &dense) const;
+    Matrix laplacian(int size) const;
+    Matrix arrow(int size) const;
+    QVector<double> multiply(const Matrix &A, const QVector<double> &x) const;
+    bool fuzzyCompare(const QVector<double> &actual, const QVector<double> &expected) const;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+tst_SparseCholesky::Matrix tst_SparseCholesky::toCsr(int size, const QVector<double> &dense) const
+{
+    Matrix A;
+    A.size = size;
+    A.rowStart << 0;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            if (dense.at(i * size + j) != 0.) {
+                A.columns << j;
+                A.values << dense.at(i * size + j);
+            }
+        }
+        A.rowStart << A.columns.count();
+    }
+    return A;
+}
+
+/* The 1D Laplacian: 2 on the diagonal, -1 besides. */
+tst_SparseCholesky::Matrix tst_SparseCholesky::laplacian(int size) const
+{
+    QVector<double> dense(size * size, 0.);
+    for (int i = 0; i < size; ++i) {
+        dense[i * size + i] = 2.;
+        if (i > 0) {
+            dense[i * size + i - 1] = -1.;
+            dense[(i - 1) * size + i] = -1.;
+        }
+    }
+    return toCsr(size, dense);
+}
+
+/* Dense first row and column, and diagonal: the first row fills L in. */
+tst_SparseCholesky::Matrix tst_SparseCholesky::arrow(int size) const
+{
+    QVector<double> dense(size * size, 0.);
+    dense[0] = size;
+    for (int i = 1; i < size; ++i) {
+        dense[i * size + i] = 2.;
+        dense[i * size] = 1.;
+        dense[i] = 1.;
+    }
+    return toCsr(size, dense);
+}
+
+QVector<double> tst_SparseCholesky::multiply(const Matrix &A, const QVector<double> &x) const
+{
+    QVector<double> b(A.size, 0.);
+    for (int i = 0; i < A.size; ++i) {
+        for (int p = A.rowStart.at(i); p < A.rowStart.at(i + 1); ++p) {
+            b[i] += A.values.at(p) * x.at(A.columns.at(p));
+        }
+    }
+    return b;
+}
+
+bool tst_SparseCholesky::fuzzyCompare(const QVector<double> &actual,
+                                      const QVector<double> &expected) const
+{
+    if (actual.count() != expected.count()) {
+        return false;
+    }
+    for (int i = 0; i < actual.count(); ++i) {
+        if (qAbs(actual.at(i) - expected.at(i)) > 1e-9 * (1. + qAbs(expected.at(i)))) {
+            qDebug() << i << actual.at(i) << expected.at(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SparseCholesky::test_empty()
+{
+    // Given
+    Math::SparseCholesky cholesky;
+    const int rowStart[1] = { 0 };
+
+    // When
+    bool analyzed = cholesky.analyze(0, rowStart, Q_NULLPTR, QVector<int>());
+    bool factorized = cholesky.factorize(Q_NULLPTR);
+
+    // Then
+    QVERIFY(analyzed);
+    QVERIFY(factorized);
+    QCOMPARE(cholesky.size(), 0);
+    QCOMPARE(cholesky.factorSize(), 0);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SparseCholesky::test_diagonal()
+{
+    // Given
+    QVector<double> dense;
+    dense << 4. << 0. << 0.
+          << 0. << 9. << 0.
+          << 0. << 0. << 16.;
+    Matrix A = toCsr(3, dense);
+    QVector<double> b;
+    b << 8. << 9. << 4.;
+
+    QVector<double> expected;
+    expected << 2. << 1. << 0.25;
+
+    // When
+    Math::SparseCholesky cholesky;
+    QVERIFY(cholesky.analyze(A.size, A.rowStart.constData(), A.columns.constData(), QVector<int>()));
+    QVERIFY(cholesky.factorize(A.values.constData()));
+    cholesky.solve(b.data(), 1);
+
+    // Then
+    QVERIFY(cholesky.isFactorized());
+    QCOMPARE(cholesky.factorSize(), 3); /* No fill-in */
+    QVERIFY(fuzzyCompare(b, expected));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SparseCholesky::test_tridiagonal_data()
+{
+    QTest::addColumn<bool>("reversed");
+
+    QTest::newRow("identity") << false;
+    QTest::newRow("reversed") << true;
+}
+
+void tst_SparseCholesky::test_tridiagonal()
+{
+    QFETCH(bool, reversed);
+
+    // Given
+    const int n = 50;
+    Matrix A = laplacian(n);
+    QVector<int> permutation;
+    if (reversed) {
+        for (int k = 0; k < n; ++k) {
+            permutation << n - 1 - k;
+        }
+    }
+    QVector<double> expected(n);
+    for (int i = 0; i < n; ++i) {
+        expected[i] = qSin(0.1 * i) + 1.;
+    }
+    QVector<double> b = multiply(A, expected);
+
+    // When
+    Math::SparseCholesky cholesky;
+    QVERIFY(cholesky.analyze(n, A.rowStart.constData(), A.columns.constData(), permutation));
+    QVERIFY(cholesky.factorize(A.values.constData()));
+    cholesky.solve(b.data(), 1);
+
+    // Then
+    QCOMPARE(cholesky.factorSize(), 2 * n - 1); /* Bidiagonal, no fill-in */
+    QVERIFY(fuzzyCompare(b, expected));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SparseCholesky::test_several_right_hand_sides()
+{
+    // Given
+    const int n = 20;
+    const int rhsCount = 3;
+    Matrix A = laplacian(n);
+    QVector<QVector<double> > expected(rhsCount, QVector<double>(n));
+    QVector<double> b(n * rhsCount); /* Interleaved */
+    for (int r = 0; r < rhsCount; ++r) {
+        for (int i = 0; i < n; ++i) {
+            expected[r][i] = (r + 1) * i - 0.5 * r;
+        }
+        const QVector<double> br = multiply(A, expected.at(r));
+        for (int i = 0; i < n; ++i) {
+            b[i * rhsCount + r] = br.at(i);
+        }
+    }
+
+    // When
+    Math::SparseCholesky cholesky;
+    QVERIFY(cholesky.analyze(n, A.rowStart.constData(), A.columns.constData(), QVector<int>()));
+    QVERIFY(cholesky.factorize(A.values.constData()));
+    cholesky.solve(b.data(), rhsCount);
+
+    // Then
+    for (int r = 0; r < rhsCount; ++r) {
+        QVector<double> actual(n);
+        for (int i = 0; i < n; ++i) {
+            actual[i] = b.at(i * rhsCount + r);
+        }
+        QVERIFY(fuzzyCompare(actual, expected.at(r)));
+    }
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SparseCholesky::test_fill_in()
+{
+    // Given
+    const int n = 10;
+    Matrix A = arrow(n);
+    QVector<int> last; /* The dense row is eliminated last */
+    for (int k = 1; k < n; ++k) {
+        last << k;
+    }
+    last << 0;
+    QVector<double> expected(n, 1.);
+    QVector<double> b1 = multiply(A, expected);
+    QVector<double> b2 = b1;
+
+    // When
+    Math::SparseCholesky first;
+    QVERIFY(first.analyze(n, A.rowStart.constData(), A.columns.constData(), QVector<int>()));
+    QVERIFY(first.factorize(A.values.constData()));
+    first.solve(b1.data(), 1);
+
+    Math::SparseCholesky second;
+    QVERIFY(second.analyze(n, A.rowStart.constData(), A.columns.constData(), last));
+    QVERIFY(second.factorize(A.values.constData()));
+    second.solve(b2.data(), 1);
+
+    // Then
+    QCOMPARE(first.factorSize(), n * (n + 1) / 2); /* L is full */
+    QCOMPARE(second.factorSize(), 2 * n - 1);
+    QVERIFY(fuzzyCompare(b1, expected));
+    QVERIFY(fuzzyCompare(b2, expected));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SparseCholesky::test_refactorize()
+{
+    /* The pattern is analyzed once, for several values */
+    // Given
+    const int n = 30;
+    Matrix A = laplacian(n);
+    QVector<double> expected(n);
+    for (int i = 0; i < n; ++i) {
+        expected[i] = i % 7;
+    }
+    Math::SparseCholesky cholesky;
+    QVERIFY(cholesky.analyze(n, A.rowStart.constData(), A.columns.constData(), QVector<int>()));
+    QVERIFY(cholesky.factorize(A.values.constData()));
+
+    // When
+    for (int p = 0; p < A.values.count(); ++p) {
+        A.values[p] *= 4.;
+    }
+    QVector<double> b = multiply(A, expected);
+    QVERIFY(cholesky.factorize(A.values.constData()));
+    cholesky.solve(b.data(), 1);
+
+    // Then
+    QVERIFY(fuzzyCompare(b, expected));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SparseCholesky::test_not_positive_definite()
+{
+    // Given
+    QVector<double> dense;
+    dense << 1. << 2.
+          << 2. << 1.;
+    Matrix A = toCsr(2, dense);
+    Math::SparseCholesky cholesky;
+    QVERIFY(cholesky.analyze(A.size, A.rowStart.constData(), A.columns.constData(), QVector<int>()));
+
+    // When
+    bool factorized = cholesky.factorize(A.values.constData());
+
+    // Then
+    QVERIFY(!factorized);
+    QVERIFY(!cholesky.isFactorized());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SparseCholesky::test_invalid_permutation()
+{
+    // Given
+    Matrix A = laplacian(3);
+    QVector<int> duplicate;
+    duplicate << 0 << 1 << 1;
+    QVector<int> outOfRange;
+    outOfRange << 0 << 1 << 3;
+    QVector<int> tooShort;
+    tooShort << 0 << 1;
+    Math::SparseCholesky cholesky;
+
+    // When, Then
+    QVERIFY(!cholesky.analyze(3, A.rowStart.constData(), A.columns.constData(), duplicate));
+    QVERIFY(!cholesky.analyze(3, A.rowStart.constData(), A.columns.constData(), outOfRange));
+    QVERIFY(!cholesky.analyze(3, A.rowStart.constData(), A.columns.constData(), tooShort));
+}
+
+QTEST_APPLESS_MAIN(tst_SparseCholesky)
+
+#include "tst_sparsecholesky.moc"
@@ -0,0 +1,40 @@
+#isEmpty(TEMPLATE):TEMPLATE=app
+TARGET       = tst_splicebinary
+CONFIG      += testcase
+QT           = core gui testlib
+SOURCES     += tst_splicebinary.cpp
+
+# Include:
+INCLUDEPATH += ../../include
+
+# Dependancies:
+HEADERS  += \
+    $$PWD/../common/splicefixture.h \
+    $$PWD/../../src/core/units/unit_system.h \
+    $$PWD/../../src/core/designspace.h \
+    $$PWD/../../src/core/fastener.h \
+    $$PWD/../../src/core/splice.h \
+    $$PWD/../../src/core/splicebinary.h \
+    $$PWD/../../src/core/tensor.h \
+    $$PWD/../../src/math/utils.h
+
+SOURCES += \
+    $$PWD/../../src/core/designspace.cpp \
+    $$PWD/../../src/core/fastener.cpp \
+    $$PWD/../../src/core/splice.cpp \
+    $$PWD/../../src/core/splicebinary.cpp \
+    $$PWD/../../src/core/tensor.cpp
+
+#-------------------------------------------------
+# Boost
+#-------------------------------------------------
+
+# INSTRUCTION: Replace the following path by your path:
+Boost_INCLUDE_DIR  = "C:/Qt/Boost/boost_1_61_0/"
+Boost_LIB_DIR      = "C:/Qt/Boost/boost_1_61_0/stage/lib/"
+#
+
+
+INCLUDEPATH += $$Boost_INCLUDE_DIR
+LIBS        += -L$$Boost_LIB_DIR
+DEFINES     += BOOST_MATH_DISABLE_FLOAT128
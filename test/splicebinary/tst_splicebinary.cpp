@@ -0,0 +1,205 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/Splice>
+#include <Core/SpliceBinary>
+
+#include "../common/splicefixture.h"
+
+#include <QtTest/QtTest>
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QtEndian>
+
+class tst_SpliceBinary : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_empty();
+    void test_roundTrip();
+    void test_roundTripThroughJson();
+    void test_read_v10();
+    void test_truncated();
+    void test_offsetOverflow_data();
+    void test_offsetOverflow();
+    void test_notBinary();
+};
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceBinary::test_empty()
+{
+    // Given
+    Splice expected;
+
+    // When
+    QByteArray bytes = SpliceBinary::toByteArray(expected);
+    Splice actual;
+    actual.setTitle(QStringLiteral("To be overwritten"));
+    actual.addFastener(Fastener());
+    bool ok = SpliceBinary::read(reinterpret_cast<const uchar*>(bytes.constData()),
+                                 bytes.size(), &actual);
+
+    // Then
+    QVERIFY(ok);
+    QCOMPARE(actual, expected);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceBinary::test_roundTrip()
+{
+    // Given
+    Splice expected = Fixture::createSplice();
+
+    // When
+    QByteArray bytes = SpliceBinary::toByteArray(expected);
+    Splice actual;
+    bool ok = SpliceBinary::read(reinterpret_cast<const uchar*>(bytes.constData()),
+                                 bytes.size(), &actual);
+
+    // Then
+    QVERIFY(ok);
+    QCOMPARE(actual, expected);
+    QCOMPARE(actual.fastenerAt(1).DoF_X, Fastener::Free);
+    QCOMPARE(actual.fastenerAt(2).DoF_Y, Fastener::Free);
+    QCOMPARE(actual.designSpaceAt(0).polygon.count(), 3);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceBinary::test_roundTripThroughJson()
+{
+    // Given
+    Splice original = Fixture::createSplice();
+    QJsonObject expected;
+    original.write(expected);
+
+    // When
+    QByteArray bytes = SpliceBinary::toByteArray(original);
+    Splice splice;
+    SpliceBinary::read(reinterpret_cast<const uchar*>(bytes.constData()),
+                       bytes.size(), &splice);
+    QJsonObject actual;
+    splice.write(actual);
+
+    // Then
+    QCOMPARE(actual, expected);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceBinary::test_truncated()
+{
+    // Given
+    QByteArray bytes = SpliceBinary::toByteArray(Fixture::createSplice());
+    bytes.chop(10);
+
+    // When
+    Splice actual;
+    QString error;
+    bool ok = SpliceBinary::read(reinterpret_cast<const uchar*>(bytes.constData()),
+                                 bytes.size(), &actual, &error);
+
+    // Then
+    QVERIFY(!ok);
+    QVERIFY(!error.isEmpty());
+    QCOMPARE(actual, Splice());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceBinary::test_offsetOverflow_data()
+{
+    QTest::addColumn<int>("field");
+
+    /* Offsets of the fields in the header */
+    QTest::newRow("fastener offset") << 72;
+    QTest::newRow("load case offset") << 128;
+}
+
+void tst_SpliceBinary::test_offsetOverflow()
+{
+    QFETCH(int, field);
+
+    // Given
+    /* An offset near 2^64 wraps 'offset + count * size' around zero. */
+    QByteArray bytes = SpliceBinary::toByteArray(Fixture::createSplice());
+    const quint64 offset = Q_UINT64_C(0xFFFFFFFFFFFFFFF8);
+    qToLittleEndian<quint64>(offset, reinterpret_cast<uchar*>(bytes.data() + field));
+
+    // When
+    Splice actual;
+    QString error;
+    bool ok = SpliceBinary::read(reinterpret_cast<const uchar*>(bytes.constData()),
+                                 bytes.size(), &actual, &error);
+
+    // Then
+    QVERIFY(!ok);
+    QVERIFY(!error.isEmpty());
+    QCOMPARE(actual, Splice());
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceBinary::test_read_v10()
+{
+    /* A file of version 1.0: header of 128 bytes, without the load cases. */
+    // Given
+    Splice expected = Fixture::createSplice();
+    expected.removeAllLoadCases();
+    const QByteArray current = SpliceBinary::toByteArray(expected);
+    QByteArray bytes = current.left(128) + current.mid(136);
+    uchar *data = reinterpret_cast<uchar*>(bytes.data());
+    qToLittleEndian<quint16>(0, data + 10);     /* minor version */
+    qToLittleEndian<quint32>(128, data + 12);   /* header size */
+    for (int field = 72; field <= 104; field += 8) {
+        const quint64 offset = qFromLittleEndian<quint64>(data + field);
+        qToLittleEndian<quint64>(offset - 8, data + field);
+    }
+    memset(data + 120, 0, 8); /* padding */
+
+    // When
+    Splice actual;
+    QString error;
+    bool ok = SpliceBinary::read(reinterpret_cast<const uchar*>(bytes.constData()),
+                                 bytes.size(), &actual, &error);
+
+    // Then
+    QVERIFY2(ok, qPrintable(error));
+    QCOMPARE(actual.loadCaseCount(), 0);
+    QCOMPARE(actual, expected);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceBinary::test_notBinary()
+{
+    // Given
+    QByteArray bytes("{ \"title\": \"json\" }");
+
+    // When
+    bool isBinary = SpliceBinary::isBinary(reinterpret_cast<const uchar*>(bytes.constData()),
+                                           bytes.size());
+
+    // Then
+    QVERIFY(!isBinary);
+}
+
+QTEST_APPLESS_MAIN(tst_SpliceBinary)
+
+#include "tst_splicebinary.moc"
@@ -15,6 +15,10 @@
  */
 
 #include <Core/SpliceCalculator>
+#include <Core/Splice>
+#include <Core/Solvers/Parameters>
+#include <Core/Solvers/RigidBodySolver>
+#include <Core/Solvers/SolverCache>
 
 #include <QtTest/QtTest>
 #include <QtCore/QDebug>
@@ -43,9 +47,30 @@ private slots:
 
     /* Applied Load */
     void test_setAppliedLoad();
+    void test_loadCases();
 
     /* Misc. */
     void test_setFastenerSelection();
+    void test_selectFasteners();
+    void test_selection_shifted();
+    void test_fastenerId();
+
+    /* Batched Edits */
+    void test_read_recalculatesOnce();
+    void test_beginUpdate_endUpdate();
+    void test_transaction();
+    void test_transaction_remove();
+    void test_flushTransaction();
+    void test_rangeSignals();
+    void test_rangeSignals_outOfRange();
+
+    /* Background Solving */
+    void test_asynchronous_latestWins();
+
+    /* Solver Cache */
+    void test_solverCache_undo();
+    void test_solverCache_asynchronousUpdate();
+    void test_solverCache_cost();
 
 };
 
@@ -198,6 +223,38 @@ void tst_SpliceCalculator::test_setAppliedLoad()
 
 }
 
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceCalculator::test_loadCases()
+{
+    // Given
+    SpliceCalculator target;
+    QSignalSpy spy(&target, SIGNAL(loadCasesChanged()));
+    Tensor first( 100.*N, 0.*N, 0.*N_m );
+    Tensor second( 0.*N, 200.*N, 0.*N_m );
+    Tensor third( 0.*N, 0.*N, 30.*N_m );
+
+    // When
+    target.insertLoadCase(0, second);
+    target.insertLoadCase(0, first);
+    target.insertLoadCase(5, third);   /* invalid */
+    target.setLoadCase(1, third);
+    target.setLoadCase(1, third);      /* unchanged */
+    target.removeLoadCase(0);
+    target.removeLoadCase(-1);         /* invalid */
+
+    // Then
+    QCOMPARE( target.loadCaseCount(), 1 );
+    QCOMPARE( target.loadCaseAt(0), third );
+    QCOMPARE( spy.count(), 4 );
+
+    // When
+    target.clear();
+
+    // Then
+    QCOMPARE( target.loadCaseCount(), 0 );
+}
+
 /******************************************************************************
  ******************************************************************************/
 void tst_SpliceCalculator::test_setFastenerSelection()
@@ -214,8 +271,510 @@ void tst_SpliceCalculator::test_setFastenerSelection()
     QCOMPARE( actual, expected);
 }
 
+void tst_SpliceCalculator::test_selectFasteners()
+{
+    // Given
+    SpliceCalculator target;
+    target.setFastenerSelection( {0,1,5} );
+    QSignalSpy spy(&target, SIGNAL(fastenersSelected(QSet<int>,QSet<int>)));
+
+    // When
+    target.selectFasteners( {1,2}, {5,9} );
+
+    // Then
+      /* Only the changes are notified */
+    QCOMPARE( target.selectedFastenerIndexes(), QSet<int>({0,1,2}) );
+    QCOMPARE( spy.count(), 1);
+    QCOMPARE( spy.at(0).at(0).value<QSet<int> >(), QSet<int>({2}) );
+    QCOMPARE( spy.at(0).at(1).value<QSet<int> >(), QSet<int>({5}) );
+}
+
+void tst_SpliceCalculator::test_selection_shifted()
+{
+    // Given
+    SpliceCalculator target;
+    target.insertFastener(0, Fastener(  1.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(1, Fastener(  2.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(2, Fastener(  3.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertDesignSpace(0, DesignSpace());
+    target.insertDesignSpace(1, DesignSpace());
+    target.setFastenerSelection( {0,2} );
+    target.setDesignSpaceSelection( {1} );
+
+    // When
+    target.insertFastener(1, Fastener(  4.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertDesignSpace(0, DesignSpace());
+
+    // Then
+    /* The same fasteners are selected */
+    QCOMPARE( target.selectedFastenerIndexes(), QSet<int>({0,3}) );
+    QCOMPARE( target.selectedDesignSpaceIndexes(), QSet<int>({2}) );
+
+    // When
+    QSignalSpy spy(&target, SIGNAL(fastenersSelected(QSet<int>,QSet<int>)));
+    target.selectFasteners( {}, {3} );
+
+    // Then
+    QCOMPARE( target.selectedFastenerIndexes(), QSet<int>({0}) );
+    QCOMPARE( spy.count(), 1 );
+    QCOMPARE( spy.at(0).at(1).value<QSet<int> >(), QSet<int>({3}) );
+
+    // When
+    target.setFastenerSelection( {2,3} );
+    target.removeFastener(1);
+    target.removeDesignSpace(0);
+
+    // Then
+    QCOMPARE( target.selectedFastenerIndexes(), QSet<int>({1,2}) );
+    QCOMPARE( target.selectedDesignSpaceIndexes(), QSet<int>({1}) );
+
+    // When
+    target.setFastenerSelection( {1} );
+
+    // Then
+    /* The fastener at 2 is deselected */
+    QCOMPARE( target.selectedFastenerIndexes(), QSet<int>({1}) );
+}
+
+void tst_SpliceCalculator::test_fastenerId()
+{
+    // Given
+    SpliceCalculator target;
+    target.insertFastener(0, Fastener(  1.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(1, Fastener(  2.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(2, Fastener(  3.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    const quint32 id0 = target.fastenerId(0);
+    const quint32 id1 = target.fastenerId(1);
+    const quint32 id2 = target.fastenerId(2);
+
+    // When
+    target.insertFastener(0, Fastener(  4.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.removeFastener(2);
+
+    // Then
+      /* The IDs follow the fasteners, when the indexes shift */
+    QCOMPARE( target.fastenerIndex(id0), 1);
+    QCOMPARE( target.fastenerIndex(id1), -1);
+    QCOMPARE( target.fastenerIndex(id2), 2);
+    QCOMPARE( target.fastenerIndex(target.fastenerId(0)), 0);
+    QCOMPARE( target.fastenerId(3), quint32(0));
+}
+
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceCalculator::test_read_recalculatesOnce()
+{
+    // Given
+    SpliceCalculator target;
+    target.setSolverParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+    Splice splice;
+    splice.setAppliedLoad( Tensor( 100.*N, 0.*N, 0.*N_m ) );
+    for (int i = 0; i < 500; ++i) {
+        splice.addFastener( Fastener( 1.*i*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ) );
+    }
+    QSignalSpy spy(&target, SIGNAL(resultsChanged()));
+
+    // When
+    target.read(splice);
+
+    // Then
+    QCOMPARE( spy.count(), 1 );
+    QCOMPARE( target.fastenerCount(), 500 );
+    QCOMPARE( target.resultAt(0).around(), Tensor( 0.2*N, 0.*N, 0.*N_m ) );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceCalculator::test_beginUpdate_endUpdate()
+{
+    // Given
+    SpliceCalculator target;
+    target.setSolverParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+    target.setAppliedLoad( Tensor( 100.*N, 0.*N, 0.*N_m ) );
+    QSignalSpy spy(&target, SIGNAL(resultsChanged()));
+
+    // When
+    target.beginUpdate();
+    target.insertFastener(0, Fastener(  1.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.beginUpdate(); /* nested */
+    target.insertFastener(1, Fastener(  2.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.setFastener(1, Fastener(  3.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.endUpdate();
+    const int countInBatch = spy.count();
+    target.endUpdate();
+
+    // Then
+    QCOMPARE( countInBatch, 0 );
+    QCOMPARE( spy.count(), 1 );
+    QCOMPARE( target.isUpdating(), false );
+    QCOMPARE( target.resultAt(0).around(), Tensor( 50.*N, 0.*N, 0.*N_m ) );
+    QCOMPARE( target.resultAt(1).around(), Tensor( 50.*N, 0.*N, 0.*N_m ) );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceCalculator::test_transaction()
+{
+    // Given
+    SpliceCalculator target;
+    target.setSolverParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+    target.setAppliedLoad( Tensor( 100.*N, 0.*N, 0.*N_m ) );
+    target.insertFastener(0, Fastener(  0.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(1, Fastener( 10.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(2, Fastener( 20.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    QSignalSpy spyChanged(&target, SIGNAL(changed()));
+    QSignalSpy spyResults(&target, SIGNAL(resultsChanged()));
+    QSignalSpy spyFinished(&target, SIGNAL(transactionFinished(int,int)));
+
+    QList<Fastener> fasteners;
+    for (int i = 0; i < 1000; ++i) {
+        fasteners << Fastener( 30.*_mm, double(i)*_mm, 4.83*_mm, 3.*_mm );
+    }
+
+    // When
+    target.beginTransaction();
+    target.setFastener(1, Fastener( 10.*_mm, 5.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFasteners(3, fasteners); /* nested */
+    target.removeFastener(2);
+    const bool inTransaction = target.isInTransaction();
+    target.endTransaction();
+
+    // Then
+    QCOMPARE( inTransaction, true );
+    QCOMPARE( target.isInTransaction(), false );
+    QCOMPARE( target.fastenerCount(), 1002 );
+    QCOMPARE( spyChanged.count(), 1 );
+    QCOMPARE( spyResults.count(), 1 );
+    QCOMPARE( spyFinished.count(), 1 );
+    QList<QVariant> arguments = spyFinished.takeFirst();
+    QCOMPARE( arguments.at(0).toInt(), 1 );
+    QCOMPARE( arguments.at(1).toInt(), 1002 );
+}
+
+void tst_SpliceCalculator::test_transaction_remove()
+{
+    // Given
+    SpliceCalculator target;
+    target.insertFastener(0, Fastener(  0.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(1, Fastener( 10.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(2, Fastener( 20.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    QSignalSpy spyFinished(&target, SIGNAL(transactionFinished(int,int)));
+
+    // When
+    target.beginTransaction();
+    target.removeFastener(1);
+    target.endTransaction();
+
+    // Then
+    /* The fastener moved from 2 to 1, no fastener at 2 */
+    QCOMPARE( spyFinished.count(), 1 );
+    QCOMPARE( spyFinished.at(0).at(0).toInt(), 1 );
+    QCOMPARE( spyFinished.at(0).at(1).toInt(), 1 );
+
+    // When
+    target.beginTransaction();
+    target.removeFastener(1);
+    target.endTransaction();
+
+    // Then
+    /* The last fastener: the range is not empty */
+    QCOMPARE( spyFinished.count(), 2 );
+    QCOMPARE( spyFinished.at(1).at(0).toInt(), 1 );
+    QCOMPARE( spyFinished.at(1).at(1).toInt(), 1 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceCalculator::test_flushTransaction()
+{
+    // Given
+    SpliceCalculator target;
+    target.setSolverParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+    target.setAppliedLoad( Tensor( 100.*N, 0.*N, 0.*N_m ) );
+    target.insertFastener(0, Fastener(  0.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(1, Fastener( 10.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    QSignalSpy spyChanged(&target, SIGNAL(changed()));
+    QSignalSpy spyResults(&target, SIGNAL(resultsChanged()));
+    QSignalSpy spyFastenersChanged(&target, SIGNAL(fastenersChanged(int,int)));
+
+    // When
+    target.beginTransaction();
+    for (int i = 1; i <= 10; ++i) {
+        /* Drag the fastener, one step per frame */
+        QMap<int, Fastener> fasteners;
+        fasteners.insert(1, Fastener( 10.*_mm, double(i)*_mm, 4.83*_mm, 3.*_mm ));
+        target.setFasteners(fasteners);
+        target.flushTransaction();
+    }
+    const int changedBeforeEnd = spyChanged.count();
+    target.setFastener(1, Fastener( 10.*_mm, 0.*_mm, 6.35*_mm, 3.*_mm ));
+    target.endTransaction();
+
+    // Then
+    QCOMPARE( changedBeforeEnd, 0 );
+    QCOMPARE( spyChanged.count(), 1 );
+    QCOMPARE( spyResults.count(), 11 );
+    QCOMPARE( spyFastenersChanged.count(), 11 );
+    Tensor expected1 = Tensor( 100.*N * 6.35 / (4.83 + 6.35), 0.*N, 0.*N_m );
+    QCOMPARE( target.resultAt(1).around(), expected1.around() );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceCalculator::test_rangeSignals()
+{
+    // Given
+    Splice splice;
+    for (int i = 0; i < 500; ++i) {
+        splice.addFastener( Fastener( double(i)*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ) );
+    }
+    SpliceCalculator target;
+    QSignalSpy spyInserted(&target, SIGNAL(fastenersInserted(int,int)));
+    QSignalSpy spyChanged(&target, SIGNAL(fastenersChanged(int,int)));
+    QSignalSpy spyRemoved(&target, SIGNAL(fastenersRemoved(int,int)));
+
+    // When
+    target.read(splice);
+    const int insertedByRead = spyInserted.count();
+    const QList<QVariant> readRange = spyInserted.takeLast();
+
+    target.beginTransaction();
+    for (int i = 10; i < 20; ++i) {
+        target.setFastener(i, Fastener( double(i)*_mm, 1.*_mm, 4.83*_mm, 3.*_mm ));
+    }
+    for (int i = 100; i < 110; ++i) {
+        target.removeFastener(100);
+    }
+    target.endTransaction();
+
+    // Then
+    QCOMPARE( insertedByRead, 1 );
+    QCOMPARE( readRange.at(0).toInt(), 0 );
+    QCOMPARE( readRange.at(1).toInt(), 499 );
+    QCOMPARE( spyChanged.count(), 1 );
+    QCOMPARE( spyChanged.at(0).at(0).toInt(), 10 );
+    QCOMPARE( spyChanged.at(0).at(1).toInt(), 19 );
+    QCOMPARE( spyRemoved.count(), 1 );
+    QCOMPARE( spyRemoved.at(0).at(0).toInt(), 100 );
+    QCOMPARE( spyRemoved.at(0).at(1).toInt(), 109 );
+    QCOMPARE( target.fastenerCount(), 490 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceCalculator::test_rangeSignals_outOfRange()
+{
+    // Given
+    SpliceCalculator target;
+    target.insertFastener(0, Fastener(  1.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(1, Fastener(  2.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.setFastenerSelection( {0,1} );
+    QSignalSpy spyInserted(&target, SIGNAL(fastenersInserted(int,int)));
+    QSignalSpy spyDesignSpaces(&target, SIGNAL(designSpacesInserted(int,int)));
+    QSignalSpy spyFinished(&target, SIGNAL(transactionFinished(int,int)));
+
+    // When
+    /* The indexes are bounded, like Splice::insertFastener() */
+    target.insertFastener(-1, Fastener(  3.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(target.fastenerCount() + 5, Fastener(  4.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertDesignSpace(-1, DesignSpace());
+    target.insertDesignSpace(target.designSpaceCount() + 5, DesignSpace());
+
+    // Then
+    QCOMPARE( target.fastenerCount(), 4 );
+    QCOMPARE( spyInserted.count(), 2 );
+    QCOMPARE( spyInserted.at(0).at(0).toInt(), 0 );
+    QCOMPARE( spyInserted.at(0).at(1).toInt(), 0 );
+    QCOMPARE( spyInserted.at(1).at(0).toInt(), 3 );
+    QCOMPARE( spyInserted.at(1).at(1).toInt(), 3 );
+    QCOMPARE( target.fastenerAt(0), Fastener(  3.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ) );
+    QCOMPARE( target.fastenerAt(3), Fastener(  4.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ) );
+    QCOMPARE( target.selectedFastenerIndexes(), QSet<int>({1,2}) );
+    QCOMPARE( spyDesignSpaces.count(), 2 );
+    QCOMPARE( spyDesignSpaces.at(0).at(0).toInt(), 0 );
+    QCOMPARE( spyDesignSpaces.at(1).at(0).toInt(), 1 );
+    QCOMPARE( spyDesignSpaces.at(1).at(1).toInt(), 1 );
+
+    // When
+    spyInserted.clear();
+    target.beginTransaction();
+    for (int i = 0; i < 3; ++i) {
+        target.insertFastener(target.fastenerCount() + 5, Fastener( 5.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    }
+    target.insertFastener(-1, Fastener( 6.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.endTransaction();
+
+    // Then
+    /* The insertions after the end are merged in one range */
+    QCOMPARE( target.fastenerCount(), 8 );
+    QCOMPARE( spyInserted.count(), 2 );
+    QCOMPARE( spyInserted.at(0).at(0).toInt(), 4 );
+    QCOMPARE( spyInserted.at(0).at(1).toInt(), 6 );
+    QCOMPARE( spyInserted.at(1).at(0).toInt(), 0 );
+    QCOMPARE( spyInserted.at(1).at(1).toInt(), 0 );
+    QCOMPARE( spyFinished.count(), 1 );
+    QCOMPARE( spyFinished.at(0).at(0).toInt(), 0 );
+    QCOMPARE( spyFinished.at(0).at(1).toInt(), 7 );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceCalculator::test_asynchronous_latestWins()
+{
+    // Given
+    SpliceCalculator target;
+    target.setSolverParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+    target.setAppliedLoad( Tensor( 100.*N, 0.*N, 0.*N_m ) );
+    target.insertFastener(0, Fastener(  0.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(1, Fastener( 10.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.setAsynchronous(true);
+    QSignalSpy spy(&target, SIGNAL(resultsChanged()));
+
+    // When
+    for (int i = 1; i <= 100; ++i) {
+        /* Drag the fastener */
+        target.setFastener(1, Fastener( 10.*_mm, double(i)*_mm, 4.83*_mm, 3.*_mm ));
+    }
+    target.setFastener(1, Fastener( 10.*_mm, 0.*_mm, 6.35*_mm, 3.*_mm ));
+    const int countBeforeEvents = spy.count();
+    target.waitForResults();
+
+    // Then
+    QCOMPARE( countBeforeEvents, 0 );
+    QCOMPARE( spy.count(), 1 );
+    QCOMPARE( target.isCalculating(), false );
+    Tensor expected0 = Tensor( 100.*N * 4.83 / (4.83 + 6.35), 0.*N, 0.*N_m );
+    Tensor expected1 = Tensor( 100.*N * 6.35 / (4.83 + 6.35), 0.*N, 0.*N_m );
+    QCOMPARE( target.resultAt(0).around(), expected0.around() );
+    QCOMPARE( target.resultAt(1).around(), expected1.around() );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceCalculator::test_solverCache_undo()
+{
+    // Given
+    SolverCache *cache = SolverCache::globalInstance();
+    cache->clear();
+    SpliceCalculator target;
+    target.setSolverParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+    target.setAppliedLoad( Tensor( 100.*N, 0.*N, 0.*N_m ) );
+    target.insertFastener(0, Fastener(  0.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(1, Fastener( 10.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    cache->resetCounters();
+
+    // When
+    target.setFastener(1, Fastener( 10.*_mm, 0.*_mm, 6.35*_mm, 3.*_mm ));
+    target.setFastener(1, Fastener( 10.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm )); /* Undo */
+    const quint64 hitCount = cache->hitCount();
+    const Tensor undone = target.resultAt(1);
+    target.setFastener(0, Fastener(  0.*_mm, 0.*_mm, 6.35*_mm, 3.*_mm ));
+
+    // Then
+    QCOMPARE( hitCount, quint64(1) );
+    QCOMPARE( cache->missCount(), quint64(2) );
+    QCOMPARE( undone.around(), Tensor( 50.*N, 0.*N, 0.*N_m ).around() );
+    /* The solver skipped the undone state, but still gives the right results. */
+    Tensor expected0 = Tensor( 100.*N * 6.35 / (4.83 + 6.35), 0.*N, 0.*N_m );
+    Tensor expected1 = Tensor( 100.*N * 4.83 / (4.83 + 6.35), 0.*N, 0.*N_m );
+    QCOMPARE( target.resultAt(0).around(), expected0.around() );
+    QCOMPARE( target.resultAt(1).around(), expected1.around() );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceCalculator::test_solverCache_asynchronousUpdate()
+{
+    /* The results are cached under the splice that was solved,
+     * even if the splice has changed since, without a new solve. */
+    // Given
+    SolverCache *cache = SolverCache::globalInstance();
+    cache->clear();
+    SpliceCalculator target;
+    target.setSolverParameters(SolverParameters::RigidBodySolverWithIsoBearing);
+    target.setAppliedLoad( Tensor( 100.*N, 0.*N, 0.*N_m ) );
+    target.insertFastener(0, Fastener(  0.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.insertFastener(1, Fastener( 10.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ));
+    target.setAsynchronous(true);
+
+    // When
+    target.setFastener(1, Fastener( 10.*_mm, 0.*_mm, 6.35*_mm, 3.*_mm ));
+    Splice submitted;
+    target.write(submitted);
+    target.beginUpdate();
+    target.setFastener(0, Fastener(  0.*_mm, 0.*_mm, 6.35*_mm, 3.*_mm ));
+    Splice postponed;
+    target.write(postponed);
+    target.waitForResults();
+
+    // Then
+    QList<Tensor> cached;
+    QVERIFY( !cache->find( target.solver(), &postponed, SolverCache::Results, &cached ) );
+    QVERIFY( cache->find( target.solver(), &submitted, SolverCache::Results, &cached ) );
+    QCOMPARE( cached.count(), 2 );
+    QCOMPARE( cached.at(1).around(),
+              Tensor( 100.*N * 6.35 / (4.83 + 6.35), 0.*N, 0.*N_m ).around() );
+
+    // When
+    target.endUpdate();
+    target.waitForResults();
+
+    // Then
+    QCOMPARE( target.resultAt(0).around(), Tensor( 50.*N, 0.*N, 0.*N_m ).around() );
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceCalculator::test_solverCache_cost()
+{
+    // Given
+    SolverCache cache;
+    RigidBodySolver solver;
+    Splice small;
+    small.addFastener( Fastener(  0.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ) );
+    small.addFastener( Fastener( 10.*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ) );
+    Splice big;
+    for (int i = 0; i < 1000; ++i) {
+        big.addFastener( Fastener( double(i)*_mm, 0.*_mm, 4.83*_mm, 3.*_mm ) );
+    }
+    const Tensor result( 1.*N, 0.*N, 0.*N_m );
+
+    // When
+    cache.insert( &solver, &small, SolverCache::Results, QList<Tensor>() << result << result );
+    const int smallCost = cache.cost();
+    QList<Tensor> bigResults;
+    for (int i = 0; i < 1000; ++i) {
+        bigResults << result;
+    }
+    cache.insert( &solver, &big, SolverCache::Results, bigResults );
+    const int bigCost = cache.cost() - smallCost;
+
+    // Then
+    /* The cost is in bytes, about 6n doubles of key plus n Tensors. */
+    QVERIFY( smallCost > 0 );
+    QVERIFY( bigCost >= 1000 * int(6 * sizeof(double) + sizeof(Tensor)) );
+    QVERIFY( bigCost > 100 * smallCost );
+
+    // When
+    /* The least recently used entry is discarded first. */
+    cache.setCapacity(bigCost);
+
+    // Then
+    QList<Tensor> cached;
+    QCOMPARE( cache.count(), 1 );
+    QVERIFY( cache.find( &solver, &big, SolverCache::Results, &cached ) );
+    QVERIFY( !cache.find( &solver, &small, SolverCache::Results, &cached ) );
+
+    // When
+    /* Too large for the cache */
+    cache.setCapacity(smallCost);
+
+    // Then
+    QCOMPARE( cache.count(), 0 );
+}
 
-QTEST_APPLESS_MAIN(tst_SpliceCalculator)
+QTEST_GUILESS_MAIN(tst_SpliceCalculator)
 
 #include "tst_splicecalculator.moc"
 
@@ -0,0 +1,197 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/Splice>
+#include <Core/SpliceFileWorker>
+
+#include "../common/splicefixture.h"
+
+#include <QtTest/QtTest>
+#include <QtCore/QFile>
+#include <QtCore/QTemporaryDir>
+
+#define C_TIMEOUT 10000 /* ms */
+
+class tst_SpliceFileWorker : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_saveAndLoad_data();
+    void test_saveAndLoad();
+    void test_load_missingFile();
+    void test_cancel();
+    void test_busy();
+    void test_waitForFinished();
+
+private:
+    Splice createBigSplice(int count) const;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+Splice tst_SpliceFileWorker::createBigSplice(int count) const
+{
+    Splice splice;
+    QVector<Fastener> fasteners;
+    fasteners.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        fasteners << Fastener( (i % 1000) *_mm, (i / 1000) *_mm, 4.83*_mm, 3.*_mm );
+    }
+    splice.addFastener(fasteners);
+    return splice;
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceFileWorker::test_saveAndLoad_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<int>("format");
+
+    QTest::newRow("json") << QString("test.splice") << int(SpliceFileWorker::Json);
+    QTest::newRow("binary") << QString("test.bsplice") << int(SpliceFileWorker::Binary);
+}
+
+void tst_SpliceFileWorker::test_saveAndLoad()
+{
+    QFETCH(QString, fileName);
+    QFETCH(int, format);
+
+    // Given
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.path() + QLatin1Char('/') + fileName;
+    const Splice expected = Fixture::createSplice();
+    SpliceFileWorker worker;
+    QSignalSpy spySaved(&worker, SIGNAL(saved(QString)));
+    QSignalSpy spyFinished(&worker, SIGNAL(finished(bool)));
+    Splice actual;
+    QObject::connect(&worker, &SpliceFileWorker::loaded,
+                     [&actual](const QString &, const Splice &splice) { actual = splice; });
+
+    // When
+    QVERIFY(worker.save(expected, path, SpliceFileWorker::Format(format)));
+    QVERIFY(spyFinished.wait(C_TIMEOUT));
+    QVERIFY(worker.load(path));
+    QVERIFY(spyFinished.wait(C_TIMEOUT));
+
+    // Then
+    QCOMPARE(spySaved.count(), 1);
+    QCOMPARE(spySaved.at(0).at(0).toString(), path);
+    QCOMPARE(spyFinished.count(), 2);
+    QCOMPARE(spyFinished.at(0).at(0).toBool(), true);
+    QCOMPARE(spyFinished.at(1).at(0).toBool(), true);
+    QCOMPARE(worker.operation(), SpliceFileWorker::Load);
+    QVERIFY(!worker.isRunning());
+    QCOMPARE(actual, expected);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceFileWorker::test_load_missingFile()
+{
+    // Given
+    QTemporaryDir dir;
+    const QString path = dir.path() + QStringLiteral("/missing.splice");
+    SpliceFileWorker worker;
+    QSignalSpy spyFailed(&worker, SIGNAL(failed(QString,QString)));
+    QSignalSpy spyFinished(&worker, SIGNAL(finished(bool)));
+
+    // When
+    QVERIFY(worker.load(path));
+    QVERIFY(spyFinished.wait(C_TIMEOUT));
+
+    // Then
+    QCOMPARE(spyFailed.count(), 1);
+    QVERIFY(!spyFailed.at(0).at(1).toString().isEmpty());
+    QCOMPARE(spyFinished.at(0).at(0).toBool(), false);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceFileWorker::test_cancel()
+{
+    // Given
+    QTemporaryDir dir;
+    const QString path = dir.path() + QStringLiteral("/cancelled.splice");
+    SpliceFileWorker worker;
+    QSignalSpy spyCancelled(&worker, SIGNAL(cancelled(QString)));
+    QSignalSpy spySaved(&worker, SIGNAL(saved(QString)));
+    QSignalSpy spyFinished(&worker, SIGNAL(finished(bool)));
+
+    // When
+    /* The cancellation is requested before the first write. */
+    QVERIFY(worker.save(createBigSplice(100000), path));
+    worker.cancel();
+    QVERIFY(spyFinished.wait(C_TIMEOUT));
+
+    // Then
+    QCOMPARE(spyCancelled.count(), 1);
+    QCOMPARE(spySaved.count(), 0);
+    QCOMPARE(spyFinished.at(0).at(0).toBool(), false);
+    QVERIFY(!QFile::exists(path)); /* QSaveFile didn't commit */
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceFileWorker::test_busy()
+{
+    // Given
+    QTemporaryDir dir;
+    const QString path = dir.path() + QStringLiteral("/busy.splice");
+    SpliceFileWorker worker;
+    QSignalSpy spyFinished(&worker, SIGNAL(finished(bool)));
+    QVERIFY(worker.save(createBigSplice(10000), path));
+
+    // When
+    bool started = worker.load(path);
+
+    // Then
+    /* Only one operation at a time */
+    QVERIFY(!started);
+    QCOMPARE(worker.operation(), SpliceFileWorker::Save);
+    QVERIFY(spyFinished.wait(C_TIMEOUT));
+    QCOMPARE(spyFinished.count(), 1);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceFileWorker::test_waitForFinished()
+{
+    // Given
+    QTemporaryDir dir;
+    const QString path = dir.path() + QStringLiteral("/wait.splice");
+    SpliceFileWorker worker;
+    QSignalSpy spySaved(&worker, SIGNAL(saved(QString)));
+    QSignalSpy spyFinished(&worker, SIGNAL(finished(bool)));
+    QVERIFY(worker.save(Fixture::createSplice(), path));
+
+    // When
+    bool ok = worker.waitForFinished();
+
+    // Then
+    /* The signals are emitted before the return, without event loop. */
+    QVERIFY(ok);
+    QVERIFY(!worker.isRunning());
+    QCOMPARE(spySaved.count(), 1);
+    QCOMPARE(spyFinished.count(), 1);
+    QVERIFY(QFile::exists(path));
+}
+
+QTEST_GUILESS_MAIN(tst_SpliceFileWorker)
+
+#include "tst_splicefileworker.moc"
@@ -0,0 +1,203 @@
+/* - FastenerPattern - Copyright (C) 2016-2017 Sebastien Vavassori
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Core/Splice>
+#include <Core/SpliceJson>
+
+#include "../common/splicefixture.h"
+
+#include <QtTest/QtTest>
+#include <QtCore/QBuffer>
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+class tst_SpliceJson : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void test_roundTrip();
+    void test_readQJsonDocument();
+    void test_writeQJsonDocument();
+    void test_unknownMembers();
+    void test_escapedStrings();
+    void test_malformed_data();
+    void test_malformed();
+
+private:
+    bool readBytes(const QByteArray &bytes, Splice *splice, QString *error = Q_NULLPTR) const;
+};
+
+/******************************************************************************
+ ******************************************************************************/
+bool tst_SpliceJson::readBytes(const QByteArray &bytes, Splice *splice, QString *error) const
+{
+    QByteArray data(bytes);
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    return SpliceJson::read(&buffer, splice, error);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceJson::test_roundTrip()
+{
+    // Given
+    Splice expected = Fixture::createSplice();
+
+    // When
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::WriteOnly);
+    bool written = SpliceJson::write(expected, &buffer);
+    buffer.close();
+
+    Splice actual;
+    bool ok = readBytes(bytes, &actual);
+
+    // Then
+    QVERIFY(written);
+    QVERIFY(ok);
+    QCOMPARE(actual, expected);
+    QCOMPARE(actual.fastenerAt(1).DoF_X, Fastener::Free);
+    QCOMPARE(actual.fastenerAt(2).DoF_Y, Fastener::Free);
+    QCOMPARE(actual.designSpaceAt(0).polygon.count(), 3);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceJson::test_readQJsonDocument()
+{
+    // Given
+    Splice expected = Fixture::createSplice();
+    QJsonObject json;
+    expected.write(json);
+    QByteArray bytes = QJsonDocument(json).toJson();
+
+    // When
+    Splice actual;
+    bool ok = readBytes(bytes, &actual);
+
+    // Then
+    QVERIFY(ok);
+    QCOMPARE(actual, expected);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceJson::test_writeQJsonDocument()
+{
+    // Given
+    Splice splice = Fixture::createSplice();
+    QJsonObject expected;
+    splice.write(expected);
+
+    // When
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::WriteOnly);
+    SpliceJson::write(splice, &buffer);
+    buffer.close();
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(bytes, &error);
+
+    // Then
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(doc.object(), expected);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceJson::test_unknownMembers()
+{
+    // Given
+    QByteArray bytes(
+                "{ \"version\": { \"major\": 2, \"tags\": [1, [true, null], {}] },"
+                "  \"title\": \"Unknown\","
+                "  \"fasteners\": [ { \"name\": \"F\", \"color\": [0, 0, 255],"
+                "                     \"position_x\": 0.5, \"DoF_X\": true } ],"
+                "  \"load\": { \"fx\": 10, \"comment\": \"ignored\" } }");
+
+    QJsonObject json = QJsonDocument::fromJson(bytes).object();
+    Splice expected;
+    expected.read(json);
+
+    // When
+    Splice actual;
+    bool ok = readBytes(bytes, &actual);
+
+    // Then
+    QVERIFY(ok);
+    QCOMPARE(actual, expected);
+    QCOMPARE(actual.fastenerCount(), 1);
+    QCOMPARE(actual.fastenerAt(0).positionX.value(), 0.5);
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceJson::test_escapedStrings()
+{
+    // Given
+    QByteArray bytes("{ \"title\": \"a\\\"b\\\\c\\/d\\n\\u00e9\\ud83d\\ude00\" }");
+
+    // When
+    Splice actual;
+    bool ok = readBytes(bytes, &actual);
+
+    // Then
+    QVERIFY(ok);
+    QCOMPARE(actual.title(), QString::fromUtf8("a\"b\\c/d\n\xC3\xA9\xF0\x9F\x98\x80"));
+}
+
+/******************************************************************************
+ ******************************************************************************/
+void tst_SpliceJson::test_malformed_data()
+{
+    QTest::addColumn<QByteArray>("bytes");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("array") << QByteArray("[]");
+    QTest::newRow("truncated") << QByteArray("{ \"title\": \"abc");
+    QTest::newRow("missing colon") << QByteArray("{ \"title\" \"abc\" }");
+    QTest::newRow("missing comma") << QByteArray("{ \"title\": \"a\" \"author\": \"b\" }");
+    QTest::newRow("bad literal") << QByteArray("{ \"fasteners\": [ { \"DoF_X\": tru } ] }");
+    QTest::newRow("bad number") << QByteArray("{ \"load\": { \"fx\": - } }");
+    QTest::newRow("trailing data") << QByteArray("{ } }");
+}
+
+void tst_SpliceJson::test_malformed()
+{
+    QFETCH(QByteArray, bytes);
+
+    // Given
+    Splice expected = Fixture::createSplice();
+    Splice actual = expected;
+
+    // When
+    QString error;
+    bool ok = readBytes(bytes, &actual, &error);
+
+    // Then
+    QVERIFY(!ok);
+    QVERIFY(!error.isEmpty());
+    QCOMPARE(actual, expected);
+}
+
+QTEST_APPLESS_MAIN(tst_SpliceJson)
+
+#include "tst_splicejson.moc"
@@ -2,9 +2,20 @@ TEMPLATE = subdirs
 CONFIG  += ordered
 
 SUBDIRS += $$PWD/boost
+SUBDIRS += $$PWD/calculator
 SUBDIRS += $$PWD/delaunay
+SUBDIRS += $$PWD/fastenertablemodel
+SUBDIRS += $$PWD/finiteelementsolver
+SUBDIRS += $$PWD/imagepyramid
+SUBDIRS += $$PWD/logmodel
 SUBDIRS += $$PWD/math
 SUBDIRS += $$PWD/optimisationsolver
+SUBDIRS += $$PWD/resulttablemodel
 SUBDIRS += $$PWD/rigidbodysolver
+SUBDIRS += $$PWD/solverservice
+SUBDIRS += $$PWD/sparsecholesky
+SUBDIRS += $$PWD/splicebinary
+SUBDIRS += $$PWD/splicejson
 SUBDIRS += $$PWD/splicecalculator
+SUBDIRS += $$PWD/splicefileworker
 SUBDIRS += $$PWD/tensor